@@ -127,6 +127,9 @@ static void* poll_thread(void* arg) {
 
     vtx_log_info("Poll thread started");
 
+    /* 应用config.thread中的CPU亲和性/实时调度配置（全0时不做修改） */
+    vtx_rx_apply_thread_config(rx);
+
     while (g_running) {
         /* 轮询事件，超时100ms */
         int ret = vtx_rx_poll(rx, 100);
@@ -177,6 +180,7 @@ int main(int argc, char* argv[]) {
         .mtu = VTX_DEFAULT_MTU,
         .recv_buf_size = VTX_DEFAULT_RECV_BUF,
         .frame_timeout_ms = VTX_DEFAULT_FRAME_TIMEOUT_MS,
+        .latency_stats = true,
     };
 
     /* 创建接收端 */
@@ -200,10 +204,11 @@ int main(int argc, char* argv[]) {
     /* 稍微等待让poll线程启动 */
     usleep(100000);  /* 100ms */
 
-    vtx_log_info("Calling vtx_rx_connect()...");
+    vtx_log_info("Calling vtx_rx_connect_start()...");
 
-    /* 连接到服务器 */
-    ret = vtx_rx_connect(rx);
+    /* 连接到服务器，同时请求开始媒体传输（0-RTT，旧服务器自动回退为START） */
+    const char* media_url = "/h264_30fps.mp4";  /* 相对于服务器根目录(data) */
+    ret = vtx_rx_connect_start(rx, media_url);
 
     if (ret != VTX_OK) {
         vtx_log_error("Failed to connect: %d", ret);
@@ -229,15 +234,7 @@ int main(int argc, char* argv[]) {
     }
 
     vtx_log_info("Connected successfully!");
-
-    /* 请求开始媒体传输 */
-    const char* media_url = "/h264_30fps.mp4";  /* 相对于服务器根目录(data) */
-    ret = vtx_rx_start(rx, media_url);
-    if (ret != VTX_OK) {
-        vtx_log_error("Failed to send START request: %d", ret);
-    } else {
-        vtx_log_info("Requested media streaming from server: %s", media_url);
-    }
+    vtx_log_info("Requested media streaming from server: %s", media_url);
 
     /* 主循环：定期发送测试数据 */
     int data_count = 0;
@@ -261,11 +258,21 @@ int main(int argc, char* argv[]) {
         if (data_count % 10 == 0) {
             vtx_rx_stats_t stats;
             if (vtx_rx_get_stats(rx, &stats) == VTX_OK) {
-                vtx_log_info("Stats: frames=%llu packets=%llu bytes=%llu lost=%llu",
+                vtx_log_info("Stats: frames=%llu packets=%llu bytes=%llu lost=%llu "
+                             "kernel_drops=%llu",
                              (unsigned long long)stats.total_frames,
                              (unsigned long long)stats.total_packets,
                              (unsigned long long)stats.total_bytes,
-                             (unsigned long long)stats.lost_packets);
+                             (unsigned long long)stats.lost_packets,
+                             (unsigned long long)stats.kernel_drops);
+                vtx_log_info("Latency p50/p99 (us): reassembly=%llu/%llu "
+                             "deliver=%llu/%llu callback=%llu/%llu",
+                             (unsigned long long)vtx_latency_hist_percentile(&stats.lat_reassembly, 50.0),
+                             (unsigned long long)vtx_latency_hist_percentile(&stats.lat_reassembly, 99.0),
+                             (unsigned long long)vtx_latency_hist_percentile(&stats.lat_deliver, 50.0),
+                             (unsigned long long)vtx_latency_hist_percentile(&stats.lat_deliver, 99.0),
+                             (unsigned long long)vtx_latency_hist_percentile(&stats.lat_callback, 50.0),
+                             (unsigned long long)vtx_latency_hist_percentile(&stats.lat_callback, 99.0));
             }
         }
     }
@@ -0,0 +1,576 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file loadgen.c
+ * @brief VTX Synthetic Load Generator
+ *
+ * 压测程序（不需要FFmpeg和媒体文件）：
+ * - 同一进程内启动N个发送端会话（端口依次递增），可选同时启动N个本地接收端
+ * - 按GOP/帧率/帧大小分布生成合成帧，帧头8字节为发送时间（CLOCK_MONOTONIC微秒）
+ * - 会话按爬升时间逐个启动，保持一段时间后按下降时间逐个停止
+ * - 定期输出总吞吐、CPU占用和内存，结束时输出每个会话的延迟分位数
+ *   （有本地接收端时为端到端延迟，否则为发送端提交→首分片发出延迟）
+ *
+ * 用法：vtx_loadgen [-n 会话数] [-r] [-a 地址] [-p 起始端口] [-f fps] [-g gop]
+ *                    [-s P帧字节] [-i I/P大小比] [-j 抖动百分比] [-d 保持秒数]
+ *                    [-u 爬升秒数] [-D 下降秒数] [-t 报告间隔秒数]
+ */
+
+#include "vtx.h"
+#include "vtx_frame.h"
+#include "vtx_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define LOADGEN_MAX_SESSIONS    1024
+#define LOADGEN_MIN_FRAME_SIZE  16      /* 帧头时间戳 + 少量负载 */
+#define LOADGEN_MAX_LAG_US      (1000 * 1000)
+
+/* 命令行参数 */
+typedef struct {
+    int         sessions;       /* 会话数 */
+    bool        local_rx;       /* 是否启动本地接收端 */
+    const char* addr;           /* 发送端绑定地址/接收端连接地址 */
+    uint16_t    base_port;      /* 第一个会话的端口 */
+    uint32_t    fps;            /* 帧率 */
+    uint32_t    gop;            /* GOP长度（每gop帧一个I帧） */
+    uint32_t    p_size;         /* P帧平均大小（字节） */
+    uint32_t    i_ratio;        /* I帧大小 = P帧平均大小 * i_ratio */
+    uint32_t    jitter;         /* 帧大小均匀抖动（百分比） */
+    uint32_t    duration_s;     /* 全部会话启动后的保持时间 */
+    uint32_t    ramp_up_s;      /* 会话逐个启动的总时间 */
+    uint32_t    ramp_down_s;    /* 会话逐个停止的总时间 */
+    uint32_t    report_s;       /* 报告间隔 */
+} loadgen_opts_t;
+
+/* 单个会话 */
+typedef struct {
+    int                 index;
+    uint16_t            port;
+    pthread_t           thread;
+    pthread_t           rx_thread;
+    volatile int        running;        /* 发送线程运行标志 */
+    volatile int        rx_running;     /* 接收poll线程运行标志 */
+    volatile int        connected;
+    bool                started;
+    bool                failed;
+    unsigned int        seed;
+
+    vtx_tx_t*           tx;
+    vtx_rx_t*           rx;
+
+    /* 计数（发送/接收线程写，主线程读） */
+    atomic_uint_fast64_t tx_frames;
+    atomic_uint_fast64_t tx_bytes;
+    atomic_uint_fast64_t tx_drops;
+    atomic_uint_fast64_t rx_frames;
+    atomic_uint_fast64_t rx_bytes;
+
+    /* 延迟（只由接收poll线程写，会话结束后读） */
+    vtx_latency_hist_t  latency;
+    vtx_tx_stats_t      tx_stats;       /* 会话结束时的发送端统计 */
+} loadgen_session_t;
+
+static loadgen_opts_t g_opts = {
+    .sessions = 1,
+    .local_rx = false,
+    .addr = "127.0.0.1",
+    .base_port = 9000,
+    .fps = 30,
+    .gop = 30,
+    .p_size = 8000,
+    .i_ratio = 8,
+    .jitter = 20,
+    .duration_s = 10,
+    .ramp_up_s = 0,
+    .ramp_down_s = 0,
+    .report_s = 1,
+};
+
+static volatile int g_running = 1;
+static loadgen_session_t* g_sessions = NULL;
+
+/* 获取当前时间（微秒，单调时钟） */
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/* 信号处理函数 */
+static void signal_handler(int sig) {
+    (void)sig;
+    g_running = 0;
+}
+
+/* 进程CPU时间（微秒） */
+static uint64_t cpu_time_us(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000ULL +
+           (uint64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+}
+
+/* 当前常驻内存（KB），无/proc时退化为峰值 */
+static uint64_t rss_kb(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f) {
+        unsigned long size = 0;
+        unsigned long resident = 0;
+        int n = fscanf(f, "%lu %lu", &size, &resident);
+        fclose(f);
+        if (n == 2) {
+            return (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE) / 1024;
+        }
+    }
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return (uint64_t)ru.ru_maxrss / 1024;
+#else
+    return (uint64_t)ru.ru_maxrss;
+#endif
+}
+
+/* 合并延迟直方图 */
+static void hist_merge(vtx_latency_hist_t* dst, const vtx_latency_hist_t* src) {
+    dst->count += src->count;
+    dst->sum_us += src->sum_us;
+    if (src->max_us > dst->max_us) {
+        dst->max_us = src->max_us;
+    }
+    for (int i = 0; i < VTX_LATENCY_BUCKETS; i++) {
+        dst->buckets[i] += src->buckets[i];
+    }
+}
+
+/* 按分布生成下一帧大小 */
+static size_t next_frame_size(loadgen_session_t* s, bool key) {
+    uint64_t base = key ? (uint64_t)g_opts.p_size * g_opts.i_ratio : g_opts.p_size;
+    uint64_t span = base * g_opts.jitter / 100;
+    uint64_t size = base;
+    if (span > 0) {
+        size = base - span + (uint64_t)rand_r(&s->seed) % (2 * span + 1);
+    }
+    if (size < LOADGEN_MIN_FRAME_SIZE) {
+        size = LOADGEN_MIN_FRAME_SIZE;
+    }
+    if (size > VTX_MAX_FRAME_SIZE) {
+        size = VTX_MAX_FRAME_SIZE;
+    }
+    return (size_t)size;
+}
+
+/* ========== 接收端 ========== */
+
+/* 帧接收回调：帧头时间戳计算端到端延迟 */
+static int on_frame(
+    const uint8_t* frame_data,
+    size_t frame_size,
+    vtx_frame_type_t frame_type,
+    void* userdata)
+{
+    (void)frame_type;
+    loadgen_session_t* s = (loadgen_session_t*)userdata;
+
+    atomic_fetch_add(&s->rx_frames, 1);
+    atomic_fetch_add(&s->rx_bytes, frame_size);
+
+    if (frame_size >= sizeof(uint64_t)) {
+        uint64_t sent_us;
+        memcpy(&sent_us, frame_data, sizeof(sent_us));
+        uint64_t now = now_us();
+        if (now >= sent_us) {
+            vtx_latency_hist_record(&s->latency, now - sent_us);
+        }
+    }
+    return VTX_OK;
+}
+
+/* 接收端poll线程 */
+static void* rx_poll_thread(void* arg) {
+    loadgen_session_t* s = (loadgen_session_t*)arg;
+
+    while (s->rx_running) {
+        if (vtx_rx_poll(s->rx, 50) < 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* ========== 发送端 ========== */
+
+/* 发送一帧合成帧 */
+static void send_frame(loadgen_session_t* s, uint64_t frame_no) {
+    bool key = g_opts.gop <= 1 || frame_no % g_opts.gop == 0;
+
+    vtx_frame_t* frame = vtx_tx_alloc_media_frame(s->tx);
+    if (!frame) {
+        atomic_fetch_add(&s->tx_drops, 1);
+        return;
+    }
+
+    /* 负载内容不影响协议开销，只写时间戳 */
+    size_t size = next_frame_size(s, key);
+    uint64_t sent_us = now_us();
+    memcpy(frame->data, &sent_us, sizeof(sent_us));
+    frame->data_size = size;
+    frame->frame_type = key ? VTX_FRAME_I : VTX_FRAME_P;
+
+    if (vtx_tx_send_media(s->tx, frame) != VTX_OK) {
+        atomic_fetch_add(&s->tx_drops, 1);
+        return;
+    }
+    atomic_fetch_add(&s->tx_frames, 1);
+    atomic_fetch_add(&s->tx_bytes, size);
+}
+
+/* 会话线程：建立连接后按帧率发送 */
+static void* session_thread(void* arg) {
+    loadgen_session_t* s = (loadgen_session_t*)arg;
+
+    vtx_tx_config_t tx_config = {
+        .bind_addr = g_opts.addr,
+        .bind_port = s->port,
+        .mtu = VTX_DEFAULT_MTU,
+        .send_buf_size = VTX_SOCKBUF_AUTO,
+        .latency_stats = true,
+    };
+    s->tx = vtx_tx_create(&tx_config, NULL, NULL, NULL);
+    if (!s->tx || vtx_tx_listen(s->tx) != VTX_OK) {
+        vtx_log_error("Session %d: failed to listen on port %u", s->index, s->port);
+        s->failed = true;
+        return NULL;
+    }
+
+    if (g_opts.local_rx) {
+        vtx_rx_config_t rx_config = {
+            .server_addr = g_opts.addr,
+            .server_port = s->port,
+            .mtu = VTX_DEFAULT_MTU,
+            .recv_buf_size = VTX_SOCKBUF_AUTO,
+            .frame_timeout_ms = VTX_DEFAULT_FRAME_TIMEOUT_MS,
+        };
+        s->rx = vtx_rx_create(&rx_config, on_frame, NULL, NULL, s);
+        if (!s->rx) {
+            vtx_log_error("Session %d: failed to create RX", s->index);
+            s->failed = true;
+            return NULL;
+        }
+        s->rx_running = 1;
+        pthread_create(&s->rx_thread, NULL, rx_poll_thread, s);
+        vtx_rx_connect(s->rx);
+    }
+
+    /* 等待接收端连接（外部接收端可以随时连接） */
+    while (s->running) {
+        if (vtx_tx_accept(s->tx, 200) == VTX_OK) {
+            s->connected = 1;
+            break;
+        }
+    }
+
+    uint64_t interval_us = 1000000ULL / g_opts.fps;
+    uint64_t next_us = now_us();
+    uint64_t frame_no = 0;
+
+    while (s->running && s->connected) {
+        uint64_t now = now_us();
+        if (now >= next_us) {
+            send_frame(s, frame_no++);
+            next_us += interval_us;
+            if (now > next_us + LOADGEN_MAX_LAG_US) {
+                next_us = now;  /* 严重落后时重新对齐，避免突发 */
+            }
+            continue;
+        }
+
+        /* 不足1ms按1ms等待（timeout为0时select会一直阻塞） */
+        uint32_t wait_ms = (uint32_t)((next_us - now + 999) / 1000);
+        if (vtx_tx_poll(s->tx, wait_ms) < 0) {
+            break;
+        }
+    }
+
+    vtx_tx_get_stats(s->tx, &s->tx_stats);
+    vtx_tx_close(s->tx);
+
+    if (s->rx) {
+        s->rx_running = 0;
+        pthread_join(s->rx_thread, NULL);
+        vtx_rx_close(s->rx);
+    }
+    return NULL;
+}
+
+static void session_start(loadgen_session_t* s) {
+    s->running = 1;
+    s->started = true;
+    if (pthread_create(&s->thread, NULL, session_thread, s) != 0) {
+        vtx_log_error("Session %d: failed to create thread", s->index);
+        s->started = false;
+        s->failed = true;
+    }
+}
+
+static void session_stop(loadgen_session_t* s) {
+    if (!s->started) {
+        return;
+    }
+    s->running = 0;
+    pthread_join(s->thread, NULL);
+    s->started = false;
+
+    if (s->rx) {
+        vtx_rx_destroy(s->rx);
+        s->rx = NULL;
+    }
+    if (s->tx) {
+        vtx_tx_destroy(s->tx);
+        s->tx = NULL;
+    }
+}
+
+/* ========== 报告 ========== */
+
+typedef struct {
+    uint64_t time_us;
+    uint64_t cpu_us;
+    uint64_t tx_frames;
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+} loadgen_sample_t;
+
+static void take_sample(loadgen_sample_t* sample) {
+    memset(sample, 0, sizeof(*sample));
+    sample->time_us = now_us();
+    sample->cpu_us = cpu_time_us();
+    for (int i = 0; i < g_opts.sessions; i++) {
+        sample->tx_frames += atomic_load(&g_sessions[i].tx_frames);
+        sample->tx_bytes += atomic_load(&g_sessions[i].tx_bytes);
+        sample->rx_bytes += atomic_load(&g_sessions[i].rx_bytes);
+    }
+}
+
+static void report_interval(const loadgen_sample_t* prev, const loadgen_sample_t* cur,
+                            uint64_t start_us) {
+    double secs = (double)(cur->time_us - prev->time_us) / 1e6;
+    if (secs <= 0) {
+        return;
+    }
+
+    int active = 0;
+    int connected = 0;
+    for (int i = 0; i < g_opts.sessions; i++) {
+        active += g_sessions[i].started;
+        connected += g_sessions[i].started && g_sessions[i].connected;
+    }
+
+    printf("[%7.1fs] sessions=%d/%d tx=%.1fMbps rx=%.1fMbps fps=%.0f cpu=%.1f%% rss=%.1fMB\n",
+           (double)(cur->time_us - start_us) / 1e6, connected, active,
+           (double)(cur->tx_bytes - prev->tx_bytes) * 8 / secs / 1e6,
+           (double)(cur->rx_bytes - prev->rx_bytes) * 8 / secs / 1e6,
+           (double)(cur->tx_frames - prev->tx_frames) / secs,
+           (double)(cur->cpu_us - prev->cpu_us) / 1e4 / secs,
+           (double)rss_kb() / 1024);
+    fflush(stdout);
+}
+
+static void report_summary(const loadgen_sample_t* first, const loadgen_sample_t* last) {
+    double secs = (double)(last->time_us - first->time_us) / 1e6;
+    vtx_latency_hist_t total = {0};
+    const char* what = g_opts.local_rx ? "end-to-end" : "tx submit";
+
+    printf("\n=== Per-session latency (%s, ms) ===\n", what);
+    printf("%7s %10s %10s %8s %8s %8s %8s %8s\n",
+           "session", "tx_frames", "rx_frames", "drops", "p50", "p90", "p99", "max");
+    for (int i = 0; i < g_opts.sessions; i++) {
+        loadgen_session_t* s = &g_sessions[i];
+        const vtx_latency_hist_t* h = g_opts.local_rx ? &s->latency : &s->tx_stats.lat_submit;
+        hist_merge(&total, h);
+        printf("%7d %10llu %10llu %8llu %8.2f %8.2f %8.2f %8.2f%s\n", s->index,
+               (unsigned long long)atomic_load(&s->tx_frames),
+               (unsigned long long)atomic_load(&s->rx_frames),
+               (unsigned long long)atomic_load(&s->tx_drops),
+               (double)vtx_latency_hist_percentile(h, 50.0) / 1000,
+               (double)vtx_latency_hist_percentile(h, 90.0) / 1000,
+               (double)vtx_latency_hist_percentile(h, 99.0) / 1000,
+               (double)h->max_us / 1000,
+               s->failed ? "  (failed)" : "");
+    }
+
+    printf("\n=== Summary ===\n");
+    printf("elapsed=%.1fs sessions=%d fps=%u gop=%u p_size=%u i_ratio=%u jitter=%u%%\n",
+           secs, g_opts.sessions, g_opts.fps, g_opts.gop, g_opts.p_size,
+           g_opts.i_ratio, g_opts.jitter);
+    if (secs > 0) {
+        printf("throughput: tx=%.1fMbps rx=%.1fMbps frames=%.0f/s\n",
+               (double)(last->tx_bytes - first->tx_bytes) * 8 / secs / 1e6,
+               (double)(last->rx_bytes - first->rx_bytes) * 8 / secs / 1e6,
+               (double)(last->tx_frames - first->tx_frames) / secs);
+        printf("cpu=%.1f%% (of one core) rss=%.1fMB\n",
+               (double)(last->cpu_us - first->cpu_us) / 1e4 / secs,
+               (double)rss_kb() / 1024);
+    }
+    printf("latency (%s): p50=%.2fms p90=%.2fms p99=%.2fms p99.9=%.2fms max=%.2fms\n", what,
+           (double)vtx_latency_hist_percentile(&total, 50.0) / 1000,
+           (double)vtx_latency_hist_percentile(&total, 90.0) / 1000,
+           (double)vtx_latency_hist_percentile(&total, 99.0) / 1000,
+           (double)vtx_latency_hist_percentile(&total, 99.9) / 1000,
+           (double)total.max_us / 1000);
+}
+
+/* ========== 主程序 ========== */
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n N     number of TX sessions (default %d, max %d)\n"
+            "  -r       also run one local RX per session (end-to-end latency)\n"
+            "  -a ADDR  TX bind / RX connect address (default %s)\n"
+            "  -p PORT  first session port, session i uses PORT+i (default %u)\n"
+            "  -f FPS   frames per second per session (default %u)\n"
+            "  -g GOP   frames per GOP, first is an I-frame (default %u)\n"
+            "  -s BYTES average P-frame size (default %u)\n"
+            "  -i RATIO I-frame size as a multiple of the P-frame size (default %u)\n"
+            "  -j PCT   uniform frame size jitter in percent (default %u)\n"
+            "  -d SECS  hold time after all sessions are up (default %u)\n"
+            "  -u SECS  ramp-up time, sessions start evenly spread (default %u)\n"
+            "  -D SECS  ramp-down time, sessions stop evenly spread (default %u)\n"
+            "  -t SECS  report interval (default %u)\n",
+            prog, g_opts.sessions, LOADGEN_MAX_SESSIONS, g_opts.addr, g_opts.base_port,
+            g_opts.fps, g_opts.gop, g_opts.p_size, g_opts.i_ratio, g_opts.jitter,
+            g_opts.duration_s, g_opts.ramp_up_s, g_opts.ramp_down_s, g_opts.report_s);
+}
+
+/* 主线程睡眠到指定时间，期间按间隔输出报告 */
+static void sleep_until(uint64_t deadline_us, uint64_t start_us,
+                        loadgen_sample_t* prev, uint64_t* next_report_us) {
+    while (g_running) {
+        uint64_t now = now_us();
+        if (now >= *next_report_us) {
+            loadgen_sample_t cur;
+            take_sample(&cur);
+            report_interval(prev, &cur, start_us);
+            *prev = cur;
+            *next_report_us += (uint64_t)g_opts.report_s * 1000000ULL;
+            continue;
+        }
+        if (now >= deadline_us) {
+            return;
+        }
+
+        uint64_t wake = deadline_us < *next_report_us ? deadline_us : *next_report_us;
+        uint64_t wait = wake - now;
+        usleep((useconds_t)(wait < 100000 ? wait : 100000));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:ra:p:f:g:s:i:j:d:u:D:t:h")) != -1) {
+        switch (opt) {
+        case 'n': g_opts.sessions = atoi(optarg); break;
+        case 'r': g_opts.local_rx = true; break;
+        case 'a': g_opts.addr = optarg; break;
+        case 'p': g_opts.base_port = (uint16_t)atoi(optarg); break;
+        case 'f': g_opts.fps = (uint32_t)atoi(optarg); break;
+        case 'g': g_opts.gop = (uint32_t)atoi(optarg); break;
+        case 's': g_opts.p_size = (uint32_t)atoi(optarg); break;
+        case 'i': g_opts.i_ratio = (uint32_t)atoi(optarg); break;
+        case 'j': g_opts.jitter = (uint32_t)atoi(optarg); break;
+        case 'd': g_opts.duration_s = (uint32_t)atoi(optarg); break;
+        case 'u': g_opts.ramp_up_s = (uint32_t)atoi(optarg); break;
+        case 'D': g_opts.ramp_down_s = (uint32_t)atoi(optarg); break;
+        case 't': g_opts.report_s = (uint32_t)atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (g_opts.sessions < 1 || g_opts.sessions > LOADGEN_MAX_SESSIONS ||
+        g_opts.fps == 0 || g_opts.report_s == 0 || g_opts.jitter > 100 ||
+        g_opts.base_port + g_opts.sessions - 1 > 65535) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    signal(SIGPIPE, SIG_IGN);
+
+    g_sessions = (loadgen_session_t*)calloc((size_t)g_opts.sessions, sizeof(loadgen_session_t));
+    if (!g_sessions) {
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < g_opts.sessions; i++) {
+        g_sessions[i].index = i;
+        g_sessions[i].port = (uint16_t)(g_opts.base_port + i);
+        g_sessions[i].seed = (unsigned int)(i * 2654435761u + 1);
+    }
+
+    printf("vtx_loadgen: %d session(s) on %s:%u-%u%s, %ufps gop=%u\n",
+           g_opts.sessions, g_opts.addr, g_opts.base_port,
+           g_opts.base_port + g_opts.sessions - 1,
+           g_opts.local_rx ? " with local RX" : ", waiting for external RX",
+           g_opts.fps, g_opts.gop);
+
+    uint64_t start_us = now_us();
+    uint64_t next_report_us = start_us + (uint64_t)g_opts.report_s * 1000000ULL;
+    loadgen_sample_t first;
+    loadgen_sample_t prev;
+    take_sample(&first);
+    prev = first;
+
+    /* 爬升：会话i在 i * ramp_up / N 时启动 */
+    uint64_t ramp_up_us = (uint64_t)g_opts.ramp_up_s * 1000000ULL;
+    for (int i = 0; i < g_opts.sessions && g_running; i++) {
+        sleep_until(start_us + ramp_up_us * (uint64_t)i / (uint64_t)g_opts.sessions,
+                    start_us, &prev, &next_report_us);
+        if (g_running) {
+            session_start(&g_sessions[i]);
+        }
+    }
+
+    /* 保持 */
+    uint64_t hold_end_us = start_us + ramp_up_us + (uint64_t)g_opts.duration_s * 1000000ULL;
+    sleep_until(hold_end_us, start_us, &prev, &next_report_us);
+
+    /* 下降：会话i在 hold_end + i * ramp_down / N 时停止（中断时立即全部停止） */
+    uint64_t ramp_down_us = (uint64_t)g_opts.ramp_down_s * 1000000ULL;
+    for (int i = 0; i < g_opts.sessions; i++) {
+        sleep_until(hold_end_us + ramp_down_us * (uint64_t)i / (uint64_t)g_opts.sessions,
+                    start_us, &prev, &next_report_us);
+        session_stop(&g_sessions[i]);
+    }
+
+    loadgen_sample_t last;
+    take_sample(&last);
+    report_summary(&first, &last);
+
+    free(g_sessions);
+    return EXIT_SUCCESS;
+}
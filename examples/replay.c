@@ -0,0 +1,268 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file replay.c
+ * @brief VTX Capture Replay
+ *
+ * 离线回放工具：
+ * - 读取pcapng/pcap抓包（vtx_tx/vtx_rx的capture_path或tcpdump抓取），
+ *   把发送端发出的数据报按原始时间间隔（或加速）注入本地接收端
+ * - 发送端地址取第一个媒体分片的源地址（可用-p指定源端口），其他数据报忽略
+ * - 结束时输出各类型帧数、不完整帧、丢包、完整性校验失败和重组延迟分位数，
+ *   可把收到的帧写入文件
+ *
+ * 用法：vtx_replay [-s 倍速] [-p 发送端端口] [-o 输出文件] [-k 密钥文件] 抓包文件
+ *       -s 0 表示不按时间间隔，尽快注入
+ */
+
+#include "vtx.h"
+#include "vtx_pcap.h"
+#include "vtx_error.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#define REPLAY_FRAME_TYPE_OFFSET    6       /* 包头中frame_type的偏移 */
+#define REPLAY_BATCH                256     /* 尽快注入时每批包数 */
+#define REPLAY_DRAIN_MS             500     /* 结束后等待不完整帧超时清理 */
+
+/* 回放状态 */
+typedef struct {
+    uint64_t    frames[VTX_FRAME_A + 1];    /* 按类型统计的帧数 */
+    uint64_t    bytes;
+    FILE*       out;                        /* 帧输出文件（可选） */
+} replay_ctx_t;
+
+static uint64_t replay_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static int on_frame(const uint8_t* data, size_t size,
+                    vtx_frame_type_t type, void* userdata) {
+    replay_ctx_t* ctx = (replay_ctx_t*)userdata;
+    if (type >= VTX_FRAME_I && type <= VTX_FRAME_A) {
+        ctx->frames[type]++;
+    }
+    ctx->bytes += size;
+    if (ctx->out && type != VTX_FRAME_A) {
+        fwrite(data, 1, size, ctx->out);
+    }
+    return 0;
+}
+
+static bool is_media(const vtx_pcap_packet_t* pkt) {
+    if (pkt->size < VTX_PACKET_HEADER_SIZE) {
+        return false;
+    }
+    uint8_t type = pkt->data[REPLAY_FRAME_TYPE_OFFSET];
+    return type >= VTX_FRAME_I && type <= VTX_FRAME_A;
+}
+
+static bool same_endpoint(const struct sockaddr_in* a, const struct sockaddr_in* b) {
+    return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+static int load_key(const char* path, uint8_t* key) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+    size_t n = fread(key, 1, VTX_CRYPTO_KEY_SIZE, fp);
+    fclose(fp);
+    return n == VTX_CRYPTO_KEY_SIZE ? 0 : -1;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-s speed] [-p port] [-o out] [-k keyfile] <capture>\n"
+            "  -s speed    Replay speed (default 1.0, 0 = as fast as possible)\n"
+            "  -p port     Sender source port (default: source of first media packet)\n"
+            "  -o out      Write delivered video frames (Annex-B) to file\n"
+            "  -k keyfile  AES-128-GCM key file (encrypted sessions)\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    double speed = 1.0;
+    int port = 0;
+    const char* out_path = NULL;
+    const char* key_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:p:o:k:h")) != -1) {
+        switch (opt) {
+        case 's': speed = atof(optarg); break;
+        case 'p': port = atoi(optarg); break;
+        case 'o': out_path = optarg; break;
+        case 'k': key_path = optarg; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind >= argc || speed < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    /* 第一遍：确定发送端地址 */
+    vtx_pcap_reader_t* reader = vtx_pcap_reader_open(argv[optind]);
+    if (!reader) {
+        return 1;
+    }
+    vtx_pcap_packet_t pkt;
+    struct sockaddr_in sender;
+    bool found = false;
+    int ret;
+    while ((ret = vtx_pcap_reader_next(reader, &pkt)) == VTX_OK) {
+        if (is_media(&pkt) && (port == 0 || ntohs(pkt.src.sin_port) == port)) {
+            sender = pkt.src;
+            found = true;
+            break;
+        }
+    }
+    vtx_pcap_reader_close(reader);
+    if (!found) {
+        fprintf(stderr, "No VTX media packets found in %s\n", argv[optind]);
+        return 1;
+    }
+    printf("Replaying %s: sender %s:%u, ", argv[optind],
+           inet_ntoa(sender.sin_addr), ntohs(sender.sin_port));
+    if (speed > 0) {
+        printf("speed %.2fx\n", speed);
+    } else {
+        printf("as fast as possible\n");
+    }
+
+    replay_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    if (out_path && !(ctx.out = fopen(out_path, "wb"))) {
+        perror(out_path);
+        return 1;
+    }
+
+    uint8_t key[VTX_CRYPTO_KEY_SIZE];
+    if (key_path && load_key(key_path, key) != 0) {
+        fprintf(stderr, "Failed to read %d-byte key from %s\n",
+                VTX_CRYPTO_KEY_SIZE, key_path);
+        return 1;
+    }
+
+    /* 本地接收端：不连接，应答发往discard端口 */
+    vtx_rx_config_t config = {
+        .server_addr = "127.0.0.1",
+        .server_port = 9,
+        .mtu = VTX_DEFAULT_MTU,
+        .crypto_key = key_path ? key : NULL,
+        .latency_stats = true,
+    };
+    vtx_rx_t* rx = vtx_rx_create(&config, on_frame, NULL, NULL, &ctx);
+    if (!rx) {
+        return 1;
+    }
+
+    /* 第二遍：按时间注入 */
+    reader = vtx_pcap_reader_open(argv[optind]);
+    if (!reader) {
+        vtx_rx_destroy(rx);
+        return 1;
+    }
+    uint64_t packets = 0, skipped = 0, rejected = 0;
+    uint64_t first_ts = 0, last_ts = 0;
+    uint64_t start_us = replay_now_us();
+    while ((ret = vtx_pcap_reader_next(reader, &pkt)) == VTX_OK) {
+        if (!same_endpoint(&pkt.src, &sender)) {
+            skipped++;
+            continue;
+        }
+        if (packets == 0) {
+            first_ts = pkt.ts_us;
+        }
+        if (pkt.ts_us > last_ts) {
+            last_ts = pkt.ts_us;
+        }
+
+        if (speed > 0) {
+            /* 按原始间隔等待，等待期间由poll完成超时清理 */
+            uint64_t due = start_us + (uint64_t)((double)(last_ts - first_ts) / speed);
+            for (uint64_t now = replay_now_us(); now < due; now = replay_now_us()) {
+                uint32_t wait_ms = (uint32_t)((due - now) / 1000);
+                if (wait_ms == 0) {
+                    break;
+                }
+                vtx_rx_poll(rx, wait_ms);
+            }
+        } else if (packets % REPLAY_BATCH == 0) {
+            vtx_rx_poll(rx, 1);
+        }
+
+        if (vtx_rx_inject_packet(rx, pkt.data, pkt.size) != VTX_OK) {
+            rejected++;
+        }
+        packets++;
+    }
+    double elapsed = (double)(replay_now_us() - start_us) / 1e6;
+    if (ret != VTX_ERR_FILE_EOF) {
+        fprintf(stderr, "Capture truncated or corrupted after %llu packets\n",
+                (unsigned long long)packets);
+    }
+    vtx_pcap_reader_close(reader);
+
+    /* 等待未完成的帧超时 */
+    uint64_t drain_end = replay_now_us() + REPLAY_DRAIN_MS * 1000;
+    while (replay_now_us() < drain_end) {
+        vtx_rx_poll(rx, 10);
+    }
+
+    vtx_rx_stats_t stats;
+    vtx_rx_get_stats(rx, &stats);
+    printf("Packets: %llu injected, %llu rejected, %llu skipped (other endpoints)\n",
+           (unsigned long long)packets, (unsigned long long)rejected,
+           (unsigned long long)skipped);
+    printf("Frames:  %llu (I=%llu P=%llu SPS=%llu PPS=%llu A=%llu), %llu bytes\n",
+           (unsigned long long)stats.total_frames,
+           (unsigned long long)ctx.frames[VTX_FRAME_I],
+           (unsigned long long)ctx.frames[VTX_FRAME_P],
+           (unsigned long long)ctx.frames[VTX_FRAME_SPS],
+           (unsigned long long)ctx.frames[VTX_FRAME_PPS],
+           (unsigned long long)ctx.frames[VTX_FRAME_A],
+           (unsigned long long)ctx.bytes);
+    printf("Loss:    %llu packets lost, %llu duplicates, %llu incomplete frames\n",
+           (unsigned long long)stats.lost_packets,
+           (unsigned long long)stats.dup_packets,
+           (unsigned long long)stats.incomplete_frames);
+    printf("Integrity: %llu frame hash failures, %llu authentication failures\n",
+           (unsigned long long)stats.hash_failures,
+           (unsigned long long)stats.auth_failures);
+    printf("Reassembly: p50=%lluus p99=%lluus max=%lluus\n",
+           (unsigned long long)vtx_latency_hist_percentile(&stats.lat_reassembly, 50.0),
+           (unsigned long long)vtx_latency_hist_percentile(&stats.lat_reassembly, 99.0),
+           (unsigned long long)stats.lat_reassembly.max_us);
+    printf("Time:    %.3fs captured, %.3fs replayed (%.0f packets/s)\n",
+           (double)(last_ts - first_ts) / 1e6, elapsed,
+           elapsed > 0 ? (double)packets / elapsed : 0.0);
+
+    vtx_rx_destroy(rx);
+    if (ctx.out) {
+        fclose(ctx.out);
+    }
+    return 0;
+}
@@ -162,6 +162,11 @@ static int on_data(vtx_data_type_t type, const uint8_t* data,
 
     if (type == VTX_DATA_USER && data && size > 0) {
         vtx_log_info("Received DATA: %.*s", (int)size, (char*)data);
+    } else if (type == VTX_DATA_LIMIT && size == sizeof(vtx_limits_t)) {
+        /* 文件源无法重新编码，超限帧由VTX丢弃 */
+        const vtx_limits_t* limits = (const vtx_limits_t*)data;
+        vtx_log_info("Client limits: %ukbps %ufps (frames over limit will be dropped)",
+                     limits->max_bitrate_kbps, limits->max_fps);
     }
 
     return VTX_OK;
@@ -221,21 +226,29 @@ static void cleanup_ffmpeg(ffmpeg_ctx_t* ctx) {
     }
 }
 
+/* 外部缓冲区释放回调：归还AVPacket引用 */
+static void on_packet_release(const uint8_t* data, size_t size, void* ctx) {
+    (void)data;
+    (void)size;
+    AVPacket* pkt = (AVPacket*)ctx;
+    av_packet_free(&pkt);
+}
+
 /* 发送媒体帧 */
 static int send_media_frame(vtx_tx_t* tx, AVPacket* pkt, vtx_frame_type_t frame_type) {
-    /* 从TX分配media frame */
-    vtx_frame_t* frame = vtx_tx_alloc_media_frame(tx);
-    if (!frame) {
-        vtx_log_error("Failed to allocate media frame");
+    /* 增加packet引用，直接包装为media frame（零拷贝） */
+    AVPacket* ref = av_packet_clone(pkt);
+    if (!ref) {
+        vtx_log_error("Failed to reference packet");
         return VTX_ERR_NO_MEMORY;
     }
 
-    /* 复制packet数据到frame */
-    size_t copied = vtx_frame_copyto(frame, 0, pkt->data, pkt->size);
-    if (copied != (size_t)pkt->size) {
-        vtx_log_error("Failed to copy packet data: copied=%zu expected=%d", copied, pkt->size);
-        vtx_tx_free_frame(tx, frame);
-        return VTX_ERR_INVALID_PARAM;
+    vtx_frame_t* frame = vtx_tx_wrap_media_frame(tx, ref->data, ref->size,
+                                                 on_packet_release, ref);
+    if (!frame) {
+        vtx_log_error("Failed to wrap media frame: size=%d", ref->size);
+        av_packet_free(&ref);
+        return VTX_ERR_NO_MEMORY;
     }
 
     /* 设置帧类型 */
@@ -352,6 +365,9 @@ static void* poll_thread(void* arg) {
 
     vtx_log_info("Poll thread started");
 
+    /* 应用config.thread中的CPU亲和性/实时调度配置（全0时不做修改） */
+    vtx_tx_apply_thread_config(tx);
+
     while (g_running) {
         int ret = vtx_tx_poll(tx, 100);
         if (ret < 0) {
@@ -34,6 +34,7 @@
 #ifndef VTX_H
 #define VTX_H
 
+#include <sys/uio.h>
 #include "vtx_types.h"
 #include "vtx_error.h"
 
@@ -124,7 +125,8 @@ vtx_tx_t* vtx_tx_create(
  * @param tx 发送端对象
  * @return 0成功，负数表示错误码
  *
- * 注意：调用后发送端开始监听指定端口，等待接收端连接
+ * 注意：调用后发送端开始监听指定端口，等待接收端连接；
+ * 配置了path_addrs时同时绑定各额外路径的socket（端口由系统分配）
  */
 int vtx_tx_listen(vtx_tx_t* tx);
 
@@ -152,6 +154,20 @@ int vtx_tx_accept(vtx_tx_t* tx, uint32_t timeout_ms);
  */
 int vtx_tx_poll(vtx_tx_t* tx, uint32_t timeout_ms);
 
+/**
+ * @brief 对当前线程应用 config->thread 配置
+ *
+ * @param tx 发送端对象
+ * @return 0成功，负数表示错误码（部分设置失败时返回最后一个错误，其余设置仍会生效）
+ *
+ * 注意：
+ * - 应在调用 vtx_tx_poll() 的线程启动时调用一次
+ * - SCHED_FIFO需要CAP_SYS_NICE或合适的RLIMIT_RTPRIO
+ * - incoming_cpu在accept之前/之后调用均可，socket在整个生命周期内不变；
+ *   配置了path_addrs时应在vtx_tx_listen之后调用（额外路径socket在listen时创建）
+ */
+int vtx_tx_apply_thread_config(vtx_tx_t* tx);
+
 /**
  * @brief 发送数据（可靠传输）
  *
@@ -163,7 +179,10 @@ int vtx_tx_poll(vtx_tx_t* tx, uint32_t timeout_ms);
  * 注意：
  * - 此函数用于发送用户数据帧（可靠传输）
  * - 数据将被自动重传直到确认或达到最大重传次数
- * - 内部会自动分配frame，复制数据
+ * - 数据复制到DATA窗口（VTX_DATA_WINDOW_SIZE=64个槽位，按frame_id取模），
+ *   不分配frame
+ * - 对应槽位仍被未确认的DATA包占用时返回VTX_ERR_BUSY（窗口满），
+ *   应稍后重试；size超过VTX_CTRL_FRAME_DATA_SIZE返回VTX_ERR_PACKET_TOO_LARGE
  */
 int vtx_tx_send(vtx_tx_t* tx, const uint8_t* data, size_t size);
 
@@ -180,6 +199,53 @@ int vtx_tx_send(vtx_tx_t* tx, const uint8_t* data, size_t size);
  */
 struct vtx_frame* vtx_tx_alloc_media_frame(vtx_tx_t* tx);
 
+/**
+ * @brief 将调用者内存包装为媒体帧（零拷贝）
+ *
+ * @param tx 发送端对象
+ * @param data 帧数据（编码器输出等稳定缓冲区）
+ * @param size 数据大小（不超过VTX_MAX_FRAME_SIZE）
+ * @param release_fn 最后一个引用释放时的回调（可为NULL）
+ * @param release_ctx 回调上下文
+ * @return vtx_frame_t* 成功返回frame对象，失败返回NULL（此时不调用release_fn）
+ *
+ * 注意：
+ * - 返回的frame已设置data/data_size，只需设置frame_type后调用
+ *   vtx_tx_send_media()，或调用vtx_tx_free_frame()放弃发送
+ * - 在release_fn被调用之前，data必须保持有效且不被修改；
+ *   I帧会被缓存用于重传和新连接，释放可能延迟到下一个I帧发送后
+ * - release_fn可能在发送线程或poll线程中调用
+ */
+struct vtx_frame* vtx_tx_wrap_media_frame(
+    vtx_tx_t* tx,
+    const uint8_t* data,
+    size_t size,
+    vtx_on_release_fn release_fn,
+    void* release_ctx);
+
+/**
+ * @brief 将多个调用者内存段包装为一个媒体帧（零拷贝，分散数据）
+ *
+ * @param tx 发送端对象
+ * @param iov 数据段数组（长度为0的段被忽略）
+ * @param iovcnt 数据段数量（不超过VTX_MAX_IOV）
+ * @param release_fn 最后一个引用释放时的回调（可为NULL）
+ * @param release_ctx 回调上下文
+ * @return vtx_frame_t* 成功返回frame对象，失败返回NULL（此时不调用release_fn）
+ *
+ * 注意：
+ * - 分片直接跨越数据段边界构造，每个UDP包由包头和若干数据段组成，
+ *   不需要先拼接成连续缓冲区
+ * - release_fn的data参数为第一个数据段地址，size为所有段的总长度
+ * - 数据段生命周期要求与vtx_tx_wrap_media_frame()相同
+ */
+struct vtx_frame* vtx_tx_wrap_media_frame_iov(
+    vtx_tx_t* tx,
+    const struct iovec* iov,
+    int iovcnt,
+    vtx_on_release_fn release_fn,
+    void* release_ctx);
+
 /**
  * @brief 释放frame
  *
@@ -196,7 +262,7 @@ void vtx_tx_free_frame(vtx_tx_t* tx, struct vtx_frame* frame);
  * @brief 发送媒体帧
  *
  * @param tx 发送端对象
- * @param frame 媒体帧（必须从 vtx_tx_alloc_media_frame() 分配）
+ * @param frame 媒体帧（来自 vtx_tx_alloc_media_frame() 或 vtx_tx_wrap_media_frame()）
  * @return 0成功，负数表示错误码
  *
  * 注意：
@@ -204,9 +270,58 @@ void vtx_tx_free_frame(vtx_tx_t* tx, struct vtx_frame* frame);
  * - frame->frame_type必须设置（VTX_FRAME_I/P/SPS/PPS/A）
  * - 发送后frame会被TX持有，应用层不应再访问
  * - TX会在适当时机自动释放frame
+ * - 接收端设置了能力限制（vtx_rx_set_limits）时，超限的帧会被丢弃，
+ *   仍返回0，计入stats.limited_frames
+ * - 例外：超过max_frame_size的I帧返回VTX_ERR_PACKET_TOO_LARGE（计入
+ *   stats.oversize_iframes），之后的P帧一直丢弃到下一个未超限的I帧，
+ *   应用层应降低I帧大小（如调低码率后重新请求I帧）
  */
 int vtx_tx_send_media(vtx_tx_t* tx, struct vtx_frame* frame);
 
+/**
+ * @brief 从调用者缓冲区发送媒体帧
+ *
+ * @param tx 发送端对象
+ * @param data 帧数据
+ * @param size 数据大小（不超过VTX_MAX_FRAME_SIZE）
+ * @param type 帧类型
+ * @return 0成功，负数表示错误码
+ *
+ * 注意：
+ * - 非I帧且能放入单个包（size <= mtu - 包头大小，如音频帧、小P帧）时，
+ *   直接从data同步发送，不分配frame、不复制，返回后data即可复用
+ * - 其他帧复制到媒体帧后按vtx_tx_send_media()发送
+ */
+int vtx_tx_send_media_buf(
+    vtx_tx_t* tx,
+    const uint8_t* data,
+    size_t size,
+    vtx_frame_type_t type);
+
+/**
+ * @brief 发送由多个内存段组成的媒体帧（零拷贝）
+ *
+ * @param tx 发送端对象
+ * @param iov 数据段数组（如SPS/PPS/切片等编码器输出的多个NAL缓冲区）
+ * @param iovcnt 数据段数量（不超过VTX_MAX_IOV）
+ * @param type 帧类型
+ * @param release_fn 数据段不再被使用时的回调（可为NULL）
+ * @param release_ctx 回调上下文
+ * @return 0成功，负数表示错误码
+ *
+ * 注意：
+ * - 等价于vtx_tx_wrap_media_frame_iov() + vtx_tx_send_media()
+ * - 无论成功与否，release_fn都会被调用且仅调用一次
+ *   （失败时可能在本函数返回前调用），size均为所有段的总长度
+ */
+int vtx_tx_send_media_iov(
+    vtx_tx_t* tx,
+    const struct iovec* iov,
+    int iovcnt,
+    vtx_frame_type_t type,
+    vtx_on_release_fn release_fn,
+    void* release_ctx);
+
 /**
  * @brief 关闭连接
  *
@@ -215,6 +330,15 @@ int vtx_tx_send_media(vtx_tx_t* tx, struct vtx_frame* frame);
  */
 int vtx_tx_close(vtx_tx_t* tx);
 
+/**
+ * @brief 获取接收端当前设置的能力限制
+ *
+ * @param tx 发送端对象
+ * @param limits 限制参数输出（全0表示无限制）
+ * @return 0成功，负数表示错误码
+ */
+int vtx_tx_get_limits(vtx_tx_t* tx, vtx_limits_t* limits);
+
 /**
  * @brief 获取统计信息
  *
@@ -268,9 +392,30 @@ vtx_rx_t* vtx_rx_create(
  * 注意：
  * - 发送连接请求到服务器
  * - 启动接收线程和发送线程
+ * - 网络中断后再次调用即可重连：CONNECT携带上次的会话令牌（VTX_FLAG_RESUME），
+ *   发送端宽限期（session_grace_ms）内恢复会话，保留限制和媒体状态并重发最新I帧；
+ *   会话已失效时自动重新发送START
+ * - vtx_rx_close()或收到DISCONNECT后令牌作废，下次连接为新会话
  */
 int vtx_rx_connect(vtx_rx_t* rx);
 
+/**
+ * @brief 连接到发送端并同时请求开始媒体传输（0-RTT）
+ *
+ * @param rx 接收端对象
+ * @param url 媒体URL参数（可为NULL），格式同vtx_rx_start()
+ * @return 0成功，负数表示错误码
+ *
+ * 注意：
+ * - URL放在CONNECT的payload中（VTX_FLAG_START），发送端回复CONNECTED后
+ *   立即重发缓存的I帧（URL与上次相同时）并通过media_fn开始发送媒体，
+ *   省去CONNECTED → ACK → START的往返
+ * - 发送端不支持时（CONNECTED未回显VTX_FLAG_START），收到CONNECTED后
+ *   自动回退为单独发送START
+ * - 媒体帧可能先于CONNECTED到达，frame_fn可能在connect_fn之前被调用
+ */
+int vtx_rx_connect_start(vtx_rx_t* rx, const char* url);
+
 /**
  * @brief 轮询事件（非阻塞）
  *
@@ -282,6 +427,37 @@ int vtx_rx_connect(vtx_rx_t* rx);
  */
 int vtx_rx_poll(vtx_rx_t* rx, uint32_t timeout_ms);
 
+/**
+ * @brief 注入一个数据报（离线回放抓包）
+ *
+ * @param rx 接收端对象
+ * @param data 数据报内容（VTX包头+载荷，即UDP载荷）
+ * @param size 数据报长度
+ * @return 0成功，负数表示错误码（超过VTX_DEFAULT_MTU返回VTX_ERR_PACKET_TOO_LARGE）
+ *
+ * 注意：
+ * - 按从服务器地址收到处理，与socket收到的包走同一处理路径；
+ *   ACK等应答仍发往config->server_addr
+ * - 必须在调用 vtx_rx_poll() 的线程中调用（或不运行poll线程），
+ *   不完整帧的超时清理仍由 vtx_rx_poll() 完成
+ * - 加密会话的抓包需要相同的crypto_key以及抓包中的CONNECTED握手才能解密；
+ *   注入的CONNECTED不需要本端发出过CONNECT，开始新会话时直接学习令牌和加密盐
+ */
+int vtx_rx_inject_packet(vtx_rx_t* rx, const uint8_t* data, size_t size);
+
+/**
+ * @brief 对当前线程应用 config->thread 配置
+ *
+ * @param rx 接收端对象
+ * @return 0成功，负数表示错误码（部分设置失败时返回最后一个错误，其余设置仍会生效）
+ *
+ * 注意：
+ * - 应在调用 vtx_rx_poll() 的线程启动时调用一次
+ * - 开启incoming_cpu时，内核会优先把该socket的数据包交给同一CPU处理，
+ *   与poll线程共享缓存，建议同时通过cpu_mask绑定到单个CPU
+ */
+int vtx_rx_apply_thread_config(vtx_rx_t* rx);
+
 /**
  * @brief 发送数据（可靠传输）
  *
@@ -293,9 +469,26 @@ int vtx_rx_poll(vtx_rx_t* rx, uint32_t timeout_ms);
  * 注意：
  * - 此函数用于发送非媒体流数据（如控制指令）
  * - 数据将被可靠传输（自动重传直到确认或达到最大重传次数）
+ * - 与vtx_rx_set_limits()共用DATA窗口（64个槽位），对应槽位仍被未确认的
+ *   包占用时返回VTX_ERR_BUSY，应稍后重试
  */
 int vtx_rx_send(vtx_rx_t* rx, const uint8_t* data, size_t size);
 
+/**
+ * @brief 通知发送端本接收端的能力限制（可靠传输）
+ *
+ * @param rx 接收端对象
+ * @param limits 限制参数（字段为0表示不限制，全0表示取消限制）
+ * @return 0成功，负数表示错误码
+ *
+ * 注意：
+ * - 发送端按码率/帧率/帧大小丢弃P帧（丢弃后直到下一个I帧才恢复）
+ * - 发送端同时通过data_fn(VTX_DATA_LIMIT)通知应用层，
+ *   应用层可据此降低编码码率/分辨率，从源头避免丢帧
+ * - 限制仅对当前连接有效，重新连接后需再次设置
+ */
+int vtx_rx_set_limits(vtx_rx_t* rx, const vtx_limits_t* limits);
+
 /**
  * @brief 请求开始媒体传输
  *
@@ -331,6 +524,30 @@ int vtx_rx_stop(vtx_rx_t* rx);
  */
 int vtx_rx_close(vtx_rx_t* rx);
 
+/**
+ * @brief 从时移环回放最近的帧（即时回放/快速切换）
+ *
+ * @param rx 接收端对象
+ * @param offset_ms 回放起点为"当前时间 - offset_ms"之前最近的关键帧；
+ *                  0表示最近的关键帧（超出保留窗口时取最旧的关键帧）
+ * @param frame_fn 逐帧回调（在调用线程中同步执行）
+ * @param userdata 回调用户数据
+ * @return 回放的帧数，未配置timeshift_ms返回VTX_ERR_NOT_SUPPORTED，
+ *         时移环中没有关键帧返回VTX_ERR_NOT_FOUND
+ *
+ * 注意：
+ * - 需要配置 config->timeshift_ms；已交付的帧复制一次到大小合适的缓冲区
+ *   （不占用512KB的重组媒体帧），timeshift_bytes按缓冲区容量计
+ * - 从关键帧（及其之前紧邻的SPS/PPS）开始，按原顺序回放到调用时的最新一帧，
+ *   新的解码器可以立即开始解码
+ * - 回放期间poll线程继续接收并通过创建时的frame_fn交付新帧
+ */
+int vtx_rx_replay(
+    vtx_rx_t* rx,
+    uint32_t offset_ms,
+    vtx_on_frame_fn frame_fn,
+    void* userdata);
+
 /**
  * @brief 获取统计信息
  *
@@ -375,6 +592,26 @@ void vtx_version_info(vtx_version_t* version);
  */
 const char* vtx_build_info(void);
 
+/**
+ * @brief 向延迟直方图添加一个样本
+ *
+ * @param hist 延迟直方图
+ * @param us 样本值（微秒）
+ *
+ * 注意：非线程安全，调用者负责加锁
+ */
+void vtx_latency_hist_record(vtx_latency_hist_t* hist, uint64_t us);
+
+/**
+ * @brief 估算延迟直方图的分位数
+ *
+ * @param hist 延迟直方图
+ * @param percentile 分位（0.0-100.0，如99.0表示p99）
+ * @return 分位数估算值（微秒，取所在桶的上界，不超过max_us），无样本返回0
+ */
+uint64_t vtx_latency_hist_percentile(const vtx_latency_hist_t* hist,
+                                     double percentile);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_crypto.h
+ * @brief VTX Payload Encryption (internal)
+ *
+ * 设计说明：
+ * - AES-128-GCM，预共享密钥（tx/rx配置crypto_key），OpenSSL EVP实现
+ *   （自动使用AES-NI/PCLMULQDQ）
+ * - 握手协商：RX在CONNECT中设置VTX_FLAG_CRYPT，TX回显并在CONNECTED的
+ *   payload中追加8字节nonce盐（每个新会话随机生成，会话恢复时保留）
+ * - 以帧为单位加密：整帧一次EVP调用（批量处理所有分片），原地加密，
+ *   16字节GCM标签作为帧尾随数据（分片按密文+标签切分）
+ * - nonce = 盐(8字节) || 帧首分片seq_num(4字节)；同一帧各分片seq连续，
+ *   重传沿用原seq，接收端由 seq_num - frag_index 还原
+ * - AAD = frame_id || frame_type || total_frags，分片头的其余字段由
+ *   重组结果的GCM校验间接保护
+ * - 加密分片设置VTX_FLAG_CRYPT，不计算CRC16（完整性由GCM标签保证）；
+ *   控制包不加密，仍使用CRC16
+ *
+ * 线程模型：seal/open内部加锁，可在发送线程和poll线程中并发调用
+ */
+
+#ifndef VTX_CRYPTO_H
+#define VTX_CRYPTO_H
+
+#include "vtx_types.h"
+#include <sys/uio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_CRYPTO_SALT_SIZE    8   /* nonce盐线上长度（字节，网络字节序） */
+#define VTX_CRYPTO_SEQ_LIMIT    0xFFF00000u /* 单个盐下可用的seq数（超过后需重新握手） */
+
+/**
+ * @brief 加密上下文（不透明类型）
+ */
+typedef struct vtx_crypto vtx_crypto_t;
+
+/**
+ * @brief 当前构建是否支持加密（需要OpenSSL）
+ */
+bool vtx_crypto_supported(void);
+
+/**
+ * @brief 创建加密上下文
+ *
+ * @param key 密钥（VTX_CRYPTO_KEY_SIZE字节）
+ * @return 成功返回上下文，失败（或不支持加密）返回NULL
+ */
+vtx_crypto_t* vtx_crypto_create(const uint8_t* key);
+
+/**
+ * @brief 销毁加密上下文
+ */
+void vtx_crypto_destroy(vtx_crypto_t* crypto);
+
+/**
+ * @brief 加密一帧
+ *
+ * @param crypto 加密上下文
+ * @param salt nonce盐
+ * @param header 帧首分片包头（主机字节序，seq_num/frame_id/frame_type/total_frags有效）
+ * @param in 明文数据段
+ * @param iovcnt 数据段数量
+ * @param out 密文输出（连续，可与单个数据段完全重合以原地加密）
+ * @param tag 输出GCM标签（VTX_CRYPTO_TAG_SIZE字节）
+ * @return 0成功，负数表示错误码
+ */
+int vtx_crypto_seal(vtx_crypto_t* crypto,
+                    uint64_t salt,
+                    const vtx_packet_header_t* header,
+                    const struct iovec* in,
+                    int iovcnt,
+                    uint8_t* out,
+                    uint8_t* tag);
+
+/**
+ * @brief 原地解密并验证一帧
+ *
+ * @param crypto 加密上下文
+ * @param salt nonce盐
+ * @param header 帧首分片包头（同vtx_crypto_seal）
+ * @param data 密文（原地替换为明文）
+ * @param size 密文大小（不含标签）
+ * @param tag GCM标签
+ * @return 0成功，VTX_ERR_CHECKSUM表示认证失败（data内容无效）
+ */
+int vtx_crypto_open(vtx_crypto_t* crypto,
+                    uint64_t salt,
+                    const vtx_packet_header_t* header,
+                    uint8_t* data,
+                    size_t size,
+                    const uint8_t* tag);
+
+/**
+ * @brief 序列化nonce盐（网络字节序）
+ */
+void vtx_crypto_pack_salt(uint64_t salt, uint8_t* buf);
+
+/**
+ * @brief 反序列化nonce盐
+ */
+uint64_t vtx_crypto_unpack_salt(const uint8_t* buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_CRYPTO_H */
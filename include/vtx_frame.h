@@ -38,6 +38,7 @@
 #include "list.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/uio.h>
 #include <stdbool.h>
 #include <stdatomic.h>
 
@@ -77,6 +78,7 @@ typedef struct vtx_frag {
     uint16_t         frag_index;     /* 分片索引 */
     bool             received;       /* 是否已接收（RX端使用） */
     uint8_t          retrans_count;  /* 重传次数 */
+    uint8_t          path;           /* 最近一次发送的路径（TX端多路径） */
     uint64_t         send_time_ms;   /* 发送时间（用于重传超时） */
     uint32_t         seq_num;        /* 该分片的序列号 */
 } vtx_frag_t;
@@ -96,6 +98,26 @@ typedef struct vtx_frag_header {
     vtx_frag_t       frag[0];        /* 柔性数组：分片数据 */
 } vtx_frag_header_t;
 
+/* ========== 帧时间戳 ========== */
+
+/**
+ * @brief 帧各阶段时间戳（单调时钟微秒，0表示未记录）
+ *
+ * 仅在配置 latency_stats 开启时填写，用于分解一帧的延迟构成。
+ * TX端使用 submit/first_wire/last_wire/retrans_done，
+ * RX端使用 first_recv/last_recv/cb_start/cb_end。
+ */
+typedef struct {
+    uint64_t submit_us;        /* 应用提交（vtx_tx_send_media） */
+    uint64_t first_wire_us;    /* 首分片发出 */
+    uint64_t last_wire_us;     /* 末分片发出 */
+    uint64_t retrans_done_us;  /* 全部分片已确认（重传完成） */
+    uint64_t first_recv_us;    /* 首分片到达 */
+    uint64_t last_recv_us;     /* 末分片到达 */
+    uint64_t cb_start_us;      /* 回调开始 */
+    uint64_t cb_end_us;        /* 回调结束 */
+} vtx_frame_timing_t;
+
 /* ========== 帧结构（统一frame和pkg） ========== */
 
 /**
@@ -117,6 +139,7 @@ typedef struct vtx_frame {
     vtx_frame_type_t frame_type;     /* 帧类型 */
     uint16_t         total_frags;    /* 总分片数 */
     uint16_t         recv_frags;     /* 已接收分片数 */
+    uint16_t         acked_frags;    /* 已确认分片数（TX端I帧重传） */
     size_t           data_size;      /* 实际数据大小 */
     size_t           data_capacity;  /* 数据缓冲区容量 */
 
@@ -125,12 +148,31 @@ typedef struct vtx_frame {
     uint64_t         last_recv_ms;   /* 最后接收时间 */
     uint64_t         send_time_ms;   /* 发送时间（用于重传超时） */
     uint8_t          retrans_count;  /* 重传次数 */
+    vtx_frame_timing_t timing;       /* 各阶段时间戳（延迟分解） */
 
     /* 重传管理（slab分配的分片数组） */
     vtx_frag_header_t* retran;       /* 重传分片头（NULL表示无重传） */
 
     /* 帧数据（动态分配） */
     uint8_t*         data;           /* 帧数据缓冲区指针 */
+
+    /* 外部缓冲区（vtx_frame_wrap，data_size为0的池） */
+    bool             external;       /* data指向调用者内存（只读，不归池所有） */
+    uint8_t          nsegs;          /* 分散数据段数量（0表示data连续） */
+    struct iovec*    segs;           /* 分散数据段（vtx_frame_wrap_iov时分配，释放时回收） */
+    vtx_on_release_fn release_fn;    /* 最后一个引用释放时的回调（可为NULL） */
+    void*            release_ctx;    /* 回调上下文 */
+
+    /* 分片序列号（各分片seq = base_seq + frag_index，重传沿用原seq） */
+    uint32_t         base_seq;       /* 帧首分片seq_num（加密时同时作为nonce） */
+
+    /* 载荷加密（AES-GCM） */
+    bool             sealed;         /* data已加密，GCM标签作为帧尾随数据发送 */
+    uint64_t         seal_salt;      /* 加密时使用的nonce盐（TX端，换会话后不能重发） */
+    uint8_t          tag[VTX_CRYPTO_TAG_SIZE]; /* GCM标签或帧哈希（TX端） */
+
+    /* 帧哈希（XXH64，未加密帧） */
+    bool             hashed;         /* 帧哈希作为帧尾随数据发送（TX端存于tag） */
 } vtx_frame_t;
 
 /* ========== 内存池（frame池） ========== */
@@ -157,6 +199,8 @@ typedef struct vtx_frame_pool vtx_frame_pool_t;
  * - 内存池可按需动态扩展
  * - 建议：媒体帧池使用VTX_MEDIA_FRAME_DATA_SIZE（512KB）
  *         控制帧池使用VTX_CTRL_FRAME_DATA_SIZE（128B）
+ * - data_size为0时创建外部数据帧池：frame不分配data缓冲区，
+ *   需通过vtx_frame_wrap()挂接调用者内存
  */
 vtx_frame_pool_t* vtx_frame_pool_create(size_t initial_size, size_t data_size);
 
@@ -338,6 +382,67 @@ static inline size_t vtx_frame_capacity(vtx_frame_t* frame) {
     return frame->data_capacity;
 }
 
+/**
+ * @brief 将调用者内存挂接到frame（零拷贝）
+ *
+ * @param frame frame对象（必须来自data_size为0的池，且未挂接数据）
+ * @param data 调用者缓冲区（在release_fn被调用前必须保持有效且不被修改）
+ * @param size 缓冲区大小
+ * @param release_fn 最后一个引用释放时的回调（可为NULL）
+ * @param release_ctx 回调上下文
+ * @return 0成功，负数表示错误码
+ *
+ * 注意：
+ * - 挂接后 data_size = data_capacity = size
+ * - VTX不会写入外部缓冲区，不应对此类frame调用vtx_frame_copyto
+ */
+int vtx_frame_wrap(
+    vtx_frame_t* frame,
+    const uint8_t* data,
+    size_t size,
+    vtx_on_release_fn release_fn,
+    void* release_ctx);
+
+/**
+ * @brief 将多个调用者内存段挂接到frame（零拷贝，分散数据）
+ *
+ * @param frame frame对象（必须来自data_size为0的池，且未挂接数据）
+ * @param iov 数据段数组（长度为0的段被忽略）
+ * @param iovcnt 数据段数量（不超过VTX_MAX_IOV）
+ * @param release_fn 最后一个引用释放时的回调（可为NULL，data参数为第一个段的地址）
+ * @param release_ctx 回调上下文
+ * @return 0成功，负数表示错误码
+ *
+ * 注意：
+ * - 挂接后 data_size = data_capacity = 所有段长度之和
+ * - frame->data指向第一个段，按偏移访问数据应使用vtx_frame_gather
+ */
+int vtx_frame_wrap_iov(
+    vtx_frame_t* frame,
+    const struct iovec* iov,
+    int iovcnt,
+    vtx_on_release_fn release_fn,
+    void* release_ctx);
+
+/**
+ * @brief 将frame中的一段数据映射为iovec（不复制）
+ *
+ * @param frame frame对象
+ * @param offset 起始偏移量（字节）
+ * @param size 大小（字节）
+ * @param iov 输出iovec数组
+ * @param max_iov iov数组容量
+ * @return 使用的iovec数量，失败（越界或容量不足）返回0
+ *
+ * 注意：连续frame始终返回1个iovec，分散frame可能跨越多个数据段
+ */
+int vtx_frame_gather(
+    const vtx_frame_t* frame,
+    size_t offset,
+    size_t size,
+    struct iovec* iov,
+    int max_iov);
+
 /**
  * @brief 从frame中复制数据到缓冲区
  *
@@ -477,6 +582,7 @@ typedef struct {
     struct list_head   frames;       /* 帧链表 */
     size_t             count;        /* 帧数量 */
     vtx_frame_pool_t*  pool;         /* 内存池 */
+    vtx_frag_pool_t*   frag_pool;    /* 分片池（丢弃帧时归还retran，可为NULL） */
     uint32_t           timeout_ms;   /* 帧超时时间（0表示无超时） */
     vtx_spinlock_t     lock;         /* 自旋锁 */
 } vtx_frame_queue_t;
@@ -485,11 +591,13 @@ typedef struct {
  * @brief 创建帧队列
  *
  * @param pool 内存池
+ * @param frag_pool 分片池，超时/销毁丢弃的帧的retran归还到这里（可为NULL）
  * @param timeout_ms 帧超时时间（0表示无超时）
  * @return vtx_frame_queue_t* 成功返回帧队列，失败返回NULL
  */
 vtx_frame_queue_t* vtx_frame_queue_create(
     vtx_frame_pool_t* pool,
+    vtx_frag_pool_t* frag_pool,
     uint32_t timeout_ms);
 
 /**
@@ -553,11 +661,18 @@ vtx_frame_t* vtx_frame_queue_find(
  */
 void vtx_frame_queue_remove(vtx_frame_queue_t* queue, vtx_frame_t* frame);
 
+/**
+ * @brief 超时帧回调（释放前调用，持有队列锁，不能再操作队列）
+ */
+typedef void (*vtx_frame_expire_fn)(void* ctx, const vtx_frame_t* frame);
+
 /**
  * @brief 检查并清理超时帧
  *
  * @param queue 帧队列
  * @param now_ms 当前时间戳（毫秒）
+ * @param expire_fn 每个超时帧的回调（可为NULL）
+ * @param ctx 回调上下文
  * @return 清理的帧数量
  *
  * 注意：
@@ -566,7 +681,35 @@ void vtx_frame_queue_remove(vtx_frame_queue_t* queue, vtx_frame_t* frame);
  */
 size_t vtx_frame_queue_cleanup_timeout(
     vtx_frame_queue_t* queue,
-    uint64_t now_ms);
+    uint64_t now_ms,
+    vtx_frame_expire_fn expire_fn,
+    void* ctx);
+
+/**
+ * @brief 丢弃frame_id早于指定帧的所有视频帧（新的关键帧完成后，旧的不完整帧已无用）
+ *
+ * 音频帧（VTX_FRAME_A）与视频共用frame_id但不依赖关键帧，保留到超时清理
+ *
+ * @param queue 帧队列
+ * @param frame_id 基准帧ID（序号比较，可回绕）
+ * @param expire_fn 每个丢弃帧的回调（可为NULL）
+ * @param ctx 回调上下文
+ * @return 丢弃的帧数量
+ */
+size_t vtx_frame_queue_purge_before(
+    vtx_frame_queue_t* queue,
+    uint16_t frame_id,
+    vtx_frame_expire_fn expire_fn,
+    void* ctx);
+
+/**
+ * @brief 队列中最早的帧的超时时刻
+ *
+ * @return 毫秒时间戳，队列为空或无超时返回UINT64_MAX
+ *
+ * 注意：帧按首分片到达顺序入队，队首即最早超时
+ */
+uint64_t vtx_frame_queue_next_deadline(vtx_frame_queue_t* queue);
 
 /**
  * @brief 获取队列中frame数量
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_hash.h
+ * @brief VTX Frame Hash (internal)
+ *
+ * 设计说明：
+ * - XXH64（seed=0），每8字节一次64位乘法，比逐字节查表的CRC16快一个数量级，
+ *   漏检概率约2^-64
+ * - 流式接口：发送端的帧可能由多个分散数据段组成，逐段更新即可，
+ *   结果与整帧一次计算相同
+ * - 线上为8字节网络字节序，作为帧尾随数据随最后的分片发送
+ */
+
+#ifndef VTX_HASH_H
+#define VTX_HASH_H
+
+#include "vtx_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief XXH64流式计算状态
+ */
+typedef struct {
+    uint64_t    total_len;      /* 已输入字节数 */
+    uint64_t    v[4];           /* 4路累加器 */
+    uint8_t     buf[32];        /* 不足一个条带的剩余输入 */
+    uint32_t    buf_size;       /* buf中的字节数 */
+} vtx_hash_state_t;
+
+/**
+ * @brief 初始化（seed=0）
+ */
+void vtx_hash_init(vtx_hash_state_t* state);
+
+/**
+ * @brief 输入一段数据
+ */
+void vtx_hash_update(vtx_hash_state_t* state, const void* data, size_t size);
+
+/**
+ * @brief 取得结果（不改变状态）
+ */
+uint64_t vtx_hash_digest(const vtx_hash_state_t* state);
+
+/**
+ * @brief 一次计算连续数据的哈希
+ */
+uint64_t vtx_hash64(const void* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_HASH_H */
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_index.h
+ * @brief VTX Media File Index (internal)
+ *
+ * 设计说明：
+ * - 对Annex-B裸流做一次起始码扫描（memchr查找0x01字节，libc内部为SIMD实现），
+ *   建立帧索引和关键帧索引
+ * - 索引保存为旁路文件 <媒体文件>.vtxidx，文件大小和修改时间一致时直接mmap使用，
+ *   不再扫描；写入时先写临时文件再rename，多个进程同时建立也不会读到半个索引
+ * - 关键帧项指向I帧之前紧邻的SPS/PPS（如有）并记录图像序号，
+ *   按字节偏移或图像序号二分查找最近的关键帧，O(log n)
+ *
+ * 旁路文件格式（小端，大端主机不使用旁路文件）：
+ *
+ *   文件头（64字节）：
+ *     magic[8]="VTXIDX01" | version(4) | flags(4) | media_size(8) | media_mtime(8)
+ *     | entry_count(4) | key_count(4) | picture_count(4) | dropped_count(4)
+ *     | reserved[16]
+ *   帧索引（entry_count项，每项16字节，按偏移递增）：
+ *     offset(8) | size(4) | frame_type(1) | reserved[3]
+ *   关键帧索引（key_count项，每项8字节，按偏移递增）：
+ *     entry(4) | picture(4)
+ */
+
+#ifndef VTX_INDEX_H
+#define VTX_INDEX_H
+
+#include "vtx_types.h"
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_INDEX_MAGIC         "VTXIDX01"
+#define VTX_INDEX_VERSION       1
+#define VTX_INDEX_HEADER_SIZE   64
+#define VTX_INDEX_SUFFIX        ".vtxidx"
+#define VTX_INDEX_FLAG_HEVC     (1 << 0)
+
+/**
+ * @brief 帧索引项（一帧，与旁路文件中的布局相同）
+ */
+typedef struct {
+    uint64_t    offset;         /* 帧在文件中的偏移（含起始码） */
+    uint32_t    size;           /* 帧大小 */
+    uint8_t     frame_type;     /* vtx_frame_type_t */
+    uint8_t     reserved[3];
+} vtx_media_entry_t;
+
+/**
+ * @brief 关键帧索引项
+ */
+typedef struct {
+    uint32_t    entry;          /* 起始帧（I帧之前紧邻的SPS/PPS，或I帧本身） */
+    uint32_t    picture;        /* I帧的图像序号（从0开始） */
+} vtx_media_key_t;
+
+/**
+ * @brief 媒体文件索引
+ */
+typedef struct {
+    const vtx_media_entry_t* entries;   /* 帧索引 */
+    uint32_t            count;          /* 帧数 */
+    const vtx_media_key_t* keys;        /* 关键帧索引 */
+    uint32_t            key_count;      /* 关键帧数 */
+    uint32_t            pictures;       /* 图像数 */
+    uint32_t            dropped;        /* 超过VTX_MAX_FRAME_SIZE未进入索引的帧数（加载时告警） */
+
+    void*               map;            /* 旁路文件映射（NULL表示索引在堆上） */
+    size_t              map_size;
+} vtx_media_index_t;
+
+/**
+ * @brief 加载索引：旁路文件有效时直接映射，否则扫描并写入旁路文件
+ *
+ * @param path 媒体文件路径
+ * @param data 媒体文件映射
+ * @param st 媒体文件属性（用于校验旁路文件）
+ * @return 0成功，文件中没有帧返回VTX_ERR_FORMAT_INVALID
+ */
+int vtx_media_index_load(vtx_media_index_t* index, const char* path,
+                         const uint8_t* data, const struct stat* st);
+
+/**
+ * @brief 释放索引
+ */
+void vtx_media_index_free(vtx_media_index_t* index);
+
+/**
+ * @brief 查找字节偏移处（不晚于offset）最近的关键帧
+ *
+ * @return 起始帧序号（offset在第一个关键帧之前时返回第一个关键帧），没有关键帧返回-1
+ */
+int64_t vtx_media_index_seek_offset(const vtx_media_index_t* index, uint64_t offset);
+
+/**
+ * @brief 查找图像序号处（不晚于picture）最近的关键帧
+ *
+ * @return 起始帧序号，没有关键帧返回-1
+ */
+int64_t vtx_media_index_seek_picture(const vtx_media_index_t* index, uint32_t picture);
+
+/**
+ * @brief 第一个偏移不小于offset的帧
+ *
+ * @return 帧序号（都小于offset时返回count）
+ */
+uint32_t vtx_media_index_lower_bound(const vtx_media_index_t* index, uint64_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_INDEX_H */
@@ -31,6 +31,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +40,7 @@ extern "C" {
 /* ========== 数据包常量 ========== */
 
 #define VTX_MAX_PAYLOAD_SIZE  (VTX_DEFAULT_MTU - VTX_PACKET_HEADER_SIZE)
+#define VTX_LIMITS_WIRE_SIZE  14  /* vtx_limits_t 线上格式大小（网络字节序） */
 
 /* ========== 数据包结构 ========== */
 
@@ -95,6 +97,21 @@ uint16_t vtx_packet_calc_crc(uint8_t* buf,
                               const uint8_t* payload,
                               size_t payload_size);
 
+/**
+ * @brief 计算包头和分散载荷的CRC
+ *
+ * @param buf 包头缓冲区（已序列化，至少VTX_PACKET_HEADER_SIZE字节）
+ * @param iov 载荷数据段
+ * @param iovcnt 数据段数量
+ * @return 计算的CRC16值
+ *
+ * 注意：结果与把所有数据段拼接后调用vtx_packet_calc_crc相同，
+ *       同样会更新buf中的CRC字段
+ */
+uint16_t vtx_packet_calc_crc_iov(uint8_t* buf,
+                                  const struct iovec* iov,
+                                  int iovcnt);
+
 /**
  * @brief 验证整个包的CRC
  *
@@ -124,6 +141,20 @@ bool vtx_packet_verify(const uint8_t* buf,
  */
 uint16_t vtx_crc16(const uint8_t* data, size_t size);
 
+#define VTX_CRC16_INIT 0xFFFF  /* CRC16初始值 */
+
+/**
+ * @brief 增量计算CRC16
+ *
+ * @param crc 当前CRC（首次使用VTX_CRC16_INIT）
+ * @param data 数据缓冲区
+ * @param size 数据大小
+ * @return 更新后的CRC
+ *
+ * 注意：vtx_crc16(data, size) == vtx_crc16_update(VTX_CRC16_INIT, data, size)
+ */
+uint16_t vtx_crc16_update(uint16_t crc, const uint8_t* data, size_t size);
+
 /**
  * @brief 验证CRC16校验和
  *
@@ -136,6 +167,26 @@ bool vtx_crc16_verify(const uint8_t* data, size_t size, uint16_t crc);
 
 /* ========== 数据包验证 ========== */
 
+/**
+ * @brief 序列化接收端限制（VTX_DATA_LIMIT载荷）
+ *
+ * @param limits 限制参数
+ * @param buf 输出缓冲区（至少VTX_LIMITS_WIRE_SIZE字节）
+ * @param size 缓冲区大小
+ * @return 0成功，负数表示错误码
+ */
+int vtx_packet_pack_limits(const vtx_limits_t* limits, uint8_t* buf, size_t size);
+
+/**
+ * @brief 反序列化接收端限制（VTX_DATA_LIMIT载荷）
+ *
+ * @param buf 载荷
+ * @param size 载荷大小
+ * @param limits 输出限制参数
+ * @return 0成功，负数表示错误码
+ */
+int vtx_packet_unpack_limits(const uint8_t* buf, size_t size, vtx_limits_t* limits);
+
 /**
  * @brief 验证包头合法性
  *
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_path.h
+ * @brief VTX Multipath Scheduling (internal)
+ *
+ * 设计说明：
+ * - 每条路径对应一个绑定到不同本地地址的UDP socket（路径0为主socket），
+ *   所有路径发往同一个客户端地址；额外路径的心跳ACK携带会话令牌，
+ *   接收端据此登记路径地址，之后I帧分片ACK沿原路径返回（未登记的地址经主路径）
+ * - ACK计入其到达的路径（重复发送时先到的副本决定）
+ * - 每条路径用I帧分片ACK估计RTT（未重传的分片，Karn算法），
+ *   用分片重传超时估计丢包率（EWMA）
+ * - 调度：平滑加权轮询（SWRR），权重 = (1 - 丢包率) / RTT，
+ *   各路径按权重比例分摊分片；重传走当前最好的路径
+ * - 接收端重组只按frame_id/frag_index，与分片来自哪条路径无关
+ *
+ * 线程模型：选择路径在发送线程，ACK/丢包在poll线程，内部使用自旋锁
+ */
+
+#ifndef VTX_PATH_H
+#define VTX_PATH_H
+
+#include "vtx_types.h"
+#include "vtx_spinlock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_PATH_DEFAULT_RTT_MS 50          /* 无RTT样本时的假定值 */
+#define VTX_PATH_NO_RTT         UINT32_MAX  /* ACK不产生RTT样本（重传过的分片） */
+
+/**
+ * @brief 单条路径状态
+ */
+typedef struct {
+    int             sockfd;         /* UDP socket */
+    uint32_t        srtt_ms;        /* 平滑RTT（0表示无样本） */
+    uint32_t        loss_permille;  /* 丢包率EWMA（千分比） */
+    int32_t         current_weight; /* SWRR当前权重 */
+    uint64_t        sent_packets;   /* 调度到该路径的分片数 */
+    uint64_t        acked_packets;  /* 已ACK分片数 */
+    uint64_t        lost_packets;   /* 超时重传的分片数 */
+} vtx_path_t;
+
+/**
+ * @brief 路径集合
+ */
+typedef struct {
+    vtx_path_t      paths[VTX_MAX_PATHS];
+    uint8_t         count;          /* 路径数（至少1） */
+    vtx_spinlock_t  lock;
+} vtx_path_set_t;
+
+/**
+ * @brief 初始化路径集合（主socket为路径0）
+ */
+void vtx_path_set_init(vtx_path_set_t* set, int primary_fd);
+
+/**
+ * @brief 销毁路径集合（关闭路径1..count-1的socket，主socket由调用者关闭）
+ */
+void vtx_path_set_destroy(vtx_path_set_t* set);
+
+/**
+ * @brief 添加路径
+ *
+ * @return 路径索引，已满返回-1
+ */
+int vtx_path_set_add(vtx_path_set_t* set, int sockfd);
+
+/**
+ * @brief 按socket查找路径（ACK到达的路径）
+ *
+ * @return 路径索引，未知socket返回0（主路径）
+ */
+uint8_t vtx_path_find(const vtx_path_set_t* set, int sockfd);
+
+/**
+ * @brief 为新分片选择路径（SWRR）并计入发送数
+ */
+uint8_t vtx_path_select(vtx_path_set_t* set);
+
+/**
+ * @brief 选择当前质量最好的路径（用于重传）并计入发送数
+ */
+uint8_t vtx_path_best(vtx_path_set_t* set);
+
+/**
+ * @brief 记录在指定路径上额外发送的分片（重复发送）
+ */
+void vtx_path_note_sent(vtx_path_set_t* set, uint8_t path);
+
+/**
+ * @brief 分片被ACK
+ *
+ * @param rtt_ms RTT样本，VTX_PATH_NO_RTT表示无样本
+ */
+void vtx_path_on_ack(vtx_path_set_t* set, uint8_t path, uint32_t rtt_ms);
+
+/**
+ * @brief 分片重传超时（视为该路径丢包）
+ */
+void vtx_path_on_loss(vtx_path_set_t* set, uint8_t path);
+
+/**
+ * @brief 导出统计
+ *
+ * @return 路径数
+ */
+uint8_t vtx_path_get_stats(vtx_path_set_t* set, vtx_path_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_PATH_H */
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_pcap.h
+ * @brief VTX Packet Capture (internal)
+ *
+ * 设计说明：
+ * - 配置capture_path后，发送端/接收端把收发的每个UDP数据报写入pcapng文件，
+ *   补上IPv4/UDP头（LINKTYPE_RAW），Wireshark等工具可直接打开；
+ *   方向写入EPB的epb_flags（1=收，2=发），时间戳为墙上时间（微秒）
+ * - 本端地址在每个socket第一次抓包时用getsockname()取得并缓存
+ * - 写入经过stdio缓冲，互斥锁保护（发送端的应用线程与poll线程都可能发包）；
+ *   写失败后停止抓包，不影响收发
+ * - 读取端同时支持pcapng和经典pcap（tcpdump抓取的以太网/Linux cooked/
+ *   回环/裸IP链路），只返回未分片的IPv4 UDP数据报，供离线回放工具使用
+ */
+
+#ifndef VTX_PCAP_H
+#define VTX_PCAP_H
+
+#include "vtx_types.h"
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_PCAP_DIR_UNKNOWN    0
+#define VTX_PCAP_DIR_IN         1   /* 本端收到 */
+#define VTX_PCAP_DIR_OUT        2   /* 本端发出 */
+
+/**
+ * @brief 抓包文件（不透明）
+ */
+typedef struct vtx_pcap vtx_pcap_t;
+
+/**
+ * @brief 创建抓包文件（写入pcapng段头和接口描述）
+ *
+ * @return 抓包对象，失败返回NULL
+ */
+vtx_pcap_t* vtx_pcap_open(const char* path);
+
+/**
+ * @brief 关闭抓包文件（刷新缓冲区）
+ */
+void vtx_pcap_close(vtx_pcap_t* pcap);
+
+/**
+ * @brief 写入一个数据报
+ *
+ * @param sockfd 收发所用socket（用于取得本端地址）
+ * @param dir VTX_PCAP_DIR_IN或VTX_PCAP_DIR_OUT
+ * @param peer 对端地址
+ * @param iov 数据报内容（VTX包头+载荷）
+ * @param iovcnt iov个数
+ */
+void vtx_pcap_write(vtx_pcap_t* pcap, int sockfd, int dir,
+                    const struct sockaddr_in* peer,
+                    const struct iovec* iov, int iovcnt);
+
+/**
+ * @brief 读取到的数据报
+ */
+typedef struct {
+    uint64_t            ts_us;      /* 时间戳（微秒） */
+    int                 dir;        /* VTX_PCAP_DIR_*（经典pcap为UNKNOWN） */
+    struct sockaddr_in  src;        /* 源地址 */
+    struct sockaddr_in  dst;        /* 目的地址 */
+    const uint8_t*      data;       /* UDP载荷（下一次读取前有效） */
+    size_t              size;       /* UDP载荷长度 */
+} vtx_pcap_packet_t;
+
+/**
+ * @brief 抓包读取器（不透明）
+ */
+typedef struct vtx_pcap_reader vtx_pcap_reader_t;
+
+/**
+ * @brief 打开抓包文件（pcapng或经典pcap）
+ *
+ * @return 读取器，文件无法打开或格式不支持返回NULL
+ */
+vtx_pcap_reader_t* vtx_pcap_reader_open(const char* path);
+
+/**
+ * @brief 读取下一个IPv4 UDP数据报（跳过其他包）
+ *
+ * @return 0成功，读完返回VTX_ERR_FILE_EOF，文件损坏返回VTX_ERR_FORMAT_INVALID
+ */
+int vtx_pcap_reader_next(vtx_pcap_reader_t* reader, vtx_pcap_packet_t* pkt);
+
+/**
+ * @brief 关闭读取器
+ */
+void vtx_pcap_reader_close(vtx_pcap_reader_t* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_PCAP_H */
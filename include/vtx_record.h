@@ -0,0 +1,104 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_record.h
+ * @brief VTX Segment Recorder (internal)
+ *
+ * 设计说明：
+ * - 接收端把交付的完整帧追加到预分配的段文件（<prefix>-NNNNNN.vtxrec），
+ *   段文件整体mmap（MAP_SHARED），帧数据从重组缓冲区直接复制到页缓存，
+ *   不经过应用层缓冲区，也没有每帧一次的write()系统调用；
+ *   脏页由内核按顺序回写
+ * - 段写满（或帧放不下）时收尾：在数据之后写入关键帧索引，
+ *   更新段头，截断到实际大小，然后打开下一个段
+ * - 段头的data_end在每帧追加后更新，进程异常退出时已追加的帧仍可顺序扫描
+ * - 段文件不覆盖：序号已存在（之前的录制）时顺延到下一个空闲序号；
+ *   创建段失败后暂停录制，重试间隔从1秒起每次失败加倍，最长60秒
+ *
+ * 段文件格式（所有整数为小端）：
+ *
+ *   段头（64字节）：
+ *     magic[8]="VTXREC01" | version(4) | header_size(4) | created_us(8)
+ *     | data_end(8) | index_offset(8) | index_count(4) | frame_count(4)
+ *     | reserved[16]
+ *   帧记录（从偏移64开始，8字节对齐）：
+ *     size(4) | frame_type(1) | reserved(1) | frame_id(2) | timestamp_us(8)
+ *     | data[size] | 填充到8字节
+ *   关键帧索引（index_offset处，收尾时写入，每项16字节）：
+ *     timestamp_us(8) | offset(8)
+ *
+ * 关键帧索引项的offset指向I帧之前紧邻的SPS/PPS记录（如有），
+ * 从该偏移开始顺序读取即可直接解码。timestamp_us为接收时刻（墙上时间，微秒）。
+ *
+ * 线程模型：只在接收端poll线程中调用，无内部锁
+ */
+
+#ifndef VTX_RECORD_H
+#define VTX_RECORD_H
+
+#include "vtx_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_RECORD_MAGIC          "VTXREC01"
+#define VTX_RECORD_VERSION        1
+#define VTX_RECORD_HEADER_SIZE    64   /* 段头大小 */
+#define VTX_RECORD_FRAME_HDR_SIZE 16   /* 帧记录头大小 */
+#define VTX_RECORD_INDEX_ENTRY    16   /* 关键帧索引项大小 */
+#define VTX_RECORD_ALIGN          8    /* 帧记录对齐 */
+
+/**
+ * @brief 段录制器（不透明）
+ */
+typedef struct vtx_recorder vtx_recorder_t;
+
+/**
+ * @brief 创建录制器（首个段在第一次追加时创建）
+ *
+ * @param prefix 段文件路径前缀
+ * @param segment_size 段文件预分配大小（字节）
+ * @return 录制器，失败返回NULL
+ */
+vtx_recorder_t* vtx_recorder_create(const char* prefix, uint64_t segment_size);
+
+/**
+ * @brief 销毁录制器（当前段收尾）
+ */
+void vtx_recorder_destroy(vtx_recorder_t* rec);
+
+/**
+ * @brief 追加一帧
+ *
+ * @param timestamp_us 帧时间戳（微秒）
+ * @return 0成功；帧超过段容量返回VTX_ERR_OVERFLOW，
+ *         创建/映射段文件失败返回VTX_ERR_FILE_OPEN/VTX_ERR_FILE_WRITE，
+ *         失败后的重试间隔内返回VTX_ERR_NOT_READY（帧未录制）
+ */
+int vtx_recorder_append(
+    vtx_recorder_t* rec,
+    vtx_frame_type_t frame_type,
+    uint16_t frame_id,
+    uint64_t timestamp_us,
+    const uint8_t* data,
+    size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_RECORD_H */
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_session.h
+ * @brief VTX Session Resumption (internal)
+ *
+ * 设计说明：
+ * - TX在建立连接时生成随机会话令牌，放在CONNECTED的payload中下发
+ * - RX重连时在CONNECT中携带令牌（VTX_FLAG_RESUME），令牌匹配则恢复会话：
+ *   保留接收端限制、I帧缓存和媒体状态，CONNECTED回显VTX_FLAG_RESUME，
+ *   一个往返即可恢复出图
+ * - 心跳超时后会话进入宽限期（挂起），宽限期内仍可恢复，
+ *   超时后会话结束（令牌作废，通知应用层STOP）
+ * - 无状态握手（handshake_cookie）：CONNECTED只携带cookie，
+ *   cookie = SipHash-2-4(密钥, 源地址+端口+时间片)，接收端以cookie为令牌
+ *   重新CONNECT，验证通过后cookie直接成为会话令牌；验证前不保存任何对端状态
+ * - 控制包按源地址限速：固定大小的令牌桶表（按地址哈希选组，组内VTX_RATELIMIT_WAYS路相联，
+ *   组满时替换最久未补充的表项，新地址继承被替换表项的令牌而不是满桶）
+ *
+ * 线程模型：只在poll线程（或vtx_tx_accept）中调用
+ */
+
+#ifndef VTX_SESSION_H
+#define VTX_SESSION_H
+
+#include "vtx_types.h"
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_SESSION_TOKEN_SIZE  8   /* 令牌线上长度（字节，网络字节序） */
+#define VTX_COOKIE_KEY_SIZE     16  /* SipHash密钥长度 */
+#define VTX_COOKIE_PERIOD_MS    (30 * 1000)  /* cookie时间片（当前和上一片有效） */
+#define VTX_RATELIMIT_SLOTS     256 /* 限速表大小（2的幂） */
+#define VTX_RATELIMIT_WAYS      4   /* 限速表组相联路数 */
+
+/**
+ * @brief 会话状态
+ */
+typedef struct {
+    uint64_t    token;          /* 会话令牌（0表示无会话） */
+    uint64_t    suspend_ms;     /* 进入宽限期的时间（0表示未挂起） */
+} vtx_session_t;
+
+/**
+ * @brief 源地址限速表项
+ */
+typedef struct {
+    uint32_t    addr;           /* IPv4地址（网络字节序） */
+    uint32_t    tokens;         /* 剩余令牌（包数） */
+    uint64_t    refill_ms;      /* 上次补充时间（0表示空闲） */
+} vtx_ratelimit_slot_t;
+
+/**
+ * @brief 源地址限速表
+ */
+typedef struct {
+    vtx_ratelimit_slot_t slots[VTX_RATELIMIT_SLOTS];
+} vtx_ratelimit_t;
+
+/**
+ * @brief 生成64位随机数（getrandom，失败时回退到/dev/urandom和时间混合）
+ */
+uint64_t vtx_session_random64(void);
+
+/**
+ * @brief 开始新会话（生成新令牌）
+ */
+void vtx_session_open(vtx_session_t* s);
+
+/**
+ * @brief 以指定令牌开始新会话（cookie验证通过后使用）
+ */
+void vtx_session_open_token(vtx_session_t* s, uint64_t token);
+
+/**
+ * @brief 结束会话（令牌作废）
+ */
+void vtx_session_close(vtx_session_t* s);
+
+/**
+ * @brief 挂起会话（进入宽限期）
+ */
+void vtx_session_suspend(vtx_session_t* s, uint64_t now_ms);
+
+/**
+ * @brief 尝试恢复会话
+ *
+ * @return true令牌匹配（会话恢复为活跃），false需要建立新会话
+ */
+bool vtx_session_resume(vtx_session_t* s, uint64_t token);
+
+/**
+ * @brief 会话是否处于宽限期
+ */
+bool vtx_session_suspended(const vtx_session_t* s);
+
+/**
+ * @brief 检查挂起的会话是否已超过宽限期
+ */
+bool vtx_session_expired(const vtx_session_t* s, uint64_t now_ms,
+                         uint32_t grace_ms);
+
+/**
+ * @brief 序列化令牌（VTX_SESSION_TOKEN_SIZE字节，网络字节序）
+ */
+void vtx_session_pack_token(uint64_t token, uint8_t* buf);
+
+/**
+ * @brief 反序列化令牌
+ */
+uint64_t vtx_session_unpack_token(const uint8_t* buf);
+
+/**
+ * @brief SipHash-2-4（64位输出）
+ */
+uint64_t vtx_siphash24(const uint8_t key[VTX_COOKIE_KEY_SIZE],
+                       const uint8_t* in, size_t len);
+
+/**
+ * @brief 计算地址在当前时间片的cookie（非0）
+ */
+uint64_t vtx_session_cookie(const uint8_t key[VTX_COOKIE_KEY_SIZE],
+                            const struct sockaddr_in* addr, uint64_t now_ms);
+
+/**
+ * @brief 验证cookie（当前或上一个时间片）
+ */
+bool vtx_session_cookie_valid(const uint8_t key[VTX_COOKIE_KEY_SIZE],
+                              const struct sockaddr_in* addr,
+                              uint64_t cookie, uint64_t now_ms);
+
+/**
+ * @brief 源地址是否允许再发送一个控制包
+ *
+ * 表为VTX_RATELIMIT_WAYS路组相联；组满时替换最久未补充的表项，
+ * 新地址继承其剩余令牌（不重置为满桶）
+ *
+ * @param rate 每秒令牌数（同时作为突发上限）
+ */
+bool vtx_ratelimit_allow(vtx_ratelimit_t* rl, uint32_t addr,
+                         uint64_t now_ms, uint32_t rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_SESSION_H */
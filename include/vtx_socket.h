@@ -0,0 +1,118 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_socket.h
+ * @brief VTX Socket Buffer Sizing (internal)
+ *
+ * 设计说明：
+ * - send_buf_size/recv_buf_size 为0时使用默认值（VTX_DEFAULT_SEND_BUF/RECV_BUF）
+ * - 为 VTX_SOCKBUF_AUTO 时按观测值自动扩大：
+ *     target = max(2 × 峰值帧大小, 峰值码率 × 平滑RTT)
+ *   并限制在 [VTX_SOCKBUF_MIN, VTX_SOCKBUF_MAX] 内，只增不减
+ * - 优先使用 SO_SNDBUFFORCE/SO_RCVBUFFORCE（需CAP_NET_ADMIN），
+ *   失败时回退到 SO_SNDBUF/SO_RCVBUF（受net.core.[rw]mem_max限制）
+ *
+ * 线程模型：
+ * - vtx_sockbuf_note_frame() 可在任意线程调用（原子操作）
+ * - 其余函数只在poll线程调用
+ */
+
+#ifndef VTX_SOCKET_H
+#define VTX_SOCKET_H
+
+#include "vtx_types.h"
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_SOCKBUF_MIN             (256 * 1024)        /* 自动模式下限 */
+#define VTX_SOCKBUF_MAX             (64 * 1024 * 1024)  /* 自动模式上限 */
+#define VTX_SOCKBUF_ADJUST_MS       1000                /* 自动调整/码率采样周期 */
+
+/**
+ * @brief socket缓冲区自动调整状态
+ */
+typedef struct {
+    uint32_t              configured;     /* 配置值（0/VTX_SOCKBUF_AUTO/字节数） */
+    uint32_t              requested;      /* 最近一次请求的大小 */
+    uint32_t              actual;         /* 内核实际大小（getsockopt） */
+    atomic_uint_fast64_t  peak_frame;     /* 峰值帧大小（字节） */
+    uint64_t              peak_bps;       /* 峰值码率（bps，按采样周期统计） */
+    uint32_t              srtt_ms;        /* 平滑RTT（毫秒，0表示未知） */
+    uint64_t              window_start_ms;/* 当前采样周期起点 */
+    uint64_t              window_bytes;   /* 采样周期起点时的累计字节数 */
+} vtx_sockbuf_t;
+
+/**
+ * @brief 设置socket缓冲区大小
+ *
+ * @param sockfd socket
+ * @param is_send true设置发送缓冲区，false设置接收缓冲区
+ * @param size 期望大小（字节）
+ * @param actual 输出内核实际大小（可为NULL）
+ * @return 0成功，负数表示错误码
+ */
+int vtx_socket_set_buf(int sockfd, bool is_send, uint32_t size, uint32_t* actual);
+
+/**
+ * @brief 初始化并应用初始缓冲区大小
+ *
+ * @param sb 状态
+ * @param sockfd socket
+ * @param is_send 发送/接收缓冲区
+ * @param configured 配置值（0/VTX_SOCKBUF_AUTO/字节数）
+ * @return 0成功，负数表示错误码
+ */
+int vtx_sockbuf_init(vtx_sockbuf_t* sb, int sockfd, bool is_send,
+                     uint32_t configured);
+
+/**
+ * @brief 记录一帧大小（更新峰值，线程安全）
+ */
+void vtx_sockbuf_note_frame(vtx_sockbuf_t* sb, size_t frame_size);
+
+/**
+ * @brief 记录一个RTT样本（毫秒）
+ */
+void vtx_sockbuf_note_rtt(vtx_sockbuf_t* sb, uint32_t rtt_ms);
+
+/**
+ * @brief 周期性更新码率并按需扩大缓冲区（仅AUTO模式生效）
+ *
+ * @param sb 状态
+ * @param sockfd socket
+ * @param is_send 发送/接收缓冲区
+ * @param total_bytes 累计收发字节数（用于计算码率）
+ * @param now_ms 当前时间（毫秒）
+ * @return true缓冲区大小发生变化
+ */
+bool vtx_sockbuf_update(vtx_sockbuf_t* sb, int sockfd, bool is_send,
+                        uint64_t total_bytes, uint64_t now_ms);
+
+/**
+ * @brief 开启SO_RXQ_OVFL（内核丢包计数，仅Linux）
+ *
+ * @return 0成功，VTX_ERR_NOT_SUPPORTED表示平台不支持
+ */
+int vtx_socket_enable_rxq_ovfl(int sockfd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_SOCKET_H */
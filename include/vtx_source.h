@@ -0,0 +1,141 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_source.h
+ * @brief VTX File Media Source (internal)
+ *
+ * 设计说明：
+ * - 配置media_root后，发送端自行处理START URL（/path/to/file?offset=10,size=20），
+ *   不再需要应用层读文件、按帧率usleep
+ * - URL不能包含".."；根目录在创建时解析为realpath，文件的realpath必须位于其下
+ *   （根目录内指向外部的符号链接同样被拒绝）
+ * - 媒体文件为H.264/H.265 Annex-B裸流（扩展名.h265/.hevc/.265按H.265解析），
+ *   整体mmap，帧索引由vtx_index建立（首次扫描后保存为旁路文件，之后直接映射）：
+ *   SPS（H.265含VPS）、PPS各为一帧，同一图像的所有slice为一帧，AUD/SEI等归入其后的帧，
+ *   IDR/IRAP图像为I帧，其余图像为P帧
+ * - 帧通过vtx_tx_wrap_media_frame()直接引用映射内存（页缓存），发送路径零拷贝；
+ *   每个在途帧持有文件的一个引用，最后一个引用释放时解除映射
+ * - 同一进程内播放同一文件的所有发送端共享映射和索引（按realpath登记）；
+ *   首个打开者先登记为"加载中"，在登记表锁外映射文件并建立索引，
+ *   同时打开同一文件的发送端等待该文件加载完成，打开其他文件不受影响
+ * - 发送节奏：第n个图像在 开始时间 + n / media_fps 发出，
+ *   SPS/PPS与其后的图像同时发出；由vtx_tx_poll()按下一帧时间缩短等待
+ * - offset/size为文件字节范围：从offset处最近的关键帧（不晚于offset，含紧邻的SPS/PPS）
+ *   开始，到offset+size之前结束；frame=N按图像序号定位关键帧，代替offset；
+ *   播放到范围末尾后从头循环
+ *
+ * 线程模型：START/STOP与发送在poll线程；close/destroy可在其他线程，内部使用自旋锁
+ */
+
+#ifndef VTX_SOURCE_H
+#define VTX_SOURCE_H
+
+#include "vtx_types.h"
+#include "vtx_index.h"
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct vtx_tx;
+
+/**
+ * @brief 媒体文件加载状态
+ */
+typedef enum {
+    VTX_MEDIA_FILE_LOADING = 0,     /* 首个打开者正在映射并建立索引 */
+    VTX_MEDIA_FILE_READY,           /* 可以播放 */
+    VTX_MEDIA_FILE_FAILED,          /* 加载失败（已从登记表移除） */
+} vtx_media_file_state_t;
+
+/**
+ * @brief 已映射的媒体文件（进程内共享，引用计数）
+ */
+typedef struct vtx_media_file {
+    struct vtx_media_file* next;    /* 登记表链表 */
+    char*               path;       /* realpath */
+    atomic_int          refcount;   /* 引用计数（原子操作，每帧retain/release不加锁） */
+    vtx_media_file_state_t state;   /* 加载状态（登记表锁保护） */
+    const uint8_t*      map;        /* 文件映射 */
+    size_t              size;       /* 文件大小 */
+    vtx_media_index_t   index;      /* 帧索引 */
+} vtx_media_file_t;
+
+/**
+ * @brief 打开媒体文件（已被其他发送端打开时共享映射和索引）
+ *
+ * @return 文件对象（持有一个引用），失败返回NULL
+ */
+vtx_media_file_t* vtx_media_file_open(const char* path);
+
+/**
+ * @brief 增加文件引用
+ */
+void vtx_media_file_retain(vtx_media_file_t* file);
+
+/**
+ * @brief 释放文件引用（最后一个引用释放时解除映射）
+ */
+void vtx_media_file_release(vtx_media_file_t* file);
+
+/**
+ * @brief 文件播放源（每个发送端一个）
+ */
+typedef struct vtx_source vtx_source_t;
+
+/**
+ * @brief 创建播放源
+ *
+ * @param root 媒体文件根目录（URL路径相对于该目录，必须存在）
+ * @param fps 图像帧率
+ * @return 播放源，根目录无效时返回NULL
+ */
+vtx_source_t* vtx_source_create(const char* root, uint16_t fps);
+
+/**
+ * @brief 销毁播放源
+ */
+void vtx_source_destroy(vtx_source_t* src);
+
+/**
+ * @brief 按START URL开始播放（与正在播放的URL相同时继续播放）
+ *
+ * @return 0成功，URL无效或文件位于根目录之外返回VTX_ERR_INVALID_PARAM，
+ *         文件无法打开返回VTX_ERR_FILE_OPEN，范围内没有关键帧返回VTX_ERR_NOT_FOUND
+ */
+int vtx_source_start(vtx_source_t* src, const char* url);
+
+/**
+ * @brief 停止播放
+ */
+void vtx_source_stop(vtx_source_t* src);
+
+/**
+ * @brief 距下一帧发送时间的微秒数（未播放返回UINT64_MAX）
+ */
+uint64_t vtx_source_wait_us(vtx_source_t* src);
+
+/**
+ * @brief 发送所有已到时间的帧
+ */
+void vtx_source_pump(vtx_source_t* src, struct vtx_tx* tx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_SOURCE_H */
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_thread.h
+ * @brief VTX Thread Affinity & Scheduling (internal)
+ *
+ * 将 vtx_thread_config_t 应用到调用线程：
+ * - cpu_mask       -> pthread_setaffinity_np（仅Linux）
+ * - sched_priority -> pthread_setschedparam(SCHED_FIFO)
+ * - incoming_cpu   -> setsockopt(SO_INCOMING_CPU, sched_getcpu())（仅Linux）
+ */
+
+#ifndef VTX_THREAD_H
+#define VTX_THREAD_H
+
+#include "vtx_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 对当前线程应用线程配置
+ *
+ * @param config 线程配置（不可为NULL）
+ * @param sockfd 需要对齐SO_INCOMING_CPU的socket（<0表示无）
+ * @return 0成功，负数表示错误码（返回最后一个失败项的错误码）
+ */
+int vtx_thread_apply(const vtx_thread_config_t* config, int sockfd);
+
+/**
+ * @brief 只对socket应用线程配置（incoming_cpu），用于同一线程的其他socket
+ *
+ * @param config 线程配置（不可为NULL）
+ * @param sockfd 需要对齐SO_INCOMING_CPU的socket（<0表示无）
+ * @return 0成功，负数表示错误码
+ */
+int vtx_thread_apply_socket(const vtx_thread_config_t* config, int sockfd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_THREAD_H */
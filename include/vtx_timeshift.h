@@ -0,0 +1,88 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_timeshift.h
+ * @brief VTX Time-shift Ring (internal)
+ *
+ * 设计说明：
+ * - 环形保存最近一段时间内交付的完整帧，只持有帧的引用（vtx_frame_retain），
+ *   不复制数据；帧出环时归还各自的内存池
+ * - 按时间窗口和字节数双重限制，超出时从最旧的帧开始淘汰；字节数按帧实际
+ *   占用的缓冲区（data_capacity）计算，而不是data_size，持有512KB的媒体帧
+ *   按512KB计入，内存池占用不超过max_bytes（调用者应把小帧复制到
+ *   大小合适的缓冲区后再写入）
+ * - 关键帧索引记录每个I帧的起始位置（I帧之前紧邻的SPS/PPS，如有），
+ *   时间单调递增，按时间二分查找
+ * - 回放时在锁内持有所选区间所有帧的引用，锁外逐帧回调，
+ *   不阻塞接收线程继续写入
+ *
+ * 线程模型：写入在接收端poll线程，回放可在任意线程，内部使用自旋锁
+ */
+
+#ifndef VTX_TIMESHIFT_H
+#define VTX_TIMESHIFT_H
+
+#include "vtx_types.h"
+#include "vtx_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 时移环（不透明）
+ */
+typedef struct vtx_timeshift vtx_timeshift_t;
+
+/**
+ * @brief 创建时移环
+ *
+ * @param window_ms 保留的时间窗口（毫秒）
+ * @param max_bytes 保留的最大字节数（按帧缓冲区容量计）
+ */
+vtx_timeshift_t* vtx_timeshift_create(uint32_t window_ms, uint64_t max_bytes);
+
+/**
+ * @brief 销毁时移环（释放所有帧引用，须在帧所属内存池销毁之前调用）
+ */
+void vtx_timeshift_destroy(vtx_timeshift_t* ts);
+
+/**
+ * @brief 追加一帧（内部持有一个引用）
+ *
+ * @param pool frame所属的内存池（出环时用于释放）
+ * @param now_ms 交付时间（毫秒，单调不减）
+ * @return 0成功，失败返回错误码（frame未被持有）
+ */
+int vtx_timeshift_push(vtx_timeshift_t* ts, vtx_frame_pool_t* pool,
+                       vtx_frame_t* frame, uint64_t now_ms);
+
+/**
+ * @brief 从关键帧开始回放到最新一帧
+ *
+ * @param since_ms 选择时间不晚于since_ms的最新关键帧（不存在时取最旧的关键帧）；
+ *                 UINT64_MAX表示最新的关键帧
+ * @param fn 逐帧回调（在调用线程中执行，不持有内部锁）
+ * @return 回放的帧数，环中没有关键帧返回VTX_ERR_NOT_FOUND
+ */
+int vtx_timeshift_replay(vtx_timeshift_t* ts, uint64_t since_ms,
+                         vtx_on_frame_fn fn, void* userdata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_TIMESHIFT_H */
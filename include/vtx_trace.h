@@ -0,0 +1,120 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_trace.h
+ * @brief VTX USDT Static Tracepoints
+ *
+ * 基于 sys/sdt.h 的用户态静态探针（USDT），provider 名称为 "vtx"。
+ *
+ * 开销说明：
+ * - 定义 VTX_ENABLE_USDT 且系统提供 sys/sdt.h 时生成探针
+ * - 探针未被attach时仅为一条nop指令（参数只做寄存器/栈传递），开销可忽略
+ * - 未启用时所有宏展开为空，不依赖VTX_DEBUG
+ *
+ * 探针列表（参数顺序即 arg0, arg1, ...）：
+ *
+ *   frag_send       (frame_id, frag_index, total_frags, payload_size, seq_num)
+ *                   TX首次发送媒体分片
+ *   frag_retrans    (frame_id, frag_index, retrans_count, payload_size, seq_num)
+ *                   重传分片（TX的I帧分片，或TX/RX的DATA包，DATA包frag_index为0）
+ *   ack_recv        (frame_id, frag_index, seq_num)
+ *                   TX收到ACK
+ *   frag_recv       (frame_id, frag_index, total_frags, payload_size, seq_num)
+ *                   RX收到媒体分片（含重复分片）
+ *   frame_complete  (frame_id, frame_type, total_frags, data_size, reassembly_ms)
+ *                   RX帧重组完成，reassembly_ms为首片到末片的耗时
+ *   frame_timeout   (frame_id, frame_type, recv_frags, total_frags, elapsed_ms)
+ *                   帧重组超时被丢弃
+ *   pool_grow       (pool, data_size, total_frames)
+ *                   帧内存池空闲链表为空，按需扩展一个frame
+ *   callback_entry  (kind, arg, size)
+ *   callback_exit   (kind, ret)
+ *                   进入/退出应用回调，kind见vtx_trace_cb_t；
+ *                   arg为帧类型或数据类型，size为数据大小（无则为0）；
+ *                   无返回值的回调ret为0
+ *
+ * 使用示例：
+ *   bpftrace -e 'usdt:./build/bin/client:vtx:frame_complete
+ *                { @reasm_ms = hist(arg4); }'
+ *   perf probe -x ./build/bin/server sdt_vtx:frag_retrans
+ */
+
+#ifndef VTX_TRACE_H
+#define VTX_TRACE_H
+
+#ifdef VTX_ENABLE_USDT
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define VTX_USDT_AVAILABLE 1
+#endif
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 回调类型（callback_entry/callback_exit探针的kind参数）
+ */
+typedef enum {
+    VTX_TRACE_CB_FRAME   = 1,  /* vtx_on_frame_fn */
+    VTX_TRACE_CB_DATA    = 2,  /* vtx_on_data_fn */
+    VTX_TRACE_CB_CONNECT = 3,  /* vtx_on_connect_fn */
+    VTX_TRACE_CB_MEDIA   = 4,  /* vtx_on_media_fn */
+} vtx_trace_cb_t;
+
+#ifdef VTX_USDT_AVAILABLE
+
+#define VTX_TRACE_FRAG_SEND(fid, idx, total, size, seq) \
+    DTRACE_PROBE5(vtx, frag_send, fid, idx, total, size, seq)
+#define VTX_TRACE_FRAG_RETRANS(fid, idx, count, size, seq) \
+    DTRACE_PROBE5(vtx, frag_retrans, fid, idx, count, size, seq)
+#define VTX_TRACE_ACK_RECV(fid, idx, seq) \
+    DTRACE_PROBE3(vtx, ack_recv, fid, idx, seq)
+#define VTX_TRACE_FRAG_RECV(fid, idx, total, size, seq) \
+    DTRACE_PROBE5(vtx, frag_recv, fid, idx, total, size, seq)
+#define VTX_TRACE_FRAME_COMPLETE(fid, type, total, size, ms) \
+    DTRACE_PROBE5(vtx, frame_complete, fid, type, total, size, ms)
+#define VTX_TRACE_FRAME_TIMEOUT(fid, type, recv, total, ms) \
+    DTRACE_PROBE5(vtx, frame_timeout, fid, type, recv, total, ms)
+#define VTX_TRACE_POOL_GROW(pool, size, total) \
+    DTRACE_PROBE3(vtx, pool_grow, pool, size, total)
+#define VTX_TRACE_CALLBACK_ENTRY(kind, arg, size) \
+    DTRACE_PROBE3(vtx, callback_entry, kind, arg, size)
+#define VTX_TRACE_CALLBACK_EXIT(kind, ret) \
+    DTRACE_PROBE2(vtx, callback_exit, kind, ret)
+
+#else
+
+#define VTX_TRACE_FRAG_SEND(fid, idx, total, size, seq)      ((void)0)
+#define VTX_TRACE_FRAG_RETRANS(fid, idx, count, size, seq)   ((void)0)
+#define VTX_TRACE_ACK_RECV(fid, idx, seq)                    ((void)0)
+#define VTX_TRACE_FRAG_RECV(fid, idx, total, size, seq)      ((void)0)
+#define VTX_TRACE_FRAME_COMPLETE(fid, type, total, size, ms) ((void)0)
+#define VTX_TRACE_FRAME_TIMEOUT(fid, type, recv, total, ms)  ((void)0)
+#define VTX_TRACE_POOL_GROW(pool, size, total)               ((void)0)
+#define VTX_TRACE_CALLBACK_ENTRY(kind, arg, size)            ((void)0)
+#define VTX_TRACE_CALLBACK_EXIT(kind, ret)                   ((void)0)
+
+#endif /* VTX_USDT_AVAILABLE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_TRACE_H */
@@ -57,6 +57,9 @@ typedef enum {
     VTX_DATA_USER       = 0x15,  /* 用户数据（可靠传输） */
     VTX_DATA_START      = 0x16,  /* 开始媒体传输 */
     VTX_DATA_STOP       = 0x17,  /* 停止媒体传输 */
+    VTX_DATA_LIMIT      = 0x18,  /* 接收端能力限制（可靠传输，RX→TX） */
+    VTX_DATA_PROBE      = 0x19,  /* 路径探测（TX→RX新地址，payload为8字节挑战值） */
+    VTX_DATA_PROBE_ACK  = 0x1A,  /* 路径探测应答（RX→TX，payload为会话令牌+挑战值） */
 } vtx_data_type_t;
 
 /**
@@ -65,6 +68,16 @@ typedef enum {
 typedef enum {
     VTX_FLAG_LAST_FRAG  = (1 << 0),  /* 最后一个分片 */
     VTX_FLAG_RETRANS    = (1 << 1),  /* 重传标记 */
+    VTX_FLAG_START      = (1 << 2),  /* CONNECT携带START（payload为URL），
+                                        CONNECTED回显表示已开始发送媒体 */
+    VTX_FLAG_RESUME     = (1 << 3),  /* CONNECT携带会话令牌（payload前8字节），
+                                        CONNECTED回显表示会话已恢复 */
+    VTX_FLAG_COOKIE     = (1 << 4),  /* 无状态CONNECTED（payload为cookie），
+                                        接收端需以cookie为令牌重新CONNECT */
+    VTX_FLAG_CRYPT      = (1 << 5),  /* CONNECT/CONNECTED：协商AES-GCM加密；
+                                        媒体分片：载荷已加密，不校验CRC */
+    VTX_FLAG_HASH       = (1 << 6),  /* 媒体分片：帧末尾附加XXH64帧哈希，
+                                        CRC只覆盖包头 */
 } vtx_packet_flags_t;
 
 /* ========== 数据包结构 ========== */
@@ -94,6 +107,31 @@ typedef struct {
 
 /* ========== 配置结构 ========== */
 
+/**
+ * @brief 线程运行配置（CPU亲和性/实时调度）
+ *
+ * 由 vtx_tx_apply_thread_config()/vtx_rx_apply_thread_config()
+ * 在调用poll的线程启动时应用，全0表示不做任何修改。
+ */
+typedef struct {
+    uint64_t    cpu_mask;       /* CPU亲和性掩码（bit i 对应 CPU i），0表示不绑定 */
+    int         sched_priority; /* SCHED_FIFO优先级（1-99），0表示保持默认调度策略 */
+    bool        incoming_cpu;   /* 是否将socket的SO_INCOMING_CPU对齐到当前线程所在CPU（仅Linux） */
+} vtx_thread_config_t;
+
+#define VTX_MAX_PATHS             4             /* 多路径发送最大路径数（含主路径） */
+
+/**
+ * @brief 单条路径统计（多路径发送）
+ */
+typedef struct {
+    uint32_t srtt_ms;           /* 平滑RTT（0表示尚无样本） */
+    uint32_t loss_permille;     /* 丢包率估计（千分比） */
+    uint64_t sent_packets;      /* 调度到该路径的分片数 */
+    uint64_t acked_packets;     /* 已ACK分片数 */
+    uint64_t lost_packets;      /* 超时重传的分片数 */
+} vtx_path_stats_t;
+
 /**
  * @brief 发送端配置
  */
@@ -101,7 +139,7 @@ typedef struct {
     const char* bind_addr;    /* 绑定地址，NULL表示INADDR_ANY */
     uint16_t    bind_port;    /* 绑定端口 */
     uint16_t    mtu;          /* MTU大小，默认1400字节 */
-    uint32_t    send_buf_size; /* 发送缓冲区大小 */
+    uint32_t    send_buf_size; /* 发送缓冲区大小（0默认，VTX_SOCKBUF_AUTO自动） */
     uint32_t    retrans_timeout_ms; /* I帧分片重传超时（默认5ms） */
     uint8_t     max_retrans;  /* I帧分片最大重传次数（默认3次） */
     uint32_t    data_retrans_timeout_ms; /* DATA包重传超时（默认30ms） */
@@ -110,8 +148,24 @@ typedef struct {
     uint8_t     connect_max_retrans; /* CONNECTED帧最大重传次数（默认3次） */
     uint32_t    heartbeat_interval_ms; /* 心跳间隔（默认60000ms=1分钟） */
     uint8_t     heartbeat_max_miss; /* 最大丢失心跳次数（默认3次） */
+    uint32_t    session_grace_ms; /* 心跳超时后会话可恢复的时间（默认10000ms） */
+    bool        handshake_cookie; /* 是否要求CONNECT先完成无状态cookie交换（防CONNECT洪泛） */
+    uint16_t    control_rate; /* 每个源地址每秒允许的控制包数（默认20） */
+    const char* path_addrs[VTX_MAX_PATHS - 1]; /* 额外本地地址（多路径，NULL表示不使用） */
+    bool        path_duplicate; /* I帧分片在所有路径上重复发送（否则按路径质量分摊） */
+    const uint8_t* crypto_key; /* AES-128-GCM预共享密钥（VTX_CRYPTO_KEY_SIZE字节），
+                                  NULL表示不加密；仅在create时读取，
+                                  设置后拒绝不加密的接收端 */
+    const char* media_root;   /* 内置文件媒体源根目录（NULL表示由应用层通过media_fn处理START），
+                                 START URL指向其中的H.264/H.265 Annex-B文件 */
+    uint16_t    media_fps;    /* 内置文件媒体源的图像帧率（默认30） */
+    bool        latency_stats; /* 是否记录每帧各阶段时间戳并统计延迟直方图 */
+    const char* capture_path; /* pcapng抓包文件路径（NULL表示不抓包），记录收发的全部数据报 */
+    bool        frame_hash;   /* 媒体帧附加64位帧哈希，分片CRC只覆盖包头
+                                 （加密会话由GCM标签校验，不附加） */
+    vtx_thread_config_t thread; /* poll线程亲和性/调度配置 */
 #ifdef VTX_DEBUG
-    float       drop_rate;    /* 丢包模拟率（0.0-1.0） */
+    float       drop_rate;    /* 媒体分片丢包模拟率（0.0-1.0，含重传） */
 #endif
 } vtx_tx_config_t;
 
@@ -122,15 +176,57 @@ typedef struct {
     const char* server_addr;  /* 服务器地址 */
     uint16_t    server_port;  /* 服务器端口 */
     uint16_t    mtu;          /* MTU大小，默认1400字节 */
-    uint32_t    recv_buf_size; /* 接收缓冲区大小 */
+    uint32_t    recv_buf_size; /* 接收缓冲区大小（0默认，VTX_SOCKBUF_AUTO自动） */
     uint32_t    frame_timeout_ms; /* 帧接收超时（默认100ms） */
     uint32_t    data_retrans_timeout_ms; /* DATA包重传超时（默认30ms） */
     uint8_t     data_max_retrans; /* DATA包最大重传次数（默认3次） */
     uint32_t    heartbeat_interval_ms; /* 心跳发送间隔（默认60000ms=1分钟） */
+    const uint8_t* crypto_key; /* AES-128-GCM预共享密钥（VTX_CRYPTO_KEY_SIZE字节），
+                                  NULL表示不加密；仅在create时读取，
+                                  设置后拒绝不加密的发送端 */
+    const char* record_path;  /* 录制段文件路径前缀（NULL表示不录制），
+                                 完整帧追加到 <record_path>-NNNNNN.vtxrec */
+    uint32_t    record_segment_size; /* 录制段文件大小（默认64MB） */
+    uint32_t    timeshift_ms; /* 时移环保留最近多少毫秒的完整帧（0表示不保留），
+                                 用于vtx_rx_replay() */
+    uint32_t    timeshift_bytes; /* 时移环字节上限（默认32MB） */
+    bool        latency_stats; /* 是否记录每帧各阶段时间戳并统计延迟直方图 */
+    const char* capture_path; /* pcapng抓包文件路径（NULL表示不抓包），记录收发的全部数据报 */
+    vtx_thread_config_t thread; /* poll线程亲和性/调度配置 */
 } vtx_rx_config_t;
 
+/**
+ * @brief 接收端能力限制（VTX_DATA_LIMIT载荷，所有字段0表示不限制）
+ *
+ * TX端强制执行 max_bitrate_kbps/max_fps/max_frame_size：
+ * 超限的P帧被丢弃，并持续丢弃到下一个I帧（保证解码参考链完整）；
+ * SPS/PPS/音频帧不受限制。max_width/max_height仅作为提示透传给应用层。
+ */
+typedef struct {
+    uint32_t    max_bitrate_kbps; /* 最大码率（kbps） */
+    uint32_t    max_frame_size;   /* 最大帧大小（字节） */
+    uint16_t    max_fps;          /* 最大视频帧率 */
+    uint16_t    max_width;        /* 最大分辨率宽度（提示） */
+    uint16_t    max_height;       /* 最大分辨率高度（提示） */
+} vtx_limits_t;
+
 /* ========== 统计结构 ========== */
 
+#define VTX_LATENCY_BUCKETS 24  /* 延迟直方图桶数（最后一桶 >= 2^22us ≈ 4.2s） */
+
+/**
+ * @brief 延迟直方图（微秒，log2分桶）
+ *
+ * buckets[0]统计 <1us 的样本，buckets[i]（i>=1）统计 [2^(i-1), 2^i) 微秒，
+ * 最后一个桶包含所有更大的样本。
+ */
+typedef struct {
+    uint64_t count;                         /* 样本数 */
+    uint64_t sum_us;                        /* 样本总和（微秒） */
+    uint64_t max_us;                        /* 最大值（微秒） */
+    uint64_t buckets[VTX_LATENCY_BUCKETS];  /* 分桶计数 */
+} vtx_latency_hist_t;
+
 /**
  * @brief 发送端统计信息
  */
@@ -143,9 +239,24 @@ typedef struct {
     uint64_t retrans_packets;   /* 重传包数 */
     uint64_t retrans_bytes;     /* 重传字节数 */
     uint64_t dropped_frames;    /* 丢弃帧数（发送失败） */
+    uint64_t limited_frames;    /* 因接收端限制（VTX_DATA_LIMIT）丢弃的帧数 */
+    uint64_t oversize_iframes;  /* 超过接收端max_frame_size的I帧数（含在limited_frames中） */
+    uint64_t session_resumes;   /* 通过会话令牌恢复的重连次数 */
+    uint64_t migrations;        /* 客户端地址迁移次数（路径验证通过） */
+    uint64_t rate_limited;      /* 因源地址限速丢弃的控制包数 */
+    uint8_t  path_count;        /* 路径数（1表示单路径） */
+    vtx_path_stats_t paths[VTX_MAX_PATHS]; /* 各路径统计（路径0为bind_addr） */
     uint32_t current_bitrate;   /* 当前比特率（bps） */
     uint32_t avg_frame_size;    /* 平均帧大小（字节） */
     float    retrans_rate;      /* 重传率 */
+    uint32_t sock_buf_size;     /* socket发送缓冲区实际大小（字节） */
+    uint32_t pool_frames;       /* 帧池已创建的帧数（只增不减，持续增长说明有帧泄漏或积压） */
+    uint32_t pool_used_frames;  /* 帧池使用中的帧数 */
+
+    /* 延迟分解（仅 latency_stats 开启时统计） */
+    vtx_latency_hist_t lat_submit;   /* 应用提交 → 首分片发出 */
+    vtx_latency_hist_t lat_wire;     /* 首分片发出 → 末分片发出 */
+    vtx_latency_hist_t lat_retrans;  /* 末分片发出 → 全部分片确认（仅I帧） */
 } vtx_tx_stats_t;
 
 /**
@@ -163,10 +274,25 @@ typedef struct {
     uint32_t current_bitrate;   /* 当前比特率（bps） */
     uint32_t avg_frame_size;    /* 平均帧大小（字节） */
     float    loss_rate;         /* 丢包率 */
+    uint32_t sock_buf_size;     /* socket接收缓冲区实际大小（字节） */
+    uint64_t kernel_drops;      /* socket缓冲区溢出丢包数（SO_RXQ_OVFL，仅Linux） */
+    uint64_t auth_failures;     /* GCM认证失败（或未加密）丢弃的帧数 */
+    uint64_t recorded_frames;   /* 已写入录制段的帧数 */
+    uint64_t record_failures;   /* 写入录制段失败的帧数 */
+    uint64_t hash_failures;     /* 帧哈希校验失败丢弃的帧数 */
+    uint64_t late_frags;        /* 已完成/已超时帧的迟到分片数（重组前丢弃） */
+    uint64_t stale_frags;       /* frame_id早于过滤窗口的过旧分片数（重组前丢弃） */
+    uint32_t pool_frames;       /* 帧池已创建的帧数（只增不减，持续增长说明有帧泄漏或积压） */
+    uint32_t pool_used_frames;  /* 帧池使用中的帧数 */
 #ifdef VTX_DEBUG
     uint32_t avg_latency_ms;    /* 平均延迟（毫秒） */
     uint32_t max_latency_ms;    /* 最大延迟（毫秒） */
 #endif
+
+    /* 延迟分解（仅 latency_stats 开启时统计） */
+    vtx_latency_hist_t lat_reassembly; /* 首分片到达 → 末分片到达 */
+    vtx_latency_hist_t lat_deliver;    /* 末分片到达 → 回调开始 */
+    vtx_latency_hist_t lat_callback;   /* 回调开始 → 回调结束 */
 } vtx_rx_stats_t;
 
 /**
@@ -194,6 +320,9 @@ typedef int (*vtx_on_frame_fn)(
  * @param size 数据大小
  * @param userdata 用户数据
  * @return 0成功，负数表示错误
+ *
+ * 注意：data_type为VTX_DATA_LIMIT时（TX端），data指向主机字节序的
+ *       vtx_limits_t，size为sizeof(vtx_limits_t)
  */
 typedef int (*vtx_on_data_fn)(
     vtx_data_type_t data_type,
@@ -225,13 +354,33 @@ typedef void (*vtx_on_media_fn)(
     const char* url,
     void* userdata);
 
+/**
+ * @brief 外部缓冲区释放回调
+ *
+ * @param data 外部缓冲区指针（vtx_tx_wrap_media_frame传入的data）
+ * @param size 外部缓冲区大小
+ * @param ctx 用户上下文
+ *
+ * 注意：在最后一个引用（包括I帧重传缓存）释放时调用，
+ *       可能在poll线程或发送线程中执行，应尽快返回
+ */
+typedef void (*vtx_on_release_fn)(
+    const uint8_t* data,
+    size_t size,
+    void* ctx);
+
 /* ========== 常量定义 ========== */
 
 #define VTX_MAX_URL_SIZE          100
 #define VTX_DEFAULT_MTU           1400
 #define VTX_MAX_FRAME_SIZE        (512 * 1024)  /* 512KB */
+#define VTX_MAX_IOV               16            /* 分散媒体帧最大数据段数 */
+#define VTX_CRYPTO_KEY_SIZE       16            /* AES-128-GCM密钥长度 */
+#define VTX_CRYPTO_TAG_SIZE       16            /* GCM标签长度（加密帧尾随数据） */
+#define VTX_FRAME_HASH_SIZE       8             /* 帧哈希长度（未加密帧尾随数据） */
 #define VTX_DEFAULT_SEND_BUF      (2 * 1024 * 1024)  /* 2MB */
 #define VTX_DEFAULT_RECV_BUF      (2 * 1024 * 1024)  /* 2MB */
+#define VTX_SOCKBUF_AUTO          0xFFFFFFFFu  /* 按峰值帧大小和带宽时延积自动调整 */
 #define VTX_DEFAULT_RETRANS_TIMEOUT_MS  5
 #define VTX_DEFAULT_MAX_RETRANS   3
 #define VTX_DEFAULT_DATA_RETRANS_TIMEOUT_MS 30
@@ -240,6 +389,12 @@ typedef void (*vtx_on_media_fn)(
 #define VTX_DEFAULT_CONNECT_MAX_RETRANS 3
 #define VTX_DEFAULT_HEARTBEAT_INTERVAL_MS (60 * 1000)  /* 1分钟 */
 #define VTX_DEFAULT_HEARTBEAT_MAX_MISS 3
+#define VTX_DEFAULT_SESSION_GRACE_MS (10 * 1000)  /* 10秒 */
+#define VTX_DEFAULT_CONTROL_RATE  20
+#define VTX_DEFAULT_RECORD_SEGMENT_SIZE (64 * 1024 * 1024)  /* 64MB */
+#define VTX_MIN_RECORD_SEGMENT_SIZE (2 * VTX_MAX_FRAME_SIZE)    /* 至少容纳一个最大帧 */
+#define VTX_DEFAULT_TIMESHIFT_BYTES (32 * 1024 * 1024)  /* 32MB */
+#define VTX_DEFAULT_MEDIA_FPS     30
 
 #ifdef __cplusplus
 }
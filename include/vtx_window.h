@@ -0,0 +1,200 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_window.h
+ * @brief VTX DATA Window (internal)
+ *
+ * 设计说明：
+ * - 可靠DATA包（VTX_DATA_USER/VTX_DATA_LIMIT）使用预分配的固定槽位表，
+ *   按 frame_id & (VTX_DATA_WINDOW_SIZE - 1) 索引，替代data帧池和data队列
+ * - 发送、ACK、重传都不分配内存、不遍历链表、不加锁：
+ *   槽位状态为原子变量（FREE → FILLING → PENDING → FREE）
+ * - 槽位被更早的未确认DATA包占用时返回VTX_ERR_BUSY（窗口已满）
+ * - 媒体帧ID窗口（接收端）：最近VTX_FID_WINDOW_SIZE个frame_id的位图，
+ *   记录已完成/已超时的帧，重组前过滤迟到和过旧的分片，不分配帧和分片表
+ *
+ * 线程模型：
+ * - vtx_data_window_reserve()/commit()/cancel() 可在任意线程调用
+ * - vtx_data_window_ack()/process() 只在poll线程调用
+ * - vtx_fid_window_*() 只在poll线程调用（其他线程需要复位时由调用方转交poll线程）
+ */
+
+#ifndef VTX_WINDOW_H
+#define VTX_WINDOW_H
+
+#include "vtx_types.h"
+#include "vtx_frame.h"
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VTX_DATA_WINDOW_SIZE    64          /* 槽位数量（2的幂） */
+#define VTX_DATA_NO_RTT         UINT32_MAX  /* 无RTT样本（包已重传） */
+
+#define VTX_FID_WINDOW_SIZE     1024        /* 帧ID窗口位数（2的幂） */
+#define VTX_FID_STALE_RESYNC    64          /* 连续过旧分片数达到后以新frame_id重新定位窗口
+                                               （发送端重启且未经CONNECT复位） */
+
+/**
+ * @brief 槽位状态
+ */
+typedef enum {
+    VTX_DATA_SLOT_FREE    = 0,  /* 空闲 */
+    VTX_DATA_SLOT_FILLING = 1,  /* 发送线程正在填充 */
+    VTX_DATA_SLOT_PENDING = 2,  /* 已发送，等待ACK */
+} vtx_data_slot_state_t;
+
+/**
+ * @brief DATA包槽位
+ */
+typedef struct {
+    atomic_uint      state;          /* vtx_data_slot_state_t */
+    uint16_t         frame_id;       /* 帧ID */
+    uint8_t          data_type;      /* vtx_data_type_t */
+    uint8_t          retrans_count;  /* 重传次数 */
+    uint16_t         size;           /* 数据大小 */
+    uint64_t         send_time_ms;   /* 最近一次发送时间 */
+    uint8_t          data[VTX_CTRL_FRAME_DATA_SIZE];  /* 数据 */
+} vtx_data_slot_t;
+
+/**
+ * @brief DATA窗口（嵌入在TX/RX对象中）
+ */
+typedef struct {
+    vtx_data_slot_t  slots[VTX_DATA_WINDOW_SIZE];
+} vtx_data_window_t;
+
+/**
+ * @brief 重传回调（poll线程中调用）
+ *
+ * @param ctx 上下文（TX/RX对象）
+ * @param slot 待重传的槽位（retrans_count已递增）
+ */
+typedef void (*vtx_data_resend_fn)(void* ctx, const vtx_data_slot_t* slot);
+
+/**
+ * @brief 初始化窗口（所有槽位空闲）
+ */
+void vtx_data_window_init(vtx_data_window_t* win);
+
+/**
+ * @brief 为frame_id预留槽位
+ *
+ * @param win 窗口
+ * @param frame_id 帧ID
+ * @param data_type 数据类型
+ * @param data 数据
+ * @param size 数据大小（不超过VTX_CTRL_FRAME_DATA_SIZE）
+ * @return 已填充的槽位（FILLING状态），槽位被占用时返回NULL
+ */
+vtx_data_slot_t* vtx_data_window_reserve(
+    vtx_data_window_t* win,
+    uint16_t frame_id,
+    uint8_t data_type,
+    const uint8_t* data,
+    size_t size);
+
+/**
+ * @brief 提交槽位（FILLING → PENDING），之后ACK和重传才可见
+ *
+ * 注意：应在发送数据包之前提交，避免ACK先于提交到达而被忽略
+ */
+void vtx_data_window_commit(vtx_data_slot_t* slot, uint64_t now_ms);
+
+/**
+ * @brief 放弃槽位（首次发送失败时）
+ */
+void vtx_data_window_cancel(vtx_data_slot_t* slot);
+
+/**
+ * @brief 处理DATA包ACK
+ *
+ * @param win 窗口
+ * @param frame_id ACK中的帧ID
+ * @param now_ms 当前时间
+ * @param rtt_ms 输出RTT样本（重传过的包为VTX_DATA_NO_RTT，Karn算法）
+ * @return true表示确认了一个等待中的DATA包
+ */
+bool vtx_data_window_ack(
+    vtx_data_window_t* win,
+    uint16_t frame_id,
+    uint64_t now_ms,
+    uint32_t* rtt_ms);
+
+/**
+ * @brief 超时重传与清理
+ *
+ * @param win 窗口
+ * @param now_ms 当前时间
+ * @param timeout_ms 重传超时
+ * @param max_retrans 最大重传次数（超过后丢弃）
+ * @param resend_fn 重传回调
+ * @param ctx 回调上下文
+ */
+void vtx_data_window_process(
+    vtx_data_window_t* win,
+    uint64_t now_ms,
+    uint32_t timeout_ms,
+    uint8_t max_retrans,
+    vtx_data_resend_fn resend_fn,
+    void* ctx);
+
+/* ========== 媒体帧ID窗口 ========== */
+
+/**
+ * @brief 分片检查结果
+ */
+typedef enum {
+    VTX_FID_NEW   = 0,  /* 未完成的帧（新帧或重组中） */
+    VTX_FID_DONE  = 1,  /* 帧已完成或已超时（迟到分片） */
+    VTX_FID_STALE = 2,  /* frame_id早于窗口（过旧分片） */
+} vtx_fid_state_t;
+
+/**
+ * @brief 媒体帧ID窗口（嵌入在RX对象中）
+ *
+ * 窗口为 (high - VTX_FID_WINDOW_SIZE, high]，high为见过的最新frame_id（序号比较，
+ * 可回绕）；high前进时清除新进入窗口的位
+ */
+typedef struct {
+    uint64_t         done[VTX_FID_WINDOW_SIZE / 64]; /* 已完成/已超时位图 */
+    uint16_t         high;           /* 最新frame_id */
+    bool             valid;          /* high有效（收到过媒体分片） */
+    uint16_t         stale_run;      /* 连续过旧分片数 */
+} vtx_fid_window_t;
+
+/**
+ * @brief 复位窗口（新会话/重新START，发送端可能重发同一frame_id的I帧）
+ */
+void vtx_fid_window_reset(vtx_fid_window_t* win);
+
+/**
+ * @brief 检查分片所属的frame_id（新frame_id使窗口前进）
+ */
+vtx_fid_state_t vtx_fid_window_check(vtx_fid_window_t* win, uint16_t frame_id);
+
+/**
+ * @brief 标记帧已完成或已超时（之后的分片为迟到分片）
+ */
+void vtx_fid_window_mark(vtx_fid_window_t* win, uint16_t frame_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VTX_WINDOW_H */
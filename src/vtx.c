@@ -131,3 +131,58 @@ const char* vtx_build_info(void) {
              VTX_VERSION_STRING, __DATE__, __TIME__);
     return build_info;
 }
+
+/* ========== 延迟直方图 ========== */
+
+void vtx_latency_hist_record(vtx_latency_hist_t* hist, uint64_t us) {
+    if (!hist) {
+        return;
+    }
+
+    /* log2分桶：bucket = floor(log2(us)) + 1 */
+    int bucket = 0;
+    uint64_t v = us;
+    while (v > 0 && bucket < VTX_LATENCY_BUCKETS - 1) {
+        v >>= 1;
+        bucket++;
+    }
+
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->sum_us += us;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+}
+
+uint64_t vtx_latency_hist_percentile(const vtx_latency_hist_t* hist,
+                                     double percentile)
+{
+    if (!hist || hist->count == 0) {
+        return 0;
+    }
+
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    /* 目标样本序号（向上取整，至少为1） */
+    uint64_t target = (uint64_t)((double)hist->count * percentile / 100.0 + 0.999999);
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < VTX_LATENCY_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            /* 桶上界：buckets[i]覆盖 [2^(i-1), 2^i) */
+            uint64_t upper = (i == 0) ? 1 : ((uint64_t)1 << i);
+            return upper < hist->max_us ? upper : hist->max_us;
+        }
+    }
+
+    return hist->max_us;
+}
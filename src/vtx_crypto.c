@@ -0,0 +1,236 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_crypto.c
+ * @brief VTX Payload Encryption Implementation
+ */
+
+#include "vtx_crypto.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include "vtx_mem.h"
+#include "vtx_spinlock.h"
+#include <string.h>
+
+#ifdef VTX_HAVE_OPENSSL
+#include <openssl/evp.h>
+#endif
+
+#define VTX_CRYPTO_NONCE_SIZE   12  /* GCM标准nonce长度 */
+#define VTX_CRYPTO_AAD_SIZE     5   /* frame_id(2) + frame_type(1) + total_frags(2) */
+
+/**
+ * @brief 加密上下文
+ */
+struct vtx_crypto {
+#ifdef VTX_HAVE_OPENSSL
+    EVP_CIPHER_CTX*     enc;        /* 加密上下文（密钥只扩展一次） */
+    EVP_CIPHER_CTX*     dec;        /* 解密上下文 */
+#endif
+    vtx_spinlock_t      lock;       /* 保护enc/dec */
+};
+
+/* ========== 辅助函数 ========== */
+
+void vtx_crypto_pack_salt(uint64_t salt, uint8_t* buf) {
+    for (int i = 0; i < VTX_CRYPTO_SALT_SIZE; i++) {
+        buf[i] = (uint8_t)(salt >> (56 - 8 * i));
+    }
+}
+
+uint64_t vtx_crypto_unpack_salt(const uint8_t* buf) {
+    uint64_t salt = 0;
+    for (int i = 0; i < VTX_CRYPTO_SALT_SIZE; i++) {
+        salt = (salt << 8) | buf[i];
+    }
+    return salt;
+}
+
+#ifdef VTX_HAVE_OPENSSL
+
+/**
+ * @brief 构造nonce和AAD
+ */
+static void vtx_crypto_prepare(
+    uint64_t salt,
+    const vtx_packet_header_t* header,
+    uint8_t nonce[VTX_CRYPTO_NONCE_SIZE],
+    uint8_t aad[VTX_CRYPTO_AAD_SIZE])
+{
+    vtx_crypto_pack_salt(salt, nonce);
+    nonce[8] = (uint8_t)(header->seq_num >> 24);
+    nonce[9] = (uint8_t)(header->seq_num >> 16);
+    nonce[10] = (uint8_t)(header->seq_num >> 8);
+    nonce[11] = (uint8_t)header->seq_num;
+
+    aad[0] = (uint8_t)(header->frame_id >> 8);
+    aad[1] = (uint8_t)header->frame_id;
+    aad[2] = header->frame_type;
+    aad[3] = (uint8_t)(header->total_frags >> 8);
+    aad[4] = (uint8_t)header->total_frags;
+}
+
+#endif
+
+/* ========== 公共接口 ========== */
+
+bool vtx_crypto_supported(void) {
+#ifdef VTX_HAVE_OPENSSL
+    return true;
+#else
+    return false;
+#endif
+}
+
+vtx_crypto_t* vtx_crypto_create(const uint8_t* key) {
+    if (!key) {
+        return NULL;
+    }
+
+#ifdef VTX_HAVE_OPENSSL
+    vtx_crypto_t* crypto = (vtx_crypto_t*)vtx_calloc(1, sizeof(vtx_crypto_t));
+    if (!crypto) {
+        return NULL;
+    }
+    vtx_spinlock_init(&crypto->lock);
+
+    crypto->enc = EVP_CIPHER_CTX_new();
+    crypto->dec = EVP_CIPHER_CTX_new();
+    if (!crypto->enc || !crypto->dec ||
+        EVP_EncryptInit_ex(crypto->enc, EVP_aes_128_gcm(), NULL, key, NULL) != 1 ||
+        EVP_DecryptInit_ex(crypto->dec, EVP_aes_128_gcm(), NULL, key, NULL) != 1) {
+        vtx_log_error("Failed to initialize AES-GCM context");
+        vtx_crypto_destroy(crypto);
+        return NULL;
+    }
+
+    return crypto;
+#else
+    vtx_log_error("Payload encryption requires OpenSSL (VTX_ENABLE_CRYPTO)");
+    return NULL;
+#endif
+}
+
+void vtx_crypto_destroy(vtx_crypto_t* crypto) {
+    if (!crypto) {
+        return;
+    }
+
+#ifdef VTX_HAVE_OPENSSL
+    EVP_CIPHER_CTX_free(crypto->enc);
+    EVP_CIPHER_CTX_free(crypto->dec);
+#endif
+    vtx_spinlock_destroy(&crypto->lock);
+    vtx_free(crypto);
+}
+
+int vtx_crypto_seal(vtx_crypto_t* crypto,
+                    uint64_t salt,
+                    const vtx_packet_header_t* header,
+                    const struct iovec* in,
+                    int iovcnt,
+                    uint8_t* out,
+                    uint8_t* tag)
+{
+    if (!crypto || !header || !in || iovcnt <= 0 || !out || !tag) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+#ifdef VTX_HAVE_OPENSSL
+    uint8_t nonce[VTX_CRYPTO_NONCE_SIZE];
+    uint8_t aad[VTX_CRYPTO_AAD_SIZE];
+    vtx_crypto_prepare(salt, header, nonce, aad);
+
+    int ret = VTX_OK;
+    int len;
+    vtx_spinlock_lock(&crypto->lock);
+
+    /* 只更换nonce，复用已扩展的密钥 */
+    if (EVP_EncryptInit_ex(crypto->enc, NULL, NULL, NULL, nonce) != 1 ||
+        EVP_EncryptUpdate(crypto->enc, NULL, &len, aad, sizeof(aad)) != 1) {
+        ret = VTX_ERR_IO_FAILED;
+    }
+
+    /* 所有数据段在一个GCM流中处理（一帧一个标签） */
+    size_t offset = 0;
+    for (int i = 0; ret == VTX_OK && i < iovcnt; i++) {
+        if (in[i].iov_len == 0) {
+            continue;
+        }
+        if (EVP_EncryptUpdate(crypto->enc, out + offset, &len,
+                              (const uint8_t*)in[i].iov_base,
+                              (int)in[i].iov_len) != 1) {
+            ret = VTX_ERR_IO_FAILED;
+        }
+        offset += in[i].iov_len;
+    }
+
+    if (ret == VTX_OK &&
+        (EVP_EncryptFinal_ex(crypto->enc, out + offset, &len) != 1 ||
+         EVP_CIPHER_CTX_ctrl(crypto->enc, EVP_CTRL_GCM_GET_TAG,
+                             VTX_CRYPTO_TAG_SIZE, tag) != 1)) {
+        ret = VTX_ERR_IO_FAILED;
+    }
+
+    vtx_spinlock_unlock(&crypto->lock);
+    return ret;
+#else
+    (void)salt;
+    return VTX_ERR_NOT_SUPPORTED;
+#endif
+}
+
+int vtx_crypto_open(vtx_crypto_t* crypto,
+                    uint64_t salt,
+                    const vtx_packet_header_t* header,
+                    uint8_t* data,
+                    size_t size,
+                    const uint8_t* tag)
+{
+    if (!crypto || !header || (!data && size > 0) || !tag) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+#ifdef VTX_HAVE_OPENSSL
+    uint8_t nonce[VTX_CRYPTO_NONCE_SIZE];
+    uint8_t aad[VTX_CRYPTO_AAD_SIZE];
+    uint8_t tag_copy[VTX_CRYPTO_TAG_SIZE];
+    vtx_crypto_prepare(salt, header, nonce, aad);
+    memcpy(tag_copy, tag, sizeof(tag_copy));
+
+    int ret = VTX_OK;
+    int len;
+    vtx_spinlock_lock(&crypto->lock);
+
+    if (EVP_DecryptInit_ex(crypto->dec, NULL, NULL, NULL, nonce) != 1 ||
+        EVP_DecryptUpdate(crypto->dec, NULL, &len, aad, sizeof(aad)) != 1 ||
+        (size > 0 &&
+         EVP_DecryptUpdate(crypto->dec, data, &len, data, (int)size) != 1) ||
+        EVP_CIPHER_CTX_ctrl(crypto->dec, EVP_CTRL_GCM_SET_TAG,
+                            VTX_CRYPTO_TAG_SIZE, tag_copy) != 1) {
+        ret = VTX_ERR_IO_FAILED;
+    } else if (EVP_DecryptFinal_ex(crypto->dec, data + size, &len) != 1) {
+        ret = VTX_ERR_CHECKSUM;
+    }
+
+    vtx_spinlock_unlock(&crypto->lock);
+    return ret;
+#else
+    (void)salt;
+    (void)size;
+    return VTX_ERR_NOT_SUPPORTED;
+#endif
+}
@@ -22,6 +22,7 @@
 #include "vtx_error.h"
 #include "vtx_log.h"
 #include "vtx_mem.h"
+#include "vtx_trace.h"
 #include <string.h>
 #include <sys/time.h>
 
@@ -91,9 +92,9 @@ static vtx_frame_t* vtx_frame_alloc(size_t data_size) {
         return NULL;
     }
 
-    /* 分配数据缓冲区 */
-    frame->data = (uint8_t*)vtx_malloc(data_size);
-    if (!frame->data) {
+    /* 分配数据缓冲区（外部数据帧池不分配） */
+    frame->data = data_size > 0 ? (uint8_t*)vtx_malloc(data_size) : NULL;
+    if (data_size > 0 && !frame->data) {
         vtx_log_error("Failed to allocate frame data buffer: %zu bytes", data_size);
         vtx_free(frame);
         return NULL;
@@ -139,11 +140,6 @@ static void vtx_frame_free(vtx_frame_t* frame) {
 /* ========== 内存池管理 ========== */
 
 vtx_frame_pool_t* vtx_frame_pool_create(size_t initial_size, size_t data_size) {
-    if (data_size == 0) {
-        vtx_log_error("Invalid data_size: 0");
-        return NULL;
-    }
-
     vtx_frame_pool_t* pool = (vtx_frame_pool_t*)vtx_calloc(1, sizeof(vtx_frame_pool_t));
     if (!pool) {
         vtx_log_error("Failed to allocate frame pool");
@@ -231,6 +227,7 @@ vtx_frame_t* vtx_frame_pool_acquire(vtx_frame_pool_t* pool) {
         pool->total_count++;
         vtx_spinlock_unlock(&pool->lock);
 
+        VTX_TRACE_POOL_GROW(pool, pool->data_size, pool->total_count);
         vtx_log_debug("Frame pool expanded: total=%zu", pool->total_count);
     }
 
@@ -461,6 +458,24 @@ void vtx_frame_release(vtx_frame_pool_t* pool, vtx_frame_t* frame) {
 
     /* 引用计数降为0，归还到池中 */
     if (old_refcount == 1) {
+        /* 外部缓冲区：通知所有者，并解除挂接（避免被vtx_frame_free释放） */
+        if (frame->external) {
+            if (frame->release_fn) {
+                frame->release_fn(frame->data, frame->data_capacity,
+                                  frame->release_ctx);
+            }
+            frame->data = NULL;
+            frame->data_capacity = 0;
+            frame->external = false;
+            if (frame->segs) {
+                vtx_free(frame->segs);
+                frame->segs = NULL;
+            }
+            frame->nsegs = 0;
+            frame->release_fn = NULL;
+            frame->release_ctx = NULL;
+        }
+
         if (pool) {
             vtx_frame_pool_release(pool, frame);
         } else {
@@ -478,6 +493,140 @@ int vtx_frame_get_refcount(vtx_frame_t* frame) {
 
 /* ========== frame数据复制 ========== */
 
+int vtx_frame_wrap_iov(
+    vtx_frame_t* frame,
+    const struct iovec* iov,
+    int iovcnt,
+    vtx_on_release_fn release_fn,
+    void* release_ctx)
+{
+    if (!frame || !iov || iovcnt <= 0 || iovcnt > VTX_MAX_IOV) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    if (frame->data || frame->external) {
+        vtx_log_error("wrap_iov: frame already owns a data buffer");
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 统计非空数据段 */
+    uint8_t nsegs = 0;
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) {
+            continue;
+        }
+        if (!iov[i].iov_base) {
+            return VTX_ERR_INVALID_PARAM;
+        }
+        nsegs++;
+        total += iov[i].iov_len;
+    }
+
+    if (nsegs == 0) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 段描述单独分配（只有分散帧需要，不占用池中每个frame的空间） */
+    frame->segs = (struct iovec*)vtx_malloc(nsegs * sizeof(struct iovec));
+    if (!frame->segs) {
+        return VTX_ERR_NO_MEMORY;
+    }
+    nsegs = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0) {
+            frame->segs[nsegs++] = iov[i];
+        }
+    }
+
+    frame->data = (uint8_t*)frame->segs[0].iov_base;
+    frame->data_capacity = total;
+    frame->data_size = total;
+    frame->nsegs = nsegs;
+    frame->external = true;
+    frame->release_fn = release_fn;
+    frame->release_ctx = release_ctx;
+
+    return VTX_OK;
+}
+
+int vtx_frame_gather(
+    const vtx_frame_t* frame,
+    size_t offset,
+    size_t size,
+    struct iovec* iov,
+    int max_iov)
+{
+    if (!frame || !frame->data || !iov || max_iov <= 0 || size == 0) {
+        return 0;
+    }
+
+    if (offset > frame->data_size || size > frame->data_size - offset) {
+        return 0;
+    }
+
+    /* 连续数据 */
+    if (frame->nsegs == 0) {
+        iov[0].iov_base = frame->data + offset;
+        iov[0].iov_len = size;
+        return 1;
+    }
+
+    /* 分散数据：跳过offset之前的段，再按需截取 */
+    int cnt = 0;
+    for (uint8_t i = 0; i < frame->nsegs && size > 0; i++) {
+        size_t len = frame->segs[i].iov_len;
+        if (offset >= len) {
+            offset -= len;
+            continue;
+        }
+
+        if (cnt >= max_iov) {
+            return 0;
+        }
+
+        size_t take = len - offset;
+        if (take > size) {
+            take = size;
+        }
+        iov[cnt].iov_base = (uint8_t*)frame->segs[i].iov_base + offset;
+        iov[cnt].iov_len = take;
+        cnt++;
+
+        size -= take;
+        offset = 0;
+    }
+
+    return size == 0 ? cnt : 0;
+}
+
+int vtx_frame_wrap(
+    vtx_frame_t* frame,
+    const uint8_t* data,
+    size_t size,
+    vtx_on_release_fn release_fn,
+    void* release_ctx)
+{
+    if (!frame || !data || size == 0) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 只能挂接到外部数据帧池的空frame */
+    if (frame->data || frame->external) {
+        vtx_log_error("wrap: frame already owns a data buffer");
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    frame->data = (uint8_t*)data;  /* 只读使用 */
+    frame->data_capacity = size;
+    frame->data_size = size;
+    frame->external = true;
+    frame->release_fn = release_fn;
+    frame->release_ctx = release_ctx;
+
+    return VTX_OK;
+}
+
 size_t vtx_frame_copyfrom(
     const vtx_frame_t* frame,
     size_t offset,
@@ -506,8 +655,13 @@ size_t vtx_frame_copyfrom(
         return 0;  /* 严格检查：要求的大小超出边界则失败 */
     }
 
-    /* 复制数据 */
-    memcpy(dst, frame->data + offset, size);
+    /* 复制数据（分散frame逐段复制） */
+    struct iovec iov[VTX_MAX_IOV];
+    int cnt = vtx_frame_gather(frame, offset, size, iov, VTX_MAX_IOV);
+    for (int i = 0; i < cnt; i++) {
+        memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+        dst += iov[i].iov_len;
+    }
     return size;
 }
 
@@ -568,9 +722,12 @@ int vtx_frame_init_recv(
     frame->frame_type = frame_type;
     frame->total_frags = total_frags;
     frame->recv_frags = 0;
+    frame->acked_frags = 0;
     frame->data_size = 0;
     frame->state = VTX_FRAME_STATE_RECEIVING;
     frame->retrans_count = 0;
+    frame->sealed = false;
+    frame->hashed = false;
 
     /* 从frag_pool分配retran用于跟踪接收状态 */
     frame->retran = vtx_frag_pool_acquire(frag_pool, total_frags);
@@ -680,11 +837,17 @@ void vtx_frame_reset(vtx_frame_t* frame) {
     frame->frame_type = 0;
     frame->total_frags = 0;
     frame->recv_frags = 0;
+    frame->acked_frags = 0;
     frame->data_size = 0;
     frame->first_recv_ms = 0;
     frame->last_recv_ms = 0;
     frame->send_time_ms = 0;
     frame->retrans_count = 0;
+    memset(&frame->timing, 0, sizeof(frame->timing));
+    frame->base_seq = 0;
+    frame->sealed = false;
+    frame->seal_salt = 0;
+    frame->hashed = false;
 
     /* data缓冲区保留，不释放 */
 }
@@ -693,6 +856,7 @@ void vtx_frame_reset(vtx_frame_t* frame) {
 
 vtx_frame_queue_t* vtx_frame_queue_create(
     vtx_frame_pool_t* pool,
+    vtx_frag_pool_t* frag_pool,
     uint32_t timeout_ms)
 {
     vtx_frame_queue_t* queue = (vtx_frame_queue_t*)vtx_calloc(1, sizeof(vtx_frame_queue_t));
@@ -704,12 +868,24 @@ vtx_frame_queue_t* vtx_frame_queue_create(
     INIT_LIST_HEAD(&queue->frames);
     queue->count = 0;
     queue->pool = pool;
+    queue->frag_pool = frag_pool;
     queue->timeout_ms = timeout_ms;
     vtx_spinlock_init(&queue->lock);
 
     return queue;
 }
 
+/**
+ * @brief 丢弃队列中的帧（归还retran并释放队列持有的引用）
+ */
+static void vtx_frame_queue_drop(vtx_frame_queue_t* queue, vtx_frame_t* frame) {
+    if (frame->retran && queue->frag_pool) {
+        vtx_frag_pool_release(queue->frag_pool, frame->retran);
+        frame->retran = NULL;
+    }
+    vtx_frame_release(queue->pool, frame);
+}
+
 void vtx_frame_queue_destroy(vtx_frame_queue_t* queue) {
     if (!queue) {
         return;
@@ -722,7 +898,7 @@ void vtx_frame_queue_destroy(vtx_frame_queue_t* queue) {
         vtx_frame_t* frame = list_first_entry(&queue->frames,
                                                vtx_frame_t, list);
         list_del(&frame->list);
-        vtx_frame_release(queue->pool, frame);
+        vtx_frame_queue_drop(queue, frame);
         queue->count--;
     }
 
@@ -813,7 +989,9 @@ void vtx_frame_queue_remove(vtx_frame_queue_t* queue, vtx_frame_t* frame) {
 
 size_t vtx_frame_queue_cleanup_timeout(
     vtx_frame_queue_t* queue,
-    uint64_t now_ms)
+    uint64_t now_ms,
+    vtx_frame_expire_fn expire_fn,
+    void* ctx)
 {
     if (!queue || queue->timeout_ms == 0) {
         return 0;
@@ -828,13 +1006,21 @@ size_t vtx_frame_queue_cleanup_timeout(
     list_for_each_entry_safe(frame, tmp, &queue->frames, list) {
         uint64_t elapsed = now_ms - frame->first_recv_ms;
         if (elapsed >= queue->timeout_ms) {
+            VTX_TRACE_FRAME_TIMEOUT(frame->frame_id, frame->frame_type,
+                                    frame->recv_frags, frame->total_frags,
+                                    elapsed);
             vtx_log_debug("Frame timeout: id=%u, elapsed=%llu ms",
                          frame->frame_id, (unsigned long long)elapsed);
 
+            if (expire_fn) {
+                expire_fn(ctx, frame);
+            }
             list_del(&frame->list);
             queue->count--;
-            vtx_frame_release(queue->pool, frame);
+            vtx_frame_queue_drop(queue, frame);
             cleaned++;
+        } else {
+            break;  /* 按到达顺序入队，之后的帧更晚超时 */
         }
     }
 
@@ -843,6 +1029,63 @@ size_t vtx_frame_queue_cleanup_timeout(
     return cleaned;
 }
 
+size_t vtx_frame_queue_purge_before(
+    vtx_frame_queue_t* queue,
+    uint16_t frame_id,
+    vtx_frame_expire_fn expire_fn,
+    void* ctx)
+{
+    if (!queue) {
+        return 0;
+    }
+
+    size_t purged = 0;
+
+    vtx_spinlock_lock(&queue->lock);
+
+    vtx_frame_t* frame;
+    vtx_frame_t* tmp;
+    list_for_each_entry_safe(frame, tmp, &queue->frames, list) {
+        /* 音频帧不依赖视频关键帧，由超时清理 */
+        if ((int16_t)(frame->frame_id - frame_id) >= 0 ||
+            frame->frame_type == VTX_FRAME_A) {
+            continue;
+        }
+        vtx_log_debug("Frame purged: id=%u, recv=%u/%u, newer key frame id=%u",
+                     frame->frame_id, frame->recv_frags, frame->total_frags,
+                     frame_id);
+
+        if (expire_fn) {
+            expire_fn(ctx, frame);
+        }
+        list_del(&frame->list);
+        queue->count--;
+        vtx_frame_queue_drop(queue, frame);
+        purged++;
+    }
+
+    vtx_spinlock_unlock(&queue->lock);
+
+    return purged;
+}
+
+uint64_t vtx_frame_queue_next_deadline(vtx_frame_queue_t* queue) {
+    if (!queue || queue->timeout_ms == 0) {
+        return UINT64_MAX;
+    }
+
+    uint64_t deadline = UINT64_MAX;
+
+    vtx_spinlock_lock(&queue->lock);
+    if (!list_empty(&queue->frames)) {
+        vtx_frame_t* frame = list_first_entry(&queue->frames, vtx_frame_t, list);
+        deadline = frame->first_recv_ms + queue->timeout_ms;
+    }
+    vtx_spinlock_unlock(&queue->lock);
+
+    return deadline;
+}
+
 /* ========== 内存池统计 ========== */
 
 int vtx_frame_pool_get_stats(
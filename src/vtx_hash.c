@@ -0,0 +1,160 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_hash.c
+ * @brief VTX Frame Hash Implementation (XXH64)
+ */
+
+#include "vtx_hash.h"
+#include <string.h>
+
+#define VTX_HASH_P1     0x9E3779B185EBCA87ULL
+#define VTX_HASH_P2     0xC2B2AE3D27D4EB4FULL
+#define VTX_HASH_P3     0x165667B19E3779F9ULL
+#define VTX_HASH_P4     0x85EBCA77C2B2AE63ULL
+#define VTX_HASH_P5     0x27D4EB2F165667C5ULL
+
+static inline uint64_t vtx_hash_rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/* 小端读取（XXH64按小端定义） */
+static inline uint64_t vtx_hash_read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline uint32_t vtx_hash_read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+static inline uint64_t vtx_hash_round(uint64_t acc, uint64_t input) {
+    acc += input * VTX_HASH_P2;
+    acc = vtx_hash_rotl(acc, 31);
+    return acc * VTX_HASH_P1;
+}
+
+static inline uint64_t vtx_hash_merge(uint64_t acc, uint64_t v) {
+    acc ^= vtx_hash_round(0, v);
+    return acc * VTX_HASH_P1 + VTX_HASH_P4;
+}
+
+/**
+ * @brief 处理完整的32字节条带
+ *
+ * @return 处理的字节数（32的倍数）
+ */
+static size_t vtx_hash_stripes(uint64_t* v, const uint8_t* p, size_t size) {
+    uint64_t v1 = v[0], v2 = v[1], v3 = v[2], v4 = v[3];
+    const uint8_t* end = p + (size & ~(size_t)31);
+    for (const uint8_t* q = p; q < end; q += 32) {
+        v1 = vtx_hash_round(v1, vtx_hash_read64(q));
+        v2 = vtx_hash_round(v2, vtx_hash_read64(q + 8));
+        v3 = vtx_hash_round(v3, vtx_hash_read64(q + 16));
+        v4 = vtx_hash_round(v4, vtx_hash_read64(q + 24));
+    }
+    v[0] = v1; v[1] = v2; v[2] = v3; v[3] = v4;
+    return size & ~(size_t)31;
+}
+
+void vtx_hash_init(vtx_hash_state_t* state) {
+    memset(state, 0, sizeof(*state));
+    state->v[0] = VTX_HASH_P1 + VTX_HASH_P2;
+    state->v[1] = VTX_HASH_P2;
+    state->v[2] = 0;
+    state->v[3] = 0 - VTX_HASH_P1;
+}
+
+void vtx_hash_update(vtx_hash_state_t* state, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    state->total_len += size;
+
+    /* 先补齐上次剩余的条带 */
+    if (state->buf_size > 0) {
+        size_t fill = sizeof(state->buf) - state->buf_size;
+        if (size < fill) {
+            memcpy(state->buf + state->buf_size, p, size);
+            state->buf_size += (uint32_t)size;
+            return;
+        }
+        memcpy(state->buf + state->buf_size, p, fill);
+        vtx_hash_stripes(state->v, state->buf, sizeof(state->buf));
+        state->buf_size = 0;
+        p += fill;
+        size -= fill;
+    }
+
+    size_t done = vtx_hash_stripes(state->v, p, size);
+    memcpy(state->buf, p + done, size - done);
+    state->buf_size = (uint32_t)(size - done);
+}
+
+uint64_t vtx_hash_digest(const vtx_hash_state_t* state) {
+    uint64_t h;
+    if (state->total_len >= 32) {
+        const uint64_t* v = state->v;
+        h = vtx_hash_rotl(v[0], 1) + vtx_hash_rotl(v[1], 7) +
+            vtx_hash_rotl(v[2], 12) + vtx_hash_rotl(v[3], 18);
+        h = vtx_hash_merge(h, v[0]);
+        h = vtx_hash_merge(h, v[1]);
+        h = vtx_hash_merge(h, v[2]);
+        h = vtx_hash_merge(h, v[3]);
+    } else {
+        h = VTX_HASH_P5;
+    }
+    h += state->total_len;
+
+    /* 剩余不足32字节 */
+    const uint8_t* p = state->buf;
+    const uint8_t* end = p + state->buf_size;
+    for (; p + 8 <= end; p += 8) {
+        h ^= vtx_hash_round(0, vtx_hash_read64(p));
+        h = vtx_hash_rotl(h, 27) * VTX_HASH_P1 + VTX_HASH_P4;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)vtx_hash_read32(p) * VTX_HASH_P1;
+        h = vtx_hash_rotl(h, 23) * VTX_HASH_P2 + VTX_HASH_P3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (uint64_t)*p * VTX_HASH_P5;
+        h = vtx_hash_rotl(h, 11) * VTX_HASH_P1;
+    }
+
+    /* 雪崩 */
+    h ^= h >> 33;
+    h *= VTX_HASH_P2;
+    h ^= h >> 29;
+    h *= VTX_HASH_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t vtx_hash64(const void* data, size_t size) {
+    vtx_hash_state_t state;
+    vtx_hash_init(&state);
+    vtx_hash_update(&state, data, size);
+    return vtx_hash_digest(&state);
+}
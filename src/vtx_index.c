@@ -0,0 +1,546 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_index.c
+ * @brief VTX Media File Index Implementation
+ */
+
+#include "vtx_index.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include "vtx_mem.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+/* 旁路文件直接映射为vtx_media_entry_t数组，只在小端主机上使用 */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define VTX_INDEX_SIDECAR 1
+#else
+#define VTX_INDEX_SIDECAR 0
+#endif
+
+/* 文件头字段偏移 */
+#define VTX_INDEX_OFF_VERSION   8
+#define VTX_INDEX_OFF_FLAGS     12
+#define VTX_INDEX_OFF_SIZE      16
+#define VTX_INDEX_OFF_MTIME     24
+#define VTX_INDEX_OFF_ENTRIES   32
+#define VTX_INDEX_OFF_KEYS      36
+#define VTX_INDEX_OFF_PICTURES  40
+#define VTX_INDEX_OFF_DROPPED   44
+
+#define VTX_INDEX_PATH_MAX      (4096 + 32)
+
+_Static_assert(sizeof(vtx_media_entry_t) == 16, "vtx_media_entry_t must be 16 bytes");
+_Static_assert(sizeof(vtx_media_key_t) == 8, "vtx_media_key_t must be 8 bytes");
+
+/* NAL分类 */
+typedef enum {
+    VTX_NAL_OTHER,      /* SEI/AUD等，归入下一帧 */
+    VTX_NAL_SPS,        /* SPS（H.265含VPS） */
+    VTX_NAL_PPS,
+    VTX_NAL_SLICE,      /* 图像的后续slice */
+    VTX_NAL_FIRST_P,    /* 非关键图像的第一个slice */
+    VTX_NAL_FIRST_I,    /* 关键图像（IDR/IRAP）的第一个slice */
+} vtx_nal_class_t;
+
+/**
+ * @brief 扫描过程中的索引（堆上）
+ */
+typedef struct {
+    const char*         path;
+    vtx_media_entry_t*  entries;
+    uint32_t            count;
+    uint32_t            capacity;
+    vtx_media_key_t*    keys;
+    uint32_t            key_count;
+    uint32_t            key_capacity;
+    uint32_t            pictures;
+    uint32_t            dropped;        /* 超过VTX_MAX_FRAME_SIZE未进入索引的帧数 */
+} vtx_index_builder_t;
+
+/* ========== 辅助函数 ========== */
+
+static void vtx_index_put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void vtx_index_put64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t vtx_index_get32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static uint64_t vtx_index_get64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+/**
+ * @brief 按扩展名判断是否为H.265
+ */
+static bool vtx_index_is_hevc(const char* path) {
+    const char* ext = strrchr(path, '.');
+    if (!ext) {
+        return false;
+    }
+    return strcasecmp(ext, ".h265") == 0 || strcasecmp(ext, ".hevc") == 0 ||
+           strcasecmp(ext, ".265") == 0;
+}
+
+/**
+ * @brief NAL分类
+ *
+ * @param nal NAL头（起始码之后）
+ * @param len NAL长度
+ */
+static vtx_nal_class_t vtx_index_classify(const uint8_t* nal, size_t len, bool hevc) {
+    if (hevc) {
+        if (len < 3) {
+            return VTX_NAL_OTHER;
+        }
+        uint8_t type = (nal[0] >> 1) & 0x3F;
+        if (type == 32 || type == 33) {
+            return VTX_NAL_SPS;
+        }
+        if (type == 34) {
+            return VTX_NAL_PPS;
+        }
+        if (type < 32) {
+            if (!(nal[2] & 0x80)) {  /* first_slice_segment_in_pic_flag */
+                return VTX_NAL_SLICE;
+            }
+            return (type >= 16 && type <= 21) ? VTX_NAL_FIRST_I : VTX_NAL_FIRST_P;
+        }
+        return VTX_NAL_OTHER;
+    }
+
+    if (len < 2) {
+        return VTX_NAL_OTHER;
+    }
+    uint8_t type = nal[0] & 0x1F;
+    if (type == 7) {
+        return VTX_NAL_SPS;
+    }
+    if (type == 8) {
+        return VTX_NAL_PPS;
+    }
+    if (type >= 1 && type <= 5) {
+        if (!(nal[1] & 0x80)) {  /* first_mb_in_slice != 0 */
+            return VTX_NAL_SLICE;
+        }
+        return type == 5 ? VTX_NAL_FIRST_I : VTX_NAL_FIRST_P;
+    }
+    return VTX_NAL_OTHER;
+}
+
+/**
+ * @brief 查找下一个起始码
+ *
+ * 用memchr跳到下一个0x01字节（压缩数据中约每256字节出现一次），
+ * 再检查前两个字节是否为0
+ *
+ * @return 起始码（含4字节形式的前导0）偏移，没有返回size
+ */
+static size_t vtx_index_next_start(const uint8_t* p, size_t pos, size_t size) {
+    size_t i = pos + 2;
+    while (i < size) {
+        const uint8_t* q = (const uint8_t*)memchr(p + i, 1, size - i);
+        if (!q) {
+            break;
+        }
+        i = (size_t)(q - p);
+        if (p[i - 1] == 0 && p[i - 2] == 0) {
+            size_t sc = i - 2;
+            return (sc > pos && p[sc - 1] == 0) ? sc - 1 : sc;
+        }
+        i++;
+    }
+    return size;
+}
+
+/**
+ * @brief 追加帧索引项（I帧同时追加关键帧索引项）
+ */
+static int vtx_index_add(vtx_index_builder_t* b, uint64_t start, uint64_t end, uint8_t type) {
+    if (end - start > VTX_MAX_FRAME_SIZE) {
+        vtx_log_warn("Frame larger than %u bytes in %s: offset=%llu size=%llu, "
+                    "dropped from index", (unsigned)VTX_MAX_FRAME_SIZE, b->path,
+                    (unsigned long long)start, (unsigned long long)(end - start));
+        b->dropped++;
+        return VTX_OK;
+    }
+
+    if (b->count == b->capacity) {
+        uint32_t cap = b->capacity ? b->capacity * 2 : 1024;
+        vtx_media_entry_t* entries = (vtx_media_entry_t*)vtx_realloc(
+            b->entries, cap * sizeof(vtx_media_entry_t));
+        if (!entries) {
+            return VTX_ERR_NO_MEMORY;
+        }
+        b->entries = entries;
+        b->capacity = cap;
+    }
+
+    if (type == VTX_FRAME_I) {
+        if (b->key_count == b->key_capacity) {
+            uint32_t cap = b->key_capacity ? b->key_capacity * 2 : 64;
+            vtx_media_key_t* keys = (vtx_media_key_t*)vtx_realloc(
+                b->keys, cap * sizeof(vtx_media_key_t));
+            if (!keys) {
+                return VTX_ERR_NO_MEMORY;
+            }
+            b->keys = keys;
+            b->key_capacity = cap;
+        }
+
+        /* 从紧邻的SPS/PPS开始 */
+        uint32_t first = b->count;
+        while (first > 0 && (b->entries[first - 1].frame_type == VTX_FRAME_SPS ||
+                             b->entries[first - 1].frame_type == VTX_FRAME_PPS)) {
+            first--;
+        }
+        b->keys[b->key_count].entry = first;
+        b->keys[b->key_count].picture = b->pictures;
+        b->key_count++;
+    }
+    if (type == VTX_FRAME_I || type == VTX_FRAME_P) {
+        b->pictures++;
+    }
+
+    vtx_media_entry_t* e = &b->entries[b->count++];
+    memset(e, 0, sizeof(*e));
+    e->offset = start;
+    e->size = (uint32_t)(end - start);
+    e->frame_type = type;
+    return VTX_OK;
+}
+
+/**
+ * @brief 扫描起始码建立索引
+ *
+ * SPS（H.265含VPS）、PPS各为一帧，同一图像的所有slice为一帧，
+ * AUD/SEI等归入其后的帧
+ */
+static int vtx_index_scan(vtx_index_builder_t* b, const uint8_t* p, size_t size, bool hevc) {
+    uint64_t cur_start = 0;
+    int cur_type = 0;       /* 0表示当前没有帧 */
+    uint64_t pend = size;   /* 未归属的SEI/AUD等起始偏移（size表示无），归入下一帧 */
+    size_t pos = vtx_index_next_start(p, 0, size);
+    if (pos < size && pos > 0 && size >= 3 && p[0] == 0 && p[1] == 0 && p[2] == 1) {
+        pos = 0;
+    }
+
+    while (pos < size) {
+        size_t hdr = pos + (p[pos + 2] == 1 ? 3 : 4);
+        size_t next = vtx_index_next_start(p, hdr, size);
+        vtx_nal_class_t cls = vtx_index_classify(p + hdr, next - hdr, hevc);
+
+        int type = 0;  /* 新帧类型，0表示属于当前帧 */
+        switch (cls) {
+        case VTX_NAL_SPS:
+            type = cur_type == VTX_FRAME_SPS ? 0 : VTX_FRAME_SPS;
+            break;
+        case VTX_NAL_PPS:
+            type = cur_type == VTX_FRAME_PPS ? 0 : VTX_FRAME_PPS;
+            break;
+        case VTX_NAL_FIRST_I:
+            type = VTX_FRAME_I;
+            break;
+        case VTX_NAL_FIRST_P:
+            type = VTX_FRAME_P;
+            break;
+        case VTX_NAL_SLICE:
+            type = (cur_type == VTX_FRAME_I || cur_type == VTX_FRAME_P) ? 0 : VTX_FRAME_P;
+            break;
+        case VTX_NAL_OTHER:
+            if (pend == size) {
+                pend = pos;
+            }
+            pos = next;
+            continue;
+        }
+
+        /* 新帧开始：结束当前帧，之前未归属的NAL归入新帧 */
+        if (type != 0) {
+            uint64_t start = pend != size ? pend : pos;
+            if (cur_type != 0) {
+                int ret = vtx_index_add(b, cur_start, start, (uint8_t)cur_type);
+                if (ret != VTX_OK) {
+                    return ret;
+                }
+            }
+            cur_start = start;
+            cur_type = type;
+        }
+        pend = size;
+        pos = next;
+    }
+
+    if (cur_type != 0) {
+        return vtx_index_add(b, cur_start, size, (uint8_t)cur_type);
+    }
+    return VTX_OK;
+}
+
+/**
+ * @brief 映射并校验旁路文件
+ */
+static int vtx_index_map_sidecar(vtx_media_index_t* index, const char* idx_path,
+                                 const struct stat* st) {
+    int fd = open(idx_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return VTX_ERR_NOT_FOUND;
+    }
+
+    struct stat ist;
+    if (fstat(fd, &ist) != 0 || ist.st_size < VTX_INDEX_HEADER_SIZE) {
+        close(fd);
+        return VTX_ERR_CORRUPTED;
+    }
+    size_t map_size = (size_t)ist.st_size;
+    void* map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return VTX_ERR_IO_FAILED;
+    }
+
+    const uint8_t* h = (const uint8_t*)map;
+    uint32_t count = vtx_index_get32(h + VTX_INDEX_OFF_ENTRIES);
+    uint32_t key_count = vtx_index_get32(h + VTX_INDEX_OFF_KEYS);
+    bool valid =
+        memcmp(h, VTX_INDEX_MAGIC, 8) == 0 &&
+        vtx_index_get32(h + VTX_INDEX_OFF_VERSION) == VTX_INDEX_VERSION &&
+        vtx_index_get64(h + VTX_INDEX_OFF_SIZE) == (uint64_t)st->st_size &&
+        vtx_index_get64(h + VTX_INDEX_OFF_MTIME) == (uint64_t)st->st_mtime &&
+        map_size == VTX_INDEX_HEADER_SIZE +
+                    (uint64_t)count * sizeof(vtx_media_entry_t) +
+                    (uint64_t)key_count * sizeof(vtx_media_key_t);
+    if (!valid) {
+        munmap(map, map_size);
+        return VTX_ERR_CORRUPTED;
+    }
+
+    const vtx_media_entry_t* entries =
+        (const vtx_media_entry_t*)(h + VTX_INDEX_HEADER_SIZE);
+    const vtx_media_key_t* keys = (const vtx_media_key_t*)(entries + count);
+
+    /* 映射内容直接用于发送，越界项视为损坏（offset + size可能回绕，先比较size） */
+    uint64_t media_size = (uint64_t)st->st_size;
+    for (uint32_t i = 0; i < count; i++) {
+        if (entries[i].size > VTX_MAX_FRAME_SIZE ||
+            entries[i].size > media_size ||
+            entries[i].offset > media_size - entries[i].size) {
+            munmap(map, map_size);
+            return VTX_ERR_CORRUPTED;
+        }
+    }
+    for (uint32_t i = 0; i < key_count; i++) {
+        if (keys[i].entry >= count) {
+            munmap(map, map_size);
+            return VTX_ERR_CORRUPTED;
+        }
+    }
+
+    index->entries = entries;
+    index->count = count;
+    index->keys = keys;
+    index->key_count = key_count;
+    index->pictures = vtx_index_get32(h + VTX_INDEX_OFF_PICTURES);
+    index->dropped = vtx_index_get32(h + VTX_INDEX_OFF_DROPPED);
+    index->map = map;
+    index->map_size = map_size;
+    return VTX_OK;
+}
+
+/**
+ * @brief 写入旁路文件（临时文件 + rename）
+ */
+static int vtx_index_write_sidecar(const vtx_index_builder_t* b, const char* idx_path,
+                                   const struct stat* st, bool hevc) {
+    char tmp_path[VTX_INDEX_PATH_MAX + 32];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", idx_path, (long)getpid());
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return VTX_ERR_FILE_OPEN;
+    }
+
+    uint8_t header[VTX_INDEX_HEADER_SIZE] = {0};
+    memcpy(header, VTX_INDEX_MAGIC, 8);
+    vtx_index_put32(header + VTX_INDEX_OFF_VERSION, VTX_INDEX_VERSION);
+    vtx_index_put32(header + VTX_INDEX_OFF_FLAGS, hevc ? VTX_INDEX_FLAG_HEVC : 0);
+    vtx_index_put64(header + VTX_INDEX_OFF_SIZE, (uint64_t)st->st_size);
+    vtx_index_put64(header + VTX_INDEX_OFF_MTIME, (uint64_t)st->st_mtime);
+    vtx_index_put32(header + VTX_INDEX_OFF_ENTRIES, b->count);
+    vtx_index_put32(header + VTX_INDEX_OFF_KEYS, b->key_count);
+    vtx_index_put32(header + VTX_INDEX_OFF_PICTURES, b->pictures);
+    vtx_index_put32(header + VTX_INDEX_OFF_DROPPED, b->dropped);
+
+    struct iovec iov[3] = {
+        { header, sizeof(header) },
+        { b->entries, b->count * sizeof(vtx_media_entry_t) },
+        { b->keys, b->key_count * sizeof(vtx_media_key_t) },
+    };
+    size_t total = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+    ssize_t n = writev(fd, iov, 3);
+    close(fd);
+
+    if (n != (ssize_t)total || rename(tmp_path, idx_path) != 0) {
+        unlink(tmp_path);
+        return VTX_ERR_FILE_WRITE;
+    }
+    return VTX_OK;
+}
+
+/**
+ * @brief 提示超大帧未进入索引（每次加载都提示，包括从旁路文件加载）
+ */
+static void vtx_index_warn_dropped(const vtx_media_index_t* index, const char* path) {
+    if (index->dropped > 0) {
+        vtx_log_warn("%s: %u frames larger than %u bytes are not indexed and will not be sent",
+                    path, index->dropped, (unsigned)VTX_MAX_FRAME_SIZE);
+    }
+}
+
+/* ========== 公共函数 ========== */
+
+int vtx_media_index_load(vtx_media_index_t* index, const char* path,
+                         const uint8_t* data, const struct stat* st) {
+    memset(index, 0, sizeof(*index));
+
+    char idx_path[VTX_INDEX_PATH_MAX];
+    snprintf(idx_path, sizeof(idx_path), "%s" VTX_INDEX_SUFFIX, path);
+
+    if (VTX_INDEX_SIDECAR && vtx_index_map_sidecar(index, idx_path, st) == VTX_OK) {
+        vtx_log_info("Media index loaded: %s frames=%u keyframes=%u",
+                    idx_path, index->count, index->key_count);
+        vtx_index_warn_dropped(index, path);
+        return index->count > 0 ? VTX_OK : VTX_ERR_FORMAT_INVALID;
+    }
+
+    bool hevc = vtx_index_is_hevc(path);
+    vtx_index_builder_t b = { .path = path };
+    int ret = vtx_index_scan(&b, data, (size_t)st->st_size, hevc);
+    if (ret != VTX_OK || b.count == 0) {
+        vtx_free(b.entries);
+        vtx_free(b.keys);
+        return ret != VTX_OK ? ret : VTX_ERR_FORMAT_INVALID;
+    }
+
+    if (VTX_INDEX_SIDECAR) {
+        if (vtx_index_write_sidecar(&b, idx_path, st, hevc) == VTX_OK) {
+            vtx_log_info("Media index written: %s", idx_path);
+        } else {
+            vtx_log_debug("Media index not cached (%s): %s", idx_path, strerror(errno));
+        }
+    }
+
+    index->entries = b.entries;
+    index->count = b.count;
+    index->keys = b.keys;
+    index->key_count = b.key_count;
+    index->pictures = b.pictures;
+    index->dropped = b.dropped;
+    vtx_log_info("Media file indexed: %s frames=%u keyframes=%u",
+                path, index->count, index->key_count);
+    vtx_index_warn_dropped(index, path);
+    return VTX_OK;
+}
+
+void vtx_media_index_free(vtx_media_index_t* index) {
+    if (!index) {
+        return;
+    }
+
+    if (index->map) {
+        munmap(index->map, index->map_size);
+    } else {
+        vtx_free((void*)index->entries);
+        vtx_free((void*)index->keys);
+    }
+    memset(index, 0, sizeof(*index));
+}
+
+int64_t vtx_media_index_seek_offset(const vtx_media_index_t* index, uint64_t offset) {
+    if (index->key_count == 0) {
+        return -1;
+    }
+
+    /* 最后一个起始偏移不大于offset的关键帧 */
+    uint32_t lo = 0;
+    uint32_t hi = index->key_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->entries[index->keys[mid].entry].offset <= offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return index->keys[lo > 0 ? lo - 1 : 0].entry;
+}
+
+int64_t vtx_media_index_seek_picture(const vtx_media_index_t* index, uint32_t picture) {
+    if (index->key_count == 0) {
+        return -1;
+    }
+
+    uint32_t lo = 0;
+    uint32_t hi = index->key_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->keys[mid].picture <= picture) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return index->keys[lo > 0 ? lo - 1 : 0].entry;
+}
+
+uint32_t vtx_media_index_lower_bound(const vtx_media_index_t* index, uint64_t offset) {
+    uint32_t lo = 0;
+    uint32_t hi = index->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->entries[mid].offset < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
@@ -70,14 +70,17 @@ static const uint16_t crc16_table[256] = {
     0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
 };
 
-uint16_t vtx_crc16(const uint8_t* data, size_t size) {
-    uint16_t crc = 0xFFFF;
+uint16_t vtx_crc16_update(uint16_t crc, const uint8_t* data, size_t size) {
     for (size_t i = 0; i < size; i++) {
         crc = (crc << 8) ^ crc16_table[((crc >> 8) ^ data[i]) & 0xFF];
     }
     return crc;
 }
 
+uint16_t vtx_crc16(const uint8_t* data, size_t size) {
+    return vtx_crc16_update(VTX_CRC16_INIT, data, size);
+}
+
 bool vtx_crc16_verify(const uint8_t* data, size_t size, uint16_t expected_crc) {
     uint16_t actual_crc = vtx_crc16(data, size);
     return actual_crc == expected_crc;
@@ -147,9 +150,28 @@ uint16_t vtx_packet_calc_crc(uint8_t* buf,
 
     /* 继续计算payload的CRC */
     if (payload && payload_size > 0) {
-        for (size_t i = 0; i < payload_size; i++) {
-            crc = (crc << 8) ^ crc16_table[((crc >> 8) ^ payload[i]) & 0xFF];
-        }
+        crc = vtx_crc16_update(crc, payload, payload_size);
+    }
+
+    /* 更新buf中的CRC字段（网络字节序） */
+    *(uint16_t*)(buf + VTX_CRC_OFFSET) = htons(crc);
+
+    return crc;
+}
+
+uint16_t vtx_packet_calc_crc_iov(uint8_t* buf,
+                                  const struct iovec* iov,
+                                  int iovcnt)
+{
+    if (!buf) {
+        return 0;
+    }
+
+    /* 计算header（CRC字段除外）的CRC，再依次累加各数据段 */
+    uint16_t crc = vtx_crc16(buf, VTX_CRC_OFFSET);
+    for (int i = 0; iov && i < iovcnt; i++) {
+        crc = vtx_crc16_update(crc, (const uint8_t*)iov[i].iov_base,
+                               iov[i].iov_len);
     }
 
     /* 更新buf中的CRC字段（网络字节序） */
@@ -174,10 +196,7 @@ bool vtx_packet_verify(const uint8_t* buf,
 
     /* 继续计算payload的CRC */
     if (payload && payload_size > 0) {
-        for (size_t i = 0; i < payload_size; i++) {
-            calculated_crc = (calculated_crc << 8) ^
-                            crc16_table[((calculated_crc >> 8) ^ payload[i]) & 0xFF];
-        }
+        calculated_crc = vtx_crc16_update(calculated_crc, payload, payload_size);
     }
 
     /* 比较CRC */
@@ -190,6 +209,52 @@ bool vtx_packet_verify(const uint8_t* buf,
     return true;
 }
 
+/* ========== 控制载荷 ========== */
+
+int vtx_packet_pack_limits(const vtx_limits_t* limits, uint8_t* buf, size_t size) {
+    if (!limits || !buf || size < VTX_LIMITS_WIRE_SIZE) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    uint32_t v32;
+    uint16_t v16;
+
+    v32 = htonl(limits->max_bitrate_kbps);
+    memcpy(buf + 0, &v32, 4);
+    v32 = htonl(limits->max_frame_size);
+    memcpy(buf + 4, &v32, 4);
+    v16 = htons(limits->max_fps);
+    memcpy(buf + 8, &v16, 2);
+    v16 = htons(limits->max_width);
+    memcpy(buf + 10, &v16, 2);
+    v16 = htons(limits->max_height);
+    memcpy(buf + 12, &v16, 2);
+
+    return VTX_OK;
+}
+
+int vtx_packet_unpack_limits(const uint8_t* buf, size_t size, vtx_limits_t* limits) {
+    if (!buf || !limits || size < VTX_LIMITS_WIRE_SIZE) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    uint32_t v32;
+    uint16_t v16;
+
+    memcpy(&v32, buf + 0, 4);
+    limits->max_bitrate_kbps = ntohl(v32);
+    memcpy(&v32, buf + 4, 4);
+    limits->max_frame_size = ntohl(v32);
+    memcpy(&v16, buf + 8, 2);
+    limits->max_fps = ntohs(v16);
+    memcpy(&v16, buf + 10, 2);
+    limits->max_width = ntohs(v16);
+    memcpy(&v16, buf + 12, 2);
+    limits->max_height = ntohs(v16);
+
+    return VTX_OK;
+}
+
 /* ========== 数据包验证 ========== */
 
 bool vtx_packet_validate_header(const vtx_packet_header_t* header) {
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_path.c
+ * @brief VTX Multipath Scheduling Implementation
+ */
+
+#include "vtx_path.h"
+#include <string.h>
+#include <unistd.h>
+
+/* ========== 辅助函数 ========== */
+
+/**
+ * @brief 路径权重：(1 - 丢包率) / RTT，至少为1
+ */
+static int32_t vtx_path_weight(const vtx_path_t* path) {
+    uint32_t rtt = path->srtt_ms > 0 ? path->srtt_ms : VTX_PATH_DEFAULT_RTT_MS;
+    int32_t weight = (int32_t)((1000 - path->loss_permille) * 100 / (rtt + 1));
+    return weight > 0 ? weight : 1;
+}
+
+/* ========== 公共函数 ========== */
+
+void vtx_path_set_init(vtx_path_set_t* set, int primary_fd) {
+    memset(set, 0, sizeof(*set));
+    set->paths[0].sockfd = primary_fd;
+    set->count = 1;
+    vtx_spinlock_init(&set->lock);
+}
+
+void vtx_path_set_destroy(vtx_path_set_t* set) {
+    for (uint8_t i = 1; i < set->count; i++) {
+        if (set->paths[i].sockfd >= 0) {
+            close(set->paths[i].sockfd);
+        }
+    }
+    set->count = 1;
+    vtx_spinlock_destroy(&set->lock);
+}
+
+int vtx_path_set_add(vtx_path_set_t* set, int sockfd) {
+    vtx_spinlock_lock(&set->lock);
+    if (set->count >= VTX_MAX_PATHS) {
+        vtx_spinlock_unlock(&set->lock);
+        return -1;
+    }
+
+    int idx = set->count;
+    memset(&set->paths[idx], 0, sizeof(set->paths[idx]));
+    set->paths[idx].sockfd = sockfd;
+    set->count++;
+    vtx_spinlock_unlock(&set->lock);
+    return idx;
+}
+
+uint8_t vtx_path_find(const vtx_path_set_t* set, int sockfd) {
+    /* 路径只在listen时添加，之后只读 */
+    for (uint8_t i = 0; i < set->count; i++) {
+        if (set->paths[i].sockfd == sockfd) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+uint8_t vtx_path_select(vtx_path_set_t* set) {
+    vtx_spinlock_lock(&set->lock);
+
+    /* 平滑加权轮询：当前权重加有效权重，选最大者，再减去总权重 */
+    int32_t total = 0;
+    uint8_t best = 0;
+    for (uint8_t i = 0; i < set->count; i++) {
+        vtx_path_t* path = &set->paths[i];
+        int32_t weight = vtx_path_weight(path);
+        path->current_weight += weight;
+        total += weight;
+        if (path->current_weight > set->paths[best].current_weight) {
+            best = i;
+        }
+    }
+    set->paths[best].current_weight -= total;
+    set->paths[best].sent_packets++;
+
+    vtx_spinlock_unlock(&set->lock);
+    return best;
+}
+
+uint8_t vtx_path_best(vtx_path_set_t* set) {
+    vtx_spinlock_lock(&set->lock);
+
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < set->count; i++) {
+        if (vtx_path_weight(&set->paths[i]) > vtx_path_weight(&set->paths[best])) {
+            best = i;
+        }
+    }
+    set->paths[best].sent_packets++;
+
+    vtx_spinlock_unlock(&set->lock);
+    return best;
+}
+
+void vtx_path_note_sent(vtx_path_set_t* set, uint8_t path) {
+    vtx_spinlock_lock(&set->lock);
+    if (path < set->count) {
+        set->paths[path].sent_packets++;
+    }
+    vtx_spinlock_unlock(&set->lock);
+}
+
+void vtx_path_on_ack(vtx_path_set_t* set, uint8_t path, uint32_t rtt_ms) {
+    vtx_spinlock_lock(&set->lock);
+    if (path < set->count) {
+        vtx_path_t* p = &set->paths[path];
+        p->acked_packets++;
+        p->loss_permille -= p->loss_permille / 8;
+
+        if (rtt_ms != VTX_PATH_NO_RTT) {
+            /* RFC 6298风格的EWMA（alpha = 1/8） */
+            if (p->srtt_ms == 0) {
+                p->srtt_ms = rtt_ms > 0 ? rtt_ms : 1;
+            } else {
+                p->srtt_ms = (p->srtt_ms * 7 + rtt_ms) / 8;
+                if (p->srtt_ms == 0) {
+                    p->srtt_ms = 1;
+                }
+            }
+        }
+    }
+    vtx_spinlock_unlock(&set->lock);
+}
+
+void vtx_path_on_loss(vtx_path_set_t* set, uint8_t path) {
+    vtx_spinlock_lock(&set->lock);
+    if (path < set->count) {
+        vtx_path_t* p = &set->paths[path];
+        p->lost_packets++;
+        p->loss_permille = p->loss_permille - p->loss_permille / 8 + 1000 / 8;
+    }
+    vtx_spinlock_unlock(&set->lock);
+}
+
+uint8_t vtx_path_get_stats(vtx_path_set_t* set, vtx_path_stats_t* stats) {
+    vtx_spinlock_lock(&set->lock);
+    uint8_t count = set->count;
+    for (uint8_t i = 0; i < count; i++) {
+        const vtx_path_t* p = &set->paths[i];
+        stats[i].srtt_ms = p->srtt_ms;
+        stats[i].loss_permille = p->loss_permille;
+        stats[i].sent_packets = p->sent_packets;
+        stats[i].acked_packets = p->acked_packets;
+        stats[i].lost_packets = p->lost_packets;
+    }
+    vtx_spinlock_unlock(&set->lock);
+    return count;
+}
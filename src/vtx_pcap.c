@@ -0,0 +1,616 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_pcap.c
+ * @brief VTX Packet Capture Implementation
+ */
+
+#include "vtx_pcap.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include "vtx_mem.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+/* pcapng块类型 */
+#define VTX_PCAPNG_SHB          0x0A0D0D0Au
+#define VTX_PCAPNG_IDB          0x00000001u
+#define VTX_PCAPNG_SPB          0x00000003u
+#define VTX_PCAPNG_EPB          0x00000006u
+#define VTX_PCAPNG_BOM          0x1A2B3C4Du
+
+/* pcapng选项 */
+#define VTX_PCAPNG_OPT_END      0
+#define VTX_PCAPNG_OPT_TSRESOL  9       /* if_tsresol */
+#define VTX_PCAPNG_OPT_FLAGS    2       /* epb_flags */
+
+/* 经典pcap */
+#define VTX_PCAP_MAGIC_US       0xA1B2C3D4u
+#define VTX_PCAP_MAGIC_NS       0xA1B23C4Du
+
+/* 链路类型 */
+#define VTX_LINKTYPE_NULL       0
+#define VTX_LINKTYPE_ETHERNET   1
+#define VTX_LINKTYPE_RAW        101
+#define VTX_LINKTYPE_LOOP       108
+#define VTX_LINKTYPE_LINUX_SLL  113
+#define VTX_LINKTYPE_IPV4       228
+#define VTX_LINKTYPE_LINUX_SLL2 276
+
+#define VTX_PCAP_IP_HDR_SIZE    20
+#define VTX_PCAP_UDP_HDR_SIZE   8
+#define VTX_PCAP_MAX_SOCKETS    (VTX_MAX_PATHS + 1)
+#define VTX_PCAP_MAX_IFACES     16
+#define VTX_PCAP_MAX_BLOCK      (16 * 1024 * 1024)
+
+/**
+ * @brief 抓包文件
+ */
+struct vtx_pcap {
+    pthread_mutex_t     lock;
+    FILE*               fp;
+    bool                failed;         /* 写失败后停止抓包 */
+    struct {
+        int             fd;
+        struct sockaddr_in addr;
+    } local[VTX_PCAP_MAX_SOCKETS];      /* 本端地址缓存 */
+    int                 local_count;
+};
+
+/**
+ * @brief 抓包读取器
+ */
+struct vtx_pcap_reader {
+    FILE*               fp;
+    bool                ng;             /* pcapng（否则为经典pcap） */
+    bool                swap;           /* 文件字节序与主机不同 */
+    uint32_t            linktype;       /* 经典pcap的链路类型 */
+    uint64_t            ts_div;         /* 经典pcap：小数部分换算为微秒的除数 */
+    struct {
+        uint32_t        linktype;
+        uint64_t        ts_per_sec;     /* 时间戳单位（每秒多少个） */
+    } ifaces[VTX_PCAP_MAX_IFACES];      /* pcapng接口 */
+    uint32_t            iface_count;
+    uint8_t*            buf;
+    size_t              buf_size;
+};
+
+/* ========== 写入 ========== */
+
+static uint64_t vtx_pcap_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief IPv4头校验和
+ */
+static uint16_t vtx_pcap_ip_checksum(const uint8_t* hdr) {
+    uint32_t sum = 0;
+    for (int i = 0; i < VTX_PCAP_IP_HDR_SIZE; i += 2) {
+        sum += ((uint32_t)hdr[i] << 8) | hdr[i + 1];
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+/**
+ * @brief 取得socket的本端地址（缓存）
+ *
+ * 缓存按socket而非对端，多个对端路由源地址不同时以第一个为准
+ */
+static struct sockaddr_in vtx_pcap_local_addr(vtx_pcap_t* pcap, int sockfd,
+                                              const struct sockaddr_in* peer) {
+    for (int i = 0; i < pcap->local_count; i++) {
+        if (pcap->local[i].fd == sockfd) {
+            return pcap->local[i].addr;
+        }
+    }
+
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    if (getsockname(sockfd, (struct sockaddr*)&addr, &len) != 0) {
+        return addr;  /* 未绑定：0.0.0.0:0，不缓存 */
+    }
+    /* 绑定在INADDR_ANY：按到对端的路由取源地址（connect不发包） */
+    if (addr.sin_addr.s_addr == htonl(INADDR_ANY)) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in route;
+        socklen_t route_len = sizeof(route);
+        if (fd >= 0 && connect(fd, (const struct sockaddr*)peer, sizeof(*peer)) == 0 &&
+            getsockname(fd, (struct sockaddr*)&route, &route_len) == 0) {
+            addr.sin_addr = route.sin_addr;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    /* 只缓存已分配端口的地址（接收端第一次发包前端口尚未分配） */
+    if (addr.sin_port != 0 && pcap->local_count < VTX_PCAP_MAX_SOCKETS) {
+        pcap->local[pcap->local_count].fd = sockfd;
+        pcap->local[pcap->local_count].addr = addr;
+        pcap->local_count++;
+    }
+    return addr;
+}
+
+static bool vtx_pcap_put(vtx_pcap_t* pcap, const void* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, pcap->fp) != size) {
+        if (!pcap->failed) {
+            vtx_log_error("Capture write failed: %s, capture stopped", strerror(errno));
+        }
+        pcap->failed = true;
+        return false;
+    }
+    return true;
+}
+
+vtx_pcap_t* vtx_pcap_open(const char* path) {
+    if (!path) {
+        return NULL;
+    }
+
+    vtx_pcap_t* pcap = (vtx_pcap_t*)vtx_calloc(1, sizeof(vtx_pcap_t));
+    if (!pcap) {
+        return NULL;
+    }
+
+    pcap->fp = fopen(path, "wb");
+    if (!pcap->fp) {
+        vtx_log_error("Failed to create capture file %s: %s", path, strerror(errno));
+        vtx_free(pcap);
+        return NULL;
+    }
+    pthread_mutex_init(&pcap->lock, NULL);
+
+    /* 段头块（主机字节序，BOM标识） */
+    uint32_t shb[7] = {
+        VTX_PCAPNG_SHB, sizeof(shb), VTX_PCAPNG_BOM,
+        1,                      /* major=1, minor=0（小端主机上为低16位） */
+        0xFFFFFFFFu, 0xFFFFFFFFu, /* section length未知 */
+        sizeof(shb),
+    };
+    uint16_t version[2] = { 1, 0 };
+    memcpy(&shb[3], version, sizeof(version));
+
+    /* 接口描述块：裸IP，不截断，默认微秒时间戳 */
+    uint32_t idb[5] = { VTX_PCAPNG_IDB, sizeof(idb), 0, 0, sizeof(idb) };
+    uint16_t link[2] = { VTX_LINKTYPE_RAW, 0 };
+    memcpy(&idb[2], link, sizeof(link));
+
+    if (!vtx_pcap_put(pcap, shb, sizeof(shb)) || !vtx_pcap_put(pcap, idb, sizeof(idb))) {
+        vtx_pcap_close(pcap);
+        return NULL;
+    }
+
+    vtx_log_info("Capturing packets to %s", path);
+    return pcap;
+}
+
+void vtx_pcap_close(vtx_pcap_t* pcap) {
+    if (!pcap) {
+        return;
+    }
+
+    fclose(pcap->fp);
+    pthread_mutex_destroy(&pcap->lock);
+    vtx_free(pcap);
+}
+
+void vtx_pcap_write(vtx_pcap_t* pcap, int sockfd, int dir,
+                    const struct sockaddr_in* peer,
+                    const struct iovec* iov, int iovcnt) {
+    if (!pcap || !peer) {
+        return;
+    }
+
+    uint64_t ts = vtx_pcap_now_us();
+    size_t payload = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        payload += iov[i].iov_len;
+    }
+    size_t pkt_len = VTX_PCAP_IP_HDR_SIZE + VTX_PCAP_UDP_HDR_SIZE + payload;
+    size_t pad = (4 - (pkt_len & 3)) & 3;
+
+    pthread_mutex_lock(&pcap->lock);
+    if (pcap->failed) {
+        pthread_mutex_unlock(&pcap->lock);
+        return;
+    }
+
+    struct sockaddr_in local = vtx_pcap_local_addr(pcap, sockfd, peer);
+    const struct sockaddr_in* src = dir == VTX_PCAP_DIR_OUT ? &local : peer;
+    const struct sockaddr_in* dst = dir == VTX_PCAP_DIR_OUT ? peer : &local;
+
+    /* IPv4 + UDP头（网络字节序，UDP校验和为0表示未计算） */
+    uint8_t hdr[VTX_PCAP_IP_HDR_SIZE + VTX_PCAP_UDP_HDR_SIZE] = {0};
+    hdr[0] = 0x45;
+    hdr[2] = (uint8_t)(pkt_len >> 8);
+    hdr[3] = (uint8_t)pkt_len;
+    hdr[6] = 0x40;  /* DF */
+    hdr[8] = 64;
+    hdr[9] = IPPROTO_UDP;
+    memcpy(hdr + 12, &src->sin_addr, 4);
+    memcpy(hdr + 16, &dst->sin_addr, 4);
+    uint16_t csum = vtx_pcap_ip_checksum(hdr);
+    hdr[10] = (uint8_t)(csum >> 8);
+    hdr[11] = (uint8_t)csum;
+
+    size_t udp_len = VTX_PCAP_UDP_HDR_SIZE + payload;
+    memcpy(hdr + 20, &src->sin_port, 2);
+    memcpy(hdr + 22, &dst->sin_port, 2);
+    hdr[24] = (uint8_t)(udp_len >> 8);
+    hdr[25] = (uint8_t)udp_len;
+
+    /* 增强包块：头（7个字） + 数据 + epb_flags + 选项结束 + 总长度 */
+    uint32_t block_len = (uint32_t)(28 + pkt_len + pad + 12 + 4);
+    uint32_t epb[7] = {
+        VTX_PCAPNG_EPB, block_len, 0,
+        (uint32_t)(ts >> 32), (uint32_t)ts,
+        (uint32_t)pkt_len, (uint32_t)pkt_len,
+    };
+    uint16_t opt[2] = { VTX_PCAPNG_OPT_FLAGS, 4 };
+    uint32_t tail[3] = { (uint32_t)dir, VTX_PCAPNG_OPT_END, block_len };
+    static const uint8_t zeros[3] = {0};
+
+    if (vtx_pcap_put(pcap, epb, sizeof(epb)) && vtx_pcap_put(pcap, hdr, sizeof(hdr))) {
+        bool ok = true;
+        for (int i = 0; i < iovcnt && ok; i++) {
+            ok = vtx_pcap_put(pcap, iov[i].iov_base, iov[i].iov_len);
+        }
+        ok = ok && vtx_pcap_put(pcap, zeros, pad) && vtx_pcap_put(pcap, opt, sizeof(opt));
+        if (ok) {
+            vtx_pcap_put(pcap, tail, sizeof(tail));
+        }
+    }
+
+    pthread_mutex_unlock(&pcap->lock);
+}
+
+/* ========== 读取 ========== */
+
+static uint16_t vtx_pcap_rd16(const vtx_pcap_reader_t* r, const uint8_t* p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return r->swap ? __builtin_bswap16(v) : v;
+}
+
+static uint32_t vtx_pcap_rd32(const vtx_pcap_reader_t* r, const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return r->swap ? __builtin_bswap32(v) : v;
+}
+
+static bool vtx_pcap_read(vtx_pcap_reader_t* r, size_t size) {
+    if (size > r->buf_size) {
+        uint8_t* buf = (uint8_t*)vtx_realloc(r->buf, size);
+        if (!buf) {
+            return false;
+        }
+        r->buf = buf;
+        r->buf_size = size;
+    }
+    return fread(r->buf, 1, size, r->fp) == size;
+}
+
+/**
+ * @brief 解析链路层到IPv4 UDP
+ *
+ * @return true表示是未分片的IPv4 UDP数据报
+ */
+static bool vtx_pcap_parse(uint32_t linktype, const uint8_t* p, size_t len,
+                           vtx_pcap_packet_t* pkt) {
+    size_t off = 0;
+    switch (linktype) {
+    case VTX_LINKTYPE_ETHERNET: {
+        if (len < 14) {
+            return false;
+        }
+        uint16_t type = (uint16_t)((p[12] << 8) | p[13]);
+        off = 14;
+        while (type == 0x8100 && len >= off + 4) {  /* VLAN */
+            type = (uint16_t)((p[off + 2] << 8) | p[off + 3]);
+            off += 4;
+        }
+        if (type != 0x0800) {
+            return false;
+        }
+        break;
+    }
+    case VTX_LINKTYPE_LINUX_SLL:
+        if (len < 16 || p[14] != 0x08 || p[15] != 0x00) {
+            return false;
+        }
+        off = 16;
+        break;
+    case VTX_LINKTYPE_LINUX_SLL2:
+        if (len < 20 || p[0] != 0x08 || p[1] != 0x00) {
+            return false;
+        }
+        off = 20;
+        break;
+    case VTX_LINKTYPE_NULL:
+    case VTX_LINKTYPE_LOOP:
+        /* 4字节地址族（抓包主机字节序），AF_INET为2 */
+        if (len < 4 || !((p[0] == 2 && p[3] == 0) || (p[0] == 0 && p[3] == 2))) {
+            return false;
+        }
+        off = 4;
+        break;
+    case VTX_LINKTYPE_RAW:
+    case VTX_LINKTYPE_IPV4:
+        break;
+    default:
+        return false;
+    }
+
+    const uint8_t* ip = p + off;
+    len -= off;
+    if (len < VTX_PCAP_IP_HDR_SIZE || (ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP) {
+        return false;
+    }
+    size_t ihl = (size_t)(ip[0] & 0x0F) * 4;
+    size_t total = (size_t)((ip[2] << 8) | ip[3]);
+    uint16_t frag = (uint16_t)(((ip[6] << 8) | ip[7]) & 0x3FFF);  /* MF + 偏移 */
+    if (ihl < VTX_PCAP_IP_HDR_SIZE || frag != 0 || total > len ||
+        total < ihl + VTX_PCAP_UDP_HDR_SIZE) {
+        return false;
+    }
+
+    const uint8_t* udp = ip + ihl;
+    size_t udp_len = (size_t)((udp[4] << 8) | udp[5]);
+    if (udp_len < VTX_PCAP_UDP_HDR_SIZE || udp_len > total - ihl) {
+        return false;
+    }
+
+    memset(&pkt->src, 0, sizeof(pkt->src));
+    memset(&pkt->dst, 0, sizeof(pkt->dst));
+    pkt->src.sin_family = AF_INET;
+    pkt->dst.sin_family = AF_INET;
+    memcpy(&pkt->src.sin_addr, ip + 12, 4);
+    memcpy(&pkt->dst.sin_addr, ip + 16, 4);
+    memcpy(&pkt->src.sin_port, udp, 2);
+    memcpy(&pkt->dst.sin_port, udp + 2, 2);
+    pkt->data = udp + VTX_PCAP_UDP_HDR_SIZE;
+    pkt->size = udp_len - VTX_PCAP_UDP_HDR_SIZE;
+    return true;
+}
+
+vtx_pcap_reader_t* vtx_pcap_reader_open(const char* path) {
+    FILE* fp = path ? fopen(path, "rb") : NULL;
+    if (!fp) {
+        vtx_log_error("Failed to open capture %s: %s",
+                     path ? path : "(null)", strerror(errno));
+        return NULL;
+    }
+
+    vtx_pcap_reader_t* r = (vtx_pcap_reader_t*)vtx_calloc(1, sizeof(vtx_pcap_reader_t));
+    if (!r) {
+        fclose(fp);
+        return NULL;
+    }
+    r->fp = fp;
+
+    uint8_t hdr[24];
+    if (fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr)) {
+        vtx_pcap_reader_close(r);
+        return NULL;
+    }
+
+    uint32_t magic;
+    memcpy(&magic, hdr, sizeof(magic));
+    if (magic == VTX_PCAPNG_SHB) {
+        /* 第一个段头在next()中按普通块处理 */
+        r->ng = true;
+        rewind(fp);
+        return r;
+    }
+
+    if (magic == VTX_PCAP_MAGIC_US || magic == VTX_PCAP_MAGIC_NS) {
+        r->swap = false;
+    } else if (__builtin_bswap32(magic) == VTX_PCAP_MAGIC_US ||
+               __builtin_bswap32(magic) == VTX_PCAP_MAGIC_NS) {
+        r->swap = true;
+        magic = __builtin_bswap32(magic);
+    } else {
+        vtx_log_error("Not a pcap/pcapng file: %s", path);
+        vtx_pcap_reader_close(r);
+        return NULL;
+    }
+    r->ts_div = magic == VTX_PCAP_MAGIC_NS ? 1000 : 1;
+    r->linktype = vtx_pcap_rd32(r, hdr + 20) & 0x0FFFFFFF;
+    return r;
+}
+
+/**
+ * @brief 经典pcap：读取下一条记录
+ */
+static int vtx_pcap_next_classic(vtx_pcap_reader_t* r, vtx_pcap_packet_t* pkt) {
+    for (;;) {
+        uint8_t rec[16];
+        size_t n = fread(rec, 1, sizeof(rec), r->fp);
+        if (n == 0) {
+            return VTX_ERR_FILE_EOF;
+        }
+        if (n != sizeof(rec)) {
+            return VTX_ERR_FORMAT_INVALID;
+        }
+        uint32_t caplen = vtx_pcap_rd32(r, rec + 8);
+        if (caplen > VTX_PCAP_MAX_BLOCK || !vtx_pcap_read(r, caplen)) {
+            return VTX_ERR_FORMAT_INVALID;
+        }
+
+        if (vtx_pcap_parse(r->linktype, r->buf, caplen, pkt)) {
+            pkt->ts_us = (uint64_t)vtx_pcap_rd32(r, rec) * 1000000ULL +
+                         vtx_pcap_rd32(r, rec + 4) / r->ts_div;
+            pkt->dir = VTX_PCAP_DIR_UNKNOWN;
+            return VTX_OK;
+        }
+    }
+}
+
+/**
+ * @brief pcapng接口描述块：链路类型和时间戳精度
+ */
+static void vtx_pcap_read_idb(vtx_pcap_reader_t* r, const uint8_t* body, size_t len) {
+    if (r->iface_count >= VTX_PCAP_MAX_IFACES || len < 8) {
+        return;
+    }
+    uint32_t idx = r->iface_count++;
+    r->ifaces[idx].linktype = vtx_pcap_rd16(r, body);
+    r->ifaces[idx].ts_per_sec = 1000000;
+
+    size_t off = 8;
+    while (off + 4 <= len) {
+        uint16_t code = vtx_pcap_rd16(r, body + off);
+        uint16_t olen = vtx_pcap_rd16(r, body + off + 2);
+        if (code == VTX_PCAPNG_OPT_END || off + 4 + olen > len) {
+            break;
+        }
+        if (code == VTX_PCAPNG_OPT_TSRESOL && olen >= 1) {
+            uint8_t v = body[off + 4];
+            uint64_t per_sec = 1;
+            for (uint8_t i = 0; i < (v & 0x7F) && per_sec < (1ULL << 60) / 10; i++) {
+                per_sec *= (v & 0x80) ? 2 : 10;
+            }
+            r->ifaces[idx].ts_per_sec = per_sec;
+        }
+        off += 4 + ((olen + 3u) & ~3u);
+    }
+}
+
+/**
+ * @brief pcapng：读取下一个块
+ */
+static int vtx_pcap_next_ng(vtx_pcap_reader_t* r, vtx_pcap_packet_t* pkt) {
+    for (;;) {
+        uint8_t bh[8];
+        size_t n = fread(bh, 1, sizeof(bh), r->fp);
+        if (n == 0) {
+            return VTX_ERR_FILE_EOF;
+        }
+        if (n != sizeof(bh)) {
+            return VTX_ERR_FORMAT_INVALID;
+        }
+
+        uint32_t type;
+        memcpy(&type, bh, sizeof(type));
+        if (type == VTX_PCAPNG_SHB) {
+            /* 新的段：按BOM确定字节序，接口编号重新开始 */
+            uint32_t bom;
+            if (fread(&bom, 1, sizeof(bom), r->fp) != sizeof(bom)) {
+                return VTX_ERR_FORMAT_INVALID;
+            }
+            if (bom == VTX_PCAPNG_BOM) {
+                r->swap = false;
+            } else if (__builtin_bswap32(bom) == VTX_PCAPNG_BOM) {
+                r->swap = true;
+            } else {
+                return VTX_ERR_FORMAT_INVALID;
+            }
+            r->iface_count = 0;
+            uint32_t len = vtx_pcap_rd32(r, bh + 4);
+            if (len < 28 || len > VTX_PCAP_MAX_BLOCK || !vtx_pcap_read(r, len - 12)) {
+                return VTX_ERR_FORMAT_INVALID;
+            }
+            continue;
+        }
+
+        type = vtx_pcap_rd32(r, bh);
+        uint32_t len = vtx_pcap_rd32(r, bh + 4);
+        if (len < 12 || len > VTX_PCAP_MAX_BLOCK || (len & 3) ||
+            !vtx_pcap_read(r, len - 8)) {
+            return VTX_ERR_FORMAT_INVALID;
+        }
+        const uint8_t* body = r->buf;
+        size_t body_len = len - 12;  /* 去掉块头和尾部长度 */
+
+        if (type == VTX_PCAPNG_IDB) {
+            vtx_pcap_read_idb(r, body, body_len);
+            continue;
+        }
+
+        if (type == VTX_PCAPNG_EPB && body_len >= 20) {
+            uint32_t ifid = vtx_pcap_rd32(r, body);
+            uint32_t caplen = vtx_pcap_rd32(r, body + 12);
+            if (ifid >= r->iface_count || 20 + (size_t)caplen > body_len) {
+                continue;
+            }
+            if (!vtx_pcap_parse(r->ifaces[ifid].linktype, body + 20, caplen, pkt)) {
+                continue;
+            }
+
+            uint64_t ts = ((uint64_t)vtx_pcap_rd32(r, body + 4) << 32) |
+                          vtx_pcap_rd32(r, body + 8);
+            uint64_t per_sec = r->ifaces[ifid].ts_per_sec;
+            pkt->ts_us = ts / per_sec * 1000000ULL + ts % per_sec * 1000000ULL / per_sec;
+
+            /* epb_flags：低2位为方向 */
+            pkt->dir = VTX_PCAP_DIR_UNKNOWN;
+            size_t off = 20 + (((size_t)caplen + 3) & ~(size_t)3);
+            while (off + 4 <= body_len) {
+                uint16_t code = vtx_pcap_rd16(r, body + off);
+                uint16_t olen = vtx_pcap_rd16(r, body + off + 2);
+                if (code == VTX_PCAPNG_OPT_END || off + 4 + olen > body_len) {
+                    break;
+                }
+                if (code == VTX_PCAPNG_OPT_FLAGS && olen >= 4) {
+                    pkt->dir = (int)(vtx_pcap_rd32(r, body + off + 4) & 3);
+                }
+                off += 4 + ((olen + 3u) & ~3u);
+            }
+            return VTX_OK;
+        }
+
+        if (type == VTX_PCAPNG_SPB && body_len >= 4 && r->iface_count > 0) {
+            uint32_t orig = vtx_pcap_rd32(r, body);
+            size_t caplen = orig < body_len - 4 ? orig : body_len - 4;
+            if (vtx_pcap_parse(r->ifaces[0].linktype, body + 4, caplen, pkt)) {
+                pkt->ts_us = 0;  /* 简单包块没有时间戳 */
+                pkt->dir = VTX_PCAP_DIR_UNKNOWN;
+                return VTX_OK;
+            }
+        }
+        /* 其他块跳过 */
+    }
+}
+
+int vtx_pcap_reader_next(vtx_pcap_reader_t* reader, vtx_pcap_packet_t* pkt) {
+    if (!reader || !pkt) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+    return reader->ng ? vtx_pcap_next_ng(reader, pkt) : vtx_pcap_next_classic(reader, pkt);
+}
+
+void vtx_pcap_reader_close(vtx_pcap_reader_t* reader) {
+    if (!reader) {
+        return;
+    }
+
+    fclose(reader->fp);
+    vtx_free(reader->buf);
+    vtx_free(reader);
+}
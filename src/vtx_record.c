@@ -0,0 +1,359 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_record.c
+ * @brief VTX Segment Recorder Implementation
+ */
+
+#include "vtx_record.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include "vtx_mem.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <time.h>
+
+/* 段头字段偏移 */
+#define VTX_RECORD_OFF_VERSION      8
+#define VTX_RECORD_OFF_HEADER_SIZE  12
+#define VTX_RECORD_OFF_CREATED      16
+#define VTX_RECORD_OFF_DATA_END     24
+#define VTX_RECORD_OFF_INDEX        32
+#define VTX_RECORD_OFF_INDEX_COUNT  40
+#define VTX_RECORD_OFF_FRAME_COUNT  44
+
+#define VTX_RECORD_PATH_MAX         512
+#define VTX_RECORD_RETRY_MIN_MS     1000    /* 打开段失败后的首次重试间隔 */
+#define VTX_RECORD_RETRY_MAX_MS     60000   /* 重试间隔上限（每次失败加倍） */
+
+/**
+ * @brief 关键帧索引项（内存中，收尾时写入段尾）
+ */
+typedef struct {
+    uint64_t    timestamp_us;
+    uint64_t    offset;
+} vtx_record_key_t;
+
+/**
+ * @brief 段录制器
+ */
+struct vtx_recorder {
+    char            prefix[VTX_RECORD_PATH_MAX]; /* 段文件路径前缀 */
+    uint64_t        segment_size;   /* 段预分配大小 */
+    uint32_t        segment_no;     /* 下一个段序号（已存在的段文件跳过，不覆盖） */
+    uint64_t        retry_ms;       /* 打开段失败后，此时刻之前不再重试（单调时钟） */
+    uint32_t        retry_interval_ms; /* 当前重试间隔（0表示上次打开成功） */
+
+    /* 当前段 */
+    int             fd;             /* 段文件（-1表示无） */
+    uint8_t*        map;            /* 段映射 */
+    uint64_t        data_end;       /* 已追加数据末尾 */
+    uint32_t        frame_count;    /* 已追加帧数 */
+    uint64_t        param_offset;   /* 未被后续帧打断的首个SPS/PPS记录偏移（0表示无） */
+
+    /* 关键帧索引 */
+    vtx_record_key_t* keys;
+    uint32_t        key_count;
+    uint32_t        key_capacity;
+};
+
+/* ========== 辅助函数 ========== */
+
+static void vtx_record_put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void vtx_record_put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void vtx_record_put64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint64_t vtx_record_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static uint64_t vtx_record_mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static uint64_t vtx_record_align(uint64_t v) {
+    return (v + VTX_RECORD_ALIGN - 1) & ~(uint64_t)(VTX_RECORD_ALIGN - 1);
+}
+
+/**
+ * @brief 预分配文件空间（避免映射写入时因磁盘满触发SIGBUS）
+ */
+static int vtx_record_preallocate(int fd, uint64_t size) {
+#if defined(__linux__)
+    int ret = posix_fallocate(fd, 0, (off_t)size);
+    if (ret == 0) {
+        return 0;
+    }
+    if (ret != EOPNOTSUPP && ret != EINVAL) {
+        errno = ret;
+        return -1;
+    }
+    /* 文件系统不支持fallocate时退回稀疏文件 */
+#endif
+    return ftruncate(fd, (off_t)size);
+}
+
+/**
+ * @brief 打开新段
+ *
+ * 段文件以O_EXCL创建，序号已被占用（之前的录制）时顺延到下一个空闲序号
+ */
+static int vtx_record_open_segment(vtx_recorder_t* rec) {
+    char path[VTX_RECORD_PATH_MAX + 32];
+    int fd;
+    for (;;) {
+        snprintf(path, sizeof(path), "%s-%06u.vtxrec",
+                 rec->prefix, rec->segment_no);
+        fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd >= 0 || errno != EEXIST) {
+            break;
+        }
+        rec->segment_no++;
+    }
+    if (fd < 0) {
+        vtx_log_error("Failed to create segment %s: %s", path, strerror(errno));
+        return VTX_ERR_FILE_OPEN;
+    }
+
+    if (vtx_record_preallocate(fd, rec->segment_size) != 0) {
+        vtx_log_error("Failed to preallocate segment %s: %s",
+                     path, strerror(errno));
+        close(fd);
+        unlink(path);
+        return VTX_ERR_FILE_WRITE;
+    }
+
+    void* map = mmap(NULL, rec->segment_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        vtx_log_error("Failed to map segment %s: %s", path, strerror(errno));
+        close(fd);
+        unlink(path);
+        return VTX_ERR_FILE_WRITE;
+    }
+    madvise(map, rec->segment_size, MADV_SEQUENTIAL);
+
+    rec->fd = fd;
+    rec->map = (uint8_t*)map;
+    rec->data_end = VTX_RECORD_HEADER_SIZE;
+    rec->frame_count = 0;
+    rec->param_offset = 0;
+    rec->key_count = 0;
+    rec->segment_no++;
+
+    memset(rec->map, 0, VTX_RECORD_HEADER_SIZE);
+    memcpy(rec->map, VTX_RECORD_MAGIC, 8);
+    vtx_record_put32(rec->map + VTX_RECORD_OFF_VERSION, VTX_RECORD_VERSION);
+    vtx_record_put32(rec->map + VTX_RECORD_OFF_HEADER_SIZE, VTX_RECORD_HEADER_SIZE);
+    vtx_record_put64(rec->map + VTX_RECORD_OFF_CREATED, vtx_record_now_us());
+    vtx_record_put64(rec->map + VTX_RECORD_OFF_DATA_END, rec->data_end);
+
+    vtx_log_info("Recording segment opened: %s", path);
+    return VTX_OK;
+}
+
+/**
+ * @brief 当前段收尾：写入关键帧索引，更新段头，截断到实际大小
+ */
+static void vtx_record_close_segment(vtx_recorder_t* rec) {
+    if (rec->fd < 0) {
+        return;
+    }
+
+    uint64_t index_offset = rec->data_end;
+    uint8_t* p = rec->map + index_offset;
+    for (uint32_t i = 0; i < rec->key_count; i++) {
+        vtx_record_put64(p, rec->keys[i].timestamp_us);
+        vtx_record_put64(p + 8, rec->keys[i].offset);
+        p += VTX_RECORD_INDEX_ENTRY;
+    }
+    uint64_t file_size = index_offset +
+                         (uint64_t)rec->key_count * VTX_RECORD_INDEX_ENTRY;
+
+    vtx_record_put64(rec->map + VTX_RECORD_OFF_INDEX, index_offset);
+    vtx_record_put32(rec->map + VTX_RECORD_OFF_INDEX_COUNT, rec->key_count);
+    vtx_record_put32(rec->map + VTX_RECORD_OFF_FRAME_COUNT, rec->frame_count);
+
+    /* 只发起异步回写，不等待落盘 */
+    msync(rec->map, file_size, MS_ASYNC);
+    munmap(rec->map, rec->segment_size);
+    if (ftruncate(rec->fd, (off_t)file_size) != 0) {
+        vtx_log_warn("Failed to truncate segment: %s", strerror(errno));
+    }
+    close(rec->fd);
+
+    vtx_log_info("Recording segment closed: frames=%u keyframes=%u size=%llu",
+                rec->frame_count, rec->key_count,
+                (unsigned long long)file_size);
+
+    rec->fd = -1;
+    rec->map = NULL;
+}
+
+/**
+ * @brief 记录关键帧索引项
+ */
+static int vtx_record_add_key(vtx_recorder_t* rec, uint64_t timestamp_us,
+                              uint64_t offset) {
+    if (rec->key_count == rec->key_capacity) {
+        uint32_t capacity = rec->key_capacity ? rec->key_capacity * 2 : 64;
+        vtx_record_key_t* keys = (vtx_record_key_t*)vtx_realloc(
+            rec->keys, capacity * sizeof(vtx_record_key_t));
+        if (!keys) {
+            return VTX_ERR_NO_MEMORY;
+        }
+        rec->keys = keys;
+        rec->key_capacity = capacity;
+    }
+    rec->keys[rec->key_count].timestamp_us = timestamp_us;
+    rec->keys[rec->key_count].offset = offset;
+    rec->key_count++;
+    return VTX_OK;
+}
+
+/* ========== 公共函数 ========== */
+
+vtx_recorder_t* vtx_recorder_create(const char* prefix, uint64_t segment_size) {
+    if (!prefix || strlen(prefix) >= VTX_RECORD_PATH_MAX) {
+        vtx_log_error("Invalid recording prefix");
+        return NULL;
+    }
+
+    vtx_recorder_t* rec = (vtx_recorder_t*)vtx_calloc(1, sizeof(vtx_recorder_t));
+    if (!rec) {
+        return NULL;
+    }
+
+    strcpy(rec->prefix, prefix);
+    rec->segment_size = segment_size;
+    rec->fd = -1;
+    return rec;
+}
+
+void vtx_recorder_destroy(vtx_recorder_t* rec) {
+    if (!rec) {
+        return;
+    }
+
+    vtx_record_close_segment(rec);
+    vtx_free(rec->keys);
+    vtx_free(rec);
+}
+
+int vtx_recorder_append(
+    vtx_recorder_t* rec,
+    vtx_frame_type_t frame_type,
+    uint16_t frame_id,
+    uint64_t timestamp_us,
+    const uint8_t* data,
+    size_t size)
+{
+    if (!rec || (!data && size > 0)) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    uint64_t record_size = vtx_record_align(VTX_RECORD_FRAME_HDR_SIZE + size);
+    bool is_key = frame_type == VTX_FRAME_I;
+
+    /* 记录和收尾时的索引都必须放得下 */
+    uint64_t index_size = (uint64_t)(rec->key_count + (is_key ? 1 : 0)) *
+                          VTX_RECORD_INDEX_ENTRY;
+    if (VTX_RECORD_HEADER_SIZE + record_size + VTX_RECORD_INDEX_ENTRY >
+        rec->segment_size) {
+        return VTX_ERR_OVERFLOW;
+    }
+    if (rec->fd >= 0 &&
+        rec->data_end + record_size + index_size > rec->segment_size) {
+        vtx_record_close_segment(rec);
+    }
+    if (rec->fd < 0) {
+        /* 打开失败后退避重试，不在每一帧上重复创建/预分配 */
+        uint64_t now_ms = vtx_record_mono_ms();
+        if (rec->retry_interval_ms > 0 && now_ms < rec->retry_ms) {
+            return VTX_ERR_NOT_READY;
+        }
+        int ret = vtx_record_open_segment(rec);
+        if (ret != VTX_OK) {
+            rec->retry_interval_ms = rec->retry_interval_ms > 0 ?
+                rec->retry_interval_ms * 2 : VTX_RECORD_RETRY_MIN_MS;
+            if (rec->retry_interval_ms > VTX_RECORD_RETRY_MAX_MS) {
+                rec->retry_interval_ms = VTX_RECORD_RETRY_MAX_MS;
+            }
+            rec->retry_ms = now_ms + rec->retry_interval_ms;
+            vtx_log_warn("Recording paused for %u ms", rec->retry_interval_ms);
+            return ret;
+        }
+        rec->retry_interval_ms = 0;
+    }
+
+    uint64_t offset = rec->data_end;
+    if (is_key) {
+        uint64_t key_offset = rec->param_offset ? rec->param_offset : offset;
+        int ret = vtx_record_add_key(rec, timestamp_us, key_offset);
+        if (ret != VTX_OK) {
+            return ret;
+        }
+    }
+
+    /* 记录头 + 数据直接写入映射（页缓存） */
+    uint8_t* p = rec->map + offset;
+    vtx_record_put32(p, (uint32_t)size);
+    p[4] = (uint8_t)frame_type;
+    p[5] = 0;
+    vtx_record_put16(p + 6, frame_id);
+    vtx_record_put64(p + 8, timestamp_us);
+    if (size > 0) {
+        memcpy(p + VTX_RECORD_FRAME_HDR_SIZE, data, size);
+    }
+    memset(p + VTX_RECORD_FRAME_HDR_SIZE + size, 0,
+           record_size - VTX_RECORD_FRAME_HDR_SIZE - size);
+
+    /* SPS/PPS连续出现时记下第一个，供紧随其后的I帧索引 */
+    if (frame_type == VTX_FRAME_SPS || frame_type == VTX_FRAME_PPS) {
+        if (rec->param_offset == 0) {
+            rec->param_offset = offset;
+        }
+    } else if (frame_type != VTX_FRAME_A) {
+        rec->param_offset = 0;
+    }
+
+    rec->data_end = offset + record_size;
+    rec->frame_count++;
+    vtx_record_put64(rec->map + VTX_RECORD_OFF_DATA_END, rec->data_end);
+
+    return VTX_OK;
+}
@@ -24,10 +24,21 @@
 #include "vtx_error.h"
 #include "vtx_log.h"
 #include "vtx_mem.h"
+#include "vtx_trace.h"
+#include "vtx_thread.h"
+#include "vtx_socket.h"
+#include "vtx_window.h"
+#include "vtx_session.h"
+#include "vtx_crypto.h"
+#include "vtx_record.h"
+#include "vtx_pcap.h"
+#include "vtx_hash.h"
+#include "vtx_timeshift.h"
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <time.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
@@ -63,12 +74,16 @@ struct vtx_rx {
 
     /* 内存池 */
     vtx_frame_pool_t*      media_pool;       /* 媒体帧池 */
-    vtx_frame_pool_t*      data_pool;        /* 控制帧池 */
     vtx_frag_pool_t*       frag_pool;        /* 分片池 */
 
     /* 接收队列 */
     vtx_frame_queue_t*     recv_queue;       /* 接收中的帧队列 */
-    vtx_frame_queue_t*     data_queue;       /* DATA包队列（需要ACK） */
+    uint64_t               cleanup_deadline_ms; /* 下一次超时帧清理时刻（与select是否超时无关） */
+    uint64_t               timer_deadline_ms; /* 下一次DATA重传/心跳检查时刻（与select是否超时无关） */
+    vtx_data_window_t      data_win;         /* DATA包窗口（需要ACK） */
+    vtx_fid_window_t       fid_win;          /* 已完成/已超时的媒体帧ID（CONNECT/START时复位，
+                                                以便接收发送端重发的同一I帧；只在poll线程访问） */
+    atomic_bool            fid_reset_pending; /* 其他线程请求复位fid_win，由poll线程执行 */
 
     /* I帧缓存 */
     vtx_frame_t*           last_iframe;      /* 最后一个I帧 */
@@ -83,6 +98,37 @@ struct vtx_rx {
     vtx_rx_stats_t         stats;            /* 统计信息 */
     vtx_spinlock_t         stats_lock;       /* 统计锁 */
 
+    /* socket缓冲区 */
+    vtx_sockbuf_t          rcvbuf;           /* 接收缓冲区自动调整状态 */
+    uint64_t               connect_send_ms;  /* CONNECT发送时间（用于RTT采样） */
+
+    /* 0-RTT START（vtx_rx_connect_start），也用于会话失效后重新START */
+    uint8_t                start_url[VTX_MAX_URL_SIZE]; /* URL payload（含'\0'） */
+    size_t                 start_url_len;    /* URL payload长度（0表示默认媒体源） */
+    bool                   start_pending;    /* 等待CONNECTED确认START */
+    bool                   media_active;     /* 已发送START且未STOP */
+
+    /* 会话恢复 */
+    uint64_t               session_token;    /* CONNECTED下发的令牌（0表示无） */
+    struct sockaddr_in     path_addrs[VTX_MAX_PATHS - 1]; /* 发送端额外路径地址
+                                                (携带令牌的心跳ACK登记，新会话清空) */
+    uint8_t                path_addr_count;  /* 已登记的额外路径数 */
+    bool                   connecting;       /* 已发送CONNECT，等待CONNECTED */
+    bool                   injecting;        /* 正在处理vtx_rx_inject_packet注入的包 */
+
+    /* 载荷加密 */
+    vtx_crypto_t*          crypto;           /* AES-GCM上下文（NULL表示不加密） */
+    uint64_t               crypt_salt;       /* CONNECTED下发的nonce盐 */
+
+    /* 录制 */
+    vtx_recorder_t*        recorder;         /* 段录制器（NULL表示不录制） */
+    vtx_pcap_t*            capture;          /* 抓包文件（配置capture_path时） */
+
+    /* 时移 */
+    vtx_timeshift_t*       timeshift;        /* 最近完整帧的时移环（NULL表示不保留） */
+    vtx_frame_pool_t*      small_pool;       /* 单分片帧池（不超过一个分片的帧进入时移环时使用） */
+    vtx_frame_pool_t*      shift_pool;       /* 外部缓冲区帧池（较大的帧复制后进入时移环） */
+
     /* 回调 */
     vtx_on_frame_fn        frame_fn;         /* 帧回调 */
     vtx_on_data_fn         data_fn;          /* 控制帧回调 */
@@ -104,6 +150,24 @@ static uint64_t vtx_get_time_ms(void) {
     return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
+/**
+ * @brief 获取单调时钟（微秒，用于延迟分解，不受系统时间调整影响）
+ */
+static uint64_t vtx_get_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 获取墙上时间（微秒，用于录制时间戳）
+ */
+static uint64_t vtx_get_wall_time_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 /**
  * @brief 创建UDP socket
  */
@@ -120,20 +184,19 @@ static int vtx_create_socket(void) {
         vtx_log_warn("Failed to set non-blocking: %s", strerror(errno));
     }
 
-    /* 设置接收缓冲区 */
-    int recvbuf = VTX_DEFAULT_RECV_BUF;
-    if (setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &recvbuf, sizeof(recvbuf)) < 0) {
-        vtx_log_warn("Failed to set recv buffer: %s", strerror(errno));
-    }
+    /* 开启内核丢包计数（socket缓冲区溢出） */
+    vtx_socket_enable_rxq_ovfl(sockfd);
 
     return sockfd;
 }
 
 /**
- * @brief 发送数据包
+ * @brief 发送数据包到指定地址
  */
-static int vtx_send_packet(
+static int vtx_send_packet_to(
     vtx_rx_t* rx,
+    const struct sockaddr_in* addr,
+    socklen_t addr_len,
     const vtx_packet_header_t* header,
     const uint8_t* payload,
     size_t payload_size)
@@ -178,15 +241,15 @@ static int vtx_send_packet(
     iov[1].iov_len = payload_size;
 
     struct msghdr msg = {0};
-    msg.msg_name = &rx->server_addr;
-    msg.msg_namelen = rx->server_addr_len;
+    msg.msg_name = (void*)addr;
+    msg.msg_namelen = addr_len;
     msg.msg_iov = iov;
     msg.msg_iovlen = payload_size > 0 ? 2 : 1;
 
     vtx_log_debug("RX sending on sockfd=%d to %s:%d",
                   rx->sockfd,
-                  inet_ntoa(rx->server_addr.sin_addr),
-                  ntohs(rx->server_addr.sin_port));
+                  inet_ntoa(addr->sin_addr),
+                  ntohs(addr->sin_port));
 
     ssize_t sent = sendmsg(rx->sockfd, &msg, 0);
     if (sent < 0) {
@@ -197,11 +260,26 @@ static int vtx_send_packet(
         vtx_log_error("vtx_send_packet: send error, errno=%d", errno);
         return VTX_ERR_SOCKET_SEND;
     }
+    vtx_pcap_write(rx->capture, rx->sockfd, VTX_PCAP_DIR_OUT, addr, iov,
+                   (int)msg.msg_iovlen);
 
     vtx_log_debug("vtx_send_packet: sent %zd bytes", sent);
     return VTX_OK;
 }
 
+/**
+ * @brief 发送数据包到发送端
+ */
+static int vtx_send_packet(
+    vtx_rx_t* rx,
+    const vtx_packet_header_t* header,
+    const uint8_t* payload,
+    size_t payload_size)
+{
+    return vtx_send_packet_to(rx, &rx->server_addr, rx->server_addr_len,
+                              header, payload, payload_size);
+}
+
 /**
  * @brief 发送ACK
  */
@@ -213,18 +291,408 @@ static int vtx_send_ack(vtx_rx_t* rx, uint16_t frame_id) {
     return vtx_send_packet(rx, &header, NULL, 0);
 }
 
+static void vtx_rx_free_shift_copy(const uint8_t* data, size_t size, void* ctx) {
+    (void)size;
+    (void)ctx;
+    vtx_free((void*)data);
+}
+
+/**
+ * @brief 完整帧加入时移环
+ *
+ * 复制后写入，不持有重组用的512KB媒体帧（时移环按缓冲区容量计字节数，
+ * 持有媒体帧会让timeshift_bytes只够保存很少几帧，并占住媒体帧池）：
+ * 不超过一个分片的帧复制到单分片帧池，更大的帧复制到按大小分配的缓冲区
+ */
+static void vtx_rx_timeshift_push(
+    vtx_rx_t* rx,
+    vtx_frame_type_t frame_type,
+    uint16_t frame_id,
+    const uint8_t* data,
+    size_t size)
+{
+    vtx_frame_pool_t* pool;
+    vtx_frame_t* frame;
+    if (size <= (size_t)(rx->config.mtu - VTX_PACKET_HEADER_SIZE)) {
+        pool = rx->small_pool;
+        frame = vtx_frame_pool_acquire(pool);
+        if (!frame) {
+            return;
+        }
+        frame->data_size = size;
+        memcpy(frame->data, data, size);
+    } else {
+        pool = rx->shift_pool;
+        uint8_t* copy = (uint8_t*)vtx_malloc(size);
+        frame = copy ? vtx_frame_pool_acquire(pool) : NULL;
+        if (!frame) {
+            vtx_free(copy);
+            return;
+        }
+        memcpy(copy, data, size);
+        vtx_frame_wrap(frame, copy, size, vtx_rx_free_shift_copy, NULL);
+    }
+    frame->frame_id = frame_id;
+    frame->frame_type = frame_type;
+
+    vtx_timeshift_push(rx->timeshift, pool, frame, vtx_get_time_ms());
+    vtx_frame_release(pool, frame);
+}
+
+/**
+ * @brief 交付完整帧（回调 + 统计）
+ *
+ * 重组路径和单分片快速路径共用（快速路径的data指向接收缓冲区）
+ */
+static void vtx_rx_deliver_frame(
+    vtx_rx_t* rx,
+    vtx_frame_type_t frame_type,
+    uint16_t frame_id,
+    const uint8_t* data,
+    size_t size,
+    vtx_frame_timing_t* timing)
+{
+    vtx_sockbuf_note_frame(&rx->rcvbuf, size);
+
+    if (rx->timeshift) {
+        vtx_rx_timeshift_push(rx, frame_type, frame_id, data, size);
+    }
+
+    /* 录制（在回调之前，数据直接从重组缓冲区写入段文件映射） */
+    int rec_ret = VTX_OK;
+    if (rx->recorder) {
+        rec_ret = vtx_recorder_append(rx->recorder, frame_type, frame_id,
+                                      vtx_get_wall_time_us(), data, size);
+        if (rec_ret != VTX_OK && rec_ret != VTX_ERR_NOT_READY) {
+            vtx_log_warn("Failed to record frame: id=%u size=%zu err=%d",
+                        frame_id, size, rec_ret);
+        }
+    }
+
+    /* 调用回调 */
+    if (rx->frame_fn) {
+        if (rx->config.latency_stats) {
+            timing->cb_start_us = vtx_get_time_us();
+        }
+        VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_FRAME, frame_type, size);
+        int cb_ret = rx->frame_fn(data, size, frame_type, rx->userdata);
+        VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_FRAME, cb_ret);
+        (void)cb_ret;
+        if (rx->config.latency_stats) {
+            timing->cb_end_us = vtx_get_time_us();
+        }
+    }
+
+    /* 更新统计 */
+    vtx_spinlock_lock(&rx->stats_lock);
+    rx->stats.total_frames++;
+    if (rx->recorder) {
+        if (rec_ret == VTX_OK) {
+            rx->stats.recorded_frames++;
+        } else {
+            rx->stats.record_failures++;
+        }
+    }
+    if (frame_type == VTX_FRAME_I) {
+        rx->stats.total_i_frames++;
+    } else if (frame_type == VTX_FRAME_P) {
+        rx->stats.total_p_frames++;
+    }
+    if (rx->config.latency_stats) {
+        vtx_latency_hist_record(&rx->stats.lat_reassembly,
+                                timing->last_recv_us - timing->first_recv_us);
+        if (timing->cb_start_us > 0) {
+            vtx_latency_hist_record(&rx->stats.lat_deliver,
+                                    timing->cb_start_us - timing->last_recv_us);
+            vtx_latency_hist_record(&rx->stats.lat_callback,
+                                    timing->cb_end_us - timing->cb_start_us);
+        }
+    }
+    vtx_spinlock_unlock(&rx->stats_lock);
+}
+
+/**
+ * @brief 原地解密并验证一帧
+ *
+ * @param header 帧首分片包头（seq_num为帧的base_seq）
+ * @param data 密文，末尾VTX_CRYPTO_TAG_SIZE字节为GCM标签
+ * @param size 密文+标签大小
+ * @return 明文大小，认证失败返回负数（已计入auth_failures）
+ */
+static ssize_t vtx_rx_open_frame(
+    vtx_rx_t* rx,
+    const vtx_packet_header_t* header,
+    uint8_t* data,
+    size_t size)
+{
+    if (size >= VTX_CRYPTO_TAG_SIZE) {
+        size -= VTX_CRYPTO_TAG_SIZE;
+        if (vtx_crypto_open(rx->crypto, rx->crypt_salt, header,
+                            data, size, data + size) == VTX_OK) {
+            return (ssize_t)size;
+        }
+    }
+
+    vtx_log_warn("Frame authentication failed: id=%u type=%u seq=%u",
+                header->frame_id, header->frame_type, header->seq_num);
+    vtx_spinlock_lock(&rx->stats_lock);
+    rx->stats.auth_failures++;
+    vtx_spinlock_unlock(&rx->stats_lock);
+    return -1;
+}
+
+/**
+ * @brief 校验并去掉帧哈希
+ *
+ * @param data 帧数据，末尾VTX_FRAME_HASH_SIZE字节为帧哈希（网络字节序）
+ * @param size 数据+哈希大小
+ * @return 帧数据大小，校验失败返回负数（已计入hash_failures）
+ */
+static ssize_t vtx_rx_check_hash(
+    vtx_rx_t* rx,
+    uint16_t frame_id,
+    uint8_t frame_type,
+    const uint8_t* data,
+    size_t size)
+{
+    if (size >= VTX_FRAME_HASH_SIZE) {
+        size -= VTX_FRAME_HASH_SIZE;
+        uint64_t expected;
+        memcpy(&expected, data + size, sizeof(expected));
+        if (vtx_hash64(data, size) == be64toh(expected)) {
+            return (ssize_t)size;
+        }
+    }
+
+    vtx_log_warn("Frame hash mismatch: id=%u type=%u size=%zu",
+                frame_id, frame_type, size);
+    vtx_spinlock_lock(&rx->stats_lock);
+    rx->stats.hash_failures++;
+    vtx_spinlock_unlock(&rx->stats_lock);
+    return -1;
+}
+
+/**
+ * @brief 比较IPv4地址和端口
+ */
+static bool vtx_rx_addr_equal(const struct sockaddr_in* a,
+                              const struct sockaddr_in* b) {
+    return a->sin_addr.s_addr == b->sin_addr.s_addr &&
+           a->sin_port == b->sin_port;
+}
+
+/**
+ * @brief 检查地址是否属于当前会话（服务器地址或已登记的发送端路径）
+ */
+static bool vtx_rx_is_session_addr(const vtx_rx_t* rx,
+                                   const struct sockaddr_in* addr) {
+    if (vtx_rx_addr_equal(addr, &rx->server_addr)) {
+        return true;
+    }
+    for (uint8_t i = 0; i < rx->path_addr_count; i++) {
+        if (vtx_rx_addr_equal(addr, &rx->path_addrs[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 登记发送端额外路径地址（心跳ACK携带的令牌与会话令牌一致）
+ */
+static void vtx_rx_learn_path(vtx_rx_t* rx, const struct sockaddr_in* addr) {
+    if (vtx_rx_is_session_addr(rx, addr) ||
+        rx->path_addr_count >= VTX_MAX_PATHS - 1) {
+        return;
+    }
+    rx->path_addrs[rx->path_addr_count++] = *addr;
+    vtx_log_info("Sender path %u registered: %s:%u", rx->path_addr_count,
+                inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
+}
+
+/**
+ * @brief 确认I帧分片
+ *
+ * 来自会话地址的分片沿来源路径返回；其他来源（未登记的路径或伪造的源地址）
+ * 只经服务器地址确认，不向任意地址发包
+ */
+static void vtx_rx_ack_frag(
+    vtx_rx_t* rx,
+    const vtx_packet_header_t* header,
+    const struct sockaddr_in* from_addr)
+{
+    vtx_packet_header_t ack_header = {0};
+    ack_header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
+    ack_header.frame_id = header->frame_id;
+    ack_header.frag_index = header->frag_index;
+    ack_header.frame_type = VTX_DATA_ACK;
+    if (!vtx_rx_is_session_addr(rx, from_addr)) {
+        from_addr = &rx->server_addr;
+    }
+    vtx_send_packet_to(rx, from_addr, sizeof(*from_addr), &ack_header, NULL, 0);
+}
+
+/**
+ * @brief 执行其他线程请求的帧ID窗口复位（poll线程在使用fid_win前调用）
+ */
+static inline void vtx_rx_apply_fid_reset(vtx_rx_t* rx) {
+    if (atomic_exchange(&rx->fid_reset_pending, false)) {
+        vtx_fid_window_reset(&rx->fid_win);
+    }
+}
+
+/**
+ * @brief 超时帧记入帧ID窗口（vtx_frame_queue_cleanup_timeout回调）
+ */
+static void vtx_rx_expire_frame(void* ctx, const vtx_frame_t* frame) {
+    vtx_rx_t* rx = (vtx_rx_t*)ctx;
+    vtx_fid_window_mark(&rx->fid_win, frame->frame_id);
+}
+
+/**
+ * @brief 清理超时的不完整帧，计算下一次清理时刻
+ *
+ * 之后入队的帧最早在 now + frame_timeout_ms 超时，
+ * 下一次清理时刻取它与队首帧超时时刻中较早的一个
+ */
+static void vtx_rx_cleanup_frames(vtx_rx_t* rx, uint64_t now_ms) {
+    vtx_rx_apply_fid_reset(rx);
+
+    size_t cleaned = vtx_frame_queue_cleanup_timeout(
+        rx->recv_queue, now_ms, vtx_rx_expire_frame, rx);
+    if (cleaned > 0) {
+        vtx_spinlock_lock(&rx->stats_lock);
+        rx->stats.incomplete_frames += cleaned;
+        vtx_spinlock_unlock(&rx->stats_lock);
+        vtx_log_debug("Cleaned %zu timeout frames", cleaned);
+    }
+
+    uint64_t deadline = vtx_frame_queue_next_deadline(rx->recv_queue);
+    uint64_t next_new = now_ms + rx->config.frame_timeout_ms;
+    rx->cleanup_deadline_ms = deadline < next_new ? deadline : next_new;
+}
+
+/**
+ * @brief 关键帧完成：丢弃更早的不完整视频帧（解码从该关键帧重新开始，旧帧已无用）
+ */
+static void vtx_rx_purge_before(vtx_rx_t* rx, uint16_t frame_id) {
+    size_t purged = vtx_frame_queue_purge_before(
+        rx->recv_queue, frame_id, vtx_rx_expire_frame, rx);
+    if (purged > 0) {
+        vtx_spinlock_lock(&rx->stats_lock);
+        rx->stats.incomplete_frames += purged;
+        vtx_spinlock_unlock(&rx->stats_lock);
+        vtx_log_debug("Purged %zu incomplete frames before key frame %u",
+                     purged, frame_id);
+    }
+}
+
+/**
+ * @brief 单分片帧快速路径
+ *
+ * 非I帧且total_frags == 1时（音频、小P帧等），payload已在接收缓冲区中
+ * 通过CRC验证（加密分片在缓冲区中原地解密），直接交付，
+ * 不经过媒体帧池、分片池和接收队列。
+ * I帧需要分片ACK和last_iframe缓存，仍走重组路径。
+ */
+static void vtx_handle_single_frag(
+    vtx_rx_t* rx,
+    const vtx_packet_header_t* header,
+    uint8_t* payload)
+{
+    vtx_frame_timing_t timing = {0};
+    if (rx->config.latency_stats) {
+        timing.first_recv_us = vtx_get_time_us();
+        timing.last_recv_us = timing.first_recv_us;
+    }
+
+    vtx_spinlock_lock(&rx->stats_lock);
+    rx->stats.total_packets++;
+    rx->stats.total_bytes += header->payload_size;
+    vtx_spinlock_unlock(&rx->stats_lock);
+
+    size_t size = header->payload_size;
+    if (header->flags & VTX_FLAG_CRYPT) {
+        ssize_t plain = vtx_rx_open_frame(rx, header, payload, size);
+        if (plain < 0) {
+            return;
+        }
+        size = (size_t)plain;
+    } else if (header->flags & VTX_FLAG_HASH) {
+        ssize_t checked = vtx_rx_check_hash(rx, header->frame_id, header->frame_type,
+                                            payload, size);
+        if (checked < 0) {
+            return;
+        }
+        size = (size_t)checked;
+    }
+
+    VTX_TRACE_FRAME_COMPLETE(header->frame_id, header->frame_type, 1,
+                             size, 0);
+
+    vtx_rx_deliver_frame(rx, (vtx_frame_type_t)header->frame_type,
+                         header->frame_id, payload, size, &timing);
+
+    vtx_log_debug("Frame complete (single fragment): id=%u type=%u size=%zu",
+                 header->frame_id, header->frame_type, size);
+}
+
 /**
  * @brief 处理接收到的分片
+ *
+ * @param from_addr 分片来源地址（发送端多路径时I帧分片ACK沿原路径返回）
  */
 static int vtx_handle_fragment(
     vtx_rx_t* rx,
     const vtx_packet_header_t* header,
-    const uint8_t* payload)
+    uint8_t* payload,
+    const struct sockaddr_in* from_addr)
 {
     if (!rx || !header || !payload) {
         return VTX_ERR_INVALID_PARAM;
     }
 
+    VTX_TRACE_FRAG_RECV(header->frame_id, header->frag_index,
+                        header->total_frags, header->payload_size,
+                        header->seq_num);
+
+    /* 已完成/已超时帧的迟到分片（重传、多路径重复发送）和过旧分片：
+     * 在查找队列和分配帧之前丢弃；I帧迟到分片仍然ACK，停止发送端重传 */
+    vtx_fid_state_t fid_state = vtx_fid_window_check(&rx->fid_win, header->frame_id);
+    if (fid_state != VTX_FID_NEW) {
+        vtx_spinlock_lock(&rx->stats_lock);
+        if (fid_state == VTX_FID_DONE) {
+            rx->stats.late_frags++;
+        } else {
+            rx->stats.stale_frags++;
+        }
+        vtx_spinlock_unlock(&rx->stats_lock);
+
+        if (fid_state == VTX_FID_DONE && header->frame_type == VTX_FRAME_I) {
+            vtx_rx_ack_frag(rx, header, from_addr);
+        }
+        vtx_log_debug("%s fragment dropped: id=%u frag=%u",
+                     fid_state == VTX_FID_DONE ? "Late" : "Stale",
+                     header->frame_id, header->frag_index);
+        return VTX_OK;
+    }
+
+    if (header->total_frags == 1 && header->frame_type != VTX_FRAME_I) {
+        vtx_fid_window_mark(&rx->fid_win, header->frame_id);
+        vtx_handle_single_frag(rx, header, payload);
+        return VTX_OK;
+    }
+
+    /* 分片必须落在重组缓冲区内（在分配之前检查） */
+    size_t offset = vtx_packet_calc_frag_offset(header->frag_index,
+                                                rx->config.mtu);
+    if (offset + header->payload_size > VTX_MEDIA_FRAME_DATA_SIZE) {
+        vtx_log_warn("Fragment out of range: id=%u frag=%u offset=%zu size=%u",
+                    header->frame_id, header->frag_index, offset,
+                    header->payload_size);
+        return VTX_ERR_OVERFLOW;
+    }
+
     /* 查找或创建frame */
     vtx_frame_t* frame = vtx_frame_queue_find(rx->recv_queue, header->frame_id);
     if (!frame) {
@@ -245,11 +713,27 @@ static int vtx_handle_fragment(
             return ret;
         }
 
+        if (rx->config.latency_stats) {
+            frame->timing.first_recv_us = vtx_get_time_us();
+        }
+        frame->base_seq = header->seq_num - header->frag_index;
+        frame->sealed = (header->flags & VTX_FLAG_CRYPT) != 0;
+        frame->hashed = !frame->sealed && (header->flags & VTX_FLAG_HASH);
+
         /* 加入接收队列 */
         vtx_frame_queue_push(rx->recv_queue, frame);
         vtx_frame_release(rx->media_pool, frame);
     }
 
+    /* 加密帧的nonce由base_seq还原，seq不连续的分片不属于该帧 */
+    if (frame->sealed &&
+        frame->base_seq != (uint32_t)(header->seq_num - header->frag_index)) {
+        vtx_log_debug("Fragment seq mismatch: id=%u frag=%u seq=%u base=%u",
+                     header->frame_id, header->frag_index,
+                     header->seq_num, frame->base_seq);
+        return VTX_ERR_SEQUENCE;
+    }
+
     /* 检查是否已接收此分片 */
     if (vtx_frame_has_frag(frame, header->frag_index)) {
         vtx_spinlock_lock(&rx->stats_lock);
@@ -259,8 +743,6 @@ static int vtx_handle_fragment(
     }
 
     /* 拷贝payload到frame */
-    size_t offset = vtx_packet_calc_frag_offset(header->frag_index,
-                                                rx->config.mtu);
     if (offset + header->payload_size > frame->data_capacity) {
         vtx_log_error("Fragment overflow: offset=%zu size=%u capacity=%zu",
                      offset, header->payload_size, frame->data_capacity);
@@ -275,12 +757,7 @@ static int vtx_handle_fragment(
 
     /* 对于I帧，发送分片ACK */
     if (header->frame_type == VTX_FRAME_I) {
-        vtx_packet_header_t ack_header = {0};
-        ack_header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
-        ack_header.frame_id = header->frame_id;
-        ack_header.frag_index = header->frag_index;
-        ack_header.frame_type = VTX_DATA_ACK;
-        vtx_send_packet(rx, &ack_header, NULL, 0);
+        vtx_rx_ack_frag(rx, header, from_addr);
     }
 
     /* 更新统计 */
@@ -291,11 +768,16 @@ static int vtx_handle_fragment(
 
     /* 检查是否完整 */
     if (vtx_frame_is_complete(frame)) {
+        if (rx->config.latency_stats) {
+            frame->timing.last_recv_us = vtx_get_time_us();
+        }
+
         /* Retain frame以防止在调用回调前被释放 */
         vtx_frame_t* complete_frame = vtx_frame_retain(frame);
 
-        /* 从接收队列移除（内部会release） */
+        /* 从接收队列移除（内部会release），之后的分片为迟到分片 */
         vtx_frame_queue_remove(rx->recv_queue, frame);
+        vtx_fid_window_mark(&rx->fid_win, complete_frame->frame_id);
 
         /* 释放retran（RX端已完成接收，不再需要跟踪） */
         if (complete_frame->retran) {
@@ -303,7 +785,35 @@ static int vtx_handle_fragment(
             complete_frame->retran = NULL;
         }
 
-        /* 如果是I帧，缓存 */
+        /* 整帧一次解密（标签为重组数据的最后VTX_CRYPTO_TAG_SIZE字节） */
+        if (complete_frame->sealed) {
+            vtx_packet_header_t seal_header = {0};
+            seal_header.seq_num = complete_frame->base_seq;
+            seal_header.frame_id = complete_frame->frame_id;
+            seal_header.frame_type = complete_frame->frame_type;
+            seal_header.total_frags = complete_frame->total_frags;
+            ssize_t plain = vtx_rx_open_frame(rx, &seal_header,
+                                              complete_frame->data,
+                                              complete_frame->data_size);
+            if (plain < 0) {
+                vtx_frame_release(rx->media_pool, complete_frame);
+                return VTX_ERR_CHECKSUM;
+            }
+            complete_frame->data_size = (size_t)plain;
+        } else if (complete_frame->hashed) {
+            /* 帧哈希为重组数据的最后VTX_FRAME_HASH_SIZE字节 */
+            ssize_t checked = vtx_rx_check_hash(rx, complete_frame->frame_id,
+                                                complete_frame->frame_type,
+                                                complete_frame->data,
+                                                complete_frame->data_size);
+            if (checked < 0) {
+                vtx_frame_release(rx->media_pool, complete_frame);
+                return VTX_ERR_CHECKSUM;
+            }
+            complete_frame->data_size = (size_t)checked;
+        }
+
+        /* 如果是I帧，缓存，并丢弃更早的不完整帧 */
         if (header->frame_type == VTX_FRAME_I) {
             vtx_spinlock_lock(&rx->iframe_lock);
             if (rx->last_iframe) {
@@ -311,23 +821,22 @@ static int vtx_handle_fragment(
             }
             rx->last_iframe = vtx_frame_retain(complete_frame);
             vtx_spinlock_unlock(&rx->iframe_lock);
-        }
 
-        /* 调用回调 */
-        if (rx->frame_fn) {
-            rx->frame_fn(complete_frame->data, complete_frame->data_size,
-                        complete_frame->frame_type, rx->userdata);
+            vtx_rx_purge_before(rx, complete_frame->frame_id);
         }
 
-        /* 更新统计 */
-        vtx_spinlock_lock(&rx->stats_lock);
-        rx->stats.total_frames++;
-        if (complete_frame->frame_type == VTX_FRAME_I) {
-            rx->stats.total_i_frames++;
-        } else if (complete_frame->frame_type == VTX_FRAME_P) {
-            rx->stats.total_p_frames++;
-        }
-        vtx_spinlock_unlock(&rx->stats_lock);
+        VTX_TRACE_FRAME_COMPLETE(complete_frame->frame_id,
+                                 complete_frame->frame_type,
+                                 complete_frame->total_frags,
+                                 complete_frame->data_size,
+                                 complete_frame->last_recv_ms -
+                                 complete_frame->first_recv_ms);
+
+        vtx_rx_deliver_frame(rx, complete_frame->frame_type,
+                             complete_frame->frame_id,
+                             complete_frame->data,
+                             complete_frame->data_size,
+                             &complete_frame->timing);
 
         vtx_log_debug("Frame complete: id=%u type=%u size=%zu",
                      complete_frame->frame_id, complete_frame->frame_type, complete_frame->data_size);
@@ -339,86 +848,210 @@ static int vtx_handle_fragment(
     return VTX_OK;
 }
 
+/**
+ * @brief 重传DATA包（vtx_data_window_process回调）
+ */
+static void vtx_rx_resend_data(void* ctx, const vtx_data_slot_t* slot) {
+    vtx_rx_t* rx = (vtx_rx_t*)ctx;
+
+    vtx_packet_header_t header = {0};
+    header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
+    header.frame_id = slot->frame_id;
+    header.frame_type = slot->data_type;
+    header.frag_index = 0;
+    header.total_frags = 1;
+    header.payload_size = slot->size;
+    header.flags = VTX_FLAG_RETRANS;
+
+    VTX_TRACE_FRAG_RETRANS(header.frame_id, 0, slot->retrans_count,
+                           header.payload_size, header.seq_num);
+    vtx_send_packet(rx, &header, slot->data, slot->size);
+}
+
 /**
  * @brief 处理重传队列（超时重传和清理）
  */
 static void vtx_process_retrans_queue(vtx_rx_t* rx) {
-    uint64_t now_ms = vtx_get_time_ms();
-    vtx_frame_t* frame;
-    vtx_frame_t* tmp;
-
-    vtx_spinlock_lock(&rx->data_queue->lock);
+    vtx_data_window_process(&rx->data_win, vtx_get_time_ms(),
+                            rx->config.data_retrans_timeout_ms,
+                            rx->config.data_max_retrans,
+                            vtx_rx_resend_data, rx);
+}
 
-    list_for_each_entry_safe(frame, tmp, &rx->data_queue->frames, list) {
-        /* 检查重传次数是否超限 */
-        if (frame->retrans_count >= rx->config.data_max_retrans) {
-            vtx_log_warn("Frame dropped: id=%u, retrans=%u",
-                       frame->frame_id, frame->retrans_count);
+/**
+ * @brief 发送心跳（连接建立后，到达心跳间隔时）
+ *
+ * 心跳携带会话令牌，地址变化后发送端据此发起路径验证
+ */
+static void vtx_rx_send_heartbeat(vtx_rx_t* rx, uint64_t now_ms) {
+    if (!rx->connected || rx->last_heartbeat_send_ms == 0 ||
+        now_ms - rx->last_heartbeat_send_ms < rx->config.heartbeat_interval_ms) {
+        return;
+    }
 
-            /* 从队列移除并释放 */
-            list_del(&frame->list);
-            rx->data_queue->count--;
-            vtx_spinlock_unlock(&rx->data_queue->lock);
+    vtx_packet_header_t hb_header = {0};
+    hb_header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
+    hb_header.frame_id = 0;
+    hb_header.frame_type = VTX_DATA_HEARTBEAT;
+    if (rx->session_token != 0) {
+        uint8_t token[VTX_SESSION_TOKEN_SIZE];
+        vtx_session_pack_token(rx->session_token, token);
+        vtx_send_packet(rx, &hb_header, token, sizeof(token));
+    } else {
+        vtx_send_packet(rx, &hb_header, NULL, 0);
+    }
 
-            vtx_frame_release(rx->data_pool, frame);
+    rx->last_heartbeat_send_ms = now_ms;
+    vtx_log_debug("Heartbeat sent");
+}
 
-            vtx_spinlock_lock(&rx->data_queue->lock);
-            continue;
+/**
+ * @brief DATA窗口重传和心跳，计算下一次检查时刻
+ *
+ * 待确认的DATA包最迟在一个重传超时后检查，心跳在到期时检查
+ */
+static void vtx_rx_process_timers(vtx_rx_t* rx, uint64_t now_ms) {
+    vtx_process_retrans_queue(rx);
+    vtx_rx_send_heartbeat(rx, now_ms);
+
+    uint64_t deadline = now_ms + rx->config.data_retrans_timeout_ms;
+    if (rx->connected && rx->last_heartbeat_send_ms > 0) {
+        uint64_t heartbeat_ms = rx->last_heartbeat_send_ms + rx->config.heartbeat_interval_ms;
+        if (heartbeat_ms < deadline) {
+            deadline = heartbeat_ms;
         }
+    }
+    rx->timer_deadline_ms = deadline;
+}
+
+/**
+ * @brief 将URL编码为START payload（含'\0'，超过VTX_MAX_URL_SIZE - 1的部分截断）
+ *
+ * @return payload长度，URL为空时返回0
+ */
+static size_t vtx_rx_pack_url(const char* url, uint8_t* buf) {
+    if (!url || url[0] == '\0') {
+        return 0;
+    }
+
+    size_t url_len = strlen(url);
+    if (url_len >= VTX_MAX_URL_SIZE) {
+        vtx_log_warn("URL truncated from %zu to %d bytes",
+                    url_len, VTX_MAX_URL_SIZE - 1);
+        url_len = VTX_MAX_URL_SIZE - 1;  /* 保留一个字节给'\0' */
+    }
+    memcpy(buf, url, url_len);
+    buf[url_len] = '\0';
+    return url_len + 1;  /* 包含'\0' */
+}
+
+/**
+ * @brief 发送START控制帧
+ */
+static int vtx_rx_send_start(vtx_rx_t* rx, const uint8_t* url, size_t url_len) {
+    /* 发送端可能重发缓存的I帧；可能在应用线程调用，复位交给poll线程执行 */
+    atomic_store(&rx->fid_reset_pending, true);
 
-        /* 检查是否需要重传 */
-        uint64_t elapsed = now_ms - frame->send_time_ms;
-        if (elapsed >= rx->config.data_retrans_timeout_ms) {
-            /* 需要重传 */
-            frame->retrans_count++;
-            frame->send_time_ms = now_ms;
+    vtx_packet_header_t header = {0};
+    header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
+    header.frame_type = VTX_DATA_START;
 
-            vtx_log_debug("Retransmitting frame: id=%u, retrans=%u, elapsed=%llu ms",
-                        frame->frame_id, frame->retrans_count,
-                        (unsigned long long)elapsed);
+    int ret = vtx_send_packet(rx, &header, url_len > 0 ? url : NULL, url_len);
+    if (ret != VTX_OK) {
+        vtx_log_error("Failed to send START: %d", ret);
+        return ret;
+    }
 
-            /* 重新发送数据包 */
-            vtx_packet_header_t header = {0};
-            header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
-            header.frame_id = frame->frame_id;
-            header.frame_type = VTX_DATA_USER;
-            header.frag_index = 0;
-            header.total_frags = 1;
-            header.payload_size = frame->data_size;
-            header.flags = VTX_FLAG_RETRANS;
+    vtx_log_info("Sent START request to server");
+    return VTX_OK;
+}
+
+/**
+ * @brief 发送CONNECT
+ *
+ * payload布局：[会话令牌（有令牌时自动添加VTX_FLAG_RESUME）][URL（VTX_FLAG_START）]
+ */
+static int vtx_rx_send_connect(
+    vtx_rx_t* rx,
+    uint8_t flags,
+    const uint8_t* url,
+    size_t url_len)
+{
+    uint8_t payload[VTX_SESSION_TOKEN_SIZE + VTX_MAX_URL_SIZE];
+    size_t size = 0;
 
-            vtx_spinlock_unlock(&rx->data_queue->lock);
+    if (rx->session_token != 0) {
+        flags |= VTX_FLAG_RESUME;
+        vtx_session_pack_token(rx->session_token, payload);
+        size = VTX_SESSION_TOKEN_SIZE;
+    }
+    if (url_len > 0) {
+        memcpy(payload + size, url, url_len);
+        size += url_len;
+    }
 
-            vtx_send_packet(rx, &header, frame->data, frame->data_size);
+    vtx_packet_header_t header = {0};
+    header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
+    header.frame_type = VTX_DATA_CONNECT;
+    header.flags = flags;
+    if (rx->crypto) {
+        header.flags |= VTX_FLAG_CRYPT;
+    }
 
-            vtx_spinlock_lock(&rx->data_queue->lock);
-        }
+    rx->connect_send_ms = vtx_get_time_ms();
+    rx->connecting = true;
+    /* 发送端可能重发缓存的I帧（同vtx_rx_send_start，复位交给poll线程） */
+    atomic_store(&rx->fid_reset_pending, true);
+    int ret = vtx_send_packet(rx, &header, size > 0 ? payload : NULL, size);
+    if (ret != VTX_OK) {
+        rx->connecting = false;
+        vtx_log_error("Failed to send CONNECT: %d", ret);
+        return ret;
     }
 
-    vtx_spinlock_unlock(&rx->data_queue->lock);
+    vtx_log_info("Sent CONNECT to server%s%s",
+                (flags & VTX_FLAG_START) ? " (with START)" : "",
+                (flags & VTX_FLAG_RESUME) ? " (resume)" : "");
+    return VTX_OK;
 }
 
 /**
- * @brief 接收并处理数据包
+ * @brief 注入的CONNECTED是否开始了新会话
+ *
+ * 抓包回放时本端没有发出CONNECT：令牌或加密盐与当前不同的CONNECTED视为新会话，
+ * 相同则为重传
  */
-static int vtx_recv_packet(vtx_rx_t* rx) {
-    uint8_t buf[VTX_DEFAULT_MTU];
-    struct sockaddr_in from_addr;
-    socklen_t from_len = sizeof(from_addr);
+static bool vtx_rx_injected_session(vtx_rx_t* rx, const uint8_t* buf, ssize_t n) {
+    if (!rx->injecting) {
+        return false;
+    }
+    if (!rx->connected) {
+        return true;
+    }
 
-    ssize_t n = recvfrom(rx->sockfd, buf, sizeof(buf), 0,
-                         (struct sockaddr*)&from_addr, &from_len);
-    if (n < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return 0;  /* 无数据 */
-        }
-        return VTX_ERR_SOCKET_RECV;
+    const uint8_t* payload = buf + VTX_PACKET_HEADER_SIZE;
+    uint64_t token = 0;
+    if (n - VTX_PACKET_HEADER_SIZE >= VTX_SESSION_TOKEN_SIZE) {
+        token = vtx_session_unpack_token(payload);
     }
+    if (token != rx->session_token) {
+        return true;
+    }
+    return rx->crypto &&
+           vtx_crypto_unpack_salt(payload + VTX_SESSION_TOKEN_SIZE) != rx->crypt_salt;
+}
 
+/**
+ * @brief 处理一个收到的数据报
+ */
+static int vtx_rx_process_packet(vtx_rx_t* rx, uint8_t* buf, ssize_t n,
+                                 const struct sockaddr_in* from) {
     if (n < VTX_PACKET_HEADER_SIZE) {
         return VTX_ERR_PACKET_INVALID;
     }
 
+    vtx_rx_apply_fid_reset(rx);
+
     /* 反序列化包头 */
     vtx_packet_header_t header;
     memcpy(&header, buf, sizeof(header));
@@ -428,9 +1061,23 @@ static int vtx_recv_packet(vtx_rx_t* rx) {
         return ret;
     }
 
-    /* 验证CRC */
-    if (!vtx_packet_verify(buf, buf + VTX_PACKET_HEADER_SIZE,
-                          n - VTX_PACKET_HEADER_SIZE)) {
+    /* 加密会话只接受加密的媒体分片，反之亦然 */
+    bool media = header.frame_type >= VTX_FRAME_I &&
+                 header.frame_type <= VTX_FRAME_A;
+    bool sealed = media && (header.flags & VTX_FLAG_CRYPT);
+    if (media && sealed != (rx->crypto != NULL)) {
+        vtx_log_warn("Media packet encryption mismatch: seq=%u flags=0x%02x",
+                    header.seq_num, header.flags);
+        vtx_spinlock_lock(&rx->stats_lock);
+        rx->stats.auth_failures++;
+        vtx_spinlock_unlock(&rx->stats_lock);
+        return VTX_ERR_CHECKSUM;
+    }
+
+    /* 验证CRC（加密分片由重组后的GCM标签验证，带帧哈希的分片只校验包头） */
+    size_t crc_size = (media && (header.flags & VTX_FLAG_HASH)) ?
+                      0 : (size_t)(n - VTX_PACKET_HEADER_SIZE);
+    if (!sealed && !vtx_packet_verify(buf, buf + VTX_PACKET_HEADER_SIZE, crc_size)) {
         vtx_log_warn("CRC verification failed: type=%u seq=%u size=%zd",
                     header.frame_type, header.seq_num, n);
         return VTX_ERR_CHECKSUM;
@@ -441,38 +1088,76 @@ static int vtx_recv_packet(vtx_rx_t* rx) {
         return VTX_ERR_PACKET_INVALID;
     }
 
-    /* 检测丢包 */
-    uint32_t last_seq = atomic_load(&rx->last_recv_seq);
-    if (last_seq > 0 && header.seq_num > last_seq + 1) {
-        uint32_t lost = header.seq_num - last_seq - 1;
-        vtx_spinlock_lock(&rx->stats_lock);
-        rx->stats.lost_packets += lost;
-        vtx_spinlock_unlock(&rx->stats_lock);
+    /* payload_size不能超过实际收到的数据（单分片帧直接从buf交付） */
+    if (header.payload_size > n - VTX_PACKET_HEADER_SIZE) {
+        vtx_log_warn("Truncated packet: payload_size=%u received=%zd",
+                    header.payload_size, n - VTX_PACKET_HEADER_SIZE);
+        return VTX_ERR_PACKET_INVALID;
     }
-    atomic_store(&rx->last_recv_seq, header.seq_num);
 
-    /* 发送ACK（对任意包都ACK） */
-    vtx_send_ack(rx, header.frame_id);
+    /* 检测丢包（重传沿用原seq，只在seq前进时更新） */
+    uint32_t last_seq = atomic_load(&rx->last_recv_seq);
+    int32_t seq_delta = (int32_t)(header.seq_num - last_seq);
+    if (last_seq == 0 || seq_delta > 0) {
+        if (last_seq > 0 && seq_delta > 1) {
+            vtx_spinlock_lock(&rx->stats_lock);
+            rx->stats.lost_packets += (uint32_t)(seq_delta - 1);
+            vtx_spinlock_unlock(&rx->stats_lock);
+        }
+        atomic_store(&rx->last_recv_seq, header.seq_num);
+    }
 
     /* 使用状态机处理不同类型的包 */
-    if (header.frame_type >= VTX_FRAME_I && header.frame_type <= VTX_FRAME_A) {
+    if (media) {
         /* 媒体帧分片 */
-        return vtx_handle_fragment(rx, &header, buf + VTX_PACKET_HEADER_SIZE);
+        return vtx_handle_fragment(rx, &header, buf + VTX_PACKET_HEADER_SIZE,
+                                   from);
     }
 
     switch (header.frame_type) {
-    case VTX_DATA_ACK: {
-        /* ACK包，从data_queue中移除对应的frame */
-        vtx_frame_t* frame = vtx_frame_queue_find(rx->data_queue,
-                                                   header.frame_id);
-        if (frame) {
-            vtx_frame_queue_remove(rx->data_queue, frame);
-            vtx_frame_release(rx->data_pool, frame);
+    case VTX_DATA_ACK:
+        /* 发送端额外路径的心跳ACK（携带会话令牌）：登记路径地址 */
+        if (header.frame_id == 0 && rx->session_token != 0 &&
+            n - VTX_PACKET_HEADER_SIZE >= VTX_SESSION_TOKEN_SIZE) {
+            if (vtx_session_unpack_token(buf + VTX_PACKET_HEADER_SIZE) ==
+                rx->session_token) {
+                vtx_rx_learn_path(rx, from);
+            }
+            break;
         }
+
+        /* ACK包，释放DATA窗口中对应的槽位 */
+        vtx_data_window_ack(&rx->data_win, header.frame_id,
+                            vtx_get_time_ms(), NULL);
         break;
-    }
 
     case VTX_DATA_CONNECTED: {
+        /* 无状态CONNECTED（发送端开启handshake_cookie）：
+         * 以cookie为令牌重新CONNECT，不ACK */
+        if (header.flags & VTX_FLAG_COOKIE) {
+            if (!rx->connecting ||
+                n - VTX_PACKET_HEADER_SIZE < VTX_SESSION_TOKEN_SIZE) {
+                break;
+            }
+            rx->session_token = vtx_session_unpack_token(buf + VTX_PACKET_HEADER_SIZE);
+            vtx_log_info("Received handshake cookie, reconnecting");
+            if (rx->start_pending) {
+                vtx_rx_send_connect(rx, VTX_FLAG_START,
+                                    rx->start_url, rx->start_url_len);
+            } else {
+                vtx_rx_send_connect(rx, 0, NULL, 0);
+            }
+            break;
+        }
+
+        /* 加密协商：发送端未回显VTX_FLAG_CRYPT（未配置密钥）时不建立连接 */
+        if (rx->crypto &&
+            (!(header.flags & VTX_FLAG_CRYPT) ||
+             n - VTX_PACKET_HEADER_SIZE < VTX_SESSION_TOKEN_SIZE + VTX_CRYPTO_SALT_SIZE)) {
+            vtx_log_error("Server does not support encryption, CONNECTED ignored");
+            break;
+        }
+
         /* 收到CONNECTED帧，发送ACK完成3次握手 */
         vtx_log_info("Received CONNECTED from server");
 
@@ -483,17 +1168,95 @@ static int vtx_recv_packet(vtx_rx_t* rx) {
         ack_header.frame_type = VTX_DATA_ACK;
         vtx_send_packet(rx, &ack_header, NULL, 0);
 
-        /* 设置连接状态 */
-        rx->connected = true;
+        /* CONNECT → CONNECTED 作为RTT样本 */
+        if (rx->connect_send_ms > 0) {
+            vtx_sockbuf_note_rtt(&rx->rcvbuf,
+                (uint32_t)(vtx_get_time_ms() - rx->connect_send_ms));
+            rx->connect_send_ms = 0;
+        }
+
+        /* 重传的CONNECTED只需再次ACK（注入的新会话CONNECTED例外，回放需要其令牌和盐） */
+        if (!rx->connecting && !vtx_rx_injected_session(rx, buf, n)) {
+            break;
+        }
+        rx->connecting = false;
+
+        /* 保存会话令牌（旧版本发送端不携带） */
+        uint64_t old_token = rx->session_token;
+        if (n - VTX_PACKET_HEADER_SIZE >= VTX_SESSION_TOKEN_SIZE) {
+            rx->session_token = vtx_session_unpack_token(buf + VTX_PACKET_HEADER_SIZE);
+        } else {
+            rx->session_token = 0;
+        }
+        if (rx->session_token != old_token) {
+            rx->path_addr_count = 0;  /* 新会话的路径需重新登记 */
+        }
+        if (rx->crypto) {
+            rx->crypt_salt = vtx_crypto_unpack_salt(
+                buf + VTX_PACKET_HEADER_SIZE + VTX_SESSION_TOKEN_SIZE);
+        }
+
+        bool resumed = (header.flags & VTX_FLAG_RESUME) != 0;
+        if (resumed) {
+            vtx_log_info("Session resumed");
+        } else {
+            /* 新会话（发送端可能已重启）：重新开始丢包检测和帧ID窗口 */
+            atomic_store(&rx->last_recv_seq, 0);
+            vtx_fid_window_reset(&rx->fid_win);
+        }
+
+        /* 设置连接状态（重连时连接回调只在状态变化时调用） */
         rx->last_heartbeat_send_ms = vtx_get_time_ms();
+        if (!rx->connected) {
+            rx->connected = true;
+
+            /* 调用连接回调 */
+            if (rx->connect_fn) {
+                VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_CONNECT, 1, 0);
+                rx->connect_fn(true, rx->userdata);
+                VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_CONNECT, 0);
+            }
+        }
 
-        /* 调用连接回调 */
-        if (rx->connect_fn) {
-            rx->connect_fn(true, rx->userdata);
+        /* 会话未恢复（宽限期已过或发送端重启）：媒体状态丢失，重新START */
+        if (!resumed && rx->media_active && !rx->start_pending) {
+            vtx_log_info("Session not resumed, restarting media");
+            vtx_rx_send_start(rx, rx->start_url, rx->start_url_len);
+        }
+
+        /* 0-RTT START：发送端未回显标志（旧版本），回退为单独的START */
+        if (rx->start_pending) {
+            rx->start_pending = false;
+            if (header.flags & VTX_FLAG_START) {
+                vtx_log_info("Server accepted START with CONNECT (0-RTT)");
+            } else {
+                vtx_log_info("Server ignored START in CONNECT, sending START");
+                vtx_rx_send_start(rx, rx->start_url, rx->start_url_len);
+            }
         }
         break;
     }
 
+    case VTX_DATA_PROBE: {
+        /* 路径探测（本端地址变化）：用会话令牌应答，发送端验证后迁移 */
+        if (rx->session_token == 0 ||
+            n - VTX_PACKET_HEADER_SIZE < VTX_SESSION_TOKEN_SIZE) {
+            break;
+        }
+
+        uint8_t payload[2 * VTX_SESSION_TOKEN_SIZE];
+        vtx_session_pack_token(rx->session_token, payload);
+        memcpy(payload + VTX_SESSION_TOKEN_SIZE, buf + VTX_PACKET_HEADER_SIZE,
+               VTX_SESSION_TOKEN_SIZE);
+
+        vtx_packet_header_t probe_header = {0};
+        probe_header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
+        probe_header.frame_type = VTX_DATA_PROBE_ACK;
+        vtx_send_packet(rx, &probe_header, payload, sizeof(payload));
+        vtx_log_info("Answered path probe from server");
+        break;
+    }
+
     case VTX_DATA_DISCONNECT: {
         /* 断开连接请求：发送ACK并断开 */
         vtx_log_info("Disconnect request from server");
@@ -505,24 +1268,34 @@ static int vtx_recv_packet(vtx_rx_t* rx) {
         ack_header.frame_type = VTX_DATA_ACK;
         vtx_send_packet(rx, &ack_header, NULL, 0);
 
-        /* 断开连接 */
+        /* 断开连接（主动断开不保留会话） */
         rx->connected = false;
         rx->last_heartbeat_send_ms = 0;
+        rx->session_token = 0;
+        rx->media_active = false;
 
         /* 调用连接回调 */
         if (rx->connect_fn) {
+            VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_CONNECT, 0, 0);
             rx->connect_fn(false, rx->userdata);
+            VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_CONNECT, 0);
         }
         break;
     }
 
     case VTX_DATA_USER:
-        /* 数据包 */
+        /* 数据包，发送ACK（TX端可靠发送） */
+        vtx_send_ack(rx, header.frame_id);
+
         if (rx->data_fn) {
-            rx->data_fn(VTX_DATA_USER,
-                       buf + VTX_PACKET_HEADER_SIZE,
-                       n - VTX_PACKET_HEADER_SIZE,
-                       rx->userdata);
+            VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_DATA, VTX_DATA_USER,
+                                     n - VTX_PACKET_HEADER_SIZE);
+            int cb_ret = rx->data_fn(VTX_DATA_USER,
+                                     buf + VTX_PACKET_HEADER_SIZE,
+                                     n - VTX_PACKET_HEADER_SIZE,
+                                     rx->userdata);
+            VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_DATA, cb_ret);
+            (void)cb_ret;
         }
         break;
 
@@ -534,6 +1307,52 @@ static int vtx_recv_packet(vtx_rx_t* rx) {
     return 1;  /* 处理了一个包 */
 }
 
+/**
+ * @brief 接收并处理数据包
+ */
+static int vtx_recv_packet(vtx_rx_t* rx) {
+    uint8_t buf[VTX_DEFAULT_MTU];
+    struct sockaddr_in from_addr;
+    uint8_t cmsg_buf[CMSG_SPACE(sizeof(uint32_t))];
+
+    struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &from_addr;
+    msg.msg_namelen = sizeof(from_addr);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsg_buf;
+    msg.msg_controllen = sizeof(cmsg_buf);
+
+    ssize_t n = recvmsg(rx->sockfd, &msg, 0);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;  /* 无数据 */
+        }
+        return VTX_ERR_SOCKET_RECV;
+    }
+
+#ifdef SO_RXQ_OVFL
+    /* 内核累计丢包数（socket接收缓冲区溢出） */
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t drops;
+            memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            vtx_spinlock_lock(&rx->stats_lock);
+            rx->stats.kernel_drops = drops;
+            vtx_spinlock_unlock(&rx->stats_lock);
+        }
+    }
+#endif
+
+    iov.iov_len = (size_t)n;
+    vtx_pcap_write(rx->capture, rx->sockfd, VTX_PCAP_DIR_IN, &from_addr, &iov, 1);
+
+    return vtx_rx_process_packet(rx, buf, n, &from_addr);
+}
+
 /* ========== 公共API ========== */
 
 vtx_rx_t* vtx_rx_create(
@@ -572,13 +1391,45 @@ vtx_rx_t* vtx_rx_create(
         rx->config.heartbeat_interval_ms = VTX_DEFAULT_HEARTBEAT_INTERVAL_MS;
     }
 
+    /* 载荷加密 */
+    if (rx->config.crypto_key) {
+        rx->crypto = vtx_crypto_create(rx->config.crypto_key);
+        if (!rx->crypto) {
+            vtx_free(rx);
+            return NULL;
+        }
+    }
+
+    /* 录制 */
+    if (rx->config.record_path) {
+        if (rx->config.record_segment_size == 0) {
+            rx->config.record_segment_size = VTX_DEFAULT_RECORD_SEGMENT_SIZE;
+        } else if (rx->config.record_segment_size < VTX_MIN_RECORD_SEGMENT_SIZE) {
+            rx->config.record_segment_size = VTX_MIN_RECORD_SEGMENT_SIZE;
+        }
+        rx->recorder = vtx_recorder_create(rx->config.record_path,
+                                           rx->config.record_segment_size);
+        if (!rx->recorder) {
+            vtx_crypto_destroy(rx->crypto);
+            vtx_free(rx);
+            return NULL;
+        }
+        rx->config.record_path = NULL;  /* 不保留调用者的字符串 */
+    }
+
     /* 创建socket */
     rx->sockfd = vtx_create_socket();
     if (rx->sockfd < 0) {
+        vtx_recorder_destroy(rx->recorder);
+        vtx_crypto_destroy(rx->crypto);
         vtx_free(rx);
         return NULL;
     }
 
+    /* 设置接收缓冲区（失败时保留系统默认值） */
+    vtx_sockbuf_init(&rx->rcvbuf, rx->sockfd, false, rx->config.recv_buf_size);
+    rx->stats.sock_buf_size = rx->rcvbuf.actual;
+
     /* 解析服务器地址 */
     rx->server_addr.sin_family = AF_INET;
     rx->server_addr.sin_port = htons(config->server_port);
@@ -586,6 +1437,8 @@ vtx_rx_t* vtx_rx_create(
                   &rx->server_addr.sin_addr) <= 0) {
         vtx_log_error("Invalid server address: %s", config->server_addr);
         close(rx->sockfd);
+        vtx_recorder_destroy(rx->recorder);
+        vtx_crypto_destroy(rx->crypto);
         vtx_free(rx);
         return NULL;
     }
@@ -594,34 +1447,65 @@ vtx_rx_t* vtx_rx_create(
     /* 创建内存池 */
     rx->media_pool = vtx_frame_pool_create(VTX_FRAME_POOL_INIT_SIZE,
                                            VTX_MEDIA_FRAME_DATA_SIZE);
-    rx->data_pool = vtx_frame_pool_create(VTX_FRAME_POOL_INIT_SIZE * 4,
-                                          VTX_CTRL_FRAME_DATA_SIZE);
     rx->frag_pool = vtx_frag_pool_create();
-    if (!rx->media_pool || !rx->data_pool || !rx->frag_pool) {
+    if (!rx->media_pool || !rx->frag_pool) {
         vtx_log_error("Failed to create frame pools");
         if (rx->media_pool) vtx_frame_pool_destroy(rx->media_pool);
-        if (rx->data_pool) vtx_frame_pool_destroy(rx->data_pool);
         if (rx->frag_pool) vtx_frag_pool_destroy(rx->frag_pool);
         close(rx->sockfd);
+        vtx_recorder_destroy(rx->recorder);
+        vtx_crypto_destroy(rx->crypto);
         vtx_free(rx);
         return NULL;
     }
 
+    /* 时移环（单分片帧使用小容量帧池，避免占用512KB的媒体帧） */
+    if (rx->config.timeshift_ms > 0) {
+        if (rx->config.timeshift_bytes == 0) {
+            rx->config.timeshift_bytes = VTX_DEFAULT_TIMESHIFT_BYTES;
+        }
+        rx->small_pool = vtx_frame_pool_create(
+            VTX_FRAME_POOL_INIT_SIZE, rx->config.mtu - VTX_PACKET_HEADER_SIZE);
+        rx->shift_pool = vtx_frame_pool_create(VTX_FRAME_POOL_INIT_SIZE, 0);
+        rx->timeshift = vtx_timeshift_create(rx->config.timeshift_ms,
+                                             rx->config.timeshift_bytes);
+        if (!rx->small_pool || !rx->shift_pool || !rx->timeshift) {
+            vtx_log_error("Failed to create time-shift ring");
+            vtx_timeshift_destroy(rx->timeshift);
+            if (rx->small_pool) vtx_frame_pool_destroy(rx->small_pool);
+            if (rx->shift_pool) vtx_frame_pool_destroy(rx->shift_pool);
+            vtx_frame_pool_destroy(rx->media_pool);
+            vtx_frag_pool_destroy(rx->frag_pool);
+            close(rx->sockfd);
+            vtx_recorder_destroy(rx->recorder);
+            vtx_crypto_destroy(rx->crypto);
+            vtx_free(rx);
+            return NULL;
+        }
+    }
+
     /* 创建队列 */
     rx->recv_queue = vtx_frame_queue_create(
-        rx->media_pool, rx->config.frame_timeout_ms);
-    rx->data_queue = vtx_frame_queue_create(rx->data_pool, 0);
-    if (!rx->recv_queue || !rx->data_queue) {
+        rx->media_pool, rx->frag_pool, rx->config.frame_timeout_ms);
+    if (!rx->recv_queue) {
         vtx_log_error("Failed to create queues");
+        vtx_timeshift_destroy(rx->timeshift);
+        if (rx->small_pool) vtx_frame_pool_destroy(rx->small_pool);
+        if (rx->shift_pool) vtx_frame_pool_destroy(rx->shift_pool);
         vtx_frame_pool_destroy(rx->media_pool);
-        vtx_frame_pool_destroy(rx->data_pool);
-        if (rx->recv_queue) vtx_frame_queue_destroy(rx->recv_queue);
-        if (rx->data_queue) vtx_frame_queue_destroy(rx->data_queue);
+        vtx_frag_pool_destroy(rx->frag_pool);
         close(rx->sockfd);
+        vtx_recorder_destroy(rx->recorder);
+        vtx_crypto_destroy(rx->crypto);
         vtx_free(rx);
         return NULL;
     }
 
+    /* 初始化DATA窗口和帧ID窗口 */
+    vtx_data_window_init(&rx->data_win);
+    vtx_fid_window_reset(&rx->fid_win);
+    atomic_init(&rx->fid_reset_pending, false);
+
     /* 初始化锁 */
     vtx_spinlock_init(&rx->iframe_lock);
     vtx_spinlock_init(&rx->stats_lock);
@@ -634,6 +1518,12 @@ vtx_rx_t* vtx_rx_create(
 
     rx->running = true;
 
+    /* 抓包（失败不影响收发） */
+    if (rx->config.capture_path) {
+        rx->capture = vtx_pcap_open(rx->config.capture_path);
+        rx->config.capture_path = NULL;  /* 不保留调用者的字符串 */
+    }
+
     vtx_log_info("RX created: server=%s:%u mtu=%u",
                 config->server_addr, config->server_port, rx->config.mtu);
 
@@ -645,22 +1535,58 @@ int vtx_rx_connect(vtx_rx_t* rx) {
         return VTX_ERR_INVALID_PARAM;
     }
 
-    /* 发送连接请求 */
-    vtx_packet_header_t header = {0};
-    header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
-    header.frame_type = VTX_DATA_CONNECT;
+    rx->start_pending = false;
 
-    int ret = vtx_send_packet(rx, &header, NULL, 0);
+    /* 不在这里等待响应，让poll线程接收CONNECTED响应
+     * 连接状态变化会通过connect_fn回调通知应用层 */
+    return vtx_rx_send_connect(rx, 0, NULL, 0);
+}
+
+int vtx_rx_connect_start(vtx_rx_t* rx, const char* url) {
+    if (!rx) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 保存URL：发送端不支持0-RTT时，收到CONNECTED后再单独发送START */
+    rx->start_url_len = vtx_rx_pack_url(url, rx->start_url);
+    rx->start_pending = true;
+
+    int ret = vtx_rx_send_connect(rx, VTX_FLAG_START,
+                                  rx->start_url, rx->start_url_len);
     if (ret != VTX_OK) {
-        vtx_log_error("Failed to send CONNECT: %d", ret);
+        rx->start_pending = false;
         return ret;
     }
+    rx->media_active = true;
+    return VTX_OK;
+}
 
-    vtx_log_info("Sent CONNECT to server");
+/**
+ * @brief 自动调整接收缓冲区（仅recv_buf_size为VTX_SOCKBUF_AUTO时生效）
+ */
+static void vtx_rx_update_sockbuf(vtx_rx_t* rx) {
+    if (rx->rcvbuf.configured != VTX_SOCKBUF_AUTO) {
+        return;
+    }
 
-    /* 不在这里等待响应，让poll线程接收CONNECTED响应
-     * 连接状态变化会通过connect_fn回调通知应用层 */
-    return VTX_OK;
+    vtx_spinlock_lock(&rx->stats_lock);
+    uint64_t total_bytes = rx->stats.total_bytes;
+    vtx_spinlock_unlock(&rx->stats_lock);
+
+    if (vtx_sockbuf_update(&rx->rcvbuf, rx->sockfd, false,
+                           total_bytes, vtx_get_time_ms())) {
+        vtx_spinlock_lock(&rx->stats_lock);
+        rx->stats.sock_buf_size = rx->rcvbuf.actual;
+        vtx_spinlock_unlock(&rx->stats_lock);
+    }
+}
+
+int vtx_rx_apply_thread_config(vtx_rx_t* rx) {
+    if (!rx) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    return vtx_thread_apply(&rx->config.thread, rx->sockfd);
 }
 
 int vtx_rx_poll(vtx_rx_t* rx, uint32_t timeout_ms) {
@@ -680,6 +1606,8 @@ int vtx_rx_poll(vtx_rx_t* rx, uint32_t timeout_ms) {
     int ret = select(rx->sockfd + 1, &readfds, NULL, NULL,
                     timeout_ms > 0 ? &tv : NULL);
 
+    vtx_rx_update_sockbuf(rx);
+
     static int first_time = 1;
     if (first_time) {
         vtx_log_info("RX poll using sockfd=%d", rx->sockfd);
@@ -695,37 +1623,10 @@ int vtx_rx_poll(vtx_rx_t* rx, uint32_t timeout_ms) {
     }
 
     if (ret == 0) {
-        /* 超时：处理重传队列和清理超时帧 */
-        vtx_process_retrans_queue(rx);
-
-        if (rx->recv_queue) {
-            size_t cleaned = vtx_frame_queue_cleanup_timeout(
-                rx->recv_queue, vtx_get_time_ms());
-            if (cleaned > 0) {
-                vtx_spinlock_lock(&rx->stats_lock);
-                rx->stats.incomplete_frames += cleaned;
-                vtx_spinlock_unlock(&rx->stats_lock);
-                vtx_log_debug("Cleaned %zu timeout frames", cleaned);
-            }
-        }
-
-        /* 发送心跳（连接建立后） */
-        if (rx->connected && rx->last_heartbeat_send_ms > 0) {
-            uint64_t now_ms = vtx_get_time_ms();
-            uint64_t elapsed = now_ms - rx->last_heartbeat_send_ms;
-
-            if (elapsed >= rx->config.heartbeat_interval_ms) {
-                /* 发送心跳 */
-                vtx_packet_header_t hb_header = {0};
-                hb_header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
-                hb_header.frame_id = 0;
-                hb_header.frame_type = VTX_DATA_HEARTBEAT;
-                vtx_send_packet(rx, &hb_header, NULL, 0);
-
-                rx->last_heartbeat_send_ms = now_ms;
-                vtx_log_debug("Heartbeat sent");
-            }
-        }
+        /* 超时：处理重传队列、心跳和清理超时帧 */
+        uint64_t now_ms = vtx_get_time_ms();
+        vtx_rx_process_timers(rx, now_ms);
+        vtx_rx_cleanup_frames(rx, now_ms);
 
         /* 检查连接状态 */
         if (!rx->running) {
@@ -736,14 +1637,46 @@ int vtx_rx_poll(vtx_rx_t* rx, uint32_t timeout_ms) {
     }
 
     /* 处理接收到的数据 */
-    return vtx_recv_packet(rx);
+    ret = vtx_recv_packet(rx);
+
+    /* 持续有数据时select不会超时，按截止时刻重传、发送心跳和清理超时帧
+     * （接收端过载发送LIMIT时正是这种情况） */
+    uint64_t now_ms = vtx_get_time_ms();
+    if (now_ms >= rx->timer_deadline_ms) {
+        vtx_rx_process_timers(rx, now_ms);
+    }
+    if (now_ms >= rx->cleanup_deadline_ms) {
+        vtx_rx_cleanup_frames(rx, now_ms);
+    }
+    return ret;
 }
 
-int vtx_rx_send(vtx_rx_t* rx, const uint8_t* data, size_t size) {
-    if (!rx || !data || size == 0) {
+int vtx_rx_inject_packet(vtx_rx_t* rx, const uint8_t* data, size_t size) {
+    if (!rx || !data) {
         return VTX_ERR_INVALID_PARAM;
     }
+    if (size > VTX_DEFAULT_MTU) {
+        return VTX_ERR_PACKET_TOO_LARGE;
+    }
 
+    /* 与socket接收相同：单分片帧可能直接从缓冲区交付 */
+    uint8_t buf[VTX_DEFAULT_MTU];
+    memcpy(buf, data, size);
+    rx->injecting = true;
+    int ret = vtx_rx_process_packet(rx, buf, (ssize_t)size, &rx->server_addr);
+    rx->injecting = false;
+    return ret;
+}
+
+/**
+ * @brief 可靠发送一个数据帧（加入DATA窗口等待ACK，超时重传）
+ */
+static int vtx_rx_send_reliable(
+    vtx_rx_t* rx,
+    vtx_data_type_t data_type,
+    const uint8_t* data,
+    size_t size)
+{
     if (!rx->connected) {
         return VTX_ERR_NOT_READY;
     }
@@ -752,79 +1685,84 @@ int vtx_rx_send(vtx_rx_t* rx, const uint8_t* data, size_t size) {
         return VTX_ERR_PACKET_TOO_LARGE;
     }
 
-    /* 创建DATA帧 */
-    vtx_frame_t* frame = vtx_frame_pool_acquire(rx->data_pool);
-    if (!frame) {
-        return VTX_ERR_NO_MEMORY;
+    /* 预留DATA窗口槽位（不分配内存） */
+    uint16_t frame_id = atomic_fetch_add(&rx->frame_id, 1);
+    vtx_data_slot_t* slot = vtx_data_window_reserve(&rx->data_win, frame_id,
+                                                    (uint8_t)data_type,
+                                                    data, size);
+    if (!slot) {
+        vtx_log_warn("DATA window full: frame_id=%u", frame_id);
+        return VTX_ERR_BUSY;
     }
 
-    frame->frame_id = atomic_fetch_add(&rx->frame_id, 1);
-    frame->frame_type = (vtx_frame_type_t)VTX_DATA_USER;
-    frame->data_size = size;
-    memcpy(frame->data, data, size);
-    frame->send_time_ms = vtx_get_time_ms();
-
     /* 发送 */
     vtx_packet_header_t header = {0};
     header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
-    header.frame_id = frame->frame_id;
-    header.frame_type = VTX_DATA_USER;
+    header.frame_id = frame_id;
+    header.frame_type = data_type;
     header.frag_index = 0;
     header.total_frags = 1;
     header.payload_size = size;
 
-    int ret = vtx_send_packet(rx, &header, frame->data, size);
+    /* 先提交再发送，避免ACK先于提交到达而被忽略 */
+    vtx_data_window_commit(slot, vtx_get_time_ms());
+
+    int ret = vtx_send_packet(rx, &header, slot->data, size);
     if (ret != VTX_OK) {
-        vtx_frame_release(rx->data_pool, frame);
+        vtx_data_window_cancel(slot);
         return ret;
     }
 
-    /* 加入data队列等待ACK */
-    vtx_frame_queue_push(rx->data_queue, frame);
-    vtx_frame_release(rx->data_pool, frame);
-
     return VTX_OK;
 }
 
-int vtx_rx_start(vtx_rx_t* rx, const char* url) {
-    if (!rx) {
+int vtx_rx_send(vtx_rx_t* rx, const uint8_t* data, size_t size) {
+    if (!rx || !data || size == 0) {
         return VTX_ERR_INVALID_PARAM;
     }
 
-    if (!rx->connected) {
-        return VTX_ERR_NOT_READY;
-    }
-
-    /* 准备URL数据（最大100字节，超过部分截断） */
-    uint8_t url_buf[VTX_MAX_URL_SIZE];
-    size_t url_len = 0;
+    return vtx_rx_send_reliable(rx, VTX_DATA_USER, data, size);
+}
 
-    if (url && url[0] != '\0') {
-        url_len = strlen(url);
-        if (url_len >= VTX_MAX_URL_SIZE) {
-            url_len = VTX_MAX_URL_SIZE - 1;  /* 保留一个字节给'\0' */
-            vtx_log_warn("URL truncated from %zu to %zu bytes", strlen(url), url_len);
-        }
-        memcpy(url_buf, url, url_len);
-        url_buf[url_len] = '\0';
-        url_len++;  /* 包含'\0' */
+int vtx_rx_set_limits(vtx_rx_t* rx, const vtx_limits_t* limits) {
+    if (!rx || !limits) {
+        return VTX_ERR_INVALID_PARAM;
     }
 
-    /* 发送START控制帧，携带URL参数 */
-    vtx_packet_header_t header = {0};
-    header.seq_num = atomic_fetch_add(&rx->seq_num, 1);
-    header.frame_type = VTX_DATA_START;
+    uint8_t payload[VTX_LIMITS_WIRE_SIZE];
+    vtx_packet_pack_limits(limits, payload, sizeof(payload));
 
-    int ret = vtx_send_packet(rx, &header, url_len > 0 ? url_buf : NULL, url_len);
+    int ret = vtx_rx_send_reliable(rx, VTX_DATA_LIMIT, payload, sizeof(payload));
     if (ret != VTX_OK) {
-        vtx_log_error("Failed to send START: %d", ret);
+        vtx_log_error("Failed to send LIMIT: %d", ret);
         return ret;
     }
 
-    vtx_log_info("Sent START request to server");
+    vtx_log_info("Sent LIMIT: bitrate=%ukbps fps=%u frame_size=%u resolution=%ux%u",
+                limits->max_bitrate_kbps, limits->max_fps,
+                limits->max_frame_size, limits->max_width, limits->max_height);
     return VTX_OK;
 }
 
+int vtx_rx_start(vtx_rx_t* rx, const char* url) {
+    if (!rx) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    if (!rx->connected) {
+        return VTX_ERR_NOT_READY;
+    }
+
+    /* 准备URL数据（最大100字节，超过部分截断），发送START控制帧
+     * URL保存下来，会话失效重连后自动重新START */
+    rx->start_url_len = vtx_rx_pack_url(url, rx->start_url);
+    int ret = vtx_rx_send_start(rx, rx->start_url, rx->start_url_len);
+    if (ret == VTX_OK) {
+        rx->media_active = true;
+    }
+    return ret;
+}
+
 int vtx_rx_stop(vtx_rx_t* rx) {
     if (!rx) {
         return VTX_ERR_INVALID_PARAM;
@@ -845,6 +1783,7 @@ int vtx_rx_stop(vtx_rx_t* rx) {
         return ret;
     }
 
+    rx->media_active = false;
     vtx_log_info("Sent STOP request to server");
     return VTX_OK;
 }
@@ -863,14 +1802,42 @@ int vtx_rx_close(vtx_rx_t* rx) {
 
         rx->connected = false;
         if (rx->connect_fn) {
+            VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_CONNECT, 0, 0);
             rx->connect_fn(false, rx->userdata);
+            VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_CONNECT, 0);
         }
         vtx_log_info("Connection closed");
     }
 
+    /* 主动关闭不保留会话 */
+    rx->session_token = 0;
+    rx->media_active = false;
+    rx->connecting = false;
+
     return VTX_OK;
 }
 
+int vtx_rx_replay(
+    vtx_rx_t* rx,
+    uint32_t offset_ms,
+    vtx_on_frame_fn frame_fn,
+    void* userdata)
+{
+    if (!rx || !frame_fn) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+    if (!rx->timeshift) {
+        return VTX_ERR_NOT_SUPPORTED;
+    }
+
+    uint64_t since_ms = UINT64_MAX;
+    if (offset_ms > 0) {
+        uint64_t now_ms = vtx_get_time_ms();
+        since_ms = now_ms > offset_ms ? now_ms - offset_ms : 0;
+    }
+    return vtx_timeshift_replay(rx->timeshift, since_ms, frame_fn, userdata);
+}
+
 int vtx_rx_get_stats(vtx_rx_t* rx, vtx_rx_stats_t* stats) {
     if (!rx || !stats) {
         return VTX_ERR_INVALID_PARAM;
@@ -880,6 +1847,15 @@ int vtx_rx_get_stats(vtx_rx_t* rx, vtx_rx_stats_t* stats) {
     *stats = rx->stats;
     vtx_spinlock_unlock(&rx->stats_lock);
 
+    vtx_frame_pool_stats_t pool_stats;
+    vtx_frame_pool_t* pools[] = { rx->media_pool, rx->small_pool, rx->shift_pool };
+    for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+        if (vtx_frame_pool_get_stats(pools[i], &pool_stats) == VTX_OK) {
+            stats->pool_frames += (uint32_t)pool_stats.total_frames;
+            stats->pool_used_frames += (uint32_t)pool_stats.used_frames;
+        }
+    }
+
     return VTX_OK;
 }
 
@@ -904,17 +1880,26 @@ void vtx_rx_destroy(vtx_rx_t* rx) {
 
     /* 销毁队列 */
     if (rx->recv_queue) vtx_frame_queue_destroy(rx->recv_queue);
-    if (rx->data_queue) vtx_frame_queue_destroy(rx->data_queue);
+
+    /* 释放时移环持有的帧（先于内存池） */
+    vtx_timeshift_destroy(rx->timeshift);
 
     /* 销毁内存池 */
+    if (rx->small_pool) vtx_frame_pool_destroy(rx->small_pool);
+    if (rx->shift_pool) vtx_frame_pool_destroy(rx->shift_pool);
     if (rx->media_pool) vtx_frame_pool_destroy(rx->media_pool);
-    if (rx->data_pool) vtx_frame_pool_destroy(rx->data_pool);
     if (rx->frag_pool) vtx_frag_pool_destroy(rx->frag_pool);
 
     /* 销毁锁 */
     vtx_spinlock_destroy(&rx->iframe_lock);
     vtx_spinlock_destroy(&rx->stats_lock);
 
+    vtx_crypto_destroy(rx->crypto);
+
+    /* 当前录制段收尾 */
+    vtx_recorder_destroy(rx->recorder);
+    vtx_pcap_close(rx->capture);
+
     /* 关闭socket */
     if (rx->sockfd >= 0) {
         close(rx->sockfd);
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_session.c
+ * @brief VTX Session Resumption Implementation
+ */
+
+#include "vtx_session.h"
+#include "vtx_log.h"
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
+/* ========== 辅助函数 ========== */
+
+/**
+ * @brief splitmix64（回退路径的混合函数）
+ */
+static uint64_t vtx_session_mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief SipHash-2-4
+ */
+#define VTX_ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define VTX_SIPROUND                                                \
+    do {                                                            \
+        v0 += v1; v1 = VTX_ROTL64(v1, 13); v1 ^= v0; v0 = VTX_ROTL64(v0, 32); \
+        v2 += v3; v3 = VTX_ROTL64(v3, 16); v3 ^= v2;                \
+        v0 += v3; v3 = VTX_ROTL64(v3, 21); v3 ^= v0;                \
+        v2 += v1; v1 = VTX_ROTL64(v1, 17); v1 ^= v2; v2 = VTX_ROTL64(v2, 32); \
+    } while (0)
+
+static uint64_t vtx_load_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+uint64_t vtx_siphash24(const uint8_t key[VTX_COOKIE_KEY_SIZE],
+                       const uint8_t* in, size_t len) {
+    uint64_t k0 = vtx_load_le64(key);
+    uint64_t k1 = vtx_load_le64(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    size_t blocks = len / 8;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t m = vtx_load_le64(in + i * 8);
+        v3 ^= m;
+        VTX_SIPROUND;
+        VTX_SIPROUND;
+        v0 ^= m;
+    }
+
+    /* 最后一块：剩余字节 + 长度 */
+    uint64_t b = (uint64_t)len << 56;
+    const uint8_t* tail = in + blocks * 8;
+    for (size_t i = 0; i < (len & 7); i++) {
+        b |= (uint64_t)tail[i] << (8 * i);
+    }
+    v3 ^= b;
+    VTX_SIPROUND;
+    VTX_SIPROUND;
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    VTX_SIPROUND;
+    VTX_SIPROUND;
+    VTX_SIPROUND;
+    VTX_SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * @brief 计算地址在指定时间片的cookie
+ */
+static uint64_t vtx_session_cookie_at(const uint8_t key[VTX_COOKIE_KEY_SIZE],
+                                      const struct sockaddr_in* addr,
+                                      uint64_t period) {
+    uint8_t msg[4 + 2 + 8];
+    memcpy(msg, &addr->sin_addr.s_addr, 4);
+    memcpy(msg + 4, &addr->sin_port, 2);
+    for (int i = 0; i < 8; i++) {
+        msg[6 + i] = (uint8_t)(period >> (8 * i));
+    }
+
+    uint64_t cookie = vtx_siphash24(key, msg, sizeof(msg));
+    return cookie != 0 ? cookie : 1;  /* 0保留表示无会话 */
+}
+
+/* ========== 公共函数 ========== */
+
+uint64_t vtx_session_random64(void) {
+    uint64_t value = 0;
+
+#if defined(__linux__)
+    if (getrandom(&value, sizeof(value), GRND_NONBLOCK) == (ssize_t)sizeof(value)) {
+        return value;
+    }
+#endif
+
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd >= 0) {
+        ssize_t n = read(fd, &value, sizeof(value));
+        close(fd);
+        if (n == (ssize_t)sizeof(value)) {
+            return value;
+        }
+    }
+
+    /* 回退：时间和进程号混合（不具备密码学强度） */
+    vtx_log_warn("No system random source, using time-based session token");
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return vtx_session_mix(((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec ^
+                           ((uint64_t)getpid() << 48));
+}
+
+void vtx_session_open(vtx_session_t* s) {
+    /* 0保留表示无会话 */
+    do {
+        s->token = vtx_session_random64();
+    } while (s->token == 0);
+    s->suspend_ms = 0;
+}
+
+void vtx_session_open_token(vtx_session_t* s, uint64_t token) {
+    s->token = token;
+    s->suspend_ms = 0;
+}
+
+void vtx_session_close(vtx_session_t* s) {
+    s->token = 0;
+    s->suspend_ms = 0;
+}
+
+void vtx_session_suspend(vtx_session_t* s, uint64_t now_ms) {
+    if (s->token != 0 && s->suspend_ms == 0) {
+        s->suspend_ms = now_ms;
+    }
+}
+
+bool vtx_session_resume(vtx_session_t* s, uint64_t token) {
+    if (s->token == 0 || token != s->token) {
+        return false;
+    }
+    s->suspend_ms = 0;
+    return true;
+}
+
+bool vtx_session_suspended(const vtx_session_t* s) {
+    return s->token != 0 && s->suspend_ms > 0;
+}
+
+bool vtx_session_expired(const vtx_session_t* s, uint64_t now_ms,
+                         uint32_t grace_ms) {
+    return s->token != 0 && s->suspend_ms > 0 &&
+           now_ms - s->suspend_ms >= grace_ms;
+}
+
+void vtx_session_pack_token(uint64_t token, uint8_t* buf) {
+    for (int i = 0; i < VTX_SESSION_TOKEN_SIZE; i++) {
+        buf[i] = (uint8_t)(token >> (56 - 8 * i));
+    }
+}
+
+uint64_t vtx_session_unpack_token(const uint8_t* buf) {
+    uint64_t token = 0;
+    for (int i = 0; i < VTX_SESSION_TOKEN_SIZE; i++) {
+        token = (token << 8) | buf[i];
+    }
+    return token;
+}
+
+uint64_t vtx_session_cookie(const uint8_t key[VTX_COOKIE_KEY_SIZE],
+                            const struct sockaddr_in* addr, uint64_t now_ms) {
+    return vtx_session_cookie_at(key, addr, now_ms / VTX_COOKIE_PERIOD_MS);
+}
+
+bool vtx_session_cookie_valid(const uint8_t key[VTX_COOKIE_KEY_SIZE],
+                              const struct sockaddr_in* addr,
+                              uint64_t cookie, uint64_t now_ms) {
+    if (cookie == 0) {
+        return false;
+    }
+
+    uint64_t period = now_ms / VTX_COOKIE_PERIOD_MS;
+    if (cookie == vtx_session_cookie_at(key, addr, period)) {
+        return true;
+    }
+    return period > 0 && cookie == vtx_session_cookie_at(key, addr, period - 1);
+}
+
+bool vtx_ratelimit_allow(vtx_ratelimit_t* rl, uint32_t addr,
+                         uint64_t now_ms, uint32_t rate) {
+    /* Fibonacci哈希选组，组内VTX_RATELIMIT_WAYS路相联 */
+    uint32_t set = (uint32_t)(addr * 2654435769u) >> 24;
+    vtx_ratelimit_slot_t* ways =
+        &rl->slots[(set % (VTX_RATELIMIT_SLOTS / VTX_RATELIMIT_WAYS)) *
+                   VTX_RATELIMIT_WAYS];
+
+    vtx_ratelimit_slot_t* slot = NULL;
+    vtx_ratelimit_slot_t* victim = NULL;
+    for (int i = 0; i < VTX_RATELIMIT_WAYS; i++) {
+        vtx_ratelimit_slot_t* way = &ways[i];
+        if (way->refill_ms != 0 && way->addr == addr) {
+            slot = way;
+            break;
+        }
+        /* 替换空闲路，否则最久未补充的路 */
+        if (!victim || (victim->refill_ms != 0 &&
+                        (way->refill_ms == 0 || way->refill_ms < victim->refill_ms))) {
+            victim = way;
+        }
+    }
+
+    if (!slot) {
+        slot = victim;
+        if (slot->refill_ms == 0) {
+            /* 新地址：满桶开始 */
+            slot->tokens = rate;
+            slot->refill_ms = now_ms;
+        }
+        /* 否则替换：新地址继承被替换地址的令牌（按下方补充），
+         * 映射到同一组的地址超过路数时共享预算，不能靠互相挤占重置为满桶 */
+        slot->addr = addr;
+    }
+
+    uint64_t elapsed = now_ms - slot->refill_ms;
+    uint64_t refill = elapsed * rate / 1000;
+    if (refill > 0) {
+        uint64_t tokens = slot->tokens + refill;
+        slot->tokens = (uint32_t)(tokens > rate ? rate : tokens);
+        slot->refill_ms = now_ms;
+    }
+
+    if (slot->tokens == 0) {
+        return false;
+    }
+    slot->tokens--;
+    return true;
+}
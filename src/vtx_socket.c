@@ -0,0 +1,191 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_socket.c
+ * @brief VTX Socket Buffer Sizing Implementation
+ */
+
+#include "vtx_socket.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+/* ========== 辅助函数 ========== */
+
+/**
+ * @brief 计算自动模式的目标大小
+ */
+static uint32_t vtx_sockbuf_target(const vtx_sockbuf_t* sb) {
+    uint64_t peak_frame = atomic_load(&sb->peak_frame);
+    uint64_t target = peak_frame * 2;
+
+    /* 带宽时延积：bps / 8 * rtt_ms / 1000 */
+    uint64_t bdp = sb->peak_bps / 8 * sb->srtt_ms / 1000;
+    if (bdp > target) {
+        target = bdp;
+    }
+
+    if (target < VTX_SOCKBUF_MIN) {
+        target = VTX_SOCKBUF_MIN;
+    }
+    if (target > VTX_SOCKBUF_MAX) {
+        target = VTX_SOCKBUF_MAX;
+    }
+    return (uint32_t)target;
+}
+
+/* ========== 公共函数 ========== */
+
+int vtx_socket_set_buf(int sockfd, bool is_send, uint32_t size, uint32_t* actual) {
+    if (sockfd < 0 || size == 0 || size > INT32_MAX) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    int opt = is_send ? SO_SNDBUF : SO_RCVBUF;
+    int val = (int)size;
+    bool ok = false;
+
+#if defined(SO_SNDBUFFORCE) && defined(SO_RCVBUFFORCE)
+    /* 优先绕过 net.core.[rw]mem_max 限制（需CAP_NET_ADMIN） */
+    int force_opt = is_send ? SO_SNDBUFFORCE : SO_RCVBUFFORCE;
+    if (setsockopt(sockfd, SOL_SOCKET, force_opt, &val, sizeof(val)) == 0) {
+        ok = true;
+    }
+#endif
+
+    if (!ok && setsockopt(sockfd, SOL_SOCKET, opt, &val, sizeof(val)) < 0) {
+        vtx_log_warn("Failed to set %s buffer to %u: %s",
+                     is_send ? "send" : "recv", size, strerror(errno));
+        return VTX_ERR_IO_FAILED;
+    }
+
+    /* 读取实际大小（Linux返回值为设置值的2倍，包含内核开销） */
+    int real = 0;
+    socklen_t len = sizeof(real);
+    if (getsockopt(sockfd, SOL_SOCKET, opt, &real, &len) == 0 && actual) {
+        *actual = (uint32_t)real;
+    }
+
+    vtx_log_debug("Socket %s buffer: requested=%u actual=%d force=%d",
+                  is_send ? "send" : "recv", size, real, ok);
+    return VTX_OK;
+}
+
+int vtx_sockbuf_init(vtx_sockbuf_t* sb, int sockfd, bool is_send,
+                     uint32_t configured) {
+    if (!sb) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    memset(sb, 0, sizeof(*sb));
+    atomic_init(&sb->peak_frame, 0);
+    sb->configured = configured;
+
+    uint32_t size = configured;
+    if (size == 0 || size == VTX_SOCKBUF_AUTO) {
+        size = is_send ? VTX_DEFAULT_SEND_BUF : VTX_DEFAULT_RECV_BUF;
+    }
+
+    sb->requested = size;
+    return vtx_socket_set_buf(sockfd, is_send, size, &sb->actual);
+}
+
+void vtx_sockbuf_note_frame(vtx_sockbuf_t* sb, size_t frame_size) {
+    if (!sb) {
+        return;
+    }
+
+    uint_fast64_t cur = atomic_load(&sb->peak_frame);
+    while (frame_size > cur &&
+           !atomic_compare_exchange_weak(&sb->peak_frame, &cur, frame_size)) {
+        /* cur已被更新为最新值，重试 */
+    }
+}
+
+void vtx_sockbuf_note_rtt(vtx_sockbuf_t* sb, uint32_t rtt_ms) {
+    if (!sb) {
+        return;
+    }
+
+    /* RFC 6298: srtt = 7/8 srtt + 1/8 rtt */
+    if (sb->srtt_ms == 0) {
+        sb->srtt_ms = rtt_ms > 0 ? rtt_ms : 1;
+    } else {
+        sb->srtt_ms = (sb->srtt_ms * 7 + rtt_ms) / 8;
+        if (sb->srtt_ms == 0) {
+            sb->srtt_ms = 1;
+        }
+    }
+}
+
+bool vtx_sockbuf_update(vtx_sockbuf_t* sb, int sockfd, bool is_send,
+                        uint64_t total_bytes, uint64_t now_ms) {
+    if (!sb || sb->configured != VTX_SOCKBUF_AUTO) {
+        return false;
+    }
+
+    if (sb->window_start_ms == 0) {
+        sb->window_start_ms = now_ms;
+        sb->window_bytes = total_bytes;
+        return false;
+    }
+
+    uint64_t elapsed = now_ms - sb->window_start_ms;
+    if (elapsed < VTX_SOCKBUF_ADJUST_MS) {
+        return false;
+    }
+
+    /* 更新峰值码率 */
+    uint64_t bps = (total_bytes - sb->window_bytes) * 8 * 1000 / elapsed;
+    if (bps > sb->peak_bps) {
+        sb->peak_bps = bps;
+    }
+    sb->window_start_ms = now_ms;
+    sb->window_bytes = total_bytes;
+
+    /* 只增不减，且增幅超过25%才调整，避免频繁setsockopt */
+    uint32_t target = vtx_sockbuf_target(sb);
+    if ((uint64_t)target * 4 <= (uint64_t)sb->requested * 5) {
+        return false;
+    }
+
+    if (vtx_socket_set_buf(sockfd, is_send, target, &sb->actual) != VTX_OK) {
+        return false;
+    }
+
+    vtx_log_info("Auto %s buffer: %u -> %u (peak_frame=%llu peak_bps=%llu srtt=%ums)",
+                 is_send ? "send" : "recv", sb->requested, target,
+                 (unsigned long long)atomic_load(&sb->peak_frame),
+                 (unsigned long long)sb->peak_bps, sb->srtt_ms);
+    sb->requested = target;
+    return true;
+}
+
+int vtx_socket_enable_rxq_ovfl(int sockfd) {
+#ifdef SO_RXQ_OVFL
+    int on = 1;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0) {
+        vtx_log_warn("Failed to enable SO_RXQ_OVFL: %s", strerror(errno));
+        return VTX_ERR_IO_FAILED;
+    }
+    return VTX_OK;
+#else
+    (void)sockfd;
+    return VTX_ERR_NOT_SUPPORTED;
+#endif
+}
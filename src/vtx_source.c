@@ -0,0 +1,527 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_source.c
+ * @brief VTX File Media Source Implementation
+ */
+
+#include "vtx_source.h"
+#include "vtx.h"
+#include "vtx_frame.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include "vtx_mem.h"
+#include "vtx_spinlock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define VTX_SOURCE_PATH_MAX     512
+#define VTX_SOURCE_MAX_LAG_US   (1000 * 1000)  /* 落后超过1秒时重新对齐，避免突发 */
+
+/**
+ * @brief 播放源
+ */
+struct vtx_source {
+    char                root[VTX_SOURCE_PATH_MAX]; /* 媒体根目录（realpath） */
+    uint64_t            interval_us;    /* 图像间隔 */
+
+    vtx_spinlock_t      lock;           /* 保护以下播放状态 */
+    vtx_media_file_t*   file;           /* 当前文件（NULL表示未播放） */
+    char                url[VTX_MAX_URL_SIZE]; /* 当前URL */
+    uint32_t            first;          /* 播放范围起始帧 */
+    uint32_t            last;           /* 播放范围结束帧（不含） */
+    uint32_t            cursor;         /* 下一帧 */
+    uint64_t            start_us;       /* 第0个图像的发送时间 */
+    uint64_t            pictures;       /* 已发送图像数 */
+};
+
+/* ========== 文件登记表 ========== */
+
+static struct {
+    pthread_mutex_t     lock;
+    pthread_cond_t      loaded;     /* 某个文件加载完成（成功或失败） */
+    vtx_media_file_t*   files;
+} g_media_files = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .loaded = PTHREAD_COND_INITIALIZER,
+    .files = NULL,
+};
+
+/* ========== 辅助函数 ========== */
+
+static uint64_t vtx_source_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 映射文件并建立索引（不持有登记表锁）
+ */
+static int vtx_media_file_load(vtx_media_file_t* file) {
+    const char* path = file->path;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        vtx_log_error("Failed to open media file %s: %s", path, strerror(errno));
+        return VTX_ERR_FILE_OPEN;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        vtx_log_error("Not a regular media file: %s", path);
+        close(fd);
+        return VTX_ERR_FILE_OPEN;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        vtx_log_error("Failed to map media file %s: %s", path, strerror(errno));
+        return VTX_ERR_FILE_READ;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    if (vtx_media_index_load(&file->index, path, (const uint8_t*)map, &st) != VTX_OK) {
+        vtx_log_error("No frames found in media file %s", path);
+        munmap(map, (size_t)st.st_size);
+        return VTX_ERR_NOT_FOUND;
+    }
+    file->map = (const uint8_t*)map;
+    file->size = (size_t)st.st_size;
+    return VTX_OK;
+}
+
+/**
+ * @brief 释放文件对象（最后一个引用已释放，且不在登记表中）
+ */
+static void vtx_media_file_free(vtx_media_file_t* file) {
+    if (file->state == VTX_MEDIA_FILE_READY) {
+        vtx_log_info("Media file closed: %s", file->path);
+        vtx_media_index_free(&file->index);
+        munmap((void*)file->map, file->size);
+    }
+    vtx_free(file->path);
+    vtx_free(file);
+}
+
+/* ========== 媒体文件 ========== */
+
+vtx_media_file_t* vtx_media_file_open(const char* path) {
+    char resolved[PATH_MAX];
+    if (!path || !realpath(path, resolved)) {
+        vtx_log_error("Media file not found: %s", path ? path : "(null)");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_media_files.lock);
+
+    for (vtx_media_file_t* f = g_media_files.files; f; f = f->next) {
+        if (strcmp(f->path, resolved) != 0) {
+            continue;
+        }
+
+        /* 引用计数已降为0的文件正在关闭，不能复用 */
+        int ref = atomic_load(&f->refcount);
+        while (ref > 0 && !atomic_compare_exchange_weak(&f->refcount, &ref, ref + 1)) {
+        }
+        if (ref == 0) {
+            continue;
+        }
+
+        /* 其他发送端正在建立索引：等待该文件加载完成（等待时释放登记表锁） */
+        while (f->state == VTX_MEDIA_FILE_LOADING) {
+            pthread_cond_wait(&g_media_files.loaded, &g_media_files.lock);
+        }
+        bool ready = f->state == VTX_MEDIA_FILE_READY;
+        pthread_mutex_unlock(&g_media_files.lock);
+
+        if (!ready) {
+            vtx_media_file_release(f);
+            return NULL;
+        }
+        return f;
+    }
+
+    /* 首次打开：登记为加载中，在锁外映射文件并建立索引（扫描和写旁路文件
+     * 可能较慢，不阻塞其他发送端打开其他文件和每帧的引用计数） */
+    vtx_media_file_t* file = (vtx_media_file_t*)vtx_calloc(1, sizeof(vtx_media_file_t));
+    if (file) {
+        file->path = vtx_strdup(resolved);
+    }
+    if (!file || !file->path) {
+        pthread_mutex_unlock(&g_media_files.lock);
+        vtx_free(file);
+        return NULL;
+    }
+    atomic_init(&file->refcount, 1);
+    file->state = VTX_MEDIA_FILE_LOADING;
+    file->next = g_media_files.files;
+    g_media_files.files = file;
+    pthread_mutex_unlock(&g_media_files.lock);
+
+    int ret = vtx_media_file_load(file);
+
+    pthread_mutex_lock(&g_media_files.lock);
+    if (ret == VTX_OK) {
+        file->state = VTX_MEDIA_FILE_READY;
+    } else {
+        /* 失败的文件移出登记表，下次打开重新加载 */
+        file->state = VTX_MEDIA_FILE_FAILED;
+        for (vtx_media_file_t** pp = &g_media_files.files; *pp; pp = &(*pp)->next) {
+            if (*pp == file) {
+                *pp = file->next;
+                break;
+            }
+        }
+    }
+    pthread_cond_broadcast(&g_media_files.loaded);
+    pthread_mutex_unlock(&g_media_files.lock);
+
+    if (ret != VTX_OK) {
+        vtx_media_file_release(file);
+        return NULL;
+    }
+    return file;
+}
+
+void vtx_media_file_retain(vtx_media_file_t* file) {
+    atomic_fetch_add(&file->refcount, 1);
+}
+
+void vtx_media_file_release(vtx_media_file_t* file) {
+    if (!file) {
+        return;
+    }
+
+    if (atomic_fetch_sub(&file->refcount, 1) > 1) {
+        return;
+    }
+
+    /* 最后一个引用：移出登记表（加载失败的文件已移除） */
+    pthread_mutex_lock(&g_media_files.lock);
+    for (vtx_media_file_t** pp = &g_media_files.files; *pp; pp = &(*pp)->next) {
+        if (*pp == file) {
+            *pp = file->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_media_files.lock);
+
+    vtx_media_file_free(file);
+}
+
+/**
+ * @brief 包装帧的释放回调：归还文件引用
+ */
+static void vtx_source_release_frame(const uint8_t* data, size_t size, void* ctx) {
+    (void)data;
+    (void)size;
+    vtx_media_file_release((vtx_media_file_t*)ctx);
+}
+
+/* ========== 播放源 ========== */
+
+/**
+ * @brief 解析URL：路径（相对根目录）和offset/size/frame查询参数
+ *
+ * @param frame 起始图像序号（未指定为-1）
+ */
+static int vtx_source_parse_url(const vtx_source_t* src, const char* url,
+                                char* path, size_t path_size,
+                                uint64_t* offset, uint64_t* size, int64_t* frame) {
+    *offset = 0;
+    *size = 0;
+    *frame = -1;
+
+    if (!url || url[0] == '\0') {
+        return VTX_ERR_INVALID_PARAM;
+    }
+    if (url[0] == '/') {
+        url++;
+    }
+
+    const char* query = strchr(url, '?');
+    size_t path_len = query ? (size_t)(query - url) : strlen(url);
+    if (path_len == 0) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 不允许跳出根目录 */
+    for (const char* s = url; s < url + path_len; ) {
+        const char* e = memchr(s, '/', (size_t)(url + path_len - s));
+        size_t seg = e ? (size_t)(e - s) : (size_t)(url + path_len - s);
+        if (seg == 2 && s[0] == '.' && s[1] == '.') {
+            return VTX_ERR_INVALID_PARAM;
+        }
+        s += seg + 1;
+    }
+
+    int n = snprintf(path, path_size, "%s/%.*s", src->root, (int)path_len, url);
+    if (n < 0 || (size_t)n >= path_size) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 查询参数：offset=10,size=20,frame=300（也接受'&'分隔） */
+    const char* q = query ? query + 1 : NULL;
+    while (q && *q) {
+        if (strncmp(q, "offset=", 7) == 0) {
+            *offset = strtoull(q + 7, NULL, 10);
+        } else if (strncmp(q, "size=", 5) == 0) {
+            *size = strtoull(q + 5, NULL, 10);
+        } else if (strncmp(q, "frame=", 6) == 0) {
+            *frame = (int64_t)(strtoul(q + 6, NULL, 10) & UINT32_MAX);
+        }
+        q = strpbrk(q, ",&");
+        if (q) {
+            q++;
+        }
+    }
+    return VTX_OK;
+}
+
+/**
+ * @brief 解析文件的realpath，并确认它位于媒体根目录之下
+ *
+ * URL中的".."已被拒绝，但根目录内的符号链接仍可能指向根目录之外
+ */
+static int vtx_source_resolve(const vtx_source_t* src, const char* path,
+                              char* resolved) {
+    if (!realpath(path, resolved)) {
+        vtx_log_error("Media file not found: %s", path);
+        return VTX_ERR_FILE_OPEN;
+    }
+
+    size_t root_len = strlen(src->root);
+    bool inside = strncmp(resolved, src->root, root_len) == 0 &&
+                  (resolved[root_len] == '/' ||
+                   (root_len == 1 && resolved[0] == '/'));
+    if (!inside) {
+        vtx_log_error("Media file outside media root: %s -> %s", path, resolved);
+        return VTX_ERR_INVALID_PARAM;
+    }
+    return VTX_OK;
+}
+
+/**
+ * @brief 计算播放范围
+ *
+ * 起点为offset（或frame指定的图像）处不晚于它的最近关键帧（含紧邻的SPS/PPS），
+ * 在索引上二分查找；size从起点算起（指定frame时从关键帧偏移算起）
+ */
+static int vtx_source_find_range(const vtx_media_index_t* index,
+                                 uint64_t offset, uint64_t size, int64_t frame,
+                                 uint32_t* first, uint32_t* last) {
+    int64_t key = frame >= 0 ? vtx_media_index_seek_picture(index, (uint32_t)frame)
+                             : vtx_media_index_seek_offset(index, offset);
+    if (key < 0) {
+        return VTX_ERR_NOT_FOUND;
+    }
+
+    uint32_t j = index->count;
+    if (size > 0) {
+        uint64_t base = frame >= 0 ? index->entries[key].offset : offset;
+        j = vtx_media_index_lower_bound(index, base + size);
+    }
+    if ((uint32_t)key >= j) {
+        return VTX_ERR_NOT_FOUND;
+    }
+
+    *first = (uint32_t)key;
+    *last = j;
+    return VTX_OK;
+}
+
+vtx_source_t* vtx_source_create(const char* root, uint16_t fps) {
+    if (!root || strlen(root) >= VTX_SOURCE_PATH_MAX || fps == 0) {
+        return NULL;
+    }
+
+    /* 根目录只解析一次，之后播放的文件都必须位于它之下 */
+    char resolved[PATH_MAX];
+    if (!realpath(root, resolved) || strlen(resolved) >= VTX_SOURCE_PATH_MAX) {
+        vtx_log_error("Invalid media root: %s", root);
+        return NULL;
+    }
+
+    vtx_source_t* src = (vtx_source_t*)vtx_calloc(1, sizeof(vtx_source_t));
+    if (!src) {
+        return NULL;
+    }
+
+    strcpy(src->root, resolved);
+    src->interval_us = 1000000ULL / fps;
+    vtx_spinlock_init(&src->lock);
+    return src;
+}
+
+void vtx_source_destroy(vtx_source_t* src) {
+    if (!src) {
+        return;
+    }
+
+    vtx_source_stop(src);
+    vtx_spinlock_destroy(&src->lock);
+    vtx_free(src);
+}
+
+int vtx_source_start(vtx_source_t* src, const char* url) {
+    if (!src) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 同一URL正在播放（会话恢复、重复START）：继续播放 */
+    vtx_spinlock_lock(&src->lock);
+    bool playing = src->file && strcmp(src->url, url ? url : "") == 0;
+    vtx_spinlock_unlock(&src->lock);
+    if (playing) {
+        return VTX_OK;
+    }
+
+    vtx_source_stop(src);
+
+    char path[VTX_SOURCE_PATH_MAX + VTX_MAX_URL_SIZE];
+    uint64_t offset;
+    uint64_t size;
+    int64_t frame;
+    int ret = vtx_source_parse_url(src, url, path, sizeof(path), &offset, &size, &frame);
+    if (ret != VTX_OK) {
+        vtx_log_error("Invalid media URL: %s", url ? url : "(null)");
+        return ret;
+    }
+
+    char resolved[PATH_MAX];
+    ret = vtx_source_resolve(src, path, resolved);
+    if (ret != VTX_OK) {
+        return ret;
+    }
+
+    vtx_media_file_t* file = vtx_media_file_open(resolved);
+    if (!file) {
+        return VTX_ERR_FILE_OPEN;
+    }
+
+    uint32_t first;
+    uint32_t last;
+    ret = vtx_source_find_range(&file->index, offset, size, frame, &first, &last);
+    if (ret != VTX_OK) {
+        vtx_log_error("No keyframe in range: %s offset=%llu size=%llu",
+                     path, (unsigned long long)offset, (unsigned long long)size);
+        vtx_media_file_release(file);
+        return ret;
+    }
+
+    vtx_spinlock_lock(&src->lock);
+    src->file = file;
+    snprintf(src->url, sizeof(src->url), "%s", url);
+    src->first = first;
+    src->last = last;
+    src->cursor = first;
+    src->start_us = vtx_source_now_us();
+    src->pictures = 0;
+    vtx_spinlock_unlock(&src->lock);
+
+    vtx_log_info("File source started: %s frames=%u-%u", path, first, last);
+    return VTX_OK;
+}
+
+void vtx_source_stop(vtx_source_t* src) {
+    if (!src) {
+        return;
+    }
+
+    vtx_spinlock_lock(&src->lock);
+    vtx_media_file_t* file = src->file;
+    src->file = NULL;
+    src->url[0] = '\0';
+    vtx_spinlock_unlock(&src->lock);
+
+    if (file) {
+        vtx_log_info("File source stopped: %s", file->path);
+        vtx_media_file_release(file);
+    }
+}
+
+uint64_t vtx_source_wait_us(vtx_source_t* src) {
+    if (!src) {
+        return UINT64_MAX;
+    }
+
+    vtx_spinlock_lock(&src->lock);
+    uint64_t wait = UINT64_MAX;
+    if (src->file) {
+        uint64_t due = src->start_us + src->pictures * src->interval_us;
+        uint64_t now = vtx_source_now_us();
+        wait = due > now ? due - now : 0;
+    }
+    vtx_spinlock_unlock(&src->lock);
+    return wait;
+}
+
+void vtx_source_pump(vtx_source_t* src, struct vtx_tx* tx) {
+    if (!src) {
+        return;
+    }
+
+    for (;;) {
+        /* 锁内取出下一帧并持有文件引用，锁外发送 */
+        vtx_spinlock_lock(&src->lock);
+        vtx_media_file_t* file = src->file;
+        if (!file) {
+            vtx_spinlock_unlock(&src->lock);
+            return;
+        }
+
+        uint64_t now = vtx_source_now_us();
+        uint64_t due = src->start_us + src->pictures * src->interval_us;
+        if (due > now) {
+            vtx_spinlock_unlock(&src->lock);
+            return;
+        }
+        if (now - due > VTX_SOURCE_MAX_LAG_US) {
+            src->start_us = now - src->pictures * src->interval_us;
+        }
+
+        const vtx_media_entry_t* e = &file->index.entries[src->cursor];
+        if (e->frame_type == VTX_FRAME_I || e->frame_type == VTX_FRAME_P) {
+            src->pictures++;
+        }
+        if (++src->cursor == src->last) {
+            src->cursor = src->first;  /* 循环播放 */
+        }
+        vtx_media_file_retain(file);
+        vtx_spinlock_unlock(&src->lock);
+
+        vtx_frame_t* frame = vtx_tx_wrap_media_frame(
+            tx, file->map + e->offset, e->size, vtx_source_release_frame, file);
+        if (!frame) {
+            vtx_media_file_release(file);
+            return;
+        }
+        frame->frame_type = (vtx_frame_type_t)e->frame_type;
+
+        /* 未连接时帧被丢弃（宽限期内I帧被缓存），播放进度照常推进 */
+        vtx_tx_send_media(tx, frame);
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_thread.c
+ * @brief VTX Thread Affinity & Scheduling Implementation
+ */
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+
+#include "vtx_thread.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+#ifndef SO_INCOMING_CPU
+#ifdef __linux__
+#define SO_INCOMING_CPU 49
+#endif
+#endif
+
+/**
+ * @brief 绑定CPU亲和性
+ */
+static int vtx_thread_set_affinity(uint64_t cpu_mask) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++) {
+        if (cpu_mask & (1ULL << cpu)) {
+            CPU_SET(cpu, &set);
+        }
+    }
+
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+        vtx_log_warn("Failed to set CPU affinity 0x%llx: %s",
+                     (unsigned long long)cpu_mask, strerror(ret));
+        return VTX_ERR_IO_FAILED;
+    }
+
+    vtx_log_info("Thread CPU affinity set: 0x%llx", (unsigned long long)cpu_mask);
+    return VTX_OK;
+#else
+    /* macOS不支持硬亲和性绑定 */
+    vtx_log_warn("CPU affinity not supported on this platform");
+    (void)cpu_mask;
+    return VTX_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/**
+ * @brief 设置SCHED_FIFO实时调度
+ */
+static int vtx_thread_set_fifo(int priority) {
+    int min = sched_get_priority_min(SCHED_FIFO);
+    int max = sched_get_priority_max(SCHED_FIFO);
+    if (priority < min || priority > max) {
+        vtx_log_warn("SCHED_FIFO priority %d out of range [%d, %d]",
+                     priority, min, max);
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+
+    int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0) {
+        vtx_log_warn("Failed to set SCHED_FIFO priority %d: %s",
+                     priority, strerror(ret));
+        return VTX_ERR_IO_FAILED;
+    }
+
+    vtx_log_info("Thread scheduling set: SCHED_FIFO priority=%d", priority);
+    return VTX_OK;
+}
+
+/**
+ * @brief 将socket的SO_INCOMING_CPU对齐到当前CPU
+ */
+static int vtx_thread_set_incoming_cpu(int sockfd) {
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+    int cpu = sched_getcpu();
+    if (cpu < 0) {
+        vtx_log_warn("sched_getcpu failed: %s", strerror(errno));
+        return VTX_ERR_IO_FAILED;
+    }
+
+    if (setsockopt(sockfd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) < 0) {
+        vtx_log_warn("Failed to set SO_INCOMING_CPU=%d: %s", cpu, strerror(errno));
+        return VTX_ERR_IO_FAILED;
+    }
+
+    vtx_log_info("Socket SO_INCOMING_CPU set: %d", cpu);
+    return VTX_OK;
+#else
+    vtx_log_warn("SO_INCOMING_CPU not supported on this platform");
+    (void)sockfd;
+    return VTX_ERR_NOT_SUPPORTED;
+#endif
+}
+
+int vtx_thread_apply(const vtx_thread_config_t* config, int sockfd) {
+    if (!config) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    int result = VTX_OK;
+    int ret;
+
+    /* 先绑定CPU，再读取当前CPU用于SO_INCOMING_CPU */
+    if (config->cpu_mask != 0) {
+        ret = vtx_thread_set_affinity(config->cpu_mask);
+        if (ret != VTX_OK) {
+            result = ret;
+        }
+    }
+
+    if (config->sched_priority > 0) {
+        ret = vtx_thread_set_fifo(config->sched_priority);
+        if (ret != VTX_OK) {
+            result = ret;
+        }
+    }
+
+    ret = vtx_thread_apply_socket(config, sockfd);
+    if (ret != VTX_OK) {
+        result = ret;
+    }
+
+    return result;
+}
+
+int vtx_thread_apply_socket(const vtx_thread_config_t* config, int sockfd) {
+    if (!config) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    if (config->incoming_cpu && sockfd >= 0) {
+        return vtx_thread_set_incoming_cpu(sockfd);
+    }
+    return VTX_OK;
+}
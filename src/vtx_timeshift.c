@@ -0,0 +1,273 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_timeshift.c
+ * @brief VTX Time-shift Ring Implementation
+ */
+
+#include "vtx_timeshift.h"
+#include "vtx_error.h"
+#include "vtx_log.h"
+#include "vtx_mem.h"
+#include "vtx_spinlock.h"
+#include <string.h>
+
+#define VTX_TIMESHIFT_INIT_CAPACITY 256   /* 初始槽位数（2的幂，按需翻倍） */
+#define VTX_TIMESHIFT_NO_POS        UINT64_MAX
+
+/**
+ * @brief 环中的一帧
+ */
+typedef struct {
+    vtx_frame_t*        frame;
+    vtx_frame_pool_t*   pool;
+    uint64_t            time_ms;
+} vtx_timeshift_entry_t;
+
+/**
+ * @brief 时移环
+ *
+ * 帧和关键帧都用单调递增的绝对位置表示，槽位 = 位置 & (容量 - 1)
+ */
+struct vtx_timeshift {
+    uint32_t            window_ms;      /* 时间窗口 */
+    uint64_t            max_bytes;      /* 字节上限 */
+    uint64_t            bytes;          /* 当前占用字节数（各帧data_capacity之和） */
+
+    vtx_timeshift_entry_t* entries;     /* 帧槽位 */
+    uint64_t            capacity;       /* 帧槽位数 */
+    uint64_t            head;           /* 最旧帧位置 */
+    uint64_t            tail;           /* 下一帧位置 */
+
+    uint64_t*           keys;           /* 关键帧起始位置 */
+    uint64_t            key_capacity;   /* 关键帧槽位数 */
+    uint64_t            key_head;
+    uint64_t            key_tail;
+
+    uint64_t            param_pos;      /* 未被后续帧打断的首个SPS/PPS位置 */
+    vtx_spinlock_t      lock;
+};
+
+/* ========== 辅助函数 ========== */
+
+static vtx_timeshift_entry_t* vtx_timeshift_at(vtx_timeshift_t* ts, uint64_t pos) {
+    return &ts->entries[pos & (ts->capacity - 1)];
+}
+
+static uint64_t vtx_timeshift_key_at(vtx_timeshift_t* ts, uint64_t k) {
+    return ts->keys[k & (ts->key_capacity - 1)];
+}
+
+/**
+ * @brief 帧槽位翻倍（按绝对位置重新摆放）
+ */
+static int vtx_timeshift_grow(vtx_timeshift_t* ts) {
+    uint64_t capacity = ts->capacity * 2;
+    vtx_timeshift_entry_t* entries = (vtx_timeshift_entry_t*)vtx_calloc(
+        capacity, sizeof(vtx_timeshift_entry_t));
+    if (!entries) {
+        return VTX_ERR_NO_MEMORY;
+    }
+    for (uint64_t pos = ts->head; pos != ts->tail; pos++) {
+        entries[pos & (capacity - 1)] = *vtx_timeshift_at(ts, pos);
+    }
+    vtx_free(ts->entries);
+    ts->entries = entries;
+    ts->capacity = capacity;
+    return VTX_OK;
+}
+
+static int vtx_timeshift_grow_keys(vtx_timeshift_t* ts) {
+    uint64_t capacity = ts->key_capacity * 2;
+    uint64_t* keys = (uint64_t*)vtx_calloc(capacity, sizeof(uint64_t));
+    if (!keys) {
+        return VTX_ERR_NO_MEMORY;
+    }
+    for (uint64_t k = ts->key_head; k != ts->key_tail; k++) {
+        keys[k & (capacity - 1)] = vtx_timeshift_key_at(ts, k);
+    }
+    vtx_free(ts->keys);
+    ts->keys = keys;
+    ts->key_capacity = capacity;
+    return VTX_OK;
+}
+
+/**
+ * @brief 淘汰最旧的一帧
+ */
+static void vtx_timeshift_pop(vtx_timeshift_t* ts) {
+    vtx_timeshift_entry_t* e = vtx_timeshift_at(ts, ts->head);
+    ts->bytes -= e->frame->data_capacity;
+    vtx_frame_release(e->pool, e->frame);
+    e->frame = NULL;
+    ts->head++;
+
+    while (ts->key_head != ts->key_tail &&
+           vtx_timeshift_key_at(ts, ts->key_head) < ts->head) {
+        ts->key_head++;
+    }
+    if (ts->param_pos != VTX_TIMESHIFT_NO_POS && ts->param_pos < ts->head) {
+        ts->param_pos = VTX_TIMESHIFT_NO_POS;
+    }
+}
+
+/* ========== 公共函数 ========== */
+
+vtx_timeshift_t* vtx_timeshift_create(uint32_t window_ms, uint64_t max_bytes) {
+    vtx_timeshift_t* ts = (vtx_timeshift_t*)vtx_calloc(1, sizeof(vtx_timeshift_t));
+    if (!ts) {
+        return NULL;
+    }
+
+    ts->capacity = VTX_TIMESHIFT_INIT_CAPACITY;
+    ts->key_capacity = VTX_TIMESHIFT_INIT_CAPACITY;
+    ts->entries = (vtx_timeshift_entry_t*)vtx_calloc(
+        ts->capacity, sizeof(vtx_timeshift_entry_t));
+    ts->keys = (uint64_t*)vtx_calloc(ts->key_capacity, sizeof(uint64_t));
+    if (!ts->entries || !ts->keys) {
+        vtx_free(ts->entries);
+        vtx_free(ts->keys);
+        vtx_free(ts);
+        return NULL;
+    }
+
+    ts->window_ms = window_ms;
+    ts->max_bytes = max_bytes;
+    ts->param_pos = VTX_TIMESHIFT_NO_POS;
+    vtx_spinlock_init(&ts->lock);
+    return ts;
+}
+
+void vtx_timeshift_destroy(vtx_timeshift_t* ts) {
+    if (!ts) {
+        return;
+    }
+
+    while (ts->head != ts->tail) {
+        vtx_timeshift_pop(ts);
+    }
+    vtx_spinlock_destroy(&ts->lock);
+    vtx_free(ts->entries);
+    vtx_free(ts->keys);
+    vtx_free(ts);
+}
+
+int vtx_timeshift_push(vtx_timeshift_t* ts, vtx_frame_pool_t* pool,
+                       vtx_frame_t* frame, uint64_t now_ms) {
+    if (!ts || !frame) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    vtx_spinlock_lock(&ts->lock);
+
+    if (ts->tail - ts->head == ts->capacity && vtx_timeshift_grow(ts) != VTX_OK) {
+        vtx_spinlock_unlock(&ts->lock);
+        return VTX_ERR_NO_MEMORY;
+    }
+    bool is_key = frame->frame_type == VTX_FRAME_I;
+    if (is_key && ts->key_tail - ts->key_head == ts->key_capacity &&
+        vtx_timeshift_grow_keys(ts) != VTX_OK) {
+        vtx_spinlock_unlock(&ts->lock);
+        return VTX_ERR_NO_MEMORY;
+    }
+
+    uint64_t pos = ts->tail++;
+    vtx_timeshift_entry_t* e = vtx_timeshift_at(ts, pos);
+    e->frame = vtx_frame_retain(frame);
+    e->pool = pool;
+    e->time_ms = now_ms;
+    ts->bytes += frame->data_capacity;
+
+    /* I帧从紧邻的SPS/PPS开始索引，回放即可直接解码 */
+    if (is_key) {
+        ts->keys[ts->key_tail & (ts->key_capacity - 1)] =
+            ts->param_pos != VTX_TIMESHIFT_NO_POS ? ts->param_pos : pos;
+        ts->key_tail++;
+    }
+    if (frame->frame_type == VTX_FRAME_SPS || frame->frame_type == VTX_FRAME_PPS) {
+        if (ts->param_pos == VTX_TIMESHIFT_NO_POS) {
+            ts->param_pos = pos;
+        }
+    } else if (frame->frame_type != VTX_FRAME_A) {
+        ts->param_pos = VTX_TIMESHIFT_NO_POS;
+    }
+
+    /* 超出时间窗口或字节上限：淘汰最旧的帧（至少保留刚写入的一帧） */
+    while (ts->tail - ts->head > 1) {
+        vtx_timeshift_entry_t* oldest = vtx_timeshift_at(ts, ts->head);
+        if (ts->bytes <= ts->max_bytes &&
+            oldest->time_ms + ts->window_ms >= now_ms) {
+            break;
+        }
+        vtx_timeshift_pop(ts);
+    }
+
+    vtx_spinlock_unlock(&ts->lock);
+    return VTX_OK;
+}
+
+int vtx_timeshift_replay(vtx_timeshift_t* ts, uint64_t since_ms,
+                         vtx_on_frame_fn fn, void* userdata) {
+    if (!ts || !fn) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    vtx_spinlock_lock(&ts->lock);
+
+    if (ts->key_head == ts->key_tail) {
+        vtx_spinlock_unlock(&ts->lock);
+        return VTX_ERR_NOT_FOUND;
+    }
+
+    /* 二分查找：时间不晚于since_ms的最后一个关键帧 */
+    uint64_t lo = ts->key_head;
+    uint64_t hi = ts->key_tail;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (vtx_timeshift_at(ts, vtx_timeshift_key_at(ts, mid))->time_ms <= since_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    uint64_t k = lo > ts->key_head ? lo - 1 : ts->key_head;
+    uint64_t start = vtx_timeshift_key_at(ts, k);
+    uint64_t count = ts->tail - start;
+
+    /* 锁内持有引用，锁外回调 */
+    vtx_timeshift_entry_t* snap = (vtx_timeshift_entry_t*)vtx_malloc(
+        count * sizeof(vtx_timeshift_entry_t));
+    if (!snap) {
+        vtx_spinlock_unlock(&ts->lock);
+        return VTX_ERR_NO_MEMORY;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        snap[i] = *vtx_timeshift_at(ts, start + i);
+        vtx_frame_retain(snap[i].frame);
+    }
+    vtx_spinlock_unlock(&ts->lock);
+
+    for (uint64_t i = 0; i < count; i++) {
+        vtx_frame_t* frame = snap[i].frame;
+        fn(frame->data, frame->data_size, frame->frame_type, userdata);
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        vtx_frame_release(snap[i].pool, snap[i].frame);
+    }
+    vtx_free(snap);
+
+    return (int)count;
+}
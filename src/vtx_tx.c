@@ -24,10 +24,21 @@
 #include "vtx_error.h"
 #include "vtx_log.h"
 #include "vtx_mem.h"
+#include "vtx_trace.h"
+#include "vtx_thread.h"
+#include "vtx_socket.h"
+#include "vtx_window.h"
+#include "vtx_session.h"
+#include "vtx_path.h"
+#include "vtx_crypto.h"
+#include "vtx_source.h"
+#include "vtx_pcap.h"
+#include "vtx_hash.h"
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <time.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
@@ -45,6 +56,18 @@
 
 /* ========== 发送端结构 ========== */
 
+#define VTX_TX_PROBE_SLOTS  4   /* 同时进行的路径验证数 */
+
+/**
+ * @brief 进行中的路径验证
+ */
+typedef struct {
+    struct sockaddr_in     addr;                   /* 待验证的新地址 */
+    socklen_t              addr_len;               /* 0表示空闲 */
+    uint64_t               challenge;              /* PROBE挑战值 */
+    uint64_t               send_ms;                /* PROBE发送时间 */
+} vtx_tx_probe_t;
+
 /**
  * @brief 发送端完整定义
  */
@@ -57,7 +80,36 @@ struct vtx_tx {
 
     /* 连接管理 */
     uint8_t                connect_retrans_count;  /* CONNECTED重传次数 */
-    uint64_t               connect_send_time_ms;   /* CONNECTED发送时间 */
+    uint8_t                connect_flags;          /* CONNECTED标志（重传时保持） */
+    uint64_t               connect_send_time_ms;   /* CONNECTED发送时间（0表示已ACK） */
+
+    /* 会话（令牌与宽限期） */
+    vtx_session_t          session;                /* 当前会话 */
+
+    /* 地址迁移（路径验证） */
+    vtx_tx_probe_t         probes[VTX_TX_PROBE_SLOTS]; /* 进行中的路径验证 */
+
+    /* 多路径（路径0为sockfd） */
+    vtx_path_set_t         paths;                  /* 发送路径集合 */
+
+    /* 握手防护 */
+    uint8_t                cookie_key[VTX_COOKIE_KEY_SIZE]; /* cookie密钥（创建时随机生成） */
+    vtx_ratelimit_t        ratelimit;              /* 控制包源地址限速表 */
+
+    /* 载荷加密（配置crypto_key时所有会话都加密） */
+    vtx_crypto_t*          crypto;                 /* AES-GCM上下文（NULL表示不加密） */
+    atomic_uint_fast64_t   seal_salt;              /* 当前会话的nonce盐（poll线程换会话时写，
+                                                      发送线程加密时读） */
+    atomic_uint_fast32_t   seal_seq_origin;        /* 生成盐时的seq_num（用于检测seq耗尽） */
+
+    /* 媒体源 */
+    char                   media_url[VTX_MAX_URL_SIZE]; /* 最近一次START的URL */
+    bool                   media_started;          /* 是否收到过START */
+    bool                   start_pending;          /* 未验证地址的0-RTT START，收到CONNECTED的ACK后开始 */
+    bool                   start_pending_url;      /* start_url有效（否则为默认媒体源） */
+    char                   start_url[VTX_MAX_URL_SIZE]; /* 等待中的START的URL */
+    vtx_source_t*          source;                 /* 内置文件媒体源（配置media_root时） */
+    vtx_pcap_t*            capture;                /* 抓包文件（配置capture_path时） */
 
     /* 心跳管理 */
     uint64_t               last_heartbeat_ms;      /* 最后收到心跳时间 */
@@ -68,12 +120,15 @@ struct vtx_tx {
 
     /* 内存池 */
     vtx_frame_pool_t*      media_pool;       /* 媒体帧池 */
-    vtx_frame_pool_t*      data_pool;        /* 数据帧池 */
+    vtx_frame_pool_t*      wrap_pool;        /* 外部数据帧池（零拷贝，不含data缓冲区） */
     vtx_frag_pool_t*       frag_pool;        /* 分片池 */
+#ifdef VTX_DEBUG
+    atomic_uint_fast32_t   drop_state;       /* 丢包模拟随机数状态（xorshift32，发送线程与poll线程共用） */
+#endif
 
     /* 发送队列 */
     vtx_frame_queue_t*     send_queue;       /* 待发送队列 */
-    vtx_frame_queue_t*     data_queue;       /* 用户数据包队列（需要ACK） */
+    vtx_data_window_t      data_win;         /* 用户数据包窗口（需要ACK） */
 
     /* I帧缓存 */
     vtx_frame_t*           last_iframe;      /* 最后一个I帧 */
@@ -87,6 +142,19 @@ struct vtx_tx {
     vtx_tx_stats_t         stats;            /* 统计信息 */
     vtx_spinlock_t         stats_lock;       /* 统计锁 */
 
+    /* socket缓冲区 */
+    vtx_sockbuf_t          sndbuf;           /* 发送缓冲区自动调整状态 */
+
+    /* 接收端限制（VTX_DATA_LIMIT） */
+    vtx_limits_t           limits;           /* 当前生效的限制 */
+    vtx_spinlock_t         limit_lock;       /* 限制锁 */
+    int64_t                limit_tokens;     /* 码率令牌桶（字节，I帧可透支为负） */
+    uint64_t               limit_refill_us;  /* 令牌桶上次补充时间 */
+    uint64_t               limit_video_us;   /* 上次发出视频帧时间（帧率限制） */
+    bool                   limit_wait_iframe; /* 已丢帧，等待下一个I帧 */
+    bool                   limit_id_valid;   /* limit_frame_id有效 */
+    uint16_t               limit_frame_id;   /* 最近应用的LIMIT的frame_id（过滤重传） */
+
     /* 回调 */
     vtx_on_data_fn         data_fn;          /* 数据帧回调 */
     vtx_on_media_fn        media_fn;         /* 媒体控制回调 */
@@ -107,6 +175,15 @@ static uint64_t vtx_get_time_ms(void) {
     return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
+/**
+ * @brief 获取单调时钟（微秒，用于延迟分解，不受系统时间调整影响）
+ */
+static uint64_t vtx_get_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
 /**
  * @brief 创建UDP socket
  */
@@ -123,28 +200,32 @@ static int vtx_create_socket(void) {
         vtx_log_warn("Failed to set non-blocking: %s", strerror(errno));
     }
 
-    /* 设置发送缓冲区 */
-    int sendbuf = VTX_DEFAULT_SEND_BUF;
-    if (setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &sendbuf, sizeof(sendbuf)) < 0) {
-        vtx_log_warn("Failed to set send buffer: %s", strerror(errno));
-    }
-
     return sockfd;
 }
 
 /**
- * @brief 发送单个数据包
+ * @brief 发送单个数据包到指定地址（载荷由多个数据段组成）
+ *
+ * 包头与各载荷段组成一个sendmsg iovec，载荷不做拼接复制
  */
-static int vtx_send_packet(
+static int vtx_send_packet_iov_to(
     vtx_tx_t* tx,
+    int sockfd,
+    const struct sockaddr_in* addr,
+    socklen_t addr_len,
     const vtx_packet_header_t* header,
-    const uint8_t* payload,
-    size_t payload_size)
+    const struct iovec* payload,
+    int payload_cnt)
 {
-    if (!tx || !header) {
+    if (!tx || !header || payload_cnt < 0 || payload_cnt > VTX_MAX_IOV) {
         return VTX_ERR_INVALID_PARAM;
     }
 
+    size_t payload_size = 0;
+    for (int i = 0; i < payload_cnt; i++) {
+        payload_size += payload[i].iov_len;
+    }
+
     /* 使用临时结构体进行序列化，避免手工计算偏移 */
     vtx_packet_header_t hdr;
 
@@ -170,25 +251,34 @@ static int vtx_send_packet(
 
     int hdr_size = VTX_PACKET_HEADER_SIZE;
 
-    /* 计算CRC */
-    uint16_t crc = vtx_packet_calc_crc(hdr_buf, payload, payload_size);
+    /* 计算CRC（加密的媒体分片由GCM标签保证完整性，带帧哈希的只校验包头） */
+    uint16_t crc = 0;
+    bool media = header->frame_type >= VTX_FRAME_I && header->frame_type <= VTX_FRAME_A;
+    if (!media || !(header->flags & VTX_FLAG_CRYPT)) {
+        bool header_only = media && (header->flags & VTX_FLAG_HASH);
+        crc = vtx_packet_calc_crc_iov(hdr_buf, payload, header_only ? 0 : payload_cnt);
+    }
     vtx_log_debug("TX send: type=%u seq=%u crc=0x%04x size=%zu",
                  header->frame_type, header->seq_num, crc, payload_size);
 
     /* 使用iovec零拷贝发送 */
-    struct iovec iov[2];
+    struct iovec iov[1 + VTX_MAX_IOV];
+    int iovcnt = 1;
     iov[0].iov_base = hdr_buf;
     iov[0].iov_len = hdr_size;
-    iov[1].iov_base = (void*)payload;
-    iov[1].iov_len = payload_size;
+    for (int i = 0; i < payload_cnt; i++) {
+        if (payload[i].iov_len > 0) {
+            iov[iovcnt++] = payload[i];
+        }
+    }
 
     struct msghdr msg = {0};
-    msg.msg_name = &tx->client_addr;
-    msg.msg_namelen = tx->client_addr_len;
+    msg.msg_name = (void*)addr;
+    msg.msg_namelen = addr_len;
     msg.msg_iov = iov;
-    msg.msg_iovlen = payload_size > 0 ? 2 : 1;
+    msg.msg_iovlen = iovcnt;
 
-    ssize_t sent = sendmsg(tx->sockfd, &msg, 0);
+    ssize_t sent = sendmsg(sockfd, &msg, 0);
     if (sent < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             return VTX_ERR_BUSY;
@@ -196,6 +286,7 @@ static int vtx_send_packet(
         vtx_log_error("sendmsg failed: %s", strerror(errno));
         return VTX_ERR_SOCKET_SEND;
     }
+    vtx_pcap_write(tx->capture, sockfd, VTX_PCAP_DIR_OUT, addr, iov, iovcnt);
 
     /* 更新统计 */
     vtx_spinlock_lock(&tx->stats_lock);
@@ -206,6 +297,197 @@ static int vtx_send_packet(
     return VTX_OK;
 }
 
+/**
+ * @brief 发送单个数据包到客户端（载荷由多个数据段组成）
+ */
+static int vtx_send_packet_iov(
+    vtx_tx_t* tx,
+    const vtx_packet_header_t* header,
+    const struct iovec* payload,
+    int payload_cnt)
+{
+    return vtx_send_packet_iov_to(tx, tx->sockfd,
+                                  &tx->client_addr, tx->client_addr_len,
+                                  header, payload, payload_cnt);
+}
+
+/**
+ * @brief 经指定路径发送单个数据包到客户端
+ */
+static int vtx_send_packet_path(
+    vtx_tx_t* tx,
+    uint8_t path,
+    const vtx_packet_header_t* header,
+    const struct iovec* payload,
+    int payload_cnt)
+{
+    return vtx_send_packet_iov_to(tx, tx->paths.paths[path].sockfd,
+                                  &tx->client_addr, tx->client_addr_len,
+                                  header, payload, payload_cnt);
+}
+
+/**
+ * @brief 发送单个数据包
+ */
+static int vtx_send_packet(
+    vtx_tx_t* tx,
+    const vtx_packet_header_t* header,
+    const uint8_t* payload,
+    size_t payload_size)
+{
+    struct iovec iov = {
+        .iov_base = (void*)payload,
+        .iov_len = payload_size,
+    };
+
+    return vtx_send_packet_iov(tx, header, &iov, payload ? 1 : 0);
+}
+
+/**
+ * @brief 检查当前盐下的seq是否即将耗尽
+ *
+ * 同一个盐下seq不能回绕（nonce重复），耗尽前断开连接，重连生成新盐
+ *
+ * @param seq_end 本次使用的最后一个seq + 1
+ * @return true已断开连接
+ */
+static bool vtx_tx_seal_exhausted(vtx_tx_t* tx, uint32_t seq_end) {
+    if ((uint32_t)(seq_end - atomic_load(&tx->seal_seq_origin)) <= VTX_CRYPTO_SEQ_LIMIT) {
+        return false;
+    }
+
+    vtx_log_error("Sequence space exhausted for session salt, closing connection");
+    vtx_tx_close(tx);
+    return true;
+}
+
+/**
+ * @brief 会话的帧尾随数据大小（加密为GCM标签，否则按配置为帧哈希）
+ */
+static size_t vtx_tx_session_trailer_size(const vtx_tx_t* tx) {
+    if (tx->crypto) {
+        return VTX_CRYPTO_TAG_SIZE;
+    }
+    return tx->config.frame_hash ? VTX_FRAME_HASH_SIZE : 0;
+}
+
+/**
+ * @brief 帧尾随数据大小（GCM标签或帧哈希）
+ */
+static size_t vtx_tx_trailer_size(const vtx_frame_t* frame) {
+    if (frame->sealed) {
+        return VTX_CRYPTO_TAG_SIZE;
+    }
+    return frame->hashed ? VTX_FRAME_HASH_SIZE : 0;
+}
+
+/**
+ * @brief 帧的线上大小（含尾随数据）
+ */
+static size_t vtx_tx_wire_size(const vtx_frame_t* frame) {
+    return frame->data_size + vtx_tx_trailer_size(frame);
+}
+
+/**
+ * @brief 帧分片的尾随数据标志
+ */
+static uint8_t vtx_tx_trailer_flags(const vtx_frame_t* frame) {
+    if (frame->sealed) {
+        return VTX_FLAG_CRYPT;
+    }
+    return frame->hashed ? VTX_FLAG_HASH : 0;
+}
+
+/**
+ * @brief 发送frame中的一个分片
+ *
+ * 分片载荷通过vtx_frame_gather映射，分散frame的分片可跨越数据段边界；
+ * GCM标签/帧哈希是data之后的尾随数据，落在末尾分片（可能跨两个分片）
+ */
+static int vtx_send_frame_frag(
+    vtx_tx_t* tx,
+    uint8_t path,
+    const vtx_packet_header_t* header,
+    const vtx_frame_t* frame,
+    size_t offset)
+{
+    size_t data_len = 0;
+    if (offset < frame->data_size) {
+        data_len = frame->data_size - offset;
+        if (data_len > header->payload_size) {
+            data_len = header->payload_size;
+        }
+    }
+
+    size_t trailer_size = vtx_tx_trailer_size(frame);
+    struct iovec iov[VTX_MAX_IOV];
+    int cnt = 0;
+    if (data_len > 0) {
+        cnt = vtx_frame_gather(frame, offset, data_len, iov,
+                               trailer_size > 0 ? VTX_MAX_IOV - 1 : VTX_MAX_IOV);
+        if (cnt == 0) {
+            return VTX_ERR_INVALID_PARAM;
+        }
+    }
+
+    if (data_len < header->payload_size) {
+        size_t tag_offset = offset + data_len - frame->data_size;
+        if (tag_offset + header->payload_size - data_len > trailer_size) {
+            return VTX_ERR_INVALID_PARAM;
+        }
+        iov[cnt].iov_base = (void*)(frame->tag + tag_offset);
+        iov[cnt].iov_len = header->payload_size - data_len;
+        cnt++;
+    }
+
+#ifdef VTX_DEBUG
+    /* 丢包模拟：当作已发出，由ACK/重传机制处理 */
+    if (tx->config.drop_rate > 0.0f) {
+        uint_fast32_t old = atomic_load(&tx->drop_state);
+        uint32_t x;
+        do {
+            x = (uint32_t)old;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        } while (!atomic_compare_exchange_weak(&tx->drop_state, &old, x));
+        if ((float)x / 4294967296.0f < tx->config.drop_rate) {
+            return VTX_OK;
+        }
+    }
+#endif
+
+    return vtx_send_packet_path(tx, path, header, iov, cnt);
+}
+
+/**
+ * @brief 首次发送媒体分片（按路径调度）
+ *
+ * 开启path_duplicate时I帧分片在其余路径上各复制一份
+ *
+ * @param path 输出：调度到的路径
+ */
+static int vtx_tx_send_media_frag(
+    vtx_tx_t* tx,
+    const vtx_packet_header_t* header,
+    const vtx_frame_t* frame,
+    size_t offset,
+    uint8_t* path)
+{
+    *path = vtx_path_select(&tx->paths);
+    int ret = vtx_send_frame_frag(tx, *path, header, frame, offset);
+
+    if (tx->config.path_duplicate && header->frame_type == VTX_FRAME_I) {
+        for (uint8_t i = 0; i < tx->paths.count; i++) {
+            if (i != *path) {
+                vtx_path_note_sent(&tx->paths, i);
+                vtx_send_frame_frag(tx, i, header, frame, offset);
+            }
+        }
+    }
+    return ret;
+}
+
 /**
  * @brief 发送帧分片
  *
@@ -244,9 +526,9 @@ static int vtx_send_frame_frags(vtx_tx_t* tx, vtx_frame_t* frame) {
 
         /* 发送分片 */
         size_t offset = vtx_packet_calc_frag_offset(i, mtu);
-        int ret = vtx_send_packet(tx, &header,
-                                  frame->data + offset,
-                                  header.payload_size);
+        VTX_TRACE_FRAG_SEND(header.frame_id, i, total_frags,
+                            header.payload_size, header.seq_num);
+        int ret = vtx_send_frame_frag(tx, 0, &header, frame, offset);
         if (ret != VTX_OK) {
             vtx_log_error("Failed to send fragment %u/%u: %d",
                          i, total_frags, ret);
@@ -268,67 +550,82 @@ static int vtx_send_frame_frags(vtx_tx_t* tx, vtx_frame_t* frame) {
 }
 
 /**
- * @brief 处理重传队列（超时重传和清理）
+ * @brief 获取frame所属的内存池
  */
-static void vtx_process_retrans_queue(vtx_tx_t* tx) {
-    uint64_t now_ms = vtx_get_time_ms();
-    vtx_frame_t* frame;
-    vtx_frame_t* tmp;
-
-    vtx_spinlock_lock(&tx->data_queue->lock);
-
-    list_for_each_entry_safe(frame, tmp, &tx->data_queue->frames, list) {
-        /* 检查重传次数是否超限 */
-        if (frame->retrans_count >= tx->config.data_max_retrans) {
-            vtx_log_warn("Frame dropped: id=%u, retrans=%u",
-                       frame->frame_id, frame->retrans_count);
-
-            /* 从队列移除并释放 */
-            list_del(&frame->list);
-            tx->data_queue->count--;
-            vtx_spinlock_unlock(&tx->data_queue->lock);
-
-            vtx_frame_release(tx->data_pool, frame);
-
-            vtx_spinlock_lock(&tx->data_queue->lock);
-            continue;
-        }
+static vtx_frame_pool_t* vtx_tx_frame_pool(vtx_tx_t* tx, const vtx_frame_t* frame) {
+    return frame->external ? tx->wrap_pool : tx->media_pool;
+}
 
-        /* 检查是否需要重传 */
-        uint64_t elapsed = now_ms - frame->send_time_ms;
-        if (elapsed >= tx->config.data_retrans_timeout_ms) {
-            /* 需要重传 */
-            frame->retrans_count++;
-            frame->send_time_ms = now_ms;
+/**
+ * @brief 重传DATA包（vtx_data_window_process回调）
+ */
+static void vtx_tx_resend_data(void* ctx, const vtx_data_slot_t* slot) {
+    vtx_tx_t* tx = (vtx_tx_t*)ctx;
 
-            vtx_log_debug("Retransmitting frame: id=%u, retrans=%u, elapsed=%llu ms",
-                        frame->frame_id, frame->retrans_count,
-                        (unsigned long long)elapsed);
+    vtx_packet_header_t header = {0};
+    header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+    header.frame_id = slot->frame_id;
+    header.frame_type = slot->data_type;
+    header.frag_index = 0;
+    header.total_frags = 1;
+    header.payload_size = slot->size;
+    header.flags = VTX_FLAG_RETRANS;
 
-            /* 重新发送数据包 */
-            vtx_packet_header_t header = {0};
-            header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
-            header.frame_id = frame->frame_id;
-            header.frame_type = VTX_DATA_USER;
-            header.frag_index = 0;
-            header.total_frags = 1;
-            header.payload_size = frame->data_size;
-            header.flags = VTX_FLAG_RETRANS;
+    VTX_TRACE_FRAG_RETRANS(header.frame_id, 0, slot->retrans_count,
+                           header.payload_size, header.seq_num);
+    vtx_send_packet(tx, &header, slot->data, slot->size);
 
-            vtx_spinlock_unlock(&tx->data_queue->lock);
+    /* 更新统计 */
+    vtx_spinlock_lock(&tx->stats_lock);
+    tx->stats.retrans_packets++;
+    vtx_spinlock_unlock(&tx->stats_lock);
+}
 
-            vtx_send_packet(tx, &header, frame->data, frame->data_size);
+/**
+ * @brief 设置接收端限制（poll线程调用）
+ */
+static void vtx_tx_set_limits(vtx_tx_t* tx, const vtx_limits_t* limits) {
+    vtx_spinlock_lock(&tx->limit_lock);
+    tx->limits = *limits;
+    tx->limit_tokens = (int64_t)limits->max_bitrate_kbps * 1000 / 8;
+    tx->limit_refill_us = vtx_get_time_us();
+    tx->limit_video_us = 0;
+    tx->limit_wait_iframe = false;
+    tx->limit_id_valid = false;
+    vtx_spinlock_unlock(&tx->limit_lock);
+}
 
-            /* 更新统计 */
-            vtx_spinlock_lock(&tx->stats_lock);
-            tx->stats.retrans_packets++;
-            vtx_spinlock_unlock(&tx->stats_lock);
+/**
+ * @brief 发送CONNECTED（payload为会话令牌，加密会话追加nonce盐）
+ */
+static void vtx_tx_send_connected(vtx_tx_t* tx, uint8_t flags) {
+    uint8_t payload[VTX_SESSION_TOKEN_SIZE + VTX_CRYPTO_SALT_SIZE];
+    size_t size = VTX_SESSION_TOKEN_SIZE;
+    vtx_session_pack_token(tx->session.token, payload);
+    if (flags & VTX_FLAG_CRYPT) {
+        vtx_crypto_pack_salt(atomic_load(&tx->seal_salt), payload + size);
+        size += VTX_CRYPTO_SALT_SIZE;
+    }
+
+    vtx_packet_header_t conn_header = {0};
+    conn_header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+    conn_header.frame_id = 0;  /* 连接帧使用frame_id=0 */
+    conn_header.frame_type = VTX_DATA_CONNECTED;
+    conn_header.flags = flags;
+    vtx_send_packet(tx, &conn_header, payload, size);
+}
 
-            vtx_spinlock_lock(&tx->data_queue->lock);
-        }
-    }
+/**
+ * @brief 处理重传队列（超时重传和清理）
+ */
+static void vtx_process_retrans_queue(vtx_tx_t* tx) {
+    uint64_t now_ms = vtx_get_time_ms();
 
-    vtx_spinlock_unlock(&tx->data_queue->lock);
+    /* 处理DATA包重传 */
+    vtx_data_window_process(&tx->data_win, now_ms,
+                            tx->config.data_retrans_timeout_ms,
+                            tx->config.data_max_retrans,
+                            vtx_tx_resend_data, tx);
 
     /* 处理I帧分片重传 */
     vtx_spinlock_lock(&tx->iframe_lock);
@@ -358,9 +655,12 @@ static void vtx_process_retrans_queue(vtx_tx_t* tx) {
             /* 检查是否需要重传 */
             uint64_t elapsed = now_ms - frag->send_time_ms;
             if (elapsed >= tx->config.retrans_timeout_ms) {
-                /* 需要重传此分片 */
+                /* 需要重传此分片（超时计为原路径丢包，重传走最好的路径） */
                 frag->retrans_count++;
                 frag->send_time_ms = now_ms;
+                vtx_path_on_loss(&tx->paths, frag->path);
+                frag->path = vtx_path_best(&tx->paths);
+                uint8_t path = frag->path;
 
                 vtx_log_debug("Retransmitting I-frame fragment: frame_id=%u, frag=%u/%u, retrans=%u",
                             iframe->frame_id, frag->frag_index, iframe->total_frags,
@@ -368,28 +668,34 @@ static void vtx_process_retrans_queue(vtx_tx_t* tx) {
 
                 /* 计算分片载荷 */
                 size_t offset = frag->frag_index * payload_capacity;
-                size_t payload_size = iframe->data_size - offset;
+                size_t payload_size = vtx_tx_wire_size(iframe) - offset;
                 if (payload_size > payload_capacity) {
                     payload_size = payload_capacity;
                 }
 
-                /* 重新发送分片 */
+                /* 重新发送分片（沿用原seq，加密帧的nonce由接收端从seq还原） */
                 vtx_packet_header_t header = {0};
-                header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+                header.seq_num = iframe->base_seq + frag->frag_index;
                 header.frame_id = iframe->frame_id;
                 header.frame_type = iframe->frame_type;
                 header.frag_index = frag->frag_index;
                 header.total_frags = iframe->total_frags;
                 header.payload_size = payload_size;
-                header.flags = VTX_FLAG_RETRANS;
+                header.flags = VTX_FLAG_RETRANS | vtx_tx_trailer_flags(iframe);
 
                 if (frag->frag_index == iframe->total_frags - 1) {
                     header.flags |= VTX_FLAG_LAST_FRAG;
                 }
 
+                /* 解锁期间新I帧可能替换last_iframe，持有引用保证数据
+                 * （尤其是调用者的外部缓冲区）在发送时有效 */
+                vtx_frame_retain(iframe);
+                VTX_TRACE_FRAG_RETRANS(header.frame_id, header.frag_index,
+                                       frag->retrans_count, header.payload_size,
+                                       header.seq_num);
                 vtx_spinlock_unlock(&tx->iframe_lock);
 
-                vtx_send_packet(tx, &header, iframe->data + offset, payload_size);
+                vtx_send_frame_frag(tx, path, &header, iframe, offset);
 
                 /* 更新统计 */
                 vtx_spinlock_lock(&tx->stats_lock);
@@ -397,13 +703,19 @@ static void vtx_process_retrans_queue(vtx_tx_t* tx) {
                 vtx_spinlock_unlock(&tx->stats_lock);
 
                 vtx_spinlock_lock(&tx->iframe_lock);
+                bool replaced = (tx->last_iframe != iframe);
+                vtx_frame_release(vtx_tx_frame_pool(tx, iframe), iframe);
+                if (replaced) {
+                    /* 旧I帧的retran已归还，停止遍历 */
+                    break;
+                }
             }
         }
     }
     vtx_spinlock_unlock(&tx->iframe_lock);
 
-    /* 处理CONNECTED帧重传（3次握手第二步） */
-    if (!tx->connected && tx->connect_send_time_ms > 0) {
+    /* 处理CONNECTED帧重传（3次握手第二步，0-RTT时已处于连接状态） */
+    if (tx->connect_send_time_ms > 0) {
         uint64_t elapsed = now_ms - tx->connect_send_time_ms;
 
         /* 检查重传次数是否超限 */
@@ -411,12 +723,10 @@ static void vtx_process_retrans_queue(vtx_tx_t* tx) {
             vtx_log_warn("CONNECTED handshake failed: max retrans exceeded");
             tx->connect_send_time_ms = 0;
             tx->connect_retrans_count = 0;
-            /* 回退到空闲状态 */
-            return;
-        }
-
-        /* 检查是否需要重传CONNECTED */
-        if (elapsed >= tx->config.connect_timeout_ms) {
+            tx->start_pending = false;
+            /* 回退到空闲状态（0-RTT/恢复的连接交给心跳超时处理） */
+        } else if (elapsed >= tx->config.connect_timeout_ms) {
+            /* 需要重传CONNECTED */
             tx->connect_retrans_count++;
             tx->connect_send_time_ms = now_ms;
 
@@ -424,12 +734,7 @@ static void vtx_process_retrans_queue(vtx_tx_t* tx) {
                         tx->connect_retrans_count);
 
             /* 重新发送CONNECTED */
-            vtx_packet_header_t conn_header = {0};
-            conn_header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
-            conn_header.frame_id = 0;
-            conn_header.frame_type = VTX_DATA_CONNECTED;
-            conn_header.flags = VTX_FLAG_RETRANS;
-            vtx_send_packet(tx, &conn_header, NULL, 0);
+            vtx_tx_send_connected(tx, tx->connect_flags | VTX_FLAG_RETRANS);
         }
     }
 
@@ -445,136 +750,809 @@ static void vtx_process_retrans_queue(vtx_tx_t* tx) {
             tx->connect_retrans_count = 0;
             tx->heartbeat_miss_count = 0;
             tx->last_heartbeat_ms = 0;
+
+            /* 会话进入宽限期，接收端可凭令牌恢复 */
+            vtx_session_suspend(&tx->session, now_ms);
         }
     }
-}
 
-/**
- * @brief 接收并处理数据包
- */
-static int vtx_recv(vtx_tx_t* tx) {
-    uint8_t buf[sizeof(vtx_packet_header_t) + 128];
-    struct sockaddr_in from_addr;
-    socklen_t from_len = sizeof(from_addr);
+    /* 宽限期结束：会话作废，通知应用层停止媒体 */
+    if (!tx->connected &&
+        vtx_session_expired(&tx->session, now_ms, tx->config.session_grace_ms)) {
+        vtx_log_info("Session grace period expired, dropping session");
+        vtx_session_close(&tx->session);
 
-    ssize_t n = recvfrom(tx->sockfd, buf, sizeof(buf), 0,
-                         (struct sockaddr*)&from_addr, &from_len);
-    if (n < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return 0;  /* 无数据 */
-        }
-        return VTX_ERR_SOCKET_RECV;
-    }
+        vtx_limits_t no_limits = {0};
+        vtx_tx_set_limits(tx, &no_limits);
+        vtx_source_stop(tx->source);
 
-    if (n < VTX_PACKET_HEADER_SIZE) {
-        return VTX_ERR_PACKET_INVALID;
+        if (tx->media_started) {
+            tx->media_started = false;
+            if (tx->media_fn) {
+                VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_MEDIA, VTX_DATA_STOP, 0);
+                tx->media_fn(VTX_DATA_STOP, NULL, tx->userdata);
+                VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_MEDIA, 0);
+            }
+        }
     }
+}
 
-    /* 反序列化包头 */
-    vtx_packet_header_t header;
-    memcpy(&header, buf, sizeof(header));
+/**
+ * @brief 接收端限制判定结果
+ */
+typedef enum {
+    VTX_LIMIT_PASS = 0,         /* 发送 */
+    VTX_LIMIT_DROP,             /* 丢弃（超限的P帧，或等待I帧期间的P帧） */
+    VTX_LIMIT_OVERSIZE,         /* I帧超过max_frame_size：丢弃并报告给调用者 */
+} vtx_limit_verdict_t;
 
-    int ret = vtx_packet_deserialize_header(&header);
-    if (ret != VTX_OK) {
-        return ret;
+/**
+ * @brief 按接收端限制判断是否丢弃该帧
+ *
+ * 策略：
+ * - SPS/PPS/音频帧不受限制
+ * - I帧只受max_frame_size约束，码率超支记为令牌桶欠账（由后续P帧偿还）
+ * - P帧超过帧大小/帧率/码率任一限制即丢弃，并持续丢弃到下一个I帧
+ * - 超过max_frame_size的I帧同样丢弃，但返回VTX_LIMIT_OVERSIZE，
+ *   由调用者返回错误码，应用层据此降低I帧大小（否则后续P帧会一直等待）
+ */
+static vtx_limit_verdict_t vtx_tx_limit_check(vtx_tx_t* tx,
+                                              vtx_frame_type_t type,
+                                              size_t size) {
+    if (type != VTX_FRAME_I && type != VTX_FRAME_P) {
+        return VTX_LIMIT_PASS;
     }
 
-    /* 验证CRC */
-    if (!vtx_packet_verify(buf, buf + VTX_PACKET_HEADER_SIZE,
-                          n - VTX_PACKET_HEADER_SIZE)) {
-        vtx_log_warn("CRC verification failed");
-        return VTX_ERR_CHECKSUM;
+    vtx_spinlock_lock(&tx->limit_lock);
+
+    const vtx_limits_t* lim = &tx->limits;
+    if (lim->max_bitrate_kbps == 0 && lim->max_frame_size == 0 &&
+        lim->max_fps == 0) {
+        vtx_spinlock_unlock(&tx->limit_lock);
+        return VTX_LIMIT_PASS;
     }
 
-    /* 使用状态机处理数据帧 */
-    switch (header.frame_type) {
-    case VTX_DATA_ACK: {
-        /* ACK包，可能是数据帧ACK、CONNECTED ACK或媒体帧分片ACK */
+    uint64_t now_us = vtx_get_time_us();
 
-        /* 检查是否是CONNECTED的ACK（frame_id==0表示连接ACK） */
-        if (header.frame_id == 0 && !tx->connected) {
-            tx->connected = true;
-            tx->connect_retrans_count = 0;
-            tx->last_heartbeat_ms = vtx_get_time_ms();
-            tx->heartbeat_miss_count = 0;
-            vtx_log_info("Connection established with client");
-            break;
+    /* 补充令牌（桶容量为1秒的码率） */
+    if (lim->max_bitrate_kbps > 0) {
+        int64_t rate = (int64_t)lim->max_bitrate_kbps * 1000 / 8;
+        tx->limit_tokens += (int64_t)(now_us - tx->limit_refill_us) * rate / 1000000;
+        if (tx->limit_tokens > rate) {
+            tx->limit_tokens = rate;
         }
-
-        /* 检查是否是数据帧ACK */
-        vtx_frame_t* data_frame = vtx_frame_queue_find(tx->data_queue,
-                                                        header.frame_id);
-        if (data_frame) {
-            vtx_frame_queue_remove(tx->data_queue, data_frame);
-            vtx_frame_release(tx->data_pool, data_frame);
-            break;
+        tx->limit_refill_us = now_us;
+    }
+
+    bool drop = false;
+    bool oversize = false;
+    if (lim->max_frame_size > 0 && size > lim->max_frame_size) {
+        drop = true;
+        oversize = type == VTX_FRAME_I;
+    } else if (type == VTX_FRAME_P) {
+        /* 允许10%的帧间隔抖动 */
+        uint64_t min_interval_us = lim->max_fps > 0 ?
+                                   900000 / lim->max_fps : 0;
+        if (tx->limit_wait_iframe) {
+            drop = true;
+        } else if (min_interval_us > 0 && tx->limit_video_us > 0 &&
+                   now_us - tx->limit_video_us < min_interval_us) {
+            drop = true;
+        } else if (lim->max_bitrate_kbps > 0 &&
+                   tx->limit_tokens < (int64_t)size) {
+            drop = true;
         }
+    }
 
-        /* 检查是否是I帧分片ACK */
-        vtx_spinlock_lock(&tx->iframe_lock);
-        if (tx->last_iframe &&
-            tx->last_iframe->frame_id == header.frame_id &&
-            tx->last_iframe->retran) {
-            /* 标记对应分片为已ACK（不再重传） */
-            vtx_frag_header_t* retran = tx->last_iframe->retran;
-            if (header.frag_index < retran->num) {
-                retran->frag[header.frag_index].received = true;
-                vtx_log_debug("I-frame fragment ACKed: frame_id=%u, frag=%u",
-                            header.frame_id, header.frag_index);
-            }
+    if (drop) {
+        tx->limit_wait_iframe = true;
+    } else {
+        if (type == VTX_FRAME_I) {
+            tx->limit_wait_iframe = false;
         }
-        vtx_spinlock_unlock(&tx->iframe_lock);
-        break;
+        if (lim->max_bitrate_kbps > 0) {
+            tx->limit_tokens -= (int64_t)size;
+        }
+        tx->limit_video_us = now_us;
     }
 
-    case VTX_DATA_CONNECT: {
-        /* 连接请求：保存客户端地址，发送CONNECTED帧 */
-        vtx_log_info("Connection request from %s:%d",
-                    inet_ntoa(from_addr.sin_addr),
-                    ntohs(from_addr.sin_port));
+    uint32_t max_frame_size = lim->max_frame_size;
+    vtx_spinlock_unlock(&tx->limit_lock);
 
-        /* 保存客户端地址 */
-        tx->client_addr = from_addr;
-        tx->client_addr_len = from_len;
+    if (oversize) {
+        vtx_log_warn("I-frame exceeds receiver limit: size=%zu max_frame_size=%u",
+                    size, max_frame_size);
+        return VTX_LIMIT_OVERSIZE;
+    }
+    return drop ? VTX_LIMIT_DROP : VTX_LIMIT_PASS;
+}
 
-        /* 发送CONNECTED响应 */
-        vtx_packet_header_t conn_header = {0};
-        conn_header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
-        conn_header.frame_id = 0;  /* 连接帧使用frame_id=0 */
-        conn_header.frame_type = VTX_DATA_CONNECTED;
-        vtx_send_packet(tx, &conn_header, NULL, 0);
+/**
+ * @brief 应用接收端限制，丢弃的帧计入统计
+ *
+ * @param ret 输出：丢弃时调用者应返回的值（超大I帧为VTX_ERR_PACKET_TOO_LARGE）
+ * @return true帧已被丢弃
+ */
+static bool vtx_tx_limit_drop(vtx_tx_t* tx, vtx_frame_type_t type, size_t size,
+                              int* ret) {
+    vtx_limit_verdict_t verdict = vtx_tx_limit_check(tx, type, size);
+    if (verdict == VTX_LIMIT_PASS) {
+        return false;
+    }
 
-        /* 设置重传状态 */
-        tx->connect_send_time_ms = vtx_get_time_ms();
-        tx->connect_retrans_count = 0;
-        break;
+    vtx_log_debug("Frame dropped by receiver limits: type=%d size=%zu",
+                 type, size);
+    vtx_spinlock_lock(&tx->stats_lock);
+    tx->stats.limited_frames++;
+    if (verdict == VTX_LIMIT_OVERSIZE) {
+        tx->stats.oversize_iframes++;
     }
+    vtx_spinlock_unlock(&tx->stats_lock);
 
-    case VTX_DATA_DISCONNECT: {
-        /* 断开连接请求：发送ACK并断开 */
-        vtx_log_info("Disconnect request from client");
+    *ret = verdict == VTX_LIMIT_OVERSIZE ? VTX_ERR_PACKET_TOO_LARGE : VTX_OK;
+    return true;
+}
 
-        /* 发送ACK */
-        vtx_packet_header_t ack_header = {0};
-        ack_header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
-        ack_header.frame_id = 0;
-        ack_header.frame_type = VTX_DATA_ACK;
-        vtx_send_packet(tx, &ack_header, NULL, 0);
+/**
+ * @brief 从START/CONNECT payload中提取URL
+ *
+ * @return 有效的NULL终止字符串，无URL或URL无效时返回NULL（使用默认媒体源）
+ */
+static const char* vtx_tx_parse_url(const uint8_t* payload, size_t payload_len) {
+    if (payload_len == 0) {
+        return NULL;
+    }
 
-        /* 断开连接 */
-        tx->connected = false;
-        tx->connect_retrans_count = 0;
-        tx->heartbeat_miss_count = 0;
-        break;
+    if (payload_len > VTX_MAX_URL_SIZE) {
+        vtx_log_warn("URL too long (%zu bytes), ignoring", payload_len);
+        return NULL;
     }
 
-    case VTX_DATA_HEARTBEAT: {
+    /* 验证payload以NULL终止符结尾 */
+    if (payload[payload_len - 1] != '\0') {
+        vtx_log_warn("Invalid URL in START frame: missing null terminator");
+        return NULL;
+    }
+
+    return (const char*)payload;
+}
+
+/**
+ * @brief 重新发送缓存的I帧（新接收端可立即解码）
+ *
+ * 重置分片重传状态，之后由vtx_process_retrans_queue继续保护
+ */
+static void vtx_tx_resend_iframe(vtx_tx_t* tx) {
+    vtx_spinlock_lock(&tx->iframe_lock);
+    vtx_frame_t* iframe = tx->last_iframe;
+    if (!iframe) {
+        vtx_spinlock_unlock(&tx->iframe_lock);
+        return;
+    }
+
+    /* 加密帧的nonce盐属于旧会话，新会话的接收端无法解密，等待下一个I帧 */
+    if (iframe->sealed && iframe->seal_salt != atomic_load(&tx->seal_salt)) {
+        vtx_spinlock_unlock(&tx->iframe_lock);
+        vtx_log_debug("Cached I-frame sealed for previous session, not resent");
+        return;
+    }
+
+    /* 发送期间新I帧可能替换last_iframe，持有引用 */
+    vtx_frame_retain(iframe);
+    uint64_t now_ms = vtx_get_time_ms();
+    if (iframe->retran) {
+        for (uint16_t i = 0; i < iframe->retran->num; i++) {
+            vtx_frag_t* frag = &iframe->retran->frag[i];
+            frag->received = false;
+            frag->retrans_count = 0;
+            frag->send_time_ms = now_ms;
+        }
+        iframe->acked_frags = 0;
+    }
+    vtx_spinlock_unlock(&tx->iframe_lock);
+
+    size_t payload_capacity = tx->config.mtu - VTX_PACKET_HEADER_SIZE;
+    size_t wire_size = vtx_tx_wire_size(iframe);
+    for (uint16_t i = 0; i < iframe->total_frags; i++) {
+        size_t offset = i * payload_capacity;
+        size_t payload_size = wire_size - offset;
+        if (payload_size > payload_capacity) {
+            payload_size = payload_capacity;
+        }
+
+        vtx_packet_header_t header = {0};
+        header.seq_num = iframe->base_seq + i;
+        header.frame_id = iframe->frame_id;
+        header.frame_type = iframe->frame_type;
+        header.frag_index = i;
+        header.total_frags = iframe->total_frags;
+        header.payload_size = payload_size;
+        if (i == iframe->total_frags - 1) {
+            header.flags |= VTX_FLAG_LAST_FRAG;
+        }
+        header.flags |= vtx_tx_trailer_flags(iframe);
+
+        VTX_TRACE_FRAG_SEND(header.frame_id, i, header.total_frags,
+                            payload_size, header.seq_num);
+        uint8_t path;
+        if (vtx_tx_send_media_frag(tx, &header, iframe, offset, &path) != VTX_OK) {
+            break;
+        }
+
+        /* 发送期间retran可能随I帧替换被归还 */
+        vtx_spinlock_lock(&tx->iframe_lock);
+        if (tx->last_iframe == iframe && iframe->retran) {
+            iframe->retran->frag[i].path = path;
+        }
+        vtx_spinlock_unlock(&tx->iframe_lock);
+    }
+
+    vtx_log_info("Resent cached I-frame: id=%u size=%zu",
+                iframe->frame_id, iframe->data_size);
+    vtx_frame_release(vtx_tx_frame_pool(tx, iframe), iframe);
+}
+
+/**
+ * @brief 开始媒体传输（START或携带START的CONNECT）
+ *
+ * URL与上次相同时先重发缓存的I帧，再通知应用层
+ */
+static void vtx_tx_start_media(vtx_tx_t* tx, const char* url) {
+    if (url) {
+        vtx_log_info("Client requested START media with URL: %s", url);
+    } else {
+        vtx_log_info("Client requested START media (default source)");
+    }
+
+    const char* cur = url ? url : "";
+    if (tx->media_started && strcmp(tx->media_url, cur) == 0) {
+        vtx_tx_resend_iframe(tx);
+    }
+    snprintf(tx->media_url, sizeof(tx->media_url), "%s", cur);
+    tx->media_started = true;
+
+    if (tx->source) {
+        vtx_source_start(tx->source, url);
+    }
+
+    if (tx->media_fn) {
+        VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_MEDIA, VTX_DATA_START, 0);
+        tx->media_fn(VTX_DATA_START, url, tx->userdata);
+        VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_MEDIA, 0);
+    }
+}
+
+/**
+ * @brief 回复CONNECTED并开始等待ACK（超时重传）
+ */
+static void vtx_tx_reply_connected(vtx_tx_t* tx, uint8_t flags) {
+    vtx_tx_send_connected(tx, flags);
+
+    /* 设置重传状态 */
+    tx->connect_flags = flags;
+    tx->connect_send_time_ms = vtx_get_time_ms();
+    tx->connect_retrans_count = 0;
+}
+
+/**
+ * @brief 回复无状态CONNECTED（payload为cookie，不保存地址、不重传）
+ */
+static void vtx_tx_send_cookie(
+    vtx_tx_t* tx,
+    const struct sockaddr_in* addr,
+    socklen_t addr_len)
+{
+    uint8_t cookie[VTX_SESSION_TOKEN_SIZE];
+    vtx_session_pack_token(vtx_session_cookie(tx->cookie_key, addr, vtx_get_time_ms()),
+                           cookie);
+
+    vtx_packet_header_t header = {0};
+    header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+    header.frame_type = VTX_DATA_CONNECTED;
+    header.flags = VTX_FLAG_COOKIE;
+
+    struct iovec iov = {
+        .iov_base = cookie,
+        .iov_len = sizeof(cookie),
+    };
+    vtx_send_packet_iov_to(tx, tx->sockfd, addr, addr_len, &header, &iov, 1);
+}
+
+/**
+ * @brief 控制包源地址限速
+ *
+ * @return true允许处理
+ */
+static bool vtx_tx_rate_allow(vtx_tx_t* tx, const struct sockaddr_in* addr) {
+    if (vtx_ratelimit_allow(&tx->ratelimit, addr->sin_addr.s_addr,
+                            vtx_get_time_ms(), tx->config.control_rate)) {
+        return true;
+    }
+
+    vtx_spinlock_lock(&tx->stats_lock);
+    tx->stats.rate_limited++;
+    vtx_spinlock_unlock(&tx->stats_lock);
+    return false;
+}
+
+/**
+ * @brief 比较两个地址（IP和端口）
+ */
+static bool vtx_tx_addr_equal(const struct sockaddr_in* a, const struct sockaddr_in* b) {
+    return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+/**
+ * @brief 处理CONNECT（vtx_tx_accept和poll线程共用）
+ *
+ * payload布局：[会话令牌（VTX_FLAG_RESUME）][URL（VTX_FLAG_START）]
+ *
+ * 开启handshake_cookie时，没有有效令牌（会话令牌或cookie）的CONNECT
+ * 只收到无状态CONNECTED，不影响当前连接
+ *
+ * 配置了crypto_key时拒绝不带VTX_FLAG_CRYPT的CONNECT；未配置时不回显该标志，
+ * 要求加密的接收端自行拒绝
+ *
+ * @param immediate true表示不等待ACK直接进入连接状态（vtx_tx_accept）
+ * @return true建立（或恢复）了连接，false只回复了cookie或拒绝了请求
+ */
+static bool vtx_tx_handle_connect(
+    vtx_tx_t* tx,
+    const vtx_packet_header_t* header,
+    const uint8_t* payload,
+    size_t payload_len,
+    const struct sockaddr_in* from_addr,
+    socklen_t from_len,
+    bool immediate)
+{
+    /* 解析payload */
+    uint64_t token = 0;
+    if (header->flags & VTX_FLAG_RESUME) {
+        if (payload_len >= VTX_SESSION_TOKEN_SIZE) {
+            token = vtx_session_unpack_token(payload);
+            payload += VTX_SESSION_TOKEN_SIZE;
+            payload_len -= VTX_SESSION_TOKEN_SIZE;
+        } else {
+            payload_len = 0;
+        }
+    }
+
+    bool start = (header->flags & VTX_FLAG_START) != 0;
+    const char* url = start ? vtx_tx_parse_url(payload, payload_len) : NULL;
+
+    if (tx->crypto && !(header->flags & VTX_FLAG_CRYPT)) {
+        vtx_log_warn("Rejected CONNECT without encryption");
+        return false;
+    }
+
+    /* 令牌匹配则恢复会话（保留限制、I帧缓存和媒体状态） */
+    uint8_t flags = start ? VTX_FLAG_START : 0;
+    if (tx->crypto) {
+        flags |= VTX_FLAG_CRYPT;
+    }
+    bool resumed = vtx_session_resume(&tx->session, token);
+
+    /* 已建立的会话只能由令牌恢复，或由原地址重新连接；
+     * 其他地址不带有效令牌的CONNECT不能接管（需等待会话心跳超时挂起） */
+    if (!resumed && tx->connected && tx->session.token != 0 &&
+        !vtx_tx_addr_equal(from_addr, &tx->client_addr)) {
+        vtx_log_warn("Rejected CONNECT from %s:%d: session in use",
+                    inet_ntoa(from_addr->sin_addr), ntohs(from_addr->sin_port));
+        return false;
+    }
+
+    /* 无状态握手：对端证明可达（回显cookie）前不创建任何状态 */
+    if (!resumed && tx->config.handshake_cookie &&
+        !vtx_session_cookie_valid(tx->cookie_key, from_addr, token,
+                                  vtx_get_time_ms())) {
+        vtx_tx_send_cookie(tx, from_addr, from_len);
+        return false;
+    }
+
+    /* 保存客户端地址 */
+    tx->client_addr = *from_addr;
+    tx->client_addr_len = from_len;
+    memset(tx->probes, 0, sizeof(tx->probes));
+
+    if (resumed) {
+        flags |= VTX_FLAG_RESUME;
+        vtx_spinlock_lock(&tx->stats_lock);
+        tx->stats.session_resumes++;
+        vtx_spinlock_unlock(&tx->stats_lock);
+        vtx_log_info("Session resumed");
+    } else {
+        /* cookie验证通过时cookie即会话令牌 */
+        if (tx->config.handshake_cookie) {
+            vtx_session_open_token(&tx->session, token);
+        } else {
+            vtx_session_open(&tx->session);
+        }
+
+        /* 新会话使用新的nonce盐（恢复的会话保留，缓存的I帧仍可重发） */
+        if (tx->crypto) {
+            atomic_store(&tx->seal_seq_origin, atomic_load(&tx->seq_num));
+            atomic_store(&tx->seal_salt, vtx_session_random64());
+        }
+
+        /* 新会话：清除上一个接收端的限制 */
+        vtx_limits_t no_limits = {0};
+        vtx_tx_set_limits(tx, &no_limits);
+    }
+
+    vtx_tx_reply_connected(tx, flags);
+
+    /* 0-RTT START只接受已证明可达的对端（会话令牌或cookie），否则伪造源地址的
+     * 一个CONNECT就能让发送端向该地址推流；未验证时仍回显START，
+     * 收到CONNECTED的ACK后再开始 */
+    bool verified = resumed || tx->config.handshake_cookie;
+    tx->start_pending = start && !verified;
+    if (tx->start_pending) {
+        tx->start_pending_url = url != NULL;
+        snprintf(tx->start_url, sizeof(tx->start_url), "%s", url ? url : "");
+        start = false;
+    }
+
+    /* 3次握手收到ACK后才进入连接状态；
+     * 已验证的0-RTT START和会话恢复立即开始发送，CONNECTED仍重传直到ACK */
+    if (immediate || start || resumed) {
+        tx->connected = true;
+        tx->last_heartbeat_ms = vtx_get_time_ms();
+        tx->heartbeat_miss_count = 0;
+        vtx_log_info("Connection established with client%s",
+                    resumed ? " (resumed)" : (start ? " (0-RTT start)" : ""));
+    }
+
+    if (start) {
+        /* 恢复的会话请求同一媒体源：媒体仍在发送，只需重发I帧 */
+        if (resumed && tx->media_started &&
+            strcmp(tx->media_url, url ? url : "") == 0) {
+            vtx_tx_resend_iframe(tx);
+        } else {
+            vtx_tx_start_media(tx, url);
+        }
+    } else if (resumed && tx->media_started) {
+        vtx_tx_resend_iframe(tx);
+    }
+    return true;
+}
+
+/**
+ * @brief 查找地址对应的路径验证
+ */
+static vtx_tx_probe_t* vtx_tx_find_probe(vtx_tx_t* tx, const struct sockaddr_in* addr) {
+    for (int i = 0; i < VTX_TX_PROBE_SLOTS; i++) {
+        if (tx->probes[i].addr_len > 0 &&
+            vtx_tx_addr_equal(&tx->probes[i].addr, addr)) {
+            return &tx->probes[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 向新地址发送PROBE（NAT重绑定或客户端切换网络）
+ *
+ * 只由携带会话令牌的心跳触发（调用者已校验令牌），新地址的包本身先丢弃；
+ * 对端用令牌和挑战值应答PROBE后才切换client_addr。
+ * 最多同时验证VTX_TX_PROBE_SLOTS个地址，槽位满时只替换超过
+ * connect_timeout_ms的验证；同一地址的探测同样按connect_timeout_ms限速。
+ */
+static void vtx_tx_probe_path(
+    vtx_tx_t* tx,
+    const struct sockaddr_in* addr,
+    socklen_t addr_len)
+{
+    uint64_t now_ms = vtx_get_time_ms();
+
+    vtx_tx_probe_t* probe = vtx_tx_find_probe(tx, addr);
+    if (probe) {
+        if (now_ms - probe->send_ms < tx->config.connect_timeout_ms) {
+            return;
+        }
+    } else {
+        /* 空闲槽位，否则最早的已超时槽位 */
+        for (int i = 0; i < VTX_TX_PROBE_SLOTS; i++) {
+            vtx_tx_probe_t* p = &tx->probes[i];
+            if (p->addr_len == 0) {
+                probe = p;
+                break;
+            }
+            if (now_ms - p->send_ms >= tx->config.connect_timeout_ms &&
+                (!probe || p->send_ms < probe->send_ms)) {
+                probe = p;
+            }
+        }
+        if (!probe) {
+            vtx_log_debug("Path probe slots busy, ignoring %s:%d",
+                         inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
+            return;
+        }
+
+        probe->addr = *addr;
+        probe->addr_len = addr_len;
+        probe->challenge = vtx_session_random64();
+        vtx_log_info("Packet from new address %s:%d, validating path",
+                    inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
+    }
+
+    uint8_t challenge[VTX_SESSION_TOKEN_SIZE];
+    vtx_session_pack_token(probe->challenge, challenge);
+
+    vtx_packet_header_t header = {0};
+    header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+    header.frame_type = VTX_DATA_PROBE;
+
+    struct iovec iov = {
+        .iov_base = challenge,
+        .iov_len = sizeof(challenge),
+    };
+    vtx_send_packet_iov_to(tx, tx->sockfd, &probe->addr, probe->addr_len,
+                           &header, &iov, 1);
+    probe->send_ms = now_ms;
+}
+
+/**
+ * @brief 处理PROBE_ACK：令牌和挑战值都匹配时迁移到新地址
+ *
+ * 只替换client_addr，帧ID、序列号、I帧缓存和DATA窗口保持不变；
+ * 会话处于宽限期时同时恢复连接
+ */
+static void vtx_tx_handle_probe_ack(
+    vtx_tx_t* tx,
+    const uint8_t* payload,
+    size_t payload_len,
+    const struct sockaddr_in* from_addr)
+{
+    vtx_tx_probe_t* probe = vtx_tx_find_probe(tx, from_addr);
+    if (!probe || payload_len < 2 * VTX_SESSION_TOKEN_SIZE) {
+        return;
+    }
+
+    uint64_t token = vtx_session_unpack_token(payload);
+    uint64_t challenge = vtx_session_unpack_token(payload + VTX_SESSION_TOKEN_SIZE);
+    if (challenge != probe->challenge ||
+        !vtx_session_resume(&tx->session, token)) {
+        vtx_log_warn("PROBE_ACK rejected from %s:%d",
+                    inet_ntoa(from_addr->sin_addr), ntohs(from_addr->sin_port));
+        return;
+    }
+
+    tx->client_addr = probe->addr;
+    tx->client_addr_len = probe->addr_len;
+    memset(tx->probes, 0, sizeof(tx->probes));
+
+    vtx_spinlock_lock(&tx->stats_lock);
+    tx->stats.migrations++;
+    vtx_spinlock_unlock(&tx->stats_lock);
+
+    vtx_log_info("Client migrated to %s:%d",
+                inet_ntoa(from_addr->sin_addr), ntohs(from_addr->sin_port));
+
+    tx->last_heartbeat_ms = vtx_get_time_ms();
+    tx->heartbeat_miss_count = 0;
+    if (!tx->connected) {
+        tx->connected = true;
+        vtx_spinlock_lock(&tx->stats_lock);
+        tx->stats.session_resumes++;
+        vtx_spinlock_unlock(&tx->stats_lock);
+        if (tx->media_started) {
+            vtx_tx_resend_iframe(tx);
+        }
+    }
+}
+
+/**
+ * @brief 在额外路径上发送携带会话令牌的心跳ACK
+ *
+ * 接收端据此登记路径地址，之后该路径上的I帧分片ACK沿原路径返回。
+ * 连接建立时和每次收到心跳时发送（丢失后下一次心跳补上）
+ */
+static void vtx_tx_announce_paths(vtx_tx_t* tx) {
+    if (tx->paths.count <= 1 || tx->session.token == 0) {
+        return;
+    }
+
+    uint8_t token[VTX_SESSION_TOKEN_SIZE];
+    vtx_session_pack_token(tx->session.token, token);
+    struct iovec iov = { .iov_base = token, .iov_len = sizeof(token) };
+    for (uint8_t i = 1; i < tx->paths.count; i++) {
+        vtx_packet_header_t header = {0};
+        header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+        header.frame_id = 0;
+        header.frame_type = VTX_DATA_ACK;
+        vtx_send_packet_path(tx, i, &header, &iov, 1);
+    }
+}
+
+/**
+ * @brief 接收并处理数据包
+ */
+static int vtx_recv(vtx_tx_t* tx, int sockfd) {
+    uint8_t buf[sizeof(vtx_packet_header_t) + 128];
+    struct sockaddr_in from_addr;
+    socklen_t from_len = sizeof(from_addr);
+
+    ssize_t n = recvfrom(sockfd, buf, sizeof(buf), 0,
+                         (struct sockaddr*)&from_addr, &from_len);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;  /* 无数据 */
+        }
+        return VTX_ERR_SOCKET_RECV;
+    }
+    vtx_pcap_write(tx->capture, sockfd, VTX_PCAP_DIR_IN, &from_addr,
+                   &(struct iovec){ buf, (size_t)n }, 1);
+
+    if (n < VTX_PACKET_HEADER_SIZE) {
+        return VTX_ERR_PACKET_INVALID;
+    }
+
+    /* 反序列化包头 */
+    vtx_packet_header_t header;
+    memcpy(&header, buf, sizeof(header));
+
+    int ret = vtx_packet_deserialize_header(&header);
+    if (ret != VTX_OK) {
+        return ret;
+    }
+
+    /* 验证CRC */
+    if (!vtx_packet_verify(buf, buf + VTX_PACKET_HEADER_SIZE,
+                          n - VTX_PACKET_HEADER_SIZE)) {
+        vtx_log_warn("CRC verification failed");
+        return VTX_ERR_CHECKSUM;
+    }
+
+    /* CONNECT和来自非客户端地址的包按源地址限速 */
+    bool from_client = vtx_tx_addr_equal(&from_addr, &tx->client_addr);
+    if ((header.frame_type == VTX_DATA_CONNECT || !from_client) &&
+        !vtx_tx_rate_allow(tx, &from_addr)) {
+        return VTX_OK;
+    }
+
+    /* 会话存在时，来自其他地址的包需先通过路径验证（CONNECT由handle_connect
+     * 检查令牌）；只有携带会话令牌的心跳才发起验证，其他包直接丢弃 */
+    if (tx->session.token != 0 &&
+        header.frame_type != VTX_DATA_CONNECT &&
+        header.frame_type != VTX_DATA_PROBE_ACK &&
+        !from_client) {
+        if (header.frame_type == VTX_DATA_HEARTBEAT &&
+            n - VTX_PACKET_HEADER_SIZE >= VTX_SESSION_TOKEN_SIZE &&
+            vtx_session_unpack_token(buf + VTX_PACKET_HEADER_SIZE) ==
+                tx->session.token) {
+            vtx_tx_probe_path(tx, &from_addr, from_len);
+        }
+        return VTX_OK;
+    }
+
+    /* 使用状态机处理数据帧 */
+    switch (header.frame_type) {
+    case VTX_DATA_ACK: {
+        /* ACK包，可能是数据帧ACK、CONNECTED ACK或媒体帧分片ACK */
+        VTX_TRACE_ACK_RECV(header.frame_id, header.frag_index, header.seq_num);
+
+        /* 检查是否是CONNECTED的ACK（frame_id==0表示连接ACK） */
+        if (header.frame_id == 0 && tx->connect_send_time_ms > 0) {
+            tx->connect_send_time_ms = 0;
+            tx->connect_retrans_count = 0;
+            if (!tx->connected) {
+                tx->connected = true;
+                tx->last_heartbeat_ms = vtx_get_time_ms();
+                tx->heartbeat_miss_count = 0;
+                vtx_log_info("Connection established with client");
+            }
+            vtx_tx_announce_paths(tx);
+
+            /* 对端已证明可达，开始等待中的0-RTT START */
+            if (tx->start_pending) {
+                tx->start_pending = false;
+                vtx_tx_start_media(tx, tx->start_pending_url ? tx->start_url : NULL);
+            }
+            break;
+        }
+
+        /* 检查是否是数据帧ACK */
+        uint32_t rtt_ms;
+        if (vtx_data_window_ack(&tx->data_win, header.frame_id,
+                                vtx_get_time_ms(), &rtt_ms)) {
+            /* 未重传的DATA包可作为RTT样本（Karn算法） */
+            if (rtt_ms != VTX_DATA_NO_RTT) {
+                vtx_sockbuf_note_rtt(&tx->sndbuf, rtt_ms);
+            }
+            break;
+        }
+
+        /* 检查是否是I帧分片ACK */
+        vtx_spinlock_lock(&tx->iframe_lock);
+        if (tx->last_iframe &&
+            tx->last_iframe->frame_id == header.frame_id &&
+            tx->last_iframe->retran) {
+            /* 标记对应分片为已ACK（不再重传） */
+            vtx_frame_t* iframe = tx->last_iframe;
+            vtx_frag_header_t* retran = iframe->retran;
+            if (header.frag_index < retran->num &&
+                !retran->frag[header.frag_index].received) {
+                vtx_frag_t* frag = &retran->frag[header.frag_index];
+                frag->received = true;
+                iframe->acked_frags++;
+                /* ACK计入其到达的路径：重复发送时先到的副本可能不在frag->path上，
+                 * 接收端对未知来源地址的分片经主路径ACK；只有该路径上
+                 * 确实发出过同一时刻的副本时才作为该路径的RTT样本 */
+                uint8_t ack_path = vtx_path_find(&tx->paths, sockfd);
+                uint32_t rtt_ms = VTX_PATH_NO_RTT;
+                if (frag->retrans_count == 0 && frag->send_time_ms > 0) {
+                    rtt_ms = (uint32_t)(vtx_get_time_ms() - frag->send_time_ms);
+                    vtx_sockbuf_note_rtt(&tx->sndbuf, rtt_ms);
+                    if (ack_path != frag->path && !tx->config.path_duplicate) {
+                        rtt_ms = VTX_PATH_NO_RTT;
+                    }
+                }
+                vtx_path_on_ack(&tx->paths, ack_path, rtt_ms);
+                vtx_log_debug("I-frame fragment ACKed: frame_id=%u, frag=%u",
+                            header.frame_id, header.frag_index);
+
+                /* 全部分片已确认：记录重传完成时间 */
+                if (iframe->acked_frags == iframe->total_frags &&
+                    tx->config.latency_stats &&
+                    iframe->timing.last_wire_us > 0) {
+                    iframe->timing.retrans_done_us = vtx_get_time_us();
+                    uint64_t us = iframe->timing.retrans_done_us -
+                                  iframe->timing.last_wire_us;
+                    vtx_spinlock_lock(&tx->stats_lock);
+                    vtx_latency_hist_record(&tx->stats.lat_retrans, us);
+                    vtx_spinlock_unlock(&tx->stats_lock);
+                }
+            }
+        }
+        vtx_spinlock_unlock(&tx->iframe_lock);
+        break;
+    }
+
+    case VTX_DATA_CONNECT: {
+        /* 连接请求：保存客户端地址，发送CONNECTED帧 */
+        vtx_log_info("Connection request from %s:%d",
+                    inet_ntoa(from_addr.sin_addr),
+                    ntohs(from_addr.sin_port));
+
+        vtx_tx_handle_connect(tx, &header, buf + VTX_PACKET_HEADER_SIZE,
+                              n - VTX_PACKET_HEADER_SIZE,
+                              &from_addr, from_len, false);
+        break;
+    }
+
+    case VTX_DATA_PROBE_ACK:
+        vtx_tx_handle_probe_ack(tx, buf + VTX_PACKET_HEADER_SIZE,
+                                n - VTX_PACKET_HEADER_SIZE, &from_addr);
+        break;
+
+    case VTX_DATA_DISCONNECT: {
+        /* 断开连接请求：发送ACK并断开 */
+        vtx_log_info("Disconnect request from client");
+
+        /* 发送ACK */
+        vtx_packet_header_t ack_header = {0};
+        ack_header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+        ack_header.frame_id = 0;
+        ack_header.frame_type = VTX_DATA_ACK;
+        vtx_send_packet(tx, &ack_header, NULL, 0);
+
+        /* 断开连接（主动断开不保留会话） */
+        tx->connected = false;
+        tx->connect_retrans_count = 0;
+        tx->heartbeat_miss_count = 0;
+        vtx_session_close(&tx->session);
+        vtx_source_stop(tx->source);
+        break;
+    }
+
+    case VTX_DATA_HEARTBEAT: {
         /* 心跳包：发送ACK并更新时间戳 */
         vtx_packet_header_t ack_header = {0};
         ack_header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
         ack_header.frame_id = 0;
         ack_header.frame_type = VTX_DATA_ACK;
         vtx_send_packet(tx, &ack_header, NULL, 0);
+        vtx_tx_announce_paths(tx);
 
         /* 更新心跳时间 */
         tx->last_heartbeat_ms = vtx_get_time_ms();
@@ -582,40 +1560,21 @@ static int vtx_recv(vtx_tx_t* tx) {
         break;
     }
 
-    case VTX_DATA_START: {
+    case VTX_DATA_START:
         /* 开始媒体传输，从payload中提取URL */
-        const char* url = NULL;
-        size_t payload_len = n - VTX_PACKET_HEADER_SIZE;
-
-        if (payload_len > 0 && payload_len < VTX_MAX_URL_SIZE) {
-            /* 验证payload以NULL终止符结尾 */
-            const uint8_t* payload = buf + VTX_PACKET_HEADER_SIZE;
-            if (payload[payload_len - 1] == '\0') {
-                /* payload是有效的NULL终止字符串 */
-                url = (const char*)payload;
-                vtx_log_info("Client requested START media with URL: %s", url);
-            } else {
-                vtx_log_warn("Invalid URL in START frame: missing null terminator");
-                vtx_log_info("Client requested START media (using default)");
-            }
-        } else if (payload_len > 0) {
-            vtx_log_warn("URL too long (%zu bytes), ignoring", payload_len);
-            vtx_log_info("Client requested START media (using default)");
-        } else {
-            vtx_log_info("Client requested START media (default source)");
-        }
-
-        if (tx->media_fn) {
-            tx->media_fn(VTX_DATA_START, url, tx->userdata);
-        }
+        vtx_tx_start_media(tx,
+                           vtx_tx_parse_url(buf + VTX_PACKET_HEADER_SIZE,
+                                            n - VTX_PACKET_HEADER_SIZE));
         break;
-    }
 
     case VTX_DATA_STOP:
         /* 停止媒体传输 */
         vtx_log_info("Client requested STOP media");
+        vtx_source_stop(tx->source);
         if (tx->media_fn) {
+            VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_MEDIA, VTX_DATA_STOP, 0);
             tx->media_fn(VTX_DATA_STOP, NULL, tx->userdata);
+            VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_MEDIA, 0);
         }
         break;
 
@@ -629,10 +1588,65 @@ static int vtx_recv(vtx_tx_t* tx) {
 
         /* 调用回调 */
         if (tx->data_fn) {
-            tx->data_fn(VTX_DATA_USER,
-                       buf + VTX_PACKET_HEADER_SIZE,
-                       n - VTX_PACKET_HEADER_SIZE,
-                       tx->userdata);
+            VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_DATA, VTX_DATA_USER,
+                                     n - VTX_PACKET_HEADER_SIZE);
+            int cb_ret = tx->data_fn(VTX_DATA_USER,
+                                     buf + VTX_PACKET_HEADER_SIZE,
+                                     n - VTX_PACKET_HEADER_SIZE,
+                                     tx->userdata);
+            VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_DATA, cb_ret);
+            (void)cb_ret;
+        }
+        break;
+    }
+
+    case VTX_DATA_LIMIT: {
+        /* 接收端能力限制（可靠传输），发送ACK */
+        vtx_packet_header_t ack_header = {0};
+        ack_header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+        ack_header.frame_id = header.frame_id;
+        ack_header.frame_type = VTX_DATA_ACK;
+        vtx_send_packet(tx, &ack_header, NULL, 0);
+
+        vtx_limits_t limits;
+        if (vtx_packet_unpack_limits(buf + VTX_PACKET_HEADER_SIZE,
+                                     n - VTX_PACKET_HEADER_SIZE,
+                                     &limits) != VTX_OK) {
+            vtx_log_warn("Invalid LIMIT payload: %zd bytes",
+                        n - VTX_PACKET_HEADER_SIZE);
+            break;
+        }
+
+        /* ACK丢失导致的重传：只回ACK，不重复应用和回调 */
+        vtx_spinlock_lock(&tx->limit_lock);
+        bool dup = tx->limit_id_valid && tx->limit_frame_id == header.frame_id;
+        vtx_spinlock_unlock(&tx->limit_lock);
+        if (dup) {
+            vtx_log_debug("Duplicate LIMIT ignored: frame_id=%u", header.frame_id);
+            break;
+        }
+
+        vtx_log_info("Client limits: bitrate=%ukbps fps=%u frame_size=%u "
+                    "resolution=%ux%u",
+                    limits.max_bitrate_kbps, limits.max_fps,
+                    limits.max_frame_size, limits.max_width,
+                    limits.max_height);
+        vtx_tx_set_limits(tx, &limits);
+        vtx_spinlock_lock(&tx->limit_lock);
+        tx->limit_frame_id = header.frame_id;
+        tx->limit_id_valid = true;
+        vtx_spinlock_unlock(&tx->limit_lock);
+
+        /* 通知应用层（可据此调整编码参数，避免TX端丢帧） */
+        if (tx->data_fn) {
+            VTX_TRACE_CALLBACK_ENTRY(VTX_TRACE_CB_DATA, VTX_DATA_LIMIT,
+                                     sizeof(limits));
+            int cb_ret = tx->data_fn(VTX_DATA_LIMIT,
+                                     (const uint8_t*)&limits,
+                                     sizeof(limits),
+                                     tx->userdata);
+            VTX_TRACE_CALLBACK_EXIT(VTX_TRACE_CB_DATA, cb_ret);
+            (void)cb_ret;
         }
         break;
     }
@@ -645,6 +1659,14 @@ static int vtx_recv(vtx_tx_t* tx) {
     return 1;  /* 处理了一个包 */
 }
 
+/**
+ * @brief 关闭已绑定的额外路径（vtx_tx_listen失败时回滚到只有主路径）
+ */
+static void vtx_tx_unbind_paths(vtx_tx_t* tx) {
+    vtx_path_set_destroy(&tx->paths);
+    vtx_path_set_init(&tx->paths, tx->sockfd);
+}
+
 /* ========== 公共API ========== */
 
 vtx_tx_t* vtx_tx_create(
@@ -666,6 +1688,9 @@ vtx_tx_t* vtx_tx_create(
 
     /* 拷贝配置 */
     tx->config = *config;
+#ifdef VTX_DEBUG
+    atomic_init(&tx->drop_state, (uint32_t)(uintptr_t)tx | 1);
+#endif
     if (!tx->config.bind_addr) {
         tx->config.bind_addr = "0.0.0.0";
     }
@@ -696,48 +1721,99 @@ vtx_tx_t* vtx_tx_create(
     if (tx->config.heartbeat_max_miss == 0) {
         tx->config.heartbeat_max_miss = VTX_DEFAULT_HEARTBEAT_MAX_MISS;
     }
+    if (tx->config.session_grace_ms == 0) {
+        tx->config.session_grace_ms = VTX_DEFAULT_SESSION_GRACE_MS;
+    }
+    if (tx->config.control_rate == 0) {
+        tx->config.control_rate = VTX_DEFAULT_CONTROL_RATE;
+    }
+
+    /* 载荷加密 */
+    if (tx->config.crypto_key) {
+        tx->crypto = vtx_crypto_create(tx->config.crypto_key);
+        if (!tx->crypto) {
+            vtx_free(tx);
+            return NULL;
+        }
+    }
+
+    /* cookie密钥 */
+    uint64_t key0 = vtx_session_random64();
+    uint64_t key1 = vtx_session_random64();
+    memcpy(tx->cookie_key, &key0, sizeof(key0));
+    memcpy(tx->cookie_key + sizeof(key0), &key1, sizeof(key1));
 
     /* 创建socket */
     tx->sockfd = vtx_create_socket();
     if (tx->sockfd < 0) {
+        vtx_crypto_destroy(tx->crypto);
         vtx_free(tx);
         return NULL;
     }
 
+    /* 设置发送缓冲区（失败时保留系统默认值） */
+    vtx_sockbuf_init(&tx->sndbuf, tx->sockfd, true, tx->config.send_buf_size);
+    tx->stats.sock_buf_size = tx->sndbuf.actual;
+
+    /* 主路径，额外路径在vtx_tx_listen中绑定 */
+    vtx_path_set_init(&tx->paths, tx->sockfd);
+
     /* 创建内存池 */
     tx->media_pool = vtx_frame_pool_create(VTX_FRAME_POOL_INIT_SIZE,
                                            VTX_MEDIA_FRAME_DATA_SIZE);
-    tx->data_pool = vtx_frame_pool_create(VTX_FRAME_POOL_INIT_SIZE * 4,
-                                          VTX_CTRL_FRAME_DATA_SIZE);
+    tx->wrap_pool = vtx_frame_pool_create(VTX_FRAME_POOL_INIT_SIZE, 0);
     tx->frag_pool = vtx_frag_pool_create();
-    if (!tx->media_pool || !tx->data_pool || !tx->frag_pool) {
+    if (!tx->media_pool || !tx->wrap_pool || !tx->frag_pool) {
         vtx_log_error("Failed to create frame pools");
         if (tx->media_pool) vtx_frame_pool_destroy(tx->media_pool);
-        if (tx->data_pool) vtx_frame_pool_destroy(tx->data_pool);
+        if (tx->wrap_pool) vtx_frame_pool_destroy(tx->wrap_pool);
         if (tx->frag_pool) vtx_frag_pool_destroy(tx->frag_pool);
         close(tx->sockfd);
+        vtx_crypto_destroy(tx->crypto);
         vtx_free(tx);
         return NULL;
     }
 
     /* 创建队列 */
-    tx->send_queue = vtx_frame_queue_create(tx->media_pool, 0);
-    tx->data_queue = vtx_frame_queue_create(
-        tx->data_pool, tx->config.data_retrans_timeout_ms);
-    if (!tx->send_queue || !tx->data_queue) {
+    tx->send_queue = vtx_frame_queue_create(tx->media_pool, tx->frag_pool, 0);
+    if (!tx->send_queue) {
         vtx_log_error("Failed to create queues");
         vtx_frame_pool_destroy(tx->media_pool);
-        vtx_frame_pool_destroy(tx->data_pool);
-        if (tx->send_queue) vtx_frame_queue_destroy(tx->send_queue);
-        if (tx->data_queue) vtx_frame_queue_destroy(tx->data_queue);
+        vtx_frame_pool_destroy(tx->wrap_pool);
+        vtx_frag_pool_destroy(tx->frag_pool);
         close(tx->sockfd);
+        vtx_crypto_destroy(tx->crypto);
         vtx_free(tx);
         return NULL;
     }
 
+    /* 内置文件媒体源 */
+    if (tx->config.media_root) {
+        if (tx->config.media_fps == 0) {
+            tx->config.media_fps = VTX_DEFAULT_MEDIA_FPS;
+        }
+        tx->source = vtx_source_create(tx->config.media_root, tx->config.media_fps);
+        if (!tx->source) {
+            vtx_log_error("Failed to create file source: %s", tx->config.media_root);
+            vtx_frame_queue_destroy(tx->send_queue);
+            vtx_frame_pool_destroy(tx->media_pool);
+            vtx_frame_pool_destroy(tx->wrap_pool);
+            vtx_frag_pool_destroy(tx->frag_pool);
+            close(tx->sockfd);
+            vtx_crypto_destroy(tx->crypto);
+            vtx_free(tx);
+            return NULL;
+        }
+        tx->config.media_root = NULL;  /* 不保留调用者的字符串 */
+    }
+
+    /* 初始化DATA窗口 */
+    vtx_data_window_init(&tx->data_win);
+
     /* 初始化锁 */
     vtx_spinlock_init(&tx->iframe_lock);
     vtx_spinlock_init(&tx->stats_lock);
+    vtx_spinlock_init(&tx->limit_lock);
 
     /* 设置回调 */
     tx->data_fn = data_fn;
@@ -746,6 +1822,12 @@ vtx_tx_t* vtx_tx_create(
 
     tx->running = true;
 
+    /* 抓包（失败不影响收发） */
+    if (tx->config.capture_path) {
+        tx->capture = vtx_pcap_open(tx->config.capture_path);
+        tx->config.capture_path = NULL;  /* 不保留调用者的字符串 */
+    }
+
     vtx_log_info("TX created: bind=%s:%u mtu=%u",
                 tx->config.bind_addr, tx->config.bind_port, tx->config.mtu);
 
@@ -775,6 +1857,44 @@ int vtx_tx_listen(vtx_tx_t* tx) {
     vtx_log_info("TX listening on %s:%u",
                 tx->config.bind_addr, tx->config.bind_port);
 
+    /* 额外路径：绑定到其他本地地址（端口由系统分配） */
+    for (int i = 0; i < VTX_MAX_PATHS - 1; i++) {
+        const char* path_addr = tx->config.path_addrs[i];
+        if (!path_addr) {
+            continue;
+        }
+
+        struct sockaddr_in local = {0};
+        local.sin_family = AF_INET;
+        if (inet_pton(AF_INET, path_addr, &local.sin_addr) <= 0) {
+            vtx_log_error("Invalid path address: %s", path_addr);
+            vtx_tx_unbind_paths(tx);
+            return VTX_ERR_ADDR_INVALID;
+        }
+
+        int fd = vtx_create_socket();
+        if (fd < 0) {
+            vtx_tx_unbind_paths(tx);
+            return fd;
+        }
+        if (bind(fd, (struct sockaddr*)&local, sizeof(local)) < 0) {
+            vtx_log_error("Failed to bind path %s: %s", path_addr, strerror(errno));
+            close(fd);
+            vtx_tx_unbind_paths(tx);
+            return VTX_ERR_SOCKET_BIND;
+        }
+        /* 与主路径相同的发送缓冲区（自动调整只作用于主路径） */
+        if (tx->sndbuf.actual > 0) {
+            vtx_socket_set_buf(fd, true, tx->sndbuf.actual, NULL);
+        }
+
+        if (vtx_path_set_add(&tx->paths, fd) < 0) {
+            close(fd);
+            break;
+        }
+        vtx_log_info("TX path %u bound to %s", tx->paths.count - 1, path_addr);
+    }
+
     return VTX_OK;
 }
 
@@ -795,8 +1915,8 @@ int vtx_tx_accept(vtx_tx_t* tx, uint32_t timeout_ms) {
             return VTX_ERR_TIMEOUT;
         }
 
-        /* 接收数据 */
-        uint8_t buf[sizeof(vtx_packet_header_t)];
+        /* 接收数据（CONNECT可能携带START的URL） */
+        uint8_t buf[VTX_DEFAULT_MTU];
         struct sockaddr_in from_addr;
         socklen_t from_len = sizeof(from_addr);
 
@@ -810,6 +1930,8 @@ int vtx_tx_accept(vtx_tx_t* tx, uint32_t timeout_ms) {
             vtx_log_error("recvfrom failed: %s (errno=%d)", strerror(errno), errno);
             return VTX_ERR_SOCKET_RECV;
         }
+        vtx_pcap_write(tx->capture, tx->sockfd, VTX_PCAP_DIR_IN, &from_addr,
+                       &(struct iovec){ buf, (size_t)n }, 1);
 
         vtx_log_debug("vtx_tx_accept: received %zd bytes from %s:%d",
                      n, inet_ntoa(from_addr.sin_addr), ntohs(from_addr.sin_port));
@@ -834,46 +1956,108 @@ int vtx_tx_accept(vtx_tx_t* tx, uint32_t timeout_ms) {
 
         /* 检查是否为连接请求 */
         if (header.frame_type == VTX_DATA_CONNECT) {
-            tx->client_addr = from_addr;
-            tx->client_addr_len = from_len;
-            tx->connected = true;
-
-            vtx_log_info("Client connected from %s:%d (saved addr family=%d, len=%d)",
-                        inet_ntoa(from_addr.sin_addr),
-                        ntohs(from_addr.sin_port),
-                        from_addr.sin_family,
-                        from_len);
-
-            /* 发送CONNECTED完成3次握手 */
-            vtx_packet_header_t connected = {0};
-            connected.seq_num = atomic_fetch_add(&tx->seq_num, 1);
-            connected.frame_type = VTX_DATA_CONNECTED;
-            connected.total_frags = 1;  /* 控制帧为单包 */
-            vtx_send_packet(tx, &connected, NULL, 0);
+            if (!vtx_packet_verify(buf, buf + VTX_PACKET_HEADER_SIZE,
+                                   n - VTX_PACKET_HEADER_SIZE)) {
+                vtx_log_warn("vtx_tx_accept: CRC verification failed");
+                continue;
+            }
 
-            return VTX_OK;
+            if (!vtx_tx_rate_allow(tx, &from_addr)) {
+                continue;
+            }
+
+            /* 发送CONNECTED完成3次握手（携带START时回显标志并开始媒体）；
+             * 只回复了cookie时继续等待带cookie的CONNECT */
+            if (vtx_tx_handle_connect(tx, &header, buf + VTX_PACKET_HEADER_SIZE,
+                                      n - VTX_PACKET_HEADER_SIZE,
+                                      &from_addr, from_len, true)) {
+                vtx_log_info("Client connected from %s:%d (saved addr family=%d, len=%d)",
+                            inet_ntoa(from_addr.sin_addr),
+                            ntohs(from_addr.sin_port),
+                            from_addr.sin_family,
+                            from_len);
+                return VTX_OK;
+            }
         }
     }
 
     return VTX_ERR_TIMEOUT;
 }
 
+/**
+ * @brief 自动调整发送缓冲区（仅send_buf_size为VTX_SOCKBUF_AUTO时生效）
+ */
+static void vtx_tx_update_sockbuf(vtx_tx_t* tx) {
+    if (tx->sndbuf.configured != VTX_SOCKBUF_AUTO) {
+        return;
+    }
+
+    vtx_spinlock_lock(&tx->stats_lock);
+    uint64_t total_bytes = tx->stats.total_bytes;
+    vtx_spinlock_unlock(&tx->stats_lock);
+
+    if (vtx_sockbuf_update(&tx->sndbuf, tx->sockfd, true,
+                           total_bytes, vtx_get_time_ms())) {
+        vtx_spinlock_lock(&tx->stats_lock);
+        tx->stats.sock_buf_size = tx->sndbuf.actual;
+        vtx_spinlock_unlock(&tx->stats_lock);
+    }
+}
+
+int vtx_tx_apply_thread_config(vtx_tx_t* tx) {
+    if (!tx) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    int result = vtx_thread_apply(&tx->config.thread, tx->sockfd);
+
+    /* 额外路径的ACK同样在poll线程接收 */
+    for (uint8_t i = 1; i < tx->paths.count; i++) {
+        int ret = vtx_thread_apply_socket(&tx->config.thread, tx->paths.paths[i].sockfd);
+        if (ret != VTX_OK) {
+            result = ret;
+        }
+    }
+
+    return result;
+}
+
 int vtx_tx_poll(vtx_tx_t* tx, uint32_t timeout_ms) {
     if (!tx) {
         return VTX_ERR_INVALID_PARAM;
     }
 
-    /* 使用select等待 */
+    /* 使用select等待（多路径时ACK沿各路径返回） */
     fd_set readfds;
     FD_ZERO(&readfds);
-    FD_SET(tx->sockfd, &readfds);
+    int maxfd = -1;
+    for (uint8_t i = 0; i < tx->paths.count; i++) {
+        int fd = tx->paths.paths[i].sockfd;
+        FD_SET(fd, &readfds);
+        if (fd > maxfd) {
+            maxfd = fd;
+        }
+    }
 
     struct timeval tv;
     tv.tv_sec = timeout_ms / 1000;
     tv.tv_usec = (timeout_ms % 1000) * 1000;
+    struct timeval* ptv = timeout_ms > 0 ? &tv : NULL;
+
+    /* 内置文件媒体源：最多等到下一帧的发送时间 */
+    uint64_t wait_us = vtx_source_wait_us(tx->source);
+    if (wait_us != UINT64_MAX &&
+        (!ptv || wait_us < (uint64_t)timeout_ms * 1000)) {
+        tv.tv_sec = wait_us / 1000000;
+        tv.tv_usec = wait_us % 1000000;
+        ptv = &tv;
+    }
+
+    int ret = select(maxfd + 1, &readfds, NULL, NULL, ptv);
+
+    vtx_tx_update_sockbuf(tx);
+    vtx_source_pump(tx->source, tx);
 
-    int ret = select(tx->sockfd + 1, &readfds, NULL, NULL,
-                    timeout_ms > 0 ? &tv : NULL);
     if (ret < 0) {
         if (errno == EINTR) {
             return 0;
@@ -894,7 +2078,14 @@ int vtx_tx_poll(vtx_tx_t* tx, uint32_t timeout_ms) {
     }
 
     /* 处理接收到的数据 */
-    return vtx_recv(tx);
+    int result = 0;
+    for (uint8_t i = 0; i < tx->paths.count; i++) {
+        int fd = tx->paths.paths[i].sockfd;
+        if (FD_ISSET(fd, &readfds)) {
+            result = vtx_recv(tx, fd);
+        }
+    }
+    return result;
 }
 
 int vtx_tx_send(vtx_tx_t* tx, const uint8_t* data, size_t size) {
@@ -910,37 +2101,33 @@ int vtx_tx_send(vtx_tx_t* tx, const uint8_t* data, size_t size) {
         return VTX_ERR_PACKET_TOO_LARGE;
     }
 
-    /* 创建DATA帧 */
-    vtx_frame_t* frame = vtx_frame_pool_acquire(tx->data_pool);
-    if (!frame) {
-        return VTX_ERR_NO_MEMORY;
+    /* 预留DATA窗口槽位（不分配内存） */
+    uint16_t frame_id = atomic_fetch_add(&tx->frame_id, 1);
+    vtx_data_slot_t* slot = vtx_data_window_reserve(&tx->data_win, frame_id,
+                                                    VTX_DATA_USER, data, size);
+    if (!slot) {
+        vtx_log_warn("DATA window full: frame_id=%u", frame_id);
+        return VTX_ERR_BUSY;
     }
 
-    frame->frame_id = atomic_fetch_add(&tx->frame_id, 1);
-    frame->frame_type = (vtx_frame_type_t)VTX_DATA_USER;
-    frame->data_size = size;
-    memcpy(frame->data, data, size);
-    frame->send_time_ms = vtx_get_time_ms();
-
     /* 发送 */
     vtx_packet_header_t header = {0};
     header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
-    header.frame_id = frame->frame_id;
+    header.frame_id = frame_id;
     header.frame_type = VTX_DATA_USER;
     header.frag_index = 0;
     header.total_frags = 1;
     header.payload_size = size;
 
-    int ret = vtx_send_packet(tx, &header, frame->data, size);
+    /* 先提交再发送，避免ACK先于提交到达而被忽略 */
+    vtx_data_window_commit(slot, vtx_get_time_ms());
+
+    int ret = vtx_send_packet(tx, &header, slot->data, size);
     if (ret != VTX_OK) {
-        vtx_frame_release(tx->data_pool, frame);
+        vtx_data_window_cancel(slot);
         return ret;
     }
 
-    /* 加入data队列等待ACK */
-    vtx_frame_queue_push(tx->data_queue, frame);
-    vtx_frame_release(tx->data_pool, frame);
-
     return VTX_OK;
 }
 
@@ -958,11 +2145,377 @@ void vtx_tx_free_frame(vtx_tx_t* tx, vtx_frame_t* frame) {
     }
 
     /* 判断frame来自哪个池 */
-    if (frame->data_capacity == VTX_MEDIA_FRAME_DATA_SIZE) {
-        vtx_frame_release(tx->media_pool, frame);
-    } else {
-        vtx_frame_release(tx->data_pool, frame);
+    vtx_frame_release(vtx_tx_frame_pool(tx, frame), frame);
+}
+
+vtx_frame_t* vtx_tx_wrap_media_frame(
+    vtx_tx_t* tx,
+    const uint8_t* data,
+    size_t size,
+    vtx_on_release_fn release_fn,
+    void* release_ctx)
+{
+    if (!tx || !data || size == 0 || size > VTX_MAX_FRAME_SIZE) {
+        return NULL;
+    }
+
+    vtx_frame_t* frame = vtx_frame_pool_acquire(tx->wrap_pool);
+    if (!frame) {
+        return NULL;
+    }
+
+    if (vtx_frame_wrap(frame, data, size, release_fn, release_ctx) != VTX_OK) {
+        vtx_frame_release(tx->wrap_pool, frame);
+        return NULL;
+    }
+
+    return frame;
+}
+
+vtx_frame_t* vtx_tx_wrap_media_frame_iov(
+    vtx_tx_t* tx,
+    const struct iovec* iov,
+    int iovcnt,
+    vtx_on_release_fn release_fn,
+    void* release_ctx)
+{
+    if (!tx || !iov || iovcnt <= 0 || iovcnt > VTX_MAX_IOV) {
+        return NULL;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+    if (total == 0 || total > VTX_MAX_FRAME_SIZE) {
+        return NULL;
+    }
+
+    vtx_frame_t* frame = vtx_frame_pool_acquire(tx->wrap_pool);
+    if (!frame) {
+        return NULL;
+    }
+
+    if (vtx_frame_wrap_iov(frame, iov, iovcnt, release_fn, release_ctx) != VTX_OK) {
+        vtx_frame_release(tx->wrap_pool, frame);
+        return NULL;
+    }
+
+    return frame;
+}
+
+int vtx_tx_send_media_iov(
+    vtx_tx_t* tx,
+    const struct iovec* iov,
+    int iovcnt,
+    vtx_frame_type_t type,
+    vtx_on_release_fn release_fn,
+    void* release_ctx)
+{
+    int ret = VTX_ERR_INVALID_PARAM;
+    vtx_frame_t* frame = NULL;
+
+    size_t total = 0;
+    for (int i = 0; iov && i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+
+    if (tx && iov && iovcnt > 0 && iovcnt <= VTX_MAX_IOV) {
+        if (total > 0 && total <= VTX_MAX_FRAME_SIZE) {
+            ret = VTX_ERR_NO_MEMORY;
+            frame = vtx_tx_wrap_media_frame_iov(tx, iov, iovcnt,
+                                                release_fn, release_ctx);
+        }
+    }
+
+    if (!frame) {
+        /* 未挂接到frame，由这里兑现release_fn调用保证 */
+        if (release_fn) {
+            const uint8_t* first = (iov && iovcnt > 0) ? iov[0].iov_base : NULL;
+            release_fn(first, total, release_ctx);
+        }
+        return ret;
+    }
+
+    frame->frame_type = type;
+
+    /* send_media在所有路径上都会释放frame，进而调用release_fn */
+    return vtx_tx_send_media(tx, frame);
+}
+
+int vtx_tx_send_media_buf(
+    vtx_tx_t* tx,
+    const uint8_t* data,
+    size_t size,
+    vtx_frame_type_t type)
+{
+    if (!tx || !data || size == 0 || size > VTX_MAX_FRAME_SIZE) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    /* 断开时I帧仍交给vtx_tx_send_media（宽限期内缓存），其他帧不必复制 */
+    if (!tx->connected && type != VTX_FRAME_I) {
+        return VTX_ERR_NOT_READY;
+    }
+
+    /* 多分片帧和I帧需要frame对象（分片重传、I帧缓存），复制到媒体帧；
+     * 加密会话直接挂接调用者缓冲区，加密时一次遍历写入媒体帧 */
+    size_t payload_capacity = tx->config.mtu - VTX_PACKET_HEADER_SIZE;
+    size_t tag_size = vtx_tx_session_trailer_size(tx);
+    if (type == VTX_FRAME_I || size + tag_size > payload_capacity ||
+        size + tag_size > VTX_MAX_PAYLOAD_SIZE) {
+        if (tx->crypto) {
+            vtx_frame_t* frame = vtx_tx_wrap_media_frame(tx, data, size, NULL, NULL);
+            if (!frame) {
+                return VTX_ERR_NO_MEMORY;
+            }
+            frame->frame_type = type;
+            return vtx_tx_send_media(tx, frame);
+        }
+
+        vtx_frame_t* frame = vtx_frame_pool_acquire(tx->media_pool);
+        if (!frame) {
+            return VTX_ERR_NO_MEMORY;
+        }
+        memcpy(frame->data, data, size);
+        frame->data_size = size;
+        frame->frame_type = type;
+        return vtx_tx_send_media(tx, frame);
+    }
+
+    /* 单分片快速路径：直接从调用者缓冲区发送，不经过帧池 */
+    int limit_ret;
+    if (vtx_tx_limit_drop(tx, type, size, &limit_ret)) {
+        return limit_ret;
+    }
+
+    uint64_t submit_us = tx->config.latency_stats ? vtx_get_time_us() : 0;
+
+    vtx_packet_header_t header = {0};
+    header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+    header.frame_id = atomic_fetch_add(&tx->frame_id, 1);
+    header.frame_type = type;
+    header.flags = VTX_FLAG_LAST_FRAG;
+    header.frag_index = 0;
+    header.total_frags = 1;
+    header.payload_size = size;
+    vtx_sockbuf_note_frame(&tx->sndbuf, size);
+
+    struct iovec iov[2] = {
+        { .iov_base = (void*)data, .iov_len = size },
+    };
+    int iovcnt = 1;
+
+    /* 加密到栈上缓冲区（与明文直接发送同样只遍历一次），标签紧随其后 */
+    uint8_t sealed[VTX_MAX_PAYLOAD_SIZE];
+    if (tx->crypto) {
+        if (vtx_tx_seal_exhausted(tx, header.seq_num + 1)) {
+            return VTX_ERR_DISCONNECTED;
+        }
+        uint64_t salt = atomic_load(&tx->seal_salt);
+        int ret = vtx_crypto_seal(tx->crypto, salt, &header, iov, 1,
+                                  sealed, sealed + size);
+        if (ret != VTX_OK) {
+            vtx_log_error("Failed to seal media fragment: %d", ret);
+            return ret;
+        }
+        iov[0].iov_base = sealed;
+        iov[0].iov_len = size + VTX_CRYPTO_TAG_SIZE;
+        header.payload_size = iov[0].iov_len;
+        header.flags |= VTX_FLAG_CRYPT;
+    }
+
+    /* 帧哈希作为第二个数据段 */
+    uint64_t hash;
+    if (!tx->crypto && tx->config.frame_hash) {
+        hash = htobe64(vtx_hash64(data, size));
+        iov[1].iov_base = &hash;
+        iov[1].iov_len = sizeof(hash);
+        iovcnt = 2;
+        header.payload_size = size + sizeof(hash);
+        header.flags |= VTX_FLAG_HASH;
+    }
+
+    VTX_TRACE_FRAG_SEND(header.frame_id, 0, 1, size, header.seq_num);
+    int ret = vtx_send_packet_path(tx, vtx_path_select(&tx->paths),
+                                   &header, iov, iovcnt);
+    if (ret != VTX_OK) {
+        vtx_log_error("Failed to send media fragment 1/1");
+        return ret;
+    }
+
+    vtx_spinlock_lock(&tx->stats_lock);
+    tx->stats.total_frames++;
+    if (type == VTX_FRAME_P) {
+        tx->stats.total_p_frames++;
+    }
+    tx->stats.total_packets++;
+    tx->stats.total_bytes += size;
+    if (tx->config.latency_stats) {
+        uint64_t wire_us = vtx_get_time_us();
+        vtx_latency_hist_record(&tx->stats.lat_submit, wire_us - submit_us);
+        vtx_latency_hist_record(&tx->stats.lat_wire, 0);
+    }
+    vtx_spinlock_unlock(&tx->stats_lock);
+
+    return VTX_OK;
+}
+
+/**
+ * @brief 替换缓存的I帧（持有frame的一个引用）
+ */
+static void vtx_tx_cache_iframe(vtx_tx_t* tx, vtx_frame_t* frame) {
+    vtx_spinlock_lock(&tx->iframe_lock);
+
+    /* 释放旧的I帧 */
+    if (tx->last_iframe) {
+        /* 释放旧I帧的retran */
+        if (tx->last_iframe->retran) {
+            vtx_frag_pool_release(tx->frag_pool, tx->last_iframe->retran);
+            tx->last_iframe->retran = NULL;
+        }
+        vtx_frame_release(vtx_tx_frame_pool(tx, tx->last_iframe),
+                          tx->last_iframe);
+    }
+
+    /* 保存新的I帧 */
+    tx->last_iframe = frame;
+    vtx_frame_retain(frame);  /* 增加引用计数 */
+
+    vtx_spinlock_unlock(&tx->iframe_lock);
+}
+
+/**
+ * @brief 计算帧哈希，存入tag（网络字节序）
+ */
+static void vtx_tx_hash_frame(vtx_frame_t* frame) {
+    struct iovec in[VTX_MAX_IOV];
+    int cnt = vtx_frame_gather(frame, 0, frame->data_size, in, VTX_MAX_IOV);
+
+    vtx_hash_state_t state;
+    vtx_hash_init(&state);
+    for (int i = 0; i < cnt; i++) {
+        vtx_hash_update(&state, in[i].iov_base, in[i].iov_len);
+    }
+    uint64_t hash = htobe64(vtx_hash_digest(&state));
+    memcpy(frame->tag, &hash, sizeof(hash));
+    frame->hashed = true;
+}
+
+/**
+ * @brief 分配frame_id和分片序列号，加密会话中同时加密帧
+ *
+ * 各分片seq连续（base_seq + frag_index），重传沿用原seq。
+ * 自有缓冲区原地加密；外部缓冲区只读，一次遍历加密到媒体帧，
+ * 原frame随即释放（release_fn提前回调），*pframe改为指向新frame。
+ * 未加密且配置frame_hash时计算帧哈希（外部缓冲区也不需要复制）。
+ *
+ * @return 0成功，失败时frame已释放
+ */
+static int vtx_tx_prepare_frame(vtx_tx_t* tx, vtx_frame_t** pframe) {
+    vtx_frame_t* frame = *pframe;
+    vtx_frame_pool_t* pool = vtx_tx_frame_pool(tx, frame);
+
+    /* 尾随数据计入帧大小，接收端重组缓冲区为VTX_MAX_FRAME_SIZE */
+    size_t trailer_size = vtx_tx_session_trailer_size(tx);
+    if (frame->data_size > VTX_MAX_FRAME_SIZE - trailer_size) {
+        vtx_frame_release(pool, frame);
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    size_t payload_capacity = tx->config.mtu - VTX_PACKET_HEADER_SIZE;
+    size_t wire_size = frame->data_size + trailer_size;
+    frame->frame_id = atomic_fetch_add(&tx->frame_id, 1);
+    frame->send_time_ms = vtx_get_time_ms();
+    frame->total_frags = (wire_size + payload_capacity - 1) / payload_capacity;
+    frame->base_seq = atomic_fetch_add(&tx->seq_num, frame->total_frags);
+    if (!tx->crypto) {
+        if (tx->config.frame_hash) {
+            vtx_tx_hash_frame(frame);
+        }
+        return VTX_OK;
+    }
+
+    if (vtx_tx_seal_exhausted(tx, frame->base_seq + frame->total_frags)) {
+        vtx_frame_release(pool, frame);
+        return VTX_ERR_DISCONNECTED;
+    }
+
+    struct iovec in[VTX_MAX_IOV];
+    int cnt = vtx_frame_gather(frame, 0, frame->data_size, in, VTX_MAX_IOV);
+    vtx_frame_t* sealed = frame;
+    if (frame->external) {
+        sealed = vtx_frame_pool_acquire(tx->media_pool);
+        if (!sealed) {
+            vtx_frame_release(pool, frame);
+            return VTX_ERR_NO_MEMORY;
+        }
+        sealed->frame_id = frame->frame_id;
+        sealed->frame_type = frame->frame_type;
+        sealed->total_frags = frame->total_frags;
+        sealed->data_size = frame->data_size;
+        sealed->send_time_ms = frame->send_time_ms;
+        sealed->timing = frame->timing;
+        sealed->base_seq = frame->base_seq;
+    }
+
+    vtx_packet_header_t header = {0};
+    header.seq_num = frame->base_seq;
+    header.frame_id = frame->frame_id;
+    header.frame_type = frame->frame_type;
+    header.total_frags = frame->total_frags;
+    /* 盐只读一次：加密和记录到帧上的必须是同一个值 */
+    uint64_t salt = atomic_load(&tx->seal_salt);
+    int ret = vtx_crypto_seal(tx->crypto, salt, &header, in, cnt,
+                              sealed->data, sealed->tag);
+    if (sealed != frame) {
+        vtx_frame_release(pool, frame);
+    }
+    if (ret != VTX_OK) {
+        vtx_log_error("Failed to seal frame: id=%u ret=%d", header.frame_id, ret);
+        vtx_frame_release(vtx_tx_frame_pool(tx, sealed), sealed);
+        return ret;
+    }
+
+    sealed->sealed = true;
+    sealed->seal_salt = salt;
+    *pframe = sealed;
+    return VTX_OK;
+}
+
+/**
+ * @brief 会话宽限期内只缓存I帧（不发送），恢复时重发
+ *
+ * 恢复后接收端从最新的I帧开始解码，而不是断开前的旧I帧
+ */
+static int vtx_tx_hold_iframe(vtx_tx_t* tx, vtx_frame_t* frame) {
+    int ret = vtx_tx_prepare_frame(tx, &frame);
+    if (ret != VTX_OK) {
+        return ret;
+    }
+
+    vtx_frame_pool_t* pool = vtx_tx_frame_pool(tx, frame);
+    uint16_t total_frags = frame->total_frags;
+
+    frame->retran = vtx_frag_pool_acquire(tx->frag_pool, total_frags);
+    if (!frame->retran) {
+        vtx_frame_release(pool, frame);
+        return VTX_ERR_NO_MEMORY;
+    }
+    frame->acked_frags = total_frags;
+
+    /* 标记为已确认，重传队列不处理，恢复时由vtx_tx_resend_iframe重置 */
+    for (uint16_t i = 0; i < total_frags; i++) {
+        vtx_frag_t* frag = &frame->retran->frag[i];
+        frag->frag_index = i;
+        frag->retrans_count = 0;
+        frag->send_time_ms = frame->send_time_ms;
+        frag->received = true;
     }
+
+    vtx_tx_cache_iframe(tx, frame);
+    vtx_frame_release(pool, frame);
+    return VTX_OK;
 }
 
 int vtx_tx_send_media(vtx_tx_t* tx, vtx_frame_t* frame) {
@@ -970,31 +2523,52 @@ int vtx_tx_send_media(vtx_tx_t* tx, vtx_frame_t* frame) {
         return VTX_ERR_INVALID_PARAM;
     }
 
+    vtx_frame_pool_t* pool = vtx_tx_frame_pool(tx, frame);
+
     if (!tx->connected) {
-        vtx_frame_release(tx->media_pool, frame);
+        if (frame->frame_type == VTX_FRAME_I &&
+            frame->data_size > 0 && frame->data_size <= frame->data_capacity &&
+            vtx_session_suspended(&tx->session)) {
+            return vtx_tx_hold_iframe(tx, frame);
+        }
+        vtx_frame_release(pool, frame);
         return VTX_ERR_NOT_READY;
     }
 
     if (frame->data_size == 0 || frame->data_size > frame->data_capacity) {
-        vtx_frame_release(tx->media_pool, frame);
+        vtx_frame_release(pool, frame);
         return VTX_ERR_INVALID_PARAM;
     }
 
-    /* 设置帧ID */
-    frame->frame_id = atomic_fetch_add(&tx->frame_id, 1);
-    frame->send_time_ms = vtx_get_time_ms();
+    /* 接收端限制：丢弃的帧不分配frame_id，视为已处理 */
+    int limit_ret;
+    if (vtx_tx_limit_drop(tx, frame->frame_type, frame->data_size, &limit_ret)) {
+        vtx_frame_release(pool, frame);
+        return limit_ret;
+    }
+
+    if (tx->config.latency_stats) {
+        frame->timing.submit_us = vtx_get_time_us();
+    }
+
+    /* 设置帧ID、分片数和序列号（加密会话中同时加密，frame可能被替换） */
+    int ret = vtx_tx_prepare_frame(tx, &frame);
+    if (ret != VTX_OK) {
+        return ret;
+    }
+    pool = vtx_tx_frame_pool(tx, frame);
+    vtx_sockbuf_note_frame(&tx->sndbuf, frame->data_size);
 
-    /* 计算分片数量 */
     size_t payload_capacity = tx->config.mtu - VTX_PACKET_HEADER_SIZE;
-    uint16_t total_frags = (frame->data_size + payload_capacity - 1) / payload_capacity;
-    frame->total_frags = total_frags;
+    size_t wire_size = vtx_tx_wire_size(frame);
+    uint16_t total_frags = frame->total_frags;
 
     /* 对于I帧，预先分配retran用于重传跟踪 */
     if (frame->frame_type == VTX_FRAME_I) {
         frame->retran = vtx_frag_pool_acquire(tx->frag_pool, total_frags);
         if (!frame->retran) {
             vtx_log_error("Failed to allocate retran for I-frame with %u frags", total_frags);
-            vtx_frame_release(tx->media_pool, frame);
+            vtx_frame_release(pool, frame);
             return VTX_ERR_NO_MEMORY;
         }
     }
@@ -1003,13 +2577,13 @@ int vtx_tx_send_media(vtx_tx_t* tx, vtx_frame_t* frame) {
     uint64_t send_time_ms = vtx_get_time_ms();
     for (uint16_t i = 0; i < total_frags; i++) {
         size_t offset = i * payload_capacity;
-        size_t payload_size = frame->data_size - offset;
+        size_t payload_size = wire_size - offset;
         if (payload_size > payload_capacity) {
             payload_size = payload_capacity;
         }
 
         vtx_packet_header_t header = {0};
-        header.seq_num = atomic_fetch_add(&tx->seq_num, 1);
+        header.seq_num = frame->base_seq + i;
         header.frame_id = frame->frame_id;
         header.frame_type = frame->frame_type;
         header.frag_index = i;
@@ -1019,8 +2593,12 @@ int vtx_tx_send_media(vtx_tx_t* tx, vtx_frame_t* frame) {
         if (i == total_frags - 1) {
             header.flags |= VTX_FLAG_LAST_FRAG;
         }
+        header.flags |= vtx_tx_trailer_flags(frame);
 
-        int ret = vtx_send_packet(tx, &header, frame->data + offset, payload_size);
+        VTX_TRACE_FRAG_SEND(header.frame_id, i, total_frags,
+                            payload_size, header.seq_num);
+        uint8_t path;
+        ret = vtx_tx_send_media_frag(tx, &header, frame, offset, &path);
         if (ret != VTX_OK) {
             vtx_log_error("Failed to send media fragment %u/%u", i + 1, total_frags);
             /* 如果已分配retran，需要释放 */
@@ -1028,55 +2606,59 @@ int vtx_tx_send_media(vtx_tx_t* tx, vtx_frame_t* frame) {
                 vtx_frag_pool_release(tx->frag_pool, frame->retran);
                 frame->retran = NULL;
             }
-            vtx_frame_release(tx->media_pool, frame);
+            vtx_frame_release(pool, frame);
             return ret;
         }
 
+        if (tx->config.latency_stats && i == 0) {
+            frame->timing.first_wire_us = vtx_get_time_us();
+        }
+
         /* 对于I帧，配置retran中的分片信息 */
         if (frame->frame_type == VTX_FRAME_I && frame->retran) {
             vtx_frag_t* frag = &frame->retran->frag[i];
             frag->frag_index = i;
             frag->seq_num = header.seq_num;
             frag->retrans_count = 0;
+            frag->path = path;
             frag->send_time_ms = send_time_ms;
             frag->received = false;  /* 尚未ACK */
         }
     }
 
+    if (tx->config.latency_stats) {
+        frame->timing.last_wire_us = vtx_get_time_us();
+    }
+
     /* 如果是I帧，缓存以备重传 */
     if (frame->frame_type == VTX_FRAME_I) {
-        vtx_spinlock_lock(&tx->iframe_lock);
-
-        /* 释放旧的I帧 */
-        if (tx->last_iframe) {
-            /* 释放旧I帧的retran */
-            if (tx->last_iframe->retran) {
-                vtx_frag_pool_release(tx->frag_pool, tx->last_iframe->retran);
-                tx->last_iframe->retran = NULL;
-            }
-            vtx_frame_release(tx->media_pool, tx->last_iframe);
-        }
-
-        /* 保存新的I帧 */
-        tx->last_iframe = frame;
-        vtx_frame_retain(frame);  /* 增加引用计数 */
-
-        vtx_spinlock_unlock(&tx->iframe_lock);
+        frame->acked_frags = 0;
+        vtx_tx_cache_iframe(tx, frame);
     }
 
+    /* 更新统计（frame可能仍被I帧缓存持有，需在释放引用前读取） */
+    vtx_frame_type_t frame_type = frame->frame_type;
+    size_t data_size = frame->data_size;
+    vtx_frame_timing_t timing = frame->timing;
+
     /* 释放frame */
-    vtx_frame_release(tx->media_pool, frame);
+    vtx_frame_release(pool, frame);
 
-    /* 更新统计 */
     vtx_spinlock_lock(&tx->stats_lock);
     tx->stats.total_frames++;
-    if (frame->frame_type == VTX_FRAME_I) {
+    if (frame_type == VTX_FRAME_I) {
         tx->stats.total_i_frames++;
-    } else if (frame->frame_type == VTX_FRAME_P) {
+    } else if (frame_type == VTX_FRAME_P) {
         tx->stats.total_p_frames++;
     }
     tx->stats.total_packets += total_frags;
-    tx->stats.total_bytes += frame->data_size;
+    tx->stats.total_bytes += data_size;
+    if (tx->config.latency_stats) {
+        vtx_latency_hist_record(&tx->stats.lat_submit,
+                                timing.first_wire_us - timing.submit_us);
+        vtx_latency_hist_record(&tx->stats.lat_wire,
+                                timing.last_wire_us - timing.first_wire_us);
+    }
     vtx_spinlock_unlock(&tx->stats_lock);
 
     return VTX_OK;
@@ -1097,6 +2679,20 @@ int vtx_tx_close(vtx_tx_t* tx) {
         tx->connected = false;
         vtx_log_info("Connection closed");
     }
+    vtx_session_close(&tx->session);
+    vtx_source_stop(tx->source);
+
+    return VTX_OK;
+}
+
+int vtx_tx_get_limits(vtx_tx_t* tx, vtx_limits_t* limits) {
+    if (!tx || !limits) {
+        return VTX_ERR_INVALID_PARAM;
+    }
+
+    vtx_spinlock_lock(&tx->limit_lock);
+    *limits = tx->limits;
+    vtx_spinlock_unlock(&tx->limit_lock);
 
     return VTX_OK;
 }
@@ -1110,6 +2706,17 @@ int vtx_tx_get_stats(vtx_tx_t* tx, vtx_tx_stats_t* stats) {
     *stats = tx->stats;
     vtx_spinlock_unlock(&tx->stats_lock);
 
+    stats->path_count = vtx_path_get_stats(&tx->paths, stats->paths);
+
+    vtx_frame_pool_stats_t pool_stats;
+    vtx_frame_pool_t* pools[] = { tx->media_pool, tx->wrap_pool };
+    for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+        if (vtx_frame_pool_get_stats(pools[i], &pool_stats) == VTX_OK) {
+            stats->pool_frames += (uint32_t)pool_stats.total_frames;
+            stats->pool_used_frames += (uint32_t)pool_stats.used_frames;
+        }
+    }
+
     return VTX_OK;
 }
 
@@ -1132,25 +2739,30 @@ void vtx_tx_destroy(vtx_tx_t* tx) {
             vtx_frag_pool_release(tx->frag_pool, tx->last_iframe->retran);
             tx->last_iframe->retran = NULL;
         }
-        vtx_frame_release(tx->media_pool, tx->last_iframe);
+        vtx_frame_release(vtx_tx_frame_pool(tx, tx->last_iframe),
+                          tx->last_iframe);
         tx->last_iframe = NULL;
     }
     vtx_spinlock_unlock(&tx->iframe_lock);
 
     /* 销毁队列 */
     if (tx->send_queue) vtx_frame_queue_destroy(tx->send_queue);
-    if (tx->data_queue) vtx_frame_queue_destroy(tx->data_queue);
 
     /* 销毁内存池 */
     if (tx->media_pool) vtx_frame_pool_destroy(tx->media_pool);
-    if (tx->data_pool) vtx_frame_pool_destroy(tx->data_pool);
+    if (tx->wrap_pool) vtx_frame_pool_destroy(tx->wrap_pool);
     if (tx->frag_pool) vtx_frag_pool_destroy(tx->frag_pool);
 
     /* 销毁锁 */
     vtx_spinlock_destroy(&tx->iframe_lock);
     vtx_spinlock_destroy(&tx->stats_lock);
 
+    vtx_crypto_destroy(tx->crypto);
+    vtx_source_destroy(tx->source);
+    vtx_pcap_close(tx->capture);
+
     /* 关闭socket */
+    vtx_path_set_destroy(&tx->paths);
     if (tx->sockfd >= 0) {
         close(tx->sockfd);
     }
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_window.c
+ * @brief VTX DATA Window Implementation
+ */
+
+#include "vtx_window.h"
+#include "vtx_log.h"
+#include <string.h>
+
+#define VTX_DATA_WINDOW_MASK (VTX_DATA_WINDOW_SIZE - 1)
+
+/* ========== 公共函数 ========== */
+
+void vtx_data_window_init(vtx_data_window_t* win) {
+    if (!win) {
+        return;
+    }
+
+    memset(win, 0, sizeof(*win));
+    for (int i = 0; i < VTX_DATA_WINDOW_SIZE; i++) {
+        atomic_init(&win->slots[i].state, VTX_DATA_SLOT_FREE);
+    }
+}
+
+vtx_data_slot_t* vtx_data_window_reserve(
+    vtx_data_window_t* win,
+    uint16_t frame_id,
+    uint8_t data_type,
+    const uint8_t* data,
+    size_t size)
+{
+    if (!win || size > VTX_CTRL_FRAME_DATA_SIZE || (size > 0 && !data)) {
+        return NULL;
+    }
+
+    vtx_data_slot_t* slot = &win->slots[frame_id & VTX_DATA_WINDOW_MASK];
+
+    unsigned int expected = VTX_DATA_SLOT_FREE;
+    if (!atomic_compare_exchange_strong(&slot->state, &expected,
+                                        VTX_DATA_SLOT_FILLING)) {
+        return NULL;
+    }
+
+    slot->frame_id = frame_id;
+    slot->data_type = data_type;
+    slot->retrans_count = 0;
+    slot->size = (uint16_t)size;
+    if (size > 0) {
+        memcpy(slot->data, data, size);
+    }
+
+    return slot;
+}
+
+void vtx_data_window_commit(vtx_data_slot_t* slot, uint64_t now_ms) {
+    slot->send_time_ms = now_ms;
+    atomic_store_explicit(&slot->state, VTX_DATA_SLOT_PENDING,
+                          memory_order_release);
+}
+
+void vtx_data_window_cancel(vtx_data_slot_t* slot) {
+    /* 可能已被ACK或超时释放，只释放仍在等待的槽位 */
+    unsigned int expected = VTX_DATA_SLOT_PENDING;
+    atomic_compare_exchange_strong(&slot->state, &expected,
+                                   VTX_DATA_SLOT_FREE);
+}
+
+bool vtx_data_window_ack(
+    vtx_data_window_t* win,
+    uint16_t frame_id,
+    uint64_t now_ms,
+    uint32_t* rtt_ms)
+{
+    if (!win) {
+        return false;
+    }
+
+    vtx_data_slot_t* slot = &win->slots[frame_id & VTX_DATA_WINDOW_MASK];
+    if (atomic_load_explicit(&slot->state, memory_order_acquire) !=
+        VTX_DATA_SLOT_PENDING || slot->frame_id != frame_id) {
+        return false;
+    }
+
+    /* 释放前读取，释放后槽位可能立即被发送线程复用 */
+    uint32_t rtt = VTX_DATA_NO_RTT;
+    if (slot->retrans_count == 0) {
+        rtt = (uint32_t)(now_ms - slot->send_time_ms);
+    }
+
+    unsigned int expected = VTX_DATA_SLOT_PENDING;
+    if (!atomic_compare_exchange_strong(&slot->state, &expected,
+                                        VTX_DATA_SLOT_FREE)) {
+        return false;
+    }
+
+    if (rtt_ms) {
+        *rtt_ms = rtt;
+    }
+    return true;
+}
+
+void vtx_data_window_process(
+    vtx_data_window_t* win,
+    uint64_t now_ms,
+    uint32_t timeout_ms,
+    uint8_t max_retrans,
+    vtx_data_resend_fn resend_fn,
+    void* ctx)
+{
+    if (!win) {
+        return;
+    }
+
+    for (int i = 0; i < VTX_DATA_WINDOW_SIZE; i++) {
+        vtx_data_slot_t* slot = &win->slots[i];
+        if (atomic_load_explicit(&slot->state, memory_order_acquire) !=
+            VTX_DATA_SLOT_PENDING) {
+            continue;
+        }
+
+        /* 检查重传次数是否超限 */
+        if (slot->retrans_count >= max_retrans) {
+            vtx_log_warn("Frame dropped: id=%u, retrans=%u",
+                       slot->frame_id, slot->retrans_count);
+            vtx_data_window_cancel(slot);
+            continue;
+        }
+
+        /* 检查是否需要重传 */
+        uint64_t elapsed = now_ms - slot->send_time_ms;
+        if (elapsed >= timeout_ms) {
+            slot->retrans_count++;
+            slot->send_time_ms = now_ms;
+
+            vtx_log_debug("Retransmitting frame: id=%u, retrans=%u, elapsed=%llu ms",
+                        slot->frame_id, slot->retrans_count,
+                        (unsigned long long)elapsed);
+
+            if (resend_fn) {
+                resend_fn(ctx, slot);
+            }
+        }
+    }
+}
+
+/* ========== 媒体帧ID窗口 ========== */
+
+#define VTX_FID_MASK    (VTX_FID_WINDOW_SIZE - 1)
+
+static inline void vtx_fid_window_set(vtx_fid_window_t* win, uint16_t frame_id, bool done) {
+    uint32_t bit = frame_id & VTX_FID_MASK;
+    if (done) {
+        win->done[bit / 64] |= 1ULL << (bit % 64);
+    } else {
+        win->done[bit / 64] &= ~(1ULL << (bit % 64));
+    }
+}
+
+void vtx_fid_window_reset(vtx_fid_window_t* win) {
+    if (!win) {
+        return;
+    }
+
+    memset(win, 0, sizeof(*win));
+}
+
+vtx_fid_state_t vtx_fid_window_check(vtx_fid_window_t* win, uint16_t frame_id) {
+    int16_t delta = (int16_t)(frame_id - win->high);
+
+    if (!win->valid || delta >= VTX_FID_WINDOW_SIZE) {
+        /* 首个分片或跳过整个窗口：全部清除 */
+        memset(win->done, 0, sizeof(win->done));
+        win->high = frame_id;
+        win->valid = true;
+        win->stale_run = 0;
+        return VTX_FID_NEW;
+    }
+
+    if (delta > 0) {
+        /* 窗口前进：(high, frame_id] 是新进入窗口的frame_id */
+        for (uint16_t id = win->high + 1; id != (uint16_t)(frame_id + 1); id++) {
+            vtx_fid_window_set(win, id, false);
+        }
+        win->high = frame_id;
+        win->stale_run = 0;
+        return VTX_FID_NEW;
+    }
+
+    if (-delta >= VTX_FID_WINDOW_SIZE) {
+        /* 连续过旧：发送端frame_id已重新开始，以当前frame_id重新定位 */
+        if (++win->stale_run >= VTX_FID_STALE_RESYNC) {
+            win->valid = false;
+            return vtx_fid_window_check(win, frame_id);
+        }
+        return VTX_FID_STALE;
+    }
+
+    win->stale_run = 0;
+    uint32_t bit = frame_id & VTX_FID_MASK;
+    return (win->done[bit / 64] >> (bit % 64)) & 1 ? VTX_FID_DONE : VTX_FID_NEW;
+}
+
+void vtx_fid_window_mark(vtx_fid_window_t* win, uint16_t frame_id) {
+    int16_t delta = (int16_t)(frame_id - win->high);
+    if (!win->valid || delta > 0 || -delta >= VTX_FID_WINDOW_SIZE) {
+        return;  /* 不在窗口内（check之后窗口已被复位或越过） */
+    }
+    vtx_fid_window_set(win, frame_id, true);
+}
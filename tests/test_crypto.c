@@ -0,0 +1,204 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_crypto.c
+ * @brief Test AES-GCM frame seal/open round trip, known answer and tampering
+ */
+
+#include "vtx_crypto.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint8_t g_key[VTX_CRYPTO_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+static vtx_packet_header_t make_header(uint32_t seq, uint16_t frame_id) {
+    vtx_packet_header_t header = {0};
+    header.seq_num = seq;
+    header.frame_id = frame_id;
+    header.frame_type = VTX_FRAME_I;
+    header.total_frags = 3;
+    return header;
+}
+
+static void test_known_answer(vtx_crypto_t* crypto) {
+    printf("Test 1: known answer (nonce = salt || seq, AAD = id/type/frags)\n");
+
+    /* 参考值由OpenSSL EVP_aes_128_gcm直接计算 */
+    static const char plain[] = "VTX AES-GCM test vector";
+    static const uint8_t expect_ct[] = {
+        0x2b, 0x05, 0xea, 0x1f, 0xb6, 0x5f, 0x26, 0x98,
+        0x95, 0xad, 0x4b, 0xd6, 0x8d, 0x9e, 0x8e, 0xb9,
+        0x5f, 0xa9, 0x06, 0x2c, 0xc2, 0xbf, 0x1d,
+    };
+    static const uint8_t expect_tag[VTX_CRYPTO_TAG_SIZE] = {
+        0xa8, 0x22, 0x70, 0x31, 0xb6, 0xde, 0x24, 0xd1,
+        0x28, 0x3e, 0x83, 0x6f, 0x47, 0x82, 0xae, 0xf2,
+    };
+    size_t size = sizeof(plain) - 1;
+
+    vtx_packet_header_t header = make_header(0x11223344, 0x1234);
+    uint8_t out[sizeof(plain)];
+    uint8_t tag[VTX_CRYPTO_TAG_SIZE];
+    struct iovec in = { .iov_base = (void*)plain, .iov_len = size };
+    CHECK(vtx_crypto_seal(crypto, 0x0102030405060708ULL, &header, &in, 1,
+                          out, tag) == VTX_OK);
+    CHECK(memcmp(out, expect_ct, size) == 0);
+    CHECK(memcmp(tag, expect_tag, sizeof(tag)) == 0);
+
+    CHECK(vtx_crypto_open(crypto, 0x0102030405060708ULL, &header, out, size,
+                          tag) == VTX_OK);
+    CHECK(memcmp(out, plain, size) == 0);
+}
+
+static void test_round_trip(vtx_crypto_t* crypto) {
+    printf("Test 2: in-place and multi-segment seal, open round trip\n");
+
+    uint8_t plain[4000];
+    for (size_t i = 0; i < sizeof(plain); i++) {
+        plain[i] = (uint8_t)(i * 31 + 7);
+    }
+    uint64_t salt = 0xdeadbeefcafef00dULL;
+    vtx_packet_header_t header = make_header(1000, 42);
+
+    /* 原地加密 */
+    uint8_t buf[sizeof(plain)];
+    uint8_t tag[VTX_CRYPTO_TAG_SIZE];
+    memcpy(buf, plain, sizeof(buf));
+    struct iovec in = { .iov_base = buf, .iov_len = sizeof(buf) };
+    CHECK(vtx_crypto_seal(crypto, salt, &header, &in, 1, buf, tag) == VTX_OK);
+    CHECK(memcmp(buf, plain, sizeof(buf)) != 0);
+
+    /* 分段加密与整段加密结果相同（空段跳过） */
+    uint8_t seg_out[sizeof(plain)];
+    uint8_t seg_tag[VTX_CRYPTO_TAG_SIZE];
+    struct iovec segs[4] = {
+        { .iov_base = plain, .iov_len = 1 },
+        { .iov_base = plain + 1, .iov_len = 0 },
+        { .iov_base = plain + 1, .iov_len = 1399 },
+        { .iov_base = plain + 1400, .iov_len = sizeof(plain) - 1400 },
+    };
+    CHECK(vtx_crypto_seal(crypto, salt, &header, segs, 4, seg_out, seg_tag) == VTX_OK);
+    CHECK(memcmp(seg_out, buf, sizeof(buf)) == 0);
+    CHECK(memcmp(seg_tag, tag, sizeof(tag)) == 0);
+
+    CHECK(vtx_crypto_open(crypto, salt, &header, buf, sizeof(buf), tag) == VTX_OK);
+    CHECK(memcmp(buf, plain, sizeof(buf)) == 0);
+
+    /* 空帧只有标签 */
+    uint8_t empty = 0;
+    struct iovec none = { .iov_base = &empty, .iov_len = 0 };
+    CHECK(vtx_crypto_seal(crypto, salt, &header, &none, 1, &empty, tag) == VTX_OK);
+    CHECK(vtx_crypto_open(crypto, salt, &header, &empty, 0, tag) == VTX_OK);
+}
+
+static void test_tamper(vtx_crypto_t* crypto) {
+    printf("Test 3: tampered data, tag, salt, seq and AAD are rejected\n");
+
+    uint8_t plain[256];
+    for (size_t i = 0; i < sizeof(plain); i++) {
+        plain[i] = (uint8_t)i;
+    }
+    uint64_t salt = 0x0123456789abcdefULL;
+    vtx_packet_header_t header = make_header(77, 9);
+
+    uint8_t sealed[sizeof(plain)];
+    uint8_t tag[VTX_CRYPTO_TAG_SIZE];
+    struct iovec in = { .iov_base = plain, .iov_len = sizeof(plain) };
+    CHECK(vtx_crypto_seal(crypto, salt, &header, &in, 1, sealed, tag) == VTX_OK);
+
+    uint8_t buf[sizeof(plain)];
+    uint8_t bad_tag[VTX_CRYPTO_TAG_SIZE];
+
+    memcpy(buf, sealed, sizeof(buf));
+    buf[100] ^= 0x01;
+    CHECK(vtx_crypto_open(crypto, salt, &header, buf, sizeof(buf), tag) == VTX_ERR_CHECKSUM);
+
+    memcpy(buf, sealed, sizeof(buf));
+    memcpy(bad_tag, tag, sizeof(bad_tag));
+    bad_tag[15] ^= 0x80;
+    CHECK(vtx_crypto_open(crypto, salt, &header, buf, sizeof(buf), bad_tag) == VTX_ERR_CHECKSUM);
+
+    memcpy(buf, sealed, sizeof(buf));
+    CHECK(vtx_crypto_open(crypto, salt + 1, &header, buf, sizeof(buf), tag) == VTX_ERR_CHECKSUM);
+
+    vtx_packet_header_t other = header;
+    other.seq_num++;
+    memcpy(buf, sealed, sizeof(buf));
+    CHECK(vtx_crypto_open(crypto, salt, &other, buf, sizeof(buf), tag) == VTX_ERR_CHECKSUM);
+
+    other = header;
+    other.frame_id++;
+    memcpy(buf, sealed, sizeof(buf));
+    CHECK(vtx_crypto_open(crypto, salt, &other, buf, sizeof(buf), tag) == VTX_ERR_CHECKSUM);
+
+    other = header;
+    other.total_frags++;
+    memcpy(buf, sealed, sizeof(buf));
+    CHECK(vtx_crypto_open(crypto, salt, &other, buf, sizeof(buf), tag) == VTX_ERR_CHECKSUM);
+
+    /* 失败后上下文仍可用 */
+    memcpy(buf, sealed, sizeof(buf));
+    CHECK(vtx_crypto_open(crypto, salt, &header, buf, sizeof(buf), tag) == VTX_OK);
+    CHECK(memcmp(buf, plain, sizeof(buf)) == 0);
+
+    /* 不同密钥无法解密 */
+    uint8_t key2[VTX_CRYPTO_KEY_SIZE];
+    memcpy(key2, g_key, sizeof(key2));
+    key2[0] ^= 0xff;
+    vtx_crypto_t* other_key = vtx_crypto_create(key2);
+    CHECK(other_key != NULL);
+    if (other_key) {
+        memcpy(buf, sealed, sizeof(buf));
+        CHECK(vtx_crypto_open(other_key, salt, &header, buf, sizeof(buf), tag) == VTX_ERR_CHECKSUM);
+        vtx_crypto_destroy(other_key);
+    }
+}
+
+static void test_salt_wire(void) {
+    printf("Test 4: salt wire format\n");
+
+    uint8_t buf[VTX_CRYPTO_SALT_SIZE];
+    vtx_crypto_pack_salt(0x0102030405060708ULL, buf);
+    CHECK(buf[0] == 0x01 && buf[7] == 0x08);
+    CHECK(vtx_crypto_unpack_salt(buf) == 0x0102030405060708ULL);
+}
+
+int main(void) {
+    printf("=== VTX Crypto Test ===\n\n");
+
+    if (!vtx_crypto_supported()) {
+        printf("\nBuilt without OpenSSL, seal/open tests skipped\n");
+    } else {
+        vtx_crypto_t* crypto = vtx_crypto_create(g_key);
+        CHECK(crypto != NULL);
+        if (crypto) {
+            test_known_answer(crypto);
+            test_round_trip(crypto);
+            test_tamper(crypto);
+            vtx_crypto_destroy(crypto);
+        }
+    }
+
+    test_salt_wire();
+
+    VTX_TEST_RESULT();
+}
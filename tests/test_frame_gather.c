@@ -0,0 +1,225 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_frame_gather.c
+ * @brief Test scatter frames (vtx_frame_wrap_iov) and vtx_frame_gather
+ */
+
+#include "vtx.h"
+#include "vtx_frame.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_releases;
+static const uint8_t* g_release_data;
+static size_t g_release_size;
+
+static void on_release(const uint8_t* data, size_t size, void* ctx) {
+    (void)ctx;
+    g_releases++;
+    g_release_data = data;
+    g_release_size = size;
+}
+
+static void reset_release(void) {
+    g_releases = 0;
+    g_release_data = NULL;
+    g_release_size = 0;
+}
+
+/* 三个数据段：a[100]、（空段）、b[50]、c[10] */
+static uint8_t g_a[100], g_b[50], g_c[10];
+
+static int wrap_segments(vtx_frame_t* frame) {
+    struct iovec iov[4] = {
+        { g_a, sizeof(g_a) },
+        { NULL, 0 },
+        { g_b, sizeof(g_b) },
+        { g_c, sizeof(g_c) },
+    };
+    return vtx_frame_wrap_iov(frame, iov, 4, on_release, NULL);
+}
+
+static void test_contiguous(void) {
+    printf("Test 1: contiguous frame maps to one iovec\n");
+
+    vtx_frame_pool_t* pool = vtx_frame_pool_create(1, 256);
+    vtx_frame_t* frame = pool ? vtx_frame_pool_acquire(pool) : NULL;
+    CHECK(frame != NULL);
+    if (!frame) {
+        vtx_frame_pool_destroy(pool);
+        return;
+    }
+    frame->data_size = 200;
+
+    struct iovec iov[2];
+    CHECK(vtx_frame_gather(frame, 10, 190, iov, 2) == 1);
+    CHECK(iov[0].iov_base == frame->data + 10 && iov[0].iov_len == 190);
+    CHECK(vtx_frame_gather(frame, 10, 191, iov, 2) == 0);
+    CHECK(vtx_frame_gather(frame, 201, 1, iov, 2) == 0);
+    CHECK(vtx_frame_gather(frame, 0, 0, iov, 2) == 0);
+
+    vtx_frame_release(pool, frame);
+    vtx_frame_pool_destroy(pool);
+}
+
+static void test_scatter(void) {
+    printf("Test 2: gather across scatter segments\n");
+
+    vtx_frame_pool_t* pool = vtx_frame_pool_create(1, 0);
+    vtx_frame_t* frame = pool ? vtx_frame_pool_acquire(pool) : NULL;
+    CHECK(frame != NULL);
+    if (!frame) {
+        vtx_frame_pool_destroy(pool);
+        return;
+    }
+
+    reset_release();
+    CHECK(wrap_segments(frame) == VTX_OK);
+    CHECK(frame->nsegs == 3);               /* 空段被忽略 */
+    CHECK(frame->data_size == 160 && frame->data_capacity == 160);
+    CHECK(frame->data == g_a);
+
+    /* 跨越三个段 */
+    struct iovec iov[VTX_MAX_IOV];
+    CHECK(vtx_frame_gather(frame, 90, 70, iov, VTX_MAX_IOV) == 3);
+    CHECK(iov[0].iov_base == g_a + 90 && iov[0].iov_len == 10);
+    CHECK(iov[1].iov_base == g_b && iov[1].iov_len == 50);
+    CHECK(iov[2].iov_base == g_c && iov[2].iov_len == 10);
+
+    /* 起点在后面的段中，终点在段内 */
+    CHECK(vtx_frame_gather(frame, 120, 35, iov, VTX_MAX_IOV) == 2);
+    CHECK(iov[0].iov_base == g_b + 20 && iov[0].iov_len == 30);
+    CHECK(iov[1].iov_base == g_c && iov[1].iov_len == 5);
+
+    /* 正好从段边界开始、在段边界结束 */
+    CHECK(vtx_frame_gather(frame, 100, 50, iov, VTX_MAX_IOV) == 1);
+    CHECK(iov[0].iov_base == g_b && iov[0].iov_len == 50);
+
+    /* iov容量不足、越界 */
+    CHECK(vtx_frame_gather(frame, 90, 70, iov, 2) == 0);
+    CHECK(vtx_frame_gather(frame, 90, 71, iov, VTX_MAX_IOV) == 0);
+    CHECK(vtx_frame_gather(frame, 161, 1, iov, VTX_MAX_IOV) == 0);
+
+    /* 已挂接的frame不能再次挂接 */
+    CHECK(wrap_segments(frame) == VTX_ERR_INVALID_PARAM);
+
+    /* 最后一个引用释放时回调一次，参数为第一个段和总长度 */
+    vtx_frame_retain(frame);
+    vtx_frame_release(pool, frame);
+    CHECK(g_releases == 0);
+    vtx_frame_release(pool, frame);
+    CHECK(g_releases == 1);
+    CHECK(g_release_data == g_a && g_release_size == 160);
+
+    vtx_frame_pool_destroy(pool);
+}
+
+static void test_wrap_invalid(void) {
+    printf("Test 3: invalid scatter segments\n");
+
+    vtx_frame_pool_t* pool = vtx_frame_pool_create(1, 0);
+    vtx_frame_t* frame = pool ? vtx_frame_pool_acquire(pool) : NULL;
+    CHECK(frame != NULL);
+    if (!frame) {
+        vtx_frame_pool_destroy(pool);
+        return;
+    }
+
+    struct iovec iov[VTX_MAX_IOV + 1];
+    for (int i = 0; i <= VTX_MAX_IOV; i++) {
+        iov[i].iov_base = g_c;
+        iov[i].iov_len = 1;
+    }
+    CHECK(vtx_frame_wrap_iov(frame, iov, VTX_MAX_IOV + 1, NULL, NULL) == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_frame_wrap_iov(frame, iov, 0, NULL, NULL) == VTX_ERR_INVALID_PARAM);
+
+    iov[0].iov_len = 0;
+    CHECK(vtx_frame_wrap_iov(frame, iov, 1, NULL, NULL) == VTX_ERR_INVALID_PARAM);
+    iov[0].iov_base = NULL;
+    iov[0].iov_len = 4;
+    CHECK(vtx_frame_wrap_iov(frame, iov, 2, NULL, NULL) == VTX_ERR_INVALID_PARAM);
+    CHECK(!frame->external && frame->nsegs == 0);
+
+    vtx_frame_release(pool, frame);
+    vtx_frame_pool_destroy(pool);
+}
+
+static void test_send_iov_release(void) {
+    printf("Test 4: vtx_tx_send_media_iov releases once on failure\n");
+
+    struct iovec iov[3] = {
+        { g_a, sizeof(g_a) },
+        { g_b, sizeof(g_b) },
+        { g_c, sizeof(g_c) },
+    };
+
+    /* 参数无效：未挂接到frame，直接回调 */
+    reset_release();
+    CHECK(vtx_tx_send_media_iov(NULL, iov, 3, VTX_FRAME_P, on_release, NULL) ==
+          VTX_ERR_INVALID_PARAM);
+    CHECK(g_releases == 1);
+    CHECK(g_release_data == g_a && g_release_size == 160);
+
+    vtx_tx_config_t config = {
+        .bind_addr = "127.0.0.1",
+        .bind_port = 8889,
+        .mtu = VTX_DEFAULT_MTU,
+    };
+    vtx_tx_t* tx = vtx_tx_create(&config, NULL, NULL, NULL);
+    CHECK(tx != NULL);
+    if (!tx) {
+        return;
+    }
+
+    struct iovec many[VTX_MAX_IOV + 1];
+    for (int i = 0; i <= VTX_MAX_IOV; i++) {
+        many[i].iov_base = g_a;
+        many[i].iov_len = 1;
+    }
+    reset_release();
+    CHECK(vtx_tx_send_media_iov(tx, many, VTX_MAX_IOV + 1, VTX_FRAME_P, on_release, NULL) ==
+          VTX_ERR_INVALID_PARAM);
+    CHECK(g_releases == 1);
+    CHECK(g_release_data == g_a && g_release_size == VTX_MAX_IOV + 1);
+
+    /* 已挂接到frame：未连接时由frame释放回调 */
+    reset_release();
+    CHECK(vtx_tx_send_media_iov(tx, iov, 3, VTX_FRAME_P, on_release, NULL) ==
+          VTX_ERR_NOT_READY);
+    CHECK(g_releases == 1);
+    CHECK(g_release_data == g_a && g_release_size == 160);
+
+    vtx_tx_destroy(tx);
+}
+
+int main(void) {
+    printf("=== VTX Frame Gather Test ===\n\n");
+
+    vtx_init(NULL);
+
+    test_contiguous();
+    test_scatter();
+    test_wrap_invalid();
+    test_send_iov_release();
+
+    vtx_fini();
+
+    VTX_TEST_RESULT();
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_hash.c
+ * @brief Test XXH64 known answers and streaming across stripe boundaries
+ */
+
+#include "vtx_hash.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t g_data[1000];
+
+static void test_known_answer(void) {
+    printf("Test 1: known answers (seed 0)\n");
+
+    CHECK(vtx_hash64("", 0) == 0xef46db3751d8e999ULL);
+    CHECK(vtx_hash64("abc", 3) == 0x44bc2cf5ad770999ULL);
+    const char* fox = "The quick brown fox jumps over the lazy dog";
+    CHECK(vtx_hash64(fox, strlen(fox)) == 0x0b242d361fda71bcULL);
+
+    /* g_data[i] = i * 31 + 7：覆盖尾部1/4/8字节分支和32字节条带边界 */
+    static const struct {
+        size_t      len;
+        uint64_t    hash;
+    } vectors[] = {
+        { 1,    0xa96c7f0ce858bbb7ULL },
+        { 4,    0xc60d15b1e3ff8f04ULL },
+        { 8,    0x3da5c7aa269683e0ULL },
+        { 31,   0x4a74f3a1a39ad4a1ULL },
+        { 32,   0x8d57d6a4671cc43dULL },
+        { 33,   0x62c9fd21ed857664ULL },
+        { 63,   0x5c320a0d2707057fULL },
+        { 64,   0x7bbabbc45729d17eULL },
+        { 100,  0xefa0ad2d3e70c151ULL },
+        { 1000, 0x99594f4828043d35ULL },
+    };
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        uint64_t hash = vtx_hash64(g_data, vectors[i].len);
+        if (hash != vectors[i].hash) {
+            printf("  len=%zu got %016llx\n", vectors[i].len, (unsigned long long)hash);
+        }
+        CHECK(hash == vectors[i].hash);
+    }
+}
+
+static void test_streaming(void) {
+    printf("Test 2: streaming matches one-shot across segment boundaries\n");
+
+    /* 三段输入，切点遍历条带内外的所有位置 */
+    int mismatches = 0;
+    for (size_t len = 0; len <= 200; len += 7) {
+        uint64_t expect = vtx_hash64(g_data, len);
+        for (size_t a = 0; a <= len && a <= 70; a++) {
+            for (size_t b = 0; a + b <= len && b <= 70; b++) {
+                vtx_hash_state_t state;
+                vtx_hash_init(&state);
+                vtx_hash_update(&state, g_data, a);
+                vtx_hash_update(&state, g_data + a, b);
+                vtx_hash_update(&state, g_data + a + b, len - a - b);
+                if (vtx_hash_digest(&state) != expect) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    /* 逐字节输入 */
+    vtx_hash_state_t state;
+    vtx_hash_init(&state);
+    for (size_t i = 0; i < sizeof(g_data); i++) {
+        vtx_hash_update(&state, g_data + i, 1);
+    }
+    CHECK(vtx_hash_digest(&state) == 0x99594f4828043d35ULL);
+}
+
+static void test_digest_keeps_state(void) {
+    printf("Test 3: digest does not change the state\n");
+
+    vtx_hash_state_t state;
+    vtx_hash_init(&state);
+    CHECK(vtx_hash_digest(&state) == 0xef46db3751d8e999ULL);
+
+    vtx_hash_update(&state, g_data, 50);
+    uint64_t mid = vtx_hash_digest(&state);
+    CHECK(mid == vtx_hash64(g_data, 50));
+    CHECK(vtx_hash_digest(&state) == mid);
+
+    vtx_hash_update(&state, g_data + 50, 50);
+    CHECK(vtx_hash_digest(&state) == 0xefa0ad2d3e70c151ULL);
+}
+
+int main(void) {
+    printf("=== VTX Hash Test ===\n\n");
+
+    for (size_t i = 0; i < sizeof(g_data); i++) {
+        g_data[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    test_known_answer();
+    test_streaming();
+    test_digest_keeps_state();
+
+    VTX_TEST_RESULT();
+}
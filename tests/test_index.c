@@ -0,0 +1,268 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_index.c
+ * @brief Test media file index: Annex-B scan, sidecar reuse and validation, seeks
+ */
+
+#include "vtx_index.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static char g_path[] = "/tmp/vtx_test_index_XXXXXX";
+static char g_idx_path[sizeof(g_path) + sizeof(VTX_INDEX_SUFFIX)];
+
+/* 测试流 */
+static uint8_t* g_stream;
+static size_t g_size;
+static size_t g_cap;
+
+/**
+ * @brief 追加一个NAL（4字节起始码，填充字节不含起始码）
+ */
+static void add_nal(uint8_t header, uint8_t first, size_t payload) {
+    size_t need = g_size + 6 + payload;
+    if (need > g_cap) {
+        g_cap = need * 2;
+        g_stream = (uint8_t*)realloc(g_stream, g_cap);
+    }
+    uint8_t* p = g_stream + g_size;
+    p[0] = 0;
+    p[1] = 0;
+    p[2] = 0;
+    p[3] = 1;
+    p[4] = header;
+    p[5] = first;
+    memset(p + 6, 0x11, payload);
+    g_size = need;
+}
+
+/* H.264：first字节最高位为1表示first_mb_in_slice == 0（图像的第一个slice） */
+static void add_gop(size_t p_frames, size_t p_size) {
+    add_nal(0x67, 0x42, 10);            /* SPS */
+    add_nal(0x68, 0xce, 4);             /* PPS */
+    add_nal(0x65, 0x88, 2000);          /* IDR */
+    add_nal(0x65, 0x08, 500);           /* IDR的第二个slice */
+    for (size_t i = 0; i < p_frames; i++) {
+        add_nal(0x06, 0x05, 8);         /* SEI，归入下一帧 */
+        add_nal(0x41, 0x9a, p_size);    /* P */
+    }
+}
+
+static int write_stream(void) {
+    int fd = open(g_path, O_WRONLY | O_TRUNC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = write(fd, g_stream, g_size);
+    close(fd);
+    unlink(g_idx_path);
+    return n == (ssize_t)g_size ? 0 : -1;
+}
+
+/**
+ * @brief 映射测试文件并加载索引
+ */
+static int load(vtx_media_index_t* index, const uint8_t** map, struct stat* st) {
+    int fd = open(g_path, O_RDONLY);
+    if (fd < 0 || fstat(fd, st) != 0) {
+        return -1;
+    }
+    void* m = mmap(NULL, (size_t)st->st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        return -1;
+    }
+    *map = (const uint8_t*)m;
+    return vtx_media_index_load(index, g_path, *map, st);
+}
+
+static void unload(vtx_media_index_t* index, const uint8_t* map, const struct stat* st) {
+    vtx_media_index_free(index);
+    munmap((void*)map, (size_t)st->st_size);
+}
+
+static void test_scan(void) {
+    printf("Test 1: scan splits SPS/PPS/pictures and indexes keyframes\n");
+
+    g_size = 0;
+    add_gop(3, 700);
+    add_gop(2, 900);
+    CHECK(write_stream() == 0);
+
+    vtx_media_index_t index;
+    const uint8_t* map;
+    struct stat st;
+    CHECK(load(&index, &map, &st) == VTX_OK);
+
+    /* SPS PPS I P P P SPS PPS I P P */
+    static const uint8_t types[] = {
+        VTX_FRAME_SPS, VTX_FRAME_PPS, VTX_FRAME_I, VTX_FRAME_P, VTX_FRAME_P, VTX_FRAME_P,
+        VTX_FRAME_SPS, VTX_FRAME_PPS, VTX_FRAME_I, VTX_FRAME_P, VTX_FRAME_P,
+    };
+    CHECK(index.count == sizeof(types));
+    CHECK(index.key_count == 2);
+    CHECK(index.pictures == 7);
+    CHECK(index.dropped == 0);
+    for (uint32_t i = 0; i < index.count && i < sizeof(types); i++) {
+        CHECK(index.entries[i].frame_type == types[i]);
+    }
+
+    /* 帧首尾相接覆盖整个文件；I帧的两个slice为一帧，SEI归入其后的P帧 */
+    uint64_t end = 0;
+    for (uint32_t i = 0; i < index.count; i++) {
+        CHECK(index.entries[i].offset == end);
+        end = index.entries[i].offset + index.entries[i].size;
+    }
+    CHECK(end == g_size);
+    CHECK(index.entries[2].size == 6 + 2000 + 6 + 500);
+    CHECK(index.entries[3].size == 6 + 8 + 6 + 700);
+
+    /* 关键帧从SPS开始 */
+    CHECK(index.keys[0].entry == 0 && index.keys[0].picture == 0);
+    CHECK(index.keys[1].entry == 6 && index.keys[1].picture == 4);
+
+    /* 查找 */
+    uint64_t key1 = index.entries[6].offset;
+    CHECK(vtx_media_index_seek_offset(&index, 0) == 0);
+    CHECK(vtx_media_index_seek_offset(&index, key1 - 1) == 0);
+    CHECK(vtx_media_index_seek_offset(&index, key1) == 6);
+    CHECK(vtx_media_index_seek_offset(&index, g_size) == 6);
+    CHECK(vtx_media_index_seek_picture(&index, 3) == 0);
+    CHECK(vtx_media_index_seek_picture(&index, 4) == 6);
+    CHECK(vtx_media_index_seek_picture(&index, 1000) == 6);
+    CHECK(vtx_media_index_lower_bound(&index, 0) == 0);
+    CHECK(vtx_media_index_lower_bound(&index, 1) == 1);
+    CHECK(vtx_media_index_lower_bound(&index, key1) == 6);
+    CHECK(vtx_media_index_lower_bound(&index, g_size) == index.count);
+
+    unload(&index, map, &st);
+}
+
+static void test_sidecar(void) {
+    printf("Test 2: sidecar is reused, invalid entries force a rescan\n");
+
+    vtx_media_index_t scanned;
+    const uint8_t* map;
+    struct stat st;
+    CHECK(load(&scanned, &map, &st) == VTX_OK);
+    uint32_t count = scanned.count;
+    uint64_t last_offset = scanned.entries[count - 1].offset;
+    unload(&scanned, map, &st);
+
+    /* 旁路文件存在且与媒体文件一致时直接映射 */
+    CHECK(access(g_idx_path, F_OK) == 0);
+    vtx_media_index_t index;
+    CHECK(load(&index, &map, &st) == VTX_OK);
+    CHECK(index.map != NULL);
+    CHECK(index.count == count);
+    CHECK(index.entries[count - 1].offset == last_offset);
+    unload(&index, map, &st);
+
+    /* offset + size回绕到文件范围内的项必须被拒绝 */
+    vtx_media_entry_t bad = {0};
+    bad.offset = UINT64_MAX - 10;
+    bad.size = 100;
+    bad.frame_type = VTX_FRAME_P;
+    int fd = open(g_idx_path, O_WRONLY);
+    CHECK(fd >= 0);
+    CHECK(pwrite(fd, &bad, sizeof(bad), VTX_INDEX_HEADER_SIZE + 3 * sizeof(bad)) ==
+          (ssize_t)sizeof(bad));
+    close(fd);
+
+    CHECK(load(&index, &map, &st) == VTX_OK);
+    CHECK(index.map == NULL);                   /* 重新扫描 */
+    CHECK(index.count == count);
+    CHECK(index.entries[3].offset < (uint64_t)st.st_size);
+    unload(&index, map, &st);
+
+    /* 重新扫描后写入了有效的旁路文件 */
+    CHECK(load(&index, &map, &st) == VTX_OK);
+    CHECK(index.map != NULL);
+    CHECK(index.entries[3].offset + index.entries[3].size <= (uint64_t)st.st_size);
+    unload(&index, map, &st);
+}
+
+static void test_oversized(void) {
+    printf("Test 3: frames larger than VTX_MAX_FRAME_SIZE are dropped and counted\n");
+
+    g_size = 0;
+    add_gop(1, 100);
+    add_nal(0x41, 0x9a, VTX_MAX_FRAME_SIZE + 1);
+    add_nal(0x41, 0x9a, 100);
+    CHECK(write_stream() == 0);
+
+    vtx_media_index_t index;
+    const uint8_t* map;
+    struct stat st;
+    CHECK(load(&index, &map, &st) == VTX_OK);
+    CHECK(index.count == 5);
+    CHECK(index.dropped == 1);
+    for (uint32_t i = 0; i < index.count; i++) {
+        CHECK(index.entries[i].size <= VTX_MAX_FRAME_SIZE);
+    }
+    unload(&index, map, &st);
+
+    /* 丢弃数保存在旁路文件中 */
+    CHECK(load(&index, &map, &st) == VTX_OK);
+    CHECK(index.map != NULL);
+    CHECK(index.dropped == 1);
+    unload(&index, map, &st);
+}
+
+static void test_no_frames(void) {
+    printf("Test 4: file without pictures is rejected\n");
+
+    g_size = 0;
+    add_nal(0x06, 0x05, 100);                   /* 只有SEI */
+    CHECK(write_stream() == 0);
+
+    vtx_media_index_t index;
+    const uint8_t* map;
+    struct stat st;
+    CHECK(load(&index, &map, &st) == VTX_ERR_FORMAT_INVALID);
+    munmap((void*)map, (size_t)st.st_size);
+}
+
+int main(void) {
+    printf("=== VTX Index Test ===\n\n");
+
+    int fd = mkstemp(g_path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    snprintf(g_idx_path, sizeof(g_idx_path), "%s" VTX_INDEX_SUFFIX, g_path);
+
+    test_scan();
+    test_sidecar();
+    test_oversized();
+    test_no_frames();
+
+    unlink(g_path);
+    unlink(g_idx_path);
+    free(g_stream);
+
+    VTX_TEST_RESULT();
+}
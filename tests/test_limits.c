@@ -0,0 +1,112 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_limits.c
+ * @brief Test VTX_DATA_LIMIT payload serialization
+ */
+
+#include "vtx_packet.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <string.h>
+
+static void test_wire_format(void) {
+    printf("Test 1: limits wire format (network byte order)\n");
+
+    vtx_limits_t limits = {
+        .max_bitrate_kbps = 0x01020304,
+        .max_frame_size = 0x05060708,
+        .max_fps = 0x090a,
+        .max_width = 0x0b0c,
+        .max_height = 0x0d0e,
+    };
+    static const uint8_t expected[VTX_LIMITS_WIRE_SIZE] = {
+        0x01, 0x02, 0x03, 0x04,
+        0x05, 0x06, 0x07, 0x08,
+        0x09, 0x0a,
+        0x0b, 0x0c,
+        0x0d, 0x0e,
+    };
+
+    uint8_t buf[VTX_LIMITS_WIRE_SIZE + 2];
+    memset(buf, 0xee, sizeof(buf));
+    CHECK(vtx_packet_pack_limits(&limits, buf, sizeof(buf)) == VTX_OK);
+    CHECK(memcmp(buf, expected, VTX_LIMITS_WIRE_SIZE) == 0);
+    CHECK(buf[VTX_LIMITS_WIRE_SIZE] == 0xee);  /* 不越界写 */
+}
+
+static void test_roundtrip(void) {
+    printf("Test 2: limits pack/unpack roundtrip\n");
+
+    vtx_limits_t in = {
+        .max_bitrate_kbps = 8000,
+        .max_frame_size = 512 * 1024,
+        .max_fps = 30,
+        .max_width = 1920,
+        .max_height = 1080,
+    };
+    vtx_limits_t out;
+    memset(&out, 0, sizeof(out));
+
+    uint8_t buf[VTX_LIMITS_WIRE_SIZE];
+    CHECK(vtx_packet_pack_limits(&in, buf, sizeof(buf)) == VTX_OK);
+    CHECK(vtx_packet_unpack_limits(buf, sizeof(buf), &out) == VTX_OK);
+    CHECK(out.max_bitrate_kbps == in.max_bitrate_kbps);
+    CHECK(out.max_frame_size == in.max_frame_size);
+    CHECK(out.max_fps == in.max_fps);
+    CHECK(out.max_width == in.max_width);
+    CHECK(out.max_height == in.max_height);
+
+    /* 全0表示不限制，同样原样往返 */
+    vtx_limits_t zero;
+    memset(&zero, 0, sizeof(zero));
+    memset(&out, 0xff, sizeof(out));
+    CHECK(vtx_packet_pack_limits(&zero, buf, sizeof(buf)) == VTX_OK);
+    CHECK(vtx_packet_unpack_limits(buf, sizeof(buf), &out) == VTX_OK);
+    CHECK(out.max_bitrate_kbps == 0 && out.max_frame_size == 0);
+    CHECK(out.max_fps == 0 && out.max_width == 0 && out.max_height == 0);
+}
+
+static void test_invalid(void) {
+    printf("Test 3: limits invalid parameters\n");
+
+    vtx_limits_t limits;
+    memset(&limits, 0, sizeof(limits));
+    uint8_t buf[VTX_LIMITS_WIRE_SIZE];
+    memset(buf, 0, sizeof(buf));
+
+    CHECK(vtx_packet_pack_limits(&limits, buf, VTX_LIMITS_WIRE_SIZE - 1) ==
+          VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_packet_pack_limits(NULL, buf, sizeof(buf)) == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_packet_pack_limits(&limits, NULL, sizeof(buf)) == VTX_ERR_INVALID_PARAM);
+
+    /* 截断的载荷 */
+    CHECK(vtx_packet_unpack_limits(buf, VTX_LIMITS_WIRE_SIZE - 1, &limits) ==
+          VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_packet_unpack_limits(NULL, sizeof(buf), &limits) == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_packet_unpack_limits(buf, sizeof(buf), NULL) == VTX_ERR_INVALID_PARAM);
+}
+
+int main(void) {
+    printf("=== VTX Limits Test ===\n\n");
+
+    test_wire_format();
+    test_roundtrip();
+    test_invalid();
+
+    VTX_TEST_RESULT();
+}
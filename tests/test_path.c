@@ -0,0 +1,175 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_path.c
+ * @brief Test multipath scheduling (SWRR weighting)
+ */
+
+#include "vtx_path.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ROUNDS 1000
+
+static void run_select(vtx_path_set_t* set, int* counts, int rounds) {
+    memset(counts, 0, sizeof(int) * VTX_MAX_PATHS);
+    for (int i = 0; i < rounds; i++) {
+        uint8_t p = vtx_path_select(set);
+        if (p < set->count) {
+            counts[p]++;
+        }
+    }
+}
+
+static void test_single_path(void) {
+    printf("Test 1: single path always selected\n");
+
+    vtx_path_set_t set;
+    vtx_path_set_init(&set, -1);
+
+    int counts[VTX_MAX_PATHS];
+    run_select(&set, counts, 100);
+    CHECK(counts[0] == 100);
+    CHECK(set.paths[0].sent_packets == 100);
+
+    vtx_path_set_destroy(&set);
+}
+
+static void test_equal_paths(void) {
+    printf("Test 2: equal paths alternate\n");
+
+    vtx_path_set_t set;
+    vtx_path_set_init(&set, -1);
+    CHECK(vtx_path_set_add(&set, -1) == 1);
+
+    /* 权重相同时严格交替 */
+    uint8_t prev = vtx_path_select(&set);
+    int alternations = 0;
+    for (int i = 0; i < 99; i++) {
+        uint8_t p = vtx_path_select(&set);
+        if (p != prev) {
+            alternations++;
+        }
+        prev = p;
+    }
+    CHECK(alternations == 99);
+    CHECK(set.paths[0].sent_packets == 50 && set.paths[1].sent_packets == 50);
+
+    vtx_path_set_destroy(&set);
+}
+
+static void test_rtt_weighting(void) {
+    printf("Test 3: lower RTT path gets proportionally more fragments\n");
+
+    vtx_path_set_t set;
+    vtx_path_set_init(&set, -1);
+    CHECK(vtx_path_set_add(&set, -1) == 1);
+
+    vtx_path_on_ack(&set, 0, 10);
+    vtx_path_on_ack(&set, 1, 40);
+    CHECK(set.paths[0].srtt_ms == 10 && set.paths[1].srtt_ms == 40);
+
+    /* 权重 100000/11 : 100000/41，约3.7 : 1 */
+    int counts[VTX_MAX_PATHS];
+    run_select(&set, counts, ROUNDS);
+    CHECK(counts[0] + counts[1] == ROUNDS);
+    CHECK(counts[0] >= 780 && counts[0] <= 795);
+    CHECK(counts[1] > 0);
+
+    /* 平滑：慢路径不会连续被选中 */
+    uint8_t prev = vtx_path_select(&set);
+    for (int i = 0; i < 100; i++) {
+        uint8_t p = vtx_path_select(&set);
+        CHECK(!(p == 1 && prev == 1));
+        prev = p;
+    }
+
+    CHECK(vtx_path_best(&set) == 0);
+
+    vtx_path_set_destroy(&set);
+}
+
+static void test_loss_weighting(void) {
+    printf("Test 4: lossy path is demoted, recovers on ACK\n");
+
+    vtx_path_set_t set;
+    vtx_path_set_init(&set, -1);
+    CHECK(vtx_path_set_add(&set, -1) == 1);
+
+    vtx_path_on_ack(&set, 0, 20);
+    vtx_path_on_ack(&set, 1, 20);
+
+    for (int i = 0; i < 20; i++) {
+        vtx_path_on_loss(&set, 1);
+    }
+    CHECK(set.paths[1].loss_permille > 900);
+    CHECK(set.paths[1].lost_packets == 20);
+
+    int counts[VTX_MAX_PATHS];
+    run_select(&set, counts, ROUNDS);
+    CHECK(counts[1] < ROUNDS / 10);
+    CHECK(counts[1] > 0);  /* 权重至少为1，仍保留探测 */
+    CHECK(vtx_path_best(&set) == 0);
+
+    /* ACK使丢包率衰减，份额回升 */
+    for (int i = 0; i < 40; i++) {
+        vtx_path_on_ack(&set, 1, VTX_PATH_NO_RTT);
+    }
+    CHECK(set.paths[1].loss_permille < 100);
+    CHECK(set.paths[1].srtt_ms == 20);  /* 无RTT样本不影响srtt */
+
+    int later[VTX_MAX_PATHS];
+    run_select(&set, later, ROUNDS);
+    CHECK(later[1] > counts[1] * 4);
+
+    vtx_path_set_destroy(&set);
+}
+
+static void test_stats(void) {
+    printf("Test 5: path stats and bounds\n");
+
+    vtx_path_set_t set;
+    vtx_path_set_init(&set, -1);
+    for (int i = 1; i < VTX_MAX_PATHS; i++) {
+        CHECK(vtx_path_set_add(&set, -1) == i);
+    }
+    CHECK(vtx_path_set_add(&set, -1) == -1);
+
+    vtx_path_note_sent(&set, 1);
+    vtx_path_on_ack(&set, 1, 30);
+    vtx_path_on_loss(&set, VTX_MAX_PATHS);  /* 越界被忽略 */
+
+    vtx_path_stats_t stats[VTX_MAX_PATHS];
+    CHECK(vtx_path_get_stats(&set, stats) == VTX_MAX_PATHS);
+    CHECK(stats[1].sent_packets == 1 && stats[1].acked_packets == 1);
+    CHECK(stats[1].srtt_ms == 30);
+    CHECK(stats[0].srtt_ms == 0 && stats[0].lost_packets == 0);
+
+    vtx_path_set_destroy(&set);
+}
+
+int main(void) {
+    printf("=== VTX Path Test ===\n\n");
+
+    test_single_path();
+    test_equal_paths();
+    test_rtt_weighting();
+    test_loss_weighting();
+    test_stats();
+
+    VTX_TEST_RESULT();
+}
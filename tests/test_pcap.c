@@ -0,0 +1,352 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_pcap.c
+ * @brief Test pcapng capture writer and pcap/pcapng reader
+ */
+
+#include "vtx.h"
+#include "vtx_pcap.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static void put_be16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+/* 写入pcapng后读回，检查方向、地址和载荷 */
+static void test_pcapng_roundtrip(const char* path) {
+    printf("Test 1: pcapng write/read round trip\n");
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in local = {0};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(fd, (struct sockaddr*)&local, sizeof(local)) == 0);
+    socklen_t len = sizeof(local);
+    getsockname(fd, (struct sockaddr*)&local, &len);
+
+    struct sockaddr_in peer = {0};
+    peer.sin_family = AF_INET;
+    peer.sin_port = htons(9000);
+    inet_pton(AF_INET, "127.0.0.9", &peer.sin_addr);
+
+    vtx_pcap_t* pcap = vtx_pcap_open(path);
+    CHECK(pcap != NULL);
+    if (!pcap) {
+        close(fd);
+        return;
+    }
+
+    /* 两段iov（包头+载荷）应拼接成一个数据报 */
+    uint8_t head[24], body[1000];
+    for (size_t i = 0; i < sizeof(head); i++) head[i] = (uint8_t)i;
+    for (size_t i = 0; i < sizeof(body); i++) body[i] = (uint8_t)(i * 7);
+    struct iovec out_iov[2] = {
+        { head, sizeof(head) },
+        { body, sizeof(body) },
+    };
+    vtx_pcap_write(pcap, fd, VTX_PCAP_DIR_OUT, &peer, out_iov, 2);
+
+    uint8_t ack[24] = { 0xAA, 0x55 };
+    struct iovec in_iov = { ack, sizeof(ack) };
+    vtx_pcap_write(pcap, fd, VTX_PCAP_DIR_IN, &peer, &in_iov, 1);
+    vtx_pcap_close(pcap);
+    close(fd);
+
+    vtx_pcap_reader_t* r = vtx_pcap_reader_open(path);
+    CHECK(r != NULL);
+    if (!r) {
+        return;
+    }
+
+    vtx_pcap_packet_t pkt;
+    CHECK(vtx_pcap_reader_next(r, &pkt) == VTX_OK);
+    CHECK(pkt.dir == VTX_PCAP_DIR_OUT);
+    CHECK(pkt.size == sizeof(head) + sizeof(body));
+    CHECK(pkt.size >= sizeof(head) && memcmp(pkt.data, head, sizeof(head)) == 0);
+    CHECK(pkt.size == sizeof(head) + sizeof(body) &&
+          memcmp(pkt.data + sizeof(head), body, sizeof(body)) == 0);
+    CHECK(pkt.src.sin_addr.s_addr == local.sin_addr.s_addr);
+    CHECK(pkt.src.sin_port == local.sin_port);
+    CHECK(pkt.dst.sin_addr.s_addr == peer.sin_addr.s_addr);
+    CHECK(pkt.dst.sin_port == peer.sin_port);
+    uint64_t first_ts = pkt.ts_us;
+    CHECK(first_ts > 0);
+
+    CHECK(vtx_pcap_reader_next(r, &pkt) == VTX_OK);
+    CHECK(pkt.dir == VTX_PCAP_DIR_IN);
+    CHECK(pkt.size == sizeof(ack) && memcmp(pkt.data, ack, sizeof(ack)) == 0);
+    CHECK(pkt.src.sin_addr.s_addr == peer.sin_addr.s_addr);
+    CHECK(pkt.dst.sin_port == local.sin_port);
+    CHECK(pkt.ts_us >= first_ts);
+
+    CHECK(vtx_pcap_reader_next(r, &pkt) == VTX_ERR_FILE_EOF);
+    vtx_pcap_reader_close(r);
+}
+
+/* 经典pcap（以太网链路，含VLAN标签和非UDP包） */
+static void test_classic_ethernet(const char* path) {
+    printf("Test 2: classic pcap with Ethernet/VLAN frames\n");
+
+    FILE* fp = fopen(path, "wb");
+    CHECK(fp != NULL);
+    if (!fp) {
+        return;
+    }
+
+    uint32_t ghdr[6] = { 0xa1b2c3d4, 0x00040002, 0, 0, 65535, 1 };
+    fwrite(ghdr, sizeof(ghdr), 1, fp);
+
+    const uint8_t payload[5] = { 'h', 'e', 'l', 'l', 'o' };
+    uint8_t pkt_buf[128];
+    memset(pkt_buf, 0, sizeof(pkt_buf));
+    put_be16(pkt_buf + 12, 0x8100);                 /* VLAN */
+    put_be16(pkt_buf + 16, 0x0800);                 /* IPv4 */
+    uint8_t* ip = pkt_buf + 18;
+    ip[0] = 0x45;
+    put_be16(ip + 2, (uint16_t)(20 + 8 + sizeof(payload)));
+    ip[8] = 64;
+    ip[9] = IPPROTO_UDP;
+    ip[12] = 10; ip[13] = 0; ip[14] = 0; ip[15] = 1;
+    ip[16] = 10; ip[17] = 0; ip[18] = 0; ip[19] = 2;
+    uint8_t* udp = ip + 20;
+    put_be16(udp, 5000);
+    put_be16(udp + 2, 6000);
+    put_be16(udp + 4, (uint16_t)(8 + sizeof(payload)));
+    memcpy(udp + 8, payload, sizeof(payload));
+    uint32_t caplen = 18 + 20 + 8 + sizeof(payload);
+
+    /* 先写一个ARP包（应被跳过） */
+    uint8_t arp[42] = {0};
+    put_be16(arp + 12, 0x0806);
+    uint32_t rec_arp[4] = { 100, 5, sizeof(arp), sizeof(arp) };
+    fwrite(rec_arp, sizeof(rec_arp), 1, fp);
+    fwrite(arp, sizeof(arp), 1, fp);
+
+    uint32_t rec[4] = { 100, 250, caplen, caplen };
+    fwrite(rec, sizeof(rec), 1, fp);
+    fwrite(pkt_buf, caplen, 1, fp);
+    fclose(fp);
+
+    vtx_pcap_reader_t* r = vtx_pcap_reader_open(path);
+    CHECK(r != NULL);
+    if (!r) {
+        return;
+    }
+    vtx_pcap_packet_t pkt;
+    CHECK(vtx_pcap_reader_next(r, &pkt) == VTX_OK);
+    CHECK(pkt.dir == VTX_PCAP_DIR_UNKNOWN);
+    CHECK(pkt.ts_us == 100 * 1000000ULL + 250);
+    CHECK(pkt.size == sizeof(payload) && memcmp(pkt.data, payload, sizeof(payload)) == 0);
+    CHECK(ntohs(pkt.src.sin_port) == 5000 && ntohs(pkt.dst.sin_port) == 6000);
+    CHECK(ntohl(pkt.src.sin_addr.s_addr) == 0x0A000001);
+    CHECK(vtx_pcap_reader_next(r, &pkt) == VTX_ERR_FILE_EOF);
+    vtx_pcap_reader_close(r);
+}
+
+/* 非抓包文件和截断的文件 */
+static void test_invalid(const char* path) {
+    printf("Test 3: invalid and truncated files\n");
+
+    FILE* fp = fopen(path, "wb");
+    if (fp) {
+        fputs("not a capture file", fp);
+        fclose(fp);
+    }
+    CHECK(vtx_pcap_reader_open(path) == NULL);
+    CHECK(vtx_pcap_reader_open("/nonexistent/vtx.pcapng") == NULL);
+
+    fp = fopen(path, "wb");
+    if (fp) {
+        uint32_t ghdr[6] = { 0xa1b2c3d4, 0x00040002, 0, 0, 65535, 101 };
+        uint32_t rec[4] = { 1, 0, 1000, 1000 };
+        fwrite(ghdr, sizeof(ghdr), 1, fp);
+        fwrite(rec, sizeof(rec), 1, fp);
+        fputs("short", fp);
+        fclose(fp);
+    }
+    vtx_pcap_reader_t* r = vtx_pcap_reader_open(path);
+    CHECK(r != NULL);
+    if (r) {
+        vtx_pcap_packet_t pkt;
+        CHECK(vtx_pcap_reader_next(r, &pkt) == VTX_ERR_FORMAT_INVALID);
+        vtx_pcap_reader_close(r);
+    }
+}
+
+#define REPLAY_PORT     8977
+#define REPLAY_FRAMES   10
+
+static const uint8_t* g_key = (const uint8_t*)"0123456789abcdef";  /* VTX_CRYPTO_KEY_SIZE字节 */
+static volatile bool g_polling;
+static volatile bool g_connected;
+static int g_frames;
+static int g_bad_frames;
+
+static uint8_t frame_byte(size_t i, size_t size) {
+    return (uint8_t)(i * 7 + size);
+}
+
+static int on_replay_frame(const uint8_t* data, size_t size,
+                           vtx_frame_type_t type, void* userdata) {
+    (void)type;
+    (void)userdata;
+    g_frames++;
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != frame_byte(i, size)) {
+            g_bad_frames++;
+            break;
+        }
+    }
+    return 0;
+}
+
+static void on_replay_connect(bool connected, void* userdata) {
+    (void)userdata;
+    g_connected = connected;
+}
+
+static void* tx_accept_thread(void* arg) {
+    vtx_tx_accept((vtx_tx_t*)arg, 3000);
+    return NULL;
+}
+
+static void* tx_poll_thread(void* arg) {
+    while (g_polling) {
+        vtx_tx_poll((vtx_tx_t*)arg, 10);
+    }
+    return NULL;
+}
+
+static void* rx_poll_thread(void* arg) {
+    while (g_polling) {
+        vtx_rx_poll((vtx_rx_t*)arg, 10);
+    }
+    return NULL;
+}
+
+/* 加密会话抓包后注入新的接收端：盐和令牌取自抓包中的CONNECTED */
+static void test_encrypted_replay(const char* path) {
+    printf("Test 4: encrypted capture replay\n");
+
+    vtx_init(NULL);
+
+    vtx_tx_config_t tx_config = {
+        .bind_addr = "127.0.0.1",
+        .bind_port = REPLAY_PORT,
+        .mtu = VTX_DEFAULT_MTU,
+        .crypto_key = g_key,
+        .capture_path = path,
+    };
+    vtx_rx_config_t rx_config = {
+        .server_addr = "127.0.0.1",
+        .server_port = REPLAY_PORT,
+        .mtu = VTX_DEFAULT_MTU,
+        .crypto_key = g_key,
+    };
+    vtx_tx_t* tx = vtx_tx_create(&tx_config, NULL, NULL, NULL);
+    vtx_rx_t* rx = vtx_rx_create(&rx_config, on_replay_frame, NULL,
+                                 on_replay_connect, NULL);
+    CHECK(tx != NULL && rx != NULL);
+    int ret = (tx && rx) ? vtx_tx_listen(tx) : VTX_ERR_INVALID_PARAM;
+    CHECK(ret == VTX_OK);
+    if (ret != VTX_OK) {
+        vtx_rx_destroy(rx);
+        vtx_tx_destroy(tx);
+        vtx_fini();
+        return;
+    }
+
+    /* 实时会话：TX抓包记录握手和加密的媒体分片 */
+    g_polling = true;
+    pthread_t accept_tid, tx_tid, rx_tid;
+    pthread_create(&accept_tid, NULL, tx_accept_thread, tx);
+    usleep(50000);
+    vtx_rx_connect(rx);
+    pthread_create(&rx_tid, NULL, rx_poll_thread, rx);
+    pthread_join(accept_tid, NULL);
+    pthread_create(&tx_tid, NULL, tx_poll_thread, tx);
+    for (int i = 0; i < 100 && !g_connected; i++) {
+        usleep(10000);
+    }
+    CHECK(g_connected);
+
+    static uint8_t data[20000];
+    for (int k = 0; k < REPLAY_FRAMES; k++) {
+        size_t size = k == 0 ? sizeof(data) : 300 + (size_t)k * 500;
+        for (size_t i = 0; i < size; i++) {
+            data[i] = frame_byte(i, size);
+        }
+        vtx_tx_send_media_buf(tx, data, size, k == 0 ? VTX_FRAME_I : VTX_FRAME_P);
+        usleep(10000);
+    }
+    usleep(100000);
+
+    g_polling = false;
+    pthread_join(rx_tid, NULL);
+    pthread_join(tx_tid, NULL);
+    int live_frames = g_frames;
+    CHECK(live_frames == REPLAY_FRAMES);
+    vtx_rx_destroy(rx);
+    vtx_tx_destroy(tx);
+
+    /* 回放：注入TX发出的全部数据报，接收端不连接 */
+    g_frames = 0;
+    g_bad_frames = 0;
+    rx_config.server_port = 9;
+    rx = vtx_rx_create(&rx_config, on_replay_frame, NULL, NULL, NULL);
+    vtx_pcap_reader_t* r = vtx_pcap_reader_open(path);
+    CHECK(rx != NULL && r != NULL);
+    if (rx && r) {
+        vtx_pcap_packet_t pkt;
+        while (vtx_pcap_reader_next(r, &pkt) == VTX_OK) {
+            if (pkt.dir == VTX_PCAP_DIR_OUT) {
+                vtx_rx_inject_packet(rx, pkt.data, pkt.size);
+            }
+        }
+        CHECK(g_frames == live_frames);
+        CHECK(g_bad_frames == 0);
+    }
+    vtx_pcap_reader_close(r);
+    vtx_rx_destroy(rx);
+
+    vtx_fini();
+}
+
+int main(void) {
+    printf("=== VTX Pcap Test ===\n\n");
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/vtx_test_pcap_%d", (int)getpid());
+
+    test_pcapng_roundtrip(path);
+    test_classic_ethernet(path);
+    test_invalid(path);
+    test_encrypted_replay(path);
+    unlink(path);
+
+    VTX_TEST_RESULT();
+}
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_record.c
+ * @brief Test segment recorder layout, rotation, numbering and open failures
+ */
+
+#include "vtx_record.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static char g_dir[] = "/tmp/vtx_test_record_XXXXXX";
+
+static uint32_t get32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+           (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get64(const uint8_t* p) {
+    return (uint64_t)get32(p) | (uint64_t)get32(p + 4) << 32;
+}
+
+/**
+ * @brief 读取整个段文件，返回大小（不存在返回0）
+ */
+static size_t read_segment(const char* prefix, unsigned no, uint8_t* buf, size_t cap) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s-%06u.vtxrec", prefix, no);
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    size_t n = fread(buf, 1, cap, fp);
+    fclose(fp);
+    return n;
+}
+
+static void test_layout(void) {
+    printf("Test 1: segment header, frame records and keyframe index\n");
+
+    char prefix[256];
+    snprintf(prefix, sizeof(prefix), "%s/layout", g_dir);
+    vtx_recorder_t* rec = vtx_recorder_create(prefix, 64 * 1024);
+    CHECK(rec != NULL);
+    if (!rec) {
+        return;
+    }
+
+    uint8_t data[100];
+    memset(data, 0xab, sizeof(data));
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_SPS, 1, 1000, data, 10) == VTX_OK);
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_PPS, 2, 1001, data, 5) == VTX_OK);
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_I, 3, 1002, data, 100) == VTX_OK);
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_P, 4, 1003, data, 33) == VTX_OK);
+    vtx_recorder_destroy(rec);
+
+    static uint8_t buf[64 * 1024];
+    size_t size = read_segment(prefix, 0, buf, sizeof(buf));
+    CHECK(size > VTX_RECORD_HEADER_SIZE);
+    CHECK(memcmp(buf, VTX_RECORD_MAGIC, 8) == 0);
+    CHECK(get32(buf + 8) == VTX_RECORD_VERSION);
+    CHECK(get32(buf + 44) == 4);                /* frame_count */
+    CHECK(get32(buf + 40) == 1);                /* index_count */
+
+    /* 记录按8字节对齐：16+10→32，16+5→24，16+100→120，16+33→56 */
+    uint64_t data_end = get64(buf + 24);
+    uint64_t index_offset = get64(buf + 32);
+    CHECK(data_end == VTX_RECORD_HEADER_SIZE + 32 + 24 + 120 + 56);
+    CHECK(index_offset == data_end);
+    CHECK(size == index_offset + VTX_RECORD_INDEX_ENTRY);
+
+    const uint8_t* p = buf + VTX_RECORD_HEADER_SIZE + 32 + 24;
+    CHECK(get32(p) == 100);
+    CHECK(p[4] == VTX_FRAME_I);
+    CHECK(get64(p + 8) == 1002);
+
+    /* I帧索引指向之前的SPS */
+    CHECK(get64(buf + index_offset) == 1002);
+    CHECK(get64(buf + index_offset + 8) == VTX_RECORD_HEADER_SIZE);
+}
+
+static void test_rotation(void) {
+    printf("Test 2: full segment rotates, oversized frame rejected\n");
+
+    char prefix[256];
+    snprintf(prefix, sizeof(prefix), "%s/rotate", g_dir);
+    vtx_recorder_t* rec = vtx_recorder_create(prefix, 4096);
+    CHECK(rec != NULL);
+    if (!rec) {
+        return;
+    }
+
+    uint8_t data[1000];
+    memset(data, 0x11, sizeof(data));
+    for (int i = 0; i < 10; i++) {
+        CHECK(vtx_recorder_append(rec, i % 5 == 0 ? VTX_FRAME_I : VTX_FRAME_P,
+                                  (uint16_t)i, (uint64_t)i, data, sizeof(data)) == VTX_OK);
+    }
+    uint8_t big[4096];
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_P, 99, 99, big, sizeof(big)) == VTX_ERR_OVERFLOW);
+    vtx_recorder_destroy(rec);
+
+    static uint8_t buf[4096];
+    uint32_t frames = 0;
+    unsigned segments = 0;
+    for (unsigned no = 0; no < 10; no++) {
+        size_t size = read_segment(prefix, no, buf, sizeof(buf));
+        if (size == 0) {
+            break;
+        }
+        CHECK(memcmp(buf, VTX_RECORD_MAGIC, 8) == 0);
+        CHECK(get64(buf + 32) + (uint64_t)get32(buf + 40) * VTX_RECORD_INDEX_ENTRY == size);
+        frames += get32(buf + 44);
+        segments++;
+    }
+    CHECK(segments >= 3);
+    CHECK(frames == 10);
+}
+
+static void test_no_overwrite(void) {
+    printf("Test 3: existing segments are kept, numbering continues\n");
+
+    char prefix[256];
+    char path[512];
+    snprintf(prefix, sizeof(prefix), "%s/keep", g_dir);
+    for (unsigned no = 0; no < 2; no++) {
+        snprintf(path, sizeof(path), "%s-%06u.vtxrec", prefix, no);
+        FILE* fp = fopen(path, "wb");
+        CHECK(fp != NULL);
+        if (fp) {
+            fputs("earlier recording", fp);
+            fclose(fp);
+        }
+    }
+
+    vtx_recorder_t* rec = vtx_recorder_create(prefix, 64 * 1024);
+    CHECK(rec != NULL);
+    if (!rec) {
+        return;
+    }
+    uint8_t data[16] = {0};
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_I, 1, 1, data, sizeof(data)) == VTX_OK);
+    vtx_recorder_destroy(rec);
+
+    static uint8_t buf[64 * 1024];
+    for (unsigned no = 0; no < 2; no++) {
+        size_t size = read_segment(prefix, no, buf, sizeof(buf));
+        CHECK(size == strlen("earlier recording"));
+        CHECK(memcmp(buf, "earlier recording", strlen("earlier recording")) == 0);
+    }
+    size_t size = read_segment(prefix, 2, buf, sizeof(buf));
+    CHECK(size > VTX_RECORD_HEADER_SIZE);
+    CHECK(memcmp(buf, VTX_RECORD_MAGIC, 8) == 0);
+    CHECK(get32(buf + 44) == 1);
+}
+
+static void test_open_failure(void) {
+    printf("Test 4: open failure pauses recording instead of retrying every frame\n");
+
+    char prefix[512];
+    char dir[256];
+    snprintf(dir, sizeof(dir), "%s/missing", g_dir);
+    snprintf(prefix, sizeof(prefix), "%s/rec", dir);
+    vtx_recorder_t* rec = vtx_recorder_create(prefix, 64 * 1024);
+    CHECK(rec != NULL);
+    if (!rec) {
+        return;
+    }
+
+    uint8_t data[16] = {0};
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_I, 1, 1, data, sizeof(data)) == VTX_ERR_FILE_OPEN);
+
+    /* 目录已可用，但重试间隔内不再尝试 */
+    CHECK(mkdir(dir, 0755) == 0);
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_P, 2, 2, data, sizeof(data)) == VTX_ERR_NOT_READY);
+    CHECK(access(dir, F_OK) == 0);
+
+    static uint8_t buf[64 * 1024];
+    CHECK(read_segment(prefix, 0, buf, sizeof(buf)) == 0);
+
+    /* 间隔过后恢复录制 */
+    usleep(1100 * 1000);
+    CHECK(vtx_recorder_append(rec, VTX_FRAME_I, 3, 3, data, sizeof(data)) == VTX_OK);
+    vtx_recorder_destroy(rec);
+    CHECK(read_segment(prefix, 0, buf, sizeof(buf)) > VTX_RECORD_HEADER_SIZE);
+}
+
+/**
+ * @brief 删除测试目录（两层）
+ */
+static void remove_tree(const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        return;
+    }
+    struct dirent* ent;
+    char child[512];
+    while ((ent = readdir(dir)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        if (unlink(child) != 0) {
+            remove_tree(child);
+        }
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+int main(void) {
+    printf("=== VTX Record Test ===\n\n");
+
+    if (!mkdtemp(g_dir)) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    test_layout();
+    test_rotation();
+    test_no_overwrite();
+    test_open_failure();
+
+    remove_tree(g_dir);
+
+    VTX_TEST_RESULT();
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_rx_queue.c
+ * @brief Test RX reassembly queue purge and timeout cleanup
+ */
+
+#include "vtx.h"
+#include "vtx_packet.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FRAG_PAYLOAD    (VTX_DEFAULT_MTU - VTX_PACKET_HEADER_SIZE)
+#define FRAME_TIMEOUT   50
+
+static int g_frames[VTX_FRAME_A + 1];
+
+static int on_frame(const uint8_t* data, size_t size,
+                    vtx_frame_type_t type, void* userdata) {
+    (void)data;
+    (void)size;
+    (void)userdata;
+    g_frames[type]++;
+    return 0;
+}
+
+/* 注入一个满载荷的媒体分片 */
+static int inject_frag(vtx_rx_t* rx, uint32_t seq, uint16_t frame_id,
+                       vtx_frame_type_t type, uint16_t frag_index, uint16_t total_frags) {
+    uint8_t buf[VTX_DEFAULT_MTU];
+    uint8_t* payload = buf + VTX_PACKET_HEADER_SIZE;
+    memset(payload, (int)frame_id, FRAG_PAYLOAD);
+
+    vtx_packet_header_t header = {0};
+    header.seq_num = seq;
+    header.frame_id = frame_id;
+    header.frame_type = type;
+    header.frag_index = frag_index;
+    header.total_frags = total_frags;
+    header.payload_size = FRAG_PAYLOAD;
+    if (frag_index + 1 == total_frags) {
+        header.flags = VTX_FLAG_LAST_FRAG;
+    }
+    vtx_packet_serialize_header(&header);
+    memcpy(buf, &header, VTX_PACKET_HEADER_SIZE);
+    vtx_packet_calc_crc(buf, payload, FRAG_PAYLOAD);
+
+    return vtx_rx_inject_packet(rx, buf, sizeof(buf));
+}
+
+static vtx_rx_stats_t get_stats(vtx_rx_t* rx) {
+    vtx_rx_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    vtx_rx_get_stats(rx, &stats);
+    return stats;
+}
+
+/* 新I帧完成时丢弃更早的不完整视频帧，音频帧保留到超时 */
+static void test_purge_before_key_frame(vtx_rx_t* rx) {
+    printf("Test 1: completed I-frame purges older video, keeps audio\n");
+
+    CHECK(inject_frag(rx, 1, 1, VTX_FRAME_P, 0, 2) == VTX_OK);
+    CHECK(inject_frag(rx, 3, 2, VTX_FRAME_A, 0, 2) == VTX_OK);
+    vtx_rx_stats_t stats = get_stats(rx);
+    CHECK(stats.pool_used_frames == 2);
+    CHECK(stats.incomplete_frames == 0);
+
+    CHECK(inject_frag(rx, 5, 3, VTX_FRAME_I, 0, 2) == VTX_OK);
+    CHECK(inject_frag(rx, 6, 3, VTX_FRAME_I, 1, 2) == VTX_OK);
+    CHECK(g_frames[VTX_FRAME_I] == 1);
+
+    /* P帧被丢弃；使用中的是音频帧和缓存的I帧 */
+    stats = get_stats(rx);
+    CHECK(stats.incomplete_frames == 1);
+    CHECK(stats.pool_used_frames == 2);
+
+    /* 音频帧在I帧之后仍可完成 */
+    CHECK(inject_frag(rx, 4, 2, VTX_FRAME_A, 1, 2) == VTX_OK);
+    CHECK(g_frames[VTX_FRAME_A] == 1);
+    stats = get_stats(rx);
+    CHECK(stats.incomplete_frames == 1);
+    CHECK(stats.pool_used_frames == 1);
+
+    /* 被丢弃帧的迟到分片不再重组 */
+    CHECK(inject_frag(rx, 2, 1, VTX_FRAME_P, 1, 2) == VTX_OK);
+    CHECK(g_frames[VTX_FRAME_P] == 0);
+    CHECK(get_stats(rx).pool_used_frames == 1);
+}
+
+/* 超时的不完整帧（包括音频）由poll按截止时刻清理 */
+static void test_timeout_cleanup(vtx_rx_t* rx) {
+    printf("Test 2: incomplete frames expire at the deadline\n");
+
+    uint64_t before = get_stats(rx).incomplete_frames;
+    CHECK(inject_frag(rx, 10, 10, VTX_FRAME_A, 0, 2) == VTX_OK);
+    CHECK(inject_frag(rx, 12, 11, VTX_FRAME_P, 0, 3) == VTX_OK);
+    CHECK(get_stats(rx).pool_used_frames == 3);
+
+    usleep((FRAME_TIMEOUT + 20) * 1000);
+    vtx_rx_poll(rx, 1);
+
+    vtx_rx_stats_t stats = get_stats(rx);
+    CHECK(stats.incomplete_frames == before + 2);
+    CHECK(stats.pool_used_frames == 1);
+}
+
+int main(void) {
+    printf("=== VTX RX Queue Test ===\n\n");
+
+    vtx_init(NULL);
+
+    /* 不连接：应答发往discard端口 */
+    vtx_rx_config_t config = {
+        .server_addr = "127.0.0.1",
+        .server_port = 9,
+        .mtu = VTX_DEFAULT_MTU,
+        .frame_timeout_ms = FRAME_TIMEOUT,
+    };
+    vtx_rx_t* rx = vtx_rx_create(&config, on_frame, NULL, NULL, NULL);
+    CHECK(rx != NULL);
+    if (!rx) {
+        vtx_fini();
+        VTX_TEST_RESULT();
+    }
+
+    test_purge_before_key_frame(rx);
+    test_timeout_cleanup(rx);
+
+    vtx_rx_destroy(rx);
+    vtx_fini();
+
+    VTX_TEST_RESULT();
+}
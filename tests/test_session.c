@@ -0,0 +1,196 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_session.c
+ * @brief Test session tokens, resumption, handshake cookies and rate limiting
+ */
+
+#include "vtx_session.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+static void test_token(void) {
+    printf("Test 1: token generation and wire format\n");
+
+    vtx_session_t a, b;
+    vtx_session_open(&a);
+    vtx_session_open(&b);
+    CHECK(a.token != 0 && b.token != 0);
+    CHECK(a.token != b.token);
+    CHECK(!vtx_session_suspended(&a));
+
+    /* 网络字节序 */
+    uint8_t buf[VTX_SESSION_TOKEN_SIZE];
+    vtx_session_pack_token(0x0102030405060708ULL, buf);
+    CHECK(buf[0] == 0x01 && buf[7] == 0x08);
+    CHECK(vtx_session_unpack_token(buf) == 0x0102030405060708ULL);
+    vtx_session_pack_token(a.token, buf);
+    CHECK(vtx_session_unpack_token(buf) == a.token);
+}
+
+static void test_resume(void) {
+    printf("Test 2: suspend, resume and grace period\n");
+
+    vtx_session_t s;
+    vtx_session_open_token(&s, 0x1234);
+    vtx_session_suspend(&s, 1000);
+    CHECK(vtx_session_suspended(&s));
+    CHECK(!vtx_session_expired(&s, 1999, 1000));
+    CHECK(vtx_session_expired(&s, 2000, 1000));
+
+    /* 重复挂起不刷新宽限期起点 */
+    vtx_session_suspend(&s, 1500);
+    CHECK(vtx_session_expired(&s, 2000, 1000));
+
+    /* 错误令牌不能恢复，正确令牌恢复为活跃 */
+    CHECK(!vtx_session_resume(&s, 0x4321));
+    CHECK(vtx_session_suspended(&s));
+    CHECK(vtx_session_resume(&s, 0x1234));
+    CHECK(!vtx_session_suspended(&s));
+    CHECK(!vtx_session_expired(&s, 100000, 1000));
+
+    /* 关闭后任何令牌（包括0）都不能恢复 */
+    vtx_session_close(&s);
+    CHECK(!vtx_session_resume(&s, 0x1234));
+    CHECK(!vtx_session_resume(&s, 0));
+    vtx_session_suspend(&s, 3000);
+    CHECK(!vtx_session_suspended(&s));
+}
+
+/* SipHash-2-4参考向量（论文附录：密钥00..0f，消息00..len-1） */
+static void test_siphash(void) {
+    printf("Test 3: SipHash-2-4 known answers\n");
+
+    static const struct {
+        size_t   len;
+        uint64_t hash;
+    } vectors[] = {
+        {  0, 0x726fdb47dd0e0e31ULL },
+        {  1, 0x74f839c593dc67fdULL },
+        {  7, 0xab0200f58b01d137ULL },
+        {  8, 0x93f5f5799a932462ULL },
+        { 15, 0xa129ca6149be45e5ULL },
+        { 63, 0x958a324ceb064572ULL },
+    };
+
+    uint8_t key[VTX_COOKIE_KEY_SIZE];
+    uint8_t msg[64];
+    for (int i = 0; i < VTX_COOKIE_KEY_SIZE; i++) key[i] = (uint8_t)i;
+    for (int i = 0; i < 64; i++) msg[i] = (uint8_t)i;
+
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        uint64_t h = vtx_siphash24(key, msg, vectors[i].len);
+        if (h != vectors[i].hash) {
+            printf("  len=%zu got=%016llx want=%016llx\n", vectors[i].len,
+                   (unsigned long long)h, (unsigned long long)vectors[i].hash);
+        }
+        CHECK(h == vectors[i].hash);
+    }
+}
+
+static void test_cookie(void) {
+    printf("Test 4: handshake cookies\n");
+
+    uint8_t key[VTX_COOKIE_KEY_SIZE] = { 1, 2, 3 };
+    uint8_t key2[VTX_COOKIE_KEY_SIZE] = { 3, 2, 1 };
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(5000);
+    inet_pton(AF_INET, "192.0.2.1", &addr.sin_addr);
+    struct sockaddr_in other = addr;
+    other.sin_port = htons(5001);
+
+    uint64_t now = 10 * VTX_COOKIE_PERIOD_MS + 5;
+    uint64_t cookie = vtx_session_cookie(key, &addr, now);
+    CHECK(cookie != 0);
+    CHECK(vtx_session_cookie_valid(key, &addr, cookie, now));
+    /* 上一个时间片有效，再往后无效 */
+    CHECK(vtx_session_cookie_valid(key, &addr, cookie, now + VTX_COOKIE_PERIOD_MS));
+    CHECK(!vtx_session_cookie_valid(key, &addr, cookie, now + 2 * VTX_COOKIE_PERIOD_MS));
+    /* 绑定地址、端口和密钥 */
+    CHECK(!vtx_session_cookie_valid(key, &other, cookie, now));
+    CHECK(!vtx_session_cookie_valid(key2, &addr, cookie, now));
+    CHECK(!vtx_session_cookie_valid(key, &addr, 0, now));
+}
+
+static vtx_ratelimit_t g_rl;
+
+static void test_ratelimit(void) {
+    printf("Test 5: per-source rate limiting\n");
+
+    const uint32_t rate = 10;
+    uint64_t now = 1000;
+    memset(&g_rl, 0, sizeof(g_rl));
+
+    /* 突发上限为rate，之后按每秒rate个补充 */
+    int allowed = 0;
+    for (int i = 0; i < 20; i++) {
+        allowed += vtx_ratelimit_allow(&g_rl, 0x0A000001, now, rate);
+    }
+    CHECK(allowed == (int)rate);
+    CHECK(!vtx_ratelimit_allow(&g_rl, 0x0A000001, now + 99, rate));
+    CHECK(vtx_ratelimit_allow(&g_rl, 0x0A000001, now + 100, rate));
+
+    /* 大量源地址互相冲突：总放行数不能超过表能容纳的满桶之和，
+     * 被挤出的地址回来时不能重新得到满桶 */
+    memset(&g_rl, 0, sizeof(g_rl));
+    allowed = 0;
+    for (int round = 0; round < 50; round++) {
+        for (uint32_t a = 1; a <= 1024; a++) {
+            allowed += vtx_ratelimit_allow(&g_rl, htonl(0xC0A80000 + a), now, rate);
+        }
+    }
+    CHECK(allowed <= (int)(VTX_RATELIMIT_SLOTS * rate));
+
+    /* 组内不超过路数的地址互不影响 */
+    memset(&g_rl, 0, sizeof(g_rl));
+    uint32_t same_set[VTX_RATELIMIT_WAYS];
+    int found = 0;
+    uint32_t set0 = (uint32_t)(1u * 2654435769u) >> 24;
+    for (uint32_t a = 1; found < VTX_RATELIMIT_WAYS && a < 1000000; a++) {
+        uint32_t set = (uint32_t)(a * 2654435769u) >> 24;
+        if (set % (VTX_RATELIMIT_SLOTS / VTX_RATELIMIT_WAYS) ==
+            set0 % (VTX_RATELIMIT_SLOTS / VTX_RATELIMIT_WAYS)) {
+            same_set[found++] = a;
+        }
+    }
+    CHECK(found == VTX_RATELIMIT_WAYS);
+    for (int i = 0; i < found; i++) {
+        allowed = 0;
+        for (int j = 0; j < (int)rate; j++) {
+            allowed += vtx_ratelimit_allow(&g_rl, same_set[i], now, rate);
+        }
+        CHECK(allowed == (int)rate);
+    }
+    for (int i = 0; i < found; i++) {
+        CHECK(!vtx_ratelimit_allow(&g_rl, same_set[i], now, rate));
+    }
+}
+
+int main(void) {
+    printf("=== VTX Session Test ===\n\n");
+
+    test_token();
+    test_resume();
+    test_siphash();
+    test_cookie();
+    test_ratelimit();
+
+    VTX_TEST_RESULT();
+}
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_soak.c
+ * @brief VTX Scale/Soak Test
+ *
+ * 长时间压力测试（CMake目标 soak）：
+ * - 同一进程内通过回环地址运行数百对TX/RX，发送端按drop_rate随机丢弃媒体分片
+ * - 按采样间隔记录RSS、帧池（已创建/使用中帧数）、vtx_mem当前字节数和端到端p99延迟
+ * - 预热期之后比较首段与末段（各1/4采样）：RSS或vtx_mem增长超过阈值、
+ *   帧池使用中帧数持续增长、末段p99比首段p99劣化超过倍数时判定失败
+ *   （帧池已创建帧数是峰值水位，随偶发突发缓慢上升，只输出不判定）
+ *
+ * 用法：test_soak [-n 对数] [-d 秒数] [-l 丢包率] [-i 采样秒数] [-w 预热秒数]
+ *                 [-m RSS增长上限MB] [-r p99劣化倍数] [-f p99判定下限ms]
+ *                 [-p p99上限ms] [-b 起始端口]
+ */
+
+#include "vtx.h"
+#include "vtx_frame.h"
+#include "vtx_mem.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+
+#define SOAK_MAX_PAIRS          1024
+#define SOAK_MAX_SAMPLES        100000
+#define SOAK_FPS                30
+#define SOAK_GOP                30
+#define SOAK_P_SIZE             4000
+#define SOAK_I_SIZE             40000
+
+/* 测试参数 */
+static struct {
+    int         pairs;          /* TX/RX对数 */
+    uint32_t    duration_s;     /* 运行时间 */
+    float       drop_rate;      /* 媒体分片丢包率 */
+    uint32_t    sample_s;       /* 采样间隔 */
+    uint32_t    warmup_s;       /* 预热时间（不参与判定） */
+    uint32_t    max_rss_growth_mb; /* 预热后允许的RSS增长 */
+    double      max_p99_ratio;  /* 末段p99 / 首段p99 上限 */
+    uint32_t    p99_floor_ms;   /* 末段p99低于该值时不做劣化判定（避免微秒级抖动误报） */
+    uint32_t    max_p99_ms;     /* p99绝对上限（0表示不检查） */
+    uint16_t    base_port;
+} g_opts = {
+    .pairs = 200,
+    .duration_s = 300,
+    .drop_rate = 0.01f,
+    .sample_s = 5,
+    .warmup_s = 30,
+    .max_rss_growth_mb = 64,
+    .max_p99_ratio = 3.0,
+    .p99_floor_ms = 20,
+    .max_p99_ms = 0,
+    .base_port = 19000,
+};
+
+/* 一对TX/RX */
+typedef struct {
+    int                 index;
+    vtx_tx_t*           tx;
+    vtx_rx_t*           rx;
+    pthread_t           tx_thread;
+    pthread_t           rx_thread;
+    volatile int        connected;
+    pthread_mutex_t     lock;           /* 保护latency */
+    vtx_latency_hist_t  latency;        /* 端到端延迟（累计） */
+} soak_pair_t;
+
+/* 一次采样 */
+typedef struct {
+    uint64_t            time_us;
+    uint64_t            rss_kb;
+    uint64_t            mem_bytes;      /* vtx_mem当前字节数（仅MEM_DEBUG） */
+    uint64_t            pool_frames;    /* 所有帧池已创建帧数 */
+    uint64_t            tx_pool_used;   /* 发送端帧池使用中帧数 */
+    uint64_t            rx_pool_used;   /* 接收端帧池使用中帧数 */
+    uint64_t            frames;         /* 累计接收帧数 */
+    uint64_t            p99_us;         /* 本采样区间的p99 */
+    vtx_latency_hist_t  latency;        /* 累计延迟（用于计算区间分位数） */
+} soak_sample_t;
+
+static volatile int g_running = 1;
+static soak_pair_t* g_pairs = NULL;
+static soak_sample_t* g_samples = NULL;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_running = 0;
+}
+
+static uint64_t rss_kb(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) {
+        return 0;
+    }
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+    return n == 2 ? (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE) / 1024 : 0;
+}
+
+/* RX回调：帧头8字节为发送时间 */
+static int on_frame(
+    const uint8_t* frame_data,
+    size_t frame_size,
+    vtx_frame_type_t frame_type,
+    void* userdata)
+{
+    (void)frame_type;
+    soak_pair_t* p = (soak_pair_t*)userdata;
+
+    if (frame_size >= sizeof(uint64_t)) {
+        uint64_t sent_us;
+        memcpy(&sent_us, frame_data, sizeof(sent_us));
+        uint64_t now = now_us();
+        pthread_mutex_lock(&p->lock);
+        vtx_latency_hist_record(&p->latency, now >= sent_us ? now - sent_us : 0);
+        pthread_mutex_unlock(&p->lock);
+    }
+    return VTX_OK;
+}
+
+static void* rx_thread(void* arg) {
+    soak_pair_t* p = (soak_pair_t*)arg;
+    while (g_running) {
+        vtx_rx_poll(p->rx, 50);
+    }
+    return NULL;
+}
+
+/* TX线程：接受连接后按帧率发送合成帧 */
+static void* tx_thread(void* arg) {
+    soak_pair_t* p = (soak_pair_t*)arg;
+
+    while (g_running && !p->connected) {
+        if (vtx_tx_accept(p->tx, 200) == VTX_OK) {
+            p->connected = 1;
+        }
+    }
+
+    uint64_t interval_us = 1000000ULL / SOAK_FPS;
+    uint64_t next_us = now_us();
+    uint32_t seed = (uint32_t)p->index * 2654435761u + 1;
+    uint64_t frame_no = 0;
+
+    while (g_running) {
+        uint64_t now = now_us();
+        if (now < next_us) {
+            /* timeout为0时select会一直阻塞，至少等1ms */
+            vtx_tx_poll(p->tx, (uint32_t)((next_us - now + 999) / 1000));
+            continue;
+        }
+        next_us += interval_us;
+
+        bool key = frame_no++ % SOAK_GOP == 0;
+        vtx_frame_t* frame = vtx_tx_alloc_media_frame(p->tx);
+        if (!frame) {
+            continue;
+        }
+        seed = seed * 1103515245u + 12345u;
+        size_t size = key ? SOAK_I_SIZE : SOAK_P_SIZE / 2 + (seed >> 8) % SOAK_P_SIZE;
+        uint64_t sent_us = now_us();
+        memcpy(frame->data, &sent_us, sizeof(sent_us));
+        frame->data_size = size;
+        frame->frame_type = key ? VTX_FRAME_I : VTX_FRAME_P;
+        vtx_tx_send_media(p->tx, frame);
+    }
+    return NULL;
+}
+
+static int pair_start(soak_pair_t* p) {
+    uint16_t port = (uint16_t)(g_opts.base_port + p->index);
+    pthread_mutex_init(&p->lock, NULL);
+
+    vtx_tx_config_t tx_config = {
+        .bind_addr = "127.0.0.1",
+        .bind_port = port,
+        .mtu = VTX_DEFAULT_MTU,
+        .drop_rate = g_opts.drop_rate,
+    };
+    p->tx = vtx_tx_create(&tx_config, NULL, NULL, NULL);
+    if (!p->tx || vtx_tx_listen(p->tx) != VTX_OK) {
+        fprintf(stderr, "Pair %d: failed to listen on %u\n", p->index, port);
+        return -1;
+    }
+
+    vtx_rx_config_t rx_config = {
+        .server_addr = "127.0.0.1",
+        .server_port = port,
+        .mtu = VTX_DEFAULT_MTU,
+        .frame_timeout_ms = VTX_DEFAULT_FRAME_TIMEOUT_MS,
+    };
+    p->rx = vtx_rx_create(&rx_config, on_frame, NULL, NULL, p);
+    if (!p->rx) {
+        fprintf(stderr, "Pair %d: failed to create RX\n", p->index);
+        return -1;
+    }
+
+    pthread_create(&p->rx_thread, NULL, rx_thread, p);
+    pthread_create(&p->tx_thread, NULL, tx_thread, p);
+    vtx_rx_connect(p->rx);
+    return 0;
+}
+
+static void pair_stop(soak_pair_t* p) {
+    if (p->tx && p->rx) {
+        pthread_join(p->tx_thread, NULL);
+        pthread_join(p->rx_thread, NULL);
+    }
+    if (p->rx) {
+        vtx_rx_close(p->rx);
+        vtx_rx_destroy(p->rx);
+    }
+    if (p->tx) {
+        vtx_tx_close(p->tx);
+        vtx_tx_destroy(p->tx);
+    }
+    pthread_mutex_destroy(&p->lock);
+}
+
+/* 采样：汇总所有对的统计 */
+static void take_sample(soak_sample_t* s, const soak_sample_t* prev) {
+    memset(s, 0, sizeof(*s));
+    s->time_us = now_us();
+    s->rss_kb = rss_kb();
+
+#ifdef MEM_DEBUG
+    vtx_mem_stats_t mem;
+    if (vtx_mem_get_stats(&mem) == VTX_OK) {
+        s->mem_bytes = mem.current_bytes;
+    }
+#endif
+
+    for (int i = 0; i < g_opts.pairs; i++) {
+        soak_pair_t* p = &g_pairs[i];
+        vtx_tx_stats_t tx_stats;
+        vtx_rx_stats_t rx_stats;
+        if (vtx_tx_get_stats(p->tx, &tx_stats) == VTX_OK) {
+            s->pool_frames += tx_stats.pool_frames;
+            s->tx_pool_used += tx_stats.pool_used_frames;
+        }
+        if (vtx_rx_get_stats(p->rx, &rx_stats) == VTX_OK) {
+            s->pool_frames += rx_stats.pool_frames;
+            s->rx_pool_used += rx_stats.pool_used_frames;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        s->latency.count += p->latency.count;
+        s->latency.sum_us += p->latency.sum_us;
+        if (p->latency.max_us > s->latency.max_us) {
+            s->latency.max_us = p->latency.max_us;
+        }
+        for (int b = 0; b < VTX_LATENCY_BUCKETS; b++) {
+            s->latency.buckets[b] += p->latency.buckets[b];
+        }
+        pthread_mutex_unlock(&p->lock);
+    }
+    s->frames = s->latency.count;
+
+    /* 区间分位数 = 本次累计 - 上次累计 */
+    vtx_latency_hist_t window = s->latency;
+    if (prev) {
+        window.count -= prev->latency.count;
+        window.sum_us -= prev->latency.sum_us;
+        for (int b = 0; b < VTX_LATENCY_BUCKETS; b++) {
+            window.buckets[b] -= prev->latency.buckets[b];
+        }
+    }
+    s->p99_us = vtx_latency_hist_percentile(&window, 99.0);
+}
+
+static double mean_of(const soak_sample_t* s, int from, int to, size_t field) {
+    if (to <= from) {
+        return 0;
+    }
+    double sum = 0;
+    for (int i = from; i < to; i++) {
+        sum += (double)*(const uint64_t*)((const uint8_t*)&s[i] + field);
+    }
+    return sum / (to - from);
+}
+
+/* 判定：预热后的首段（1/4）与末段（1/4）比较 */
+static int evaluate(int count) {
+    int first = 0;
+    while (first < count &&
+           g_samples[first].time_us - g_samples[0].time_us < (uint64_t)g_opts.warmup_s * 1000000ULL) {
+        first++;
+    }
+    int usable = count - first;
+    if (usable < 4) {
+        printf("Not enough samples after warm-up (%d), increase -d\n", usable);
+        return -1;
+    }
+
+    int quarter = usable / 4;
+    int head_end = first + quarter;
+    int tail_begin = count - quarter;
+    int failed = 0;
+
+    double rss_head = mean_of(g_samples, first, head_end, offsetof(soak_sample_t, rss_kb));
+    double rss_tail = mean_of(g_samples, tail_begin, count, offsetof(soak_sample_t, rss_kb));
+    double mem_head = mean_of(g_samples, first, head_end, offsetof(soak_sample_t, mem_bytes));
+    double mem_tail = mean_of(g_samples, tail_begin, count, offsetof(soak_sample_t, mem_bytes));
+    double pool_head = mean_of(g_samples, first, head_end, offsetof(soak_sample_t, pool_frames));
+    double pool_tail = mean_of(g_samples, tail_begin, count, offsetof(soak_sample_t, pool_frames));
+    double used_head = mean_of(g_samples, first, head_end, offsetof(soak_sample_t, tx_pool_used)) +
+                       mean_of(g_samples, first, head_end, offsetof(soak_sample_t, rx_pool_used));
+    double used_tail = mean_of(g_samples, tail_begin, count, offsetof(soak_sample_t, tx_pool_used)) +
+                       mean_of(g_samples, tail_begin, count, offsetof(soak_sample_t, rx_pool_used));
+    double p99_head = mean_of(g_samples, first, head_end, offsetof(soak_sample_t, p99_us));
+    double p99_tail = mean_of(g_samples, tail_begin, count, offsetof(soak_sample_t, p99_us));
+
+    printf("\n=== Soak Result (%d samples after warm-up) ===\n", usable);
+    printf("RSS:         %.1fMB -> %.1fMB\n", rss_head / 1024, rss_tail / 1024);
+    printf("vtx_mem:     %.1fKB -> %.1fKB\n", mem_head / 1024, mem_tail / 1024);
+    printf("pool frames: %.0f -> %.0f (in use %.0f -> %.0f)\n",
+           pool_head, pool_tail, used_head, used_tail);
+    printf("p99 latency: %.2fms -> %.2fms\n", p99_head / 1000, p99_tail / 1000);
+
+    double limit_kb = (double)g_opts.max_rss_growth_mb * 1024;
+    if (rss_tail - rss_head > limit_kb) {
+        printf("FAIL: RSS grew by %.1fMB (limit %uMB)\n",
+               (rss_tail - rss_head) / 1024, g_opts.max_rss_growth_mb);
+        failed = 1;
+    }
+    if (mem_tail - mem_head > limit_kb * 1024) {
+        printf("FAIL: vtx_mem grew by %.1fMB (limit %uMB)\n",
+               (mem_tail - mem_head) / 1024 / 1024, g_opts.max_rss_growth_mb);
+        failed = 1;
+    }
+    /* 使用中帧数应围绕稳态波动：翻倍且每对多出一帧以上视为泄漏或积压 */
+    if (used_tail > used_head * 2 + g_opts.pairs) {
+        printf("FAIL: frames in use grew from %.0f to %.0f\n", used_head, used_tail);
+        failed = 1;
+    }
+    if (p99_head > 0 && p99_tail > p99_head * g_opts.max_p99_ratio &&
+        p99_tail > g_opts.p99_floor_ms * 1000.0) {
+        printf("FAIL: p99 latency regressed %.1fx (limit %.1fx)\n",
+               p99_tail / p99_head, g_opts.max_p99_ratio);
+        failed = 1;
+    }
+    if (g_opts.max_p99_ms > 0 && p99_tail > g_opts.max_p99_ms * 1000.0) {
+        printf("FAIL: p99 latency %.2fms above %ums\n", p99_tail / 1000, g_opts.max_p99_ms);
+        failed = 1;
+    }
+    if (g_samples[count - 1].frames == g_samples[first].frames) {
+        printf("FAIL: no frames received after warm-up\n");
+        failed = 1;
+    }
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:l:i:w:m:r:f:p:b:")) != -1) {
+        switch (opt) {
+        case 'n': g_opts.pairs = atoi(optarg); break;
+        case 'd': g_opts.duration_s = (uint32_t)atoi(optarg); break;
+        case 'l': g_opts.drop_rate = (float)atof(optarg); break;
+        case 'i': g_opts.sample_s = (uint32_t)atoi(optarg); break;
+        case 'w': g_opts.warmup_s = (uint32_t)atoi(optarg); break;
+        case 'm': g_opts.max_rss_growth_mb = (uint32_t)atoi(optarg); break;
+        case 'r': g_opts.max_p99_ratio = atof(optarg); break;
+        case 'f': g_opts.p99_floor_ms = (uint32_t)atoi(optarg); break;
+        case 'p': g_opts.max_p99_ms = (uint32_t)atoi(optarg); break;
+        case 'b': g_opts.base_port = (uint16_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-n pairs] [-d seconds] [-l drop_rate] "
+                    "[-i sample_s] [-w warmup_s] [-m rss_growth_mb] [-r p99_ratio] "
+                    "[-f p99_floor_ms] [-p p99_ms] [-b base_port]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (g_opts.pairs < 1 || g_opts.pairs > SOAK_MAX_PAIRS || g_opts.sample_s == 0 ||
+        g_opts.base_port + g_opts.pairs - 1 > 65535) {
+        fprintf(stderr, "Invalid arguments\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("=== VTX Soak Test ===\n");
+    printf("pairs=%d duration=%us drop_rate=%.3f sample=%us warmup=%us\n\n",
+           g_opts.pairs, g_opts.duration_s, g_opts.drop_rate,
+           g_opts.sample_s, g_opts.warmup_s);
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    vtx_init(NULL);
+
+    g_pairs = (soak_pair_t*)calloc((size_t)g_opts.pairs, sizeof(soak_pair_t));
+    int max_samples = (int)(g_opts.duration_s / g_opts.sample_s) + 2;
+    if (max_samples > SOAK_MAX_SAMPLES) {
+        max_samples = SOAK_MAX_SAMPLES;
+    }
+    g_samples = (soak_sample_t*)calloc((size_t)max_samples, sizeof(soak_sample_t));
+    if (!g_pairs || !g_samples) {
+        return EXIT_FAILURE;
+    }
+
+    int started = 0;
+    for (; started < g_opts.pairs; started++) {
+        g_pairs[started].index = started;
+        if (pair_start(&g_pairs[started]) != 0) {
+            break;
+        }
+    }
+    int result = started == g_opts.pairs ? 0 : -1;
+
+    int count = 0;
+    uint64_t start_us = now_us();
+    uint64_t end_us = start_us + (uint64_t)g_opts.duration_s * 1000000ULL;
+    uint64_t next_us = start_us;
+    while (result == 0 && g_running && count < max_samples) {
+        uint64_t now = now_us();
+        if (now < next_us) {
+            usleep((useconds_t)(next_us - now < 200000 ? next_us - now : 200000));
+            continue;
+        }
+
+        soak_sample_t* s = &g_samples[count];
+        take_sample(s, count > 0 ? &g_samples[count - 1] : NULL);
+        count++;
+
+        int connected = 0;
+        for (int i = 0; i < g_opts.pairs; i++) {
+            connected += g_pairs[i].connected;
+        }
+        printf("[%6.0fs] connected=%d frames=%llu rss=%.1fMB vtx_mem=%.1fKB "
+               "pool(tx/rx/total)=%llu/%llu/%llu p99=%.2fms\n",
+               (double)(s->time_us - start_us) / 1e6, connected,
+               (unsigned long long)s->frames, (double)s->rss_kb / 1024,
+               (double)s->mem_bytes / 1024,
+               (unsigned long long)s->tx_pool_used, (unsigned long long)s->rx_pool_used,
+               (unsigned long long)s->pool_frames,
+               (double)s->p99_us / 1000);
+        fflush(stdout);
+
+        if (now >= end_us) {
+            break;
+        }
+        next_us += (uint64_t)g_opts.sample_s * 1000000ULL;
+    }
+
+    if (result == 0) {
+        result = evaluate(count);
+    }
+
+    g_running = 0;
+    for (int i = 0; i < g_opts.pairs; i++) {
+        if (i <= started) {
+            pair_stop(&g_pairs[i]);
+        }
+    }
+    free(g_samples);
+    free(g_pairs);
+    vtx_fini();
+
+    printf("\n%s\n", result == 0 ? "PASS" : "FAIL");
+    return result == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
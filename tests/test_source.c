@@ -0,0 +1,142 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_source.c
+ * @brief Test that the file media source stays inside its media root
+ */
+
+#include "vtx_source.h"
+#include "vtx_index.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static char g_dir[] = "/tmp/vtx_test_source_XXXXXX";
+static char g_root[sizeof(g_dir) + 16];
+
+/**
+ * @brief 写入最小的H.264流（SPS、PPS、IDR）
+ */
+static int write_stream(const char* path) {
+    static const uint8_t stream[] = {
+        0, 0, 0, 1, 0x67, 0x42, 0x11, 0x11,     /* SPS */
+        0, 0, 0, 1, 0x68, 0xce, 0x11, 0x11,     /* PPS */
+        0, 0, 0, 1, 0x65, 0x88, 0x11, 0x11,     /* IDR */
+    };
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = write(fd, stream, sizeof(stream));
+    close(fd);
+    return n == (ssize_t)sizeof(stream) ? 0 : -1;
+}
+
+static void path_in(char* buf, size_t size, const char* dir, const char* name) {
+    snprintf(buf, size, "%s/%s", dir, name);
+}
+
+static void test_invalid_root(void) {
+    printf("Test 1: media root must exist\n");
+
+    CHECK(vtx_source_create("/nonexistent/vtx_media", 25) == NULL);
+    CHECK(vtx_source_create(g_root, 0) == NULL);
+}
+
+static void test_containment(void) {
+    printf("Test 2: paths escaping the media root are rejected\n");
+
+    /* 根目录以带".."的路径给出，解析后比较 */
+    char root_alias[sizeof(g_root) + 16];
+    snprintf(root_alias, sizeof(root_alias), "%s/../root", g_root);
+    vtx_source_t* src = vtx_source_create(root_alias, 25);
+    CHECK(src != NULL);
+    if (!src) {
+        return;
+    }
+
+    /* 根目录内的文件和指向根目录内的符号链接可以播放 */
+    CHECK(vtx_source_start(src, "/in.h264") == VTX_OK);
+    CHECK(vtx_source_start(src, "/link_in.h264") == VTX_OK);
+    vtx_source_stop(src);
+
+    /* ".."、根目录外的符号链接（文件或目录）和同前缀的兄弟目录 */
+    CHECK(vtx_source_start(src, "/../out.h264") == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_source_start(src, "/sub/../../out.h264") == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_source_start(src, "/link_out.h264") == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_source_start(src, "/link_dir/out.h264") == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_source_start(src, "/link_sibling/in.h264") == VTX_ERR_INVALID_PARAM);
+    CHECK(vtx_source_start(src, "/missing.h264") == VTX_ERR_FILE_OPEN);
+
+    vtx_source_destroy(src);
+}
+
+int main(void) {
+    printf("=== VTX Source Test ===\n\n");
+
+    if (!mkdtemp(g_dir)) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    /* g_dir/root为媒体根目录，g_dir/out.h264在根目录之外，
+     * g_dir/rootx是与根目录同前缀的兄弟目录 */
+    char path[256];
+    char target[256];
+    path_in(g_root, sizeof(g_root), g_dir, "root");
+    mkdir(g_root, 0755);
+    path_in(path, sizeof(path), g_dir, "rootx");
+    mkdir(path, 0755);
+    path_in(path, sizeof(path), g_dir, "out.h264");
+    CHECK(write_stream(path) == 0);
+    path_in(path, sizeof(path), g_dir, "rootx/in.h264");
+    CHECK(write_stream(path) == 0);
+    path_in(path, sizeof(path), g_root, "in.h264");
+    CHECK(write_stream(path) == 0);
+
+    path_in(path, sizeof(path), g_root, "link_in.h264");
+    path_in(target, sizeof(target), g_root, "in.h264");
+    CHECK(symlink(target, path) == 0);
+    path_in(path, sizeof(path), g_root, "link_out.h264");
+    path_in(target, sizeof(target), g_dir, "out.h264");
+    CHECK(symlink(target, path) == 0);
+    path_in(path, sizeof(path), g_root, "link_dir");
+    CHECK(symlink(g_dir, path) == 0);
+    path_in(path, sizeof(path), g_root, "link_sibling");
+    path_in(target, sizeof(target), g_dir, "rootx");
+    CHECK(symlink(target, path) == 0);
+
+    test_invalid_root();
+    test_containment();
+
+    const char* names[] = {
+        "root/link_in.h264", "root/link_out.h264", "root/link_dir", "root/link_sibling",
+        "root/in.h264", "root/in.h264" VTX_INDEX_SUFFIX, "root",
+        "rootx/in.h264", "rootx", "out.h264",
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        path_in(path, sizeof(path), g_dir, names[i]);
+        remove(path);
+    }
+    rmdir(g_dir);
+
+    VTX_TEST_RESULT();
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_timeshift.c
+ * @brief Test time-shift ring byte accounting, eviction and keyframe replay
+ */
+
+#include "vtx_timeshift.h"
+#include "vtx_error.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 回放记录 */
+static vtx_frame_type_t g_types[64];
+static int g_count = 0;
+
+static int on_replay(const uint8_t* data, size_t size,
+                     vtx_frame_type_t frame_type, void* userdata) {
+    (void)data;
+    (void)size;
+    (void)userdata;
+    if (g_count < 64) {
+        g_types[g_count] = frame_type;
+    }
+    g_count++;
+    return 0;
+}
+
+static size_t pool_used(vtx_frame_pool_t* pool) {
+    vtx_frame_pool_stats_t stats;
+    vtx_frame_pool_get_stats(pool, &stats);
+    return stats.used_frames;
+}
+
+static void push(vtx_timeshift_t* ts, vtx_frame_pool_t* pool,
+                 vtx_frame_type_t type, size_t size, uint64_t now_ms) {
+    vtx_frame_t* frame = vtx_frame_pool_acquire(pool);
+    CHECK(frame != NULL);
+    if (!frame) {
+        return;
+    }
+    frame->frame_type = type;
+    frame->data_size = size;
+    memset(frame->data, 0x5a, size);
+    CHECK(vtx_timeshift_push(ts, pool, frame, now_ms) == VTX_OK);
+    vtx_frame_release(pool, frame);
+}
+
+static void test_pool_bounded(void) {
+    printf("Test 1: byte limit counts buffer capacity, pool usage stays bounded\n");
+
+    /* 512KB的媒体帧只装1000字节：按容量计，2MB最多保留4帧 */
+    size_t capacity = 512 * 1024;
+    vtx_frame_pool_t* pool = vtx_frame_pool_create(4, capacity);
+    vtx_timeshift_t* ts = vtx_timeshift_create(60000, 4 * capacity);
+    CHECK(pool != NULL && ts != NULL);
+    if (!pool || !ts) {
+        return;
+    }
+
+    for (int i = 0; i < 200; i++) {
+        push(ts, pool, i % 10 == 0 ? VTX_FRAME_I : VTX_FRAME_P, 1000, (uint64_t)i);
+        CHECK(pool_used(pool) <= 4);
+    }
+    CHECK(pool_used(pool) == 4);
+
+    /* 至少保留刚写入的一帧 */
+    vtx_timeshift_t* tiny = vtx_timeshift_create(60000, 1);
+    push(tiny, pool, VTX_FRAME_I, 10, 0);
+    push(tiny, pool, VTX_FRAME_P, 10, 1);
+    CHECK(pool_used(pool) == 5);
+
+    vtx_timeshift_destroy(tiny);
+    vtx_timeshift_destroy(ts);
+    CHECK(pool_used(pool) == 0);
+    vtx_frame_pool_destroy(pool);
+}
+
+static void test_replay(void) {
+    printf("Test 2: replay starts at SPS/PPS before the chosen keyframe\n");
+
+    vtx_frame_pool_t* pool = vtx_frame_pool_create(16, 64);
+    vtx_timeshift_t* ts = vtx_timeshift_create(60000, 1024 * 1024);
+    CHECK(pool != NULL && ts != NULL);
+    if (!pool || !ts) {
+        return;
+    }
+
+    g_count = 0;
+    CHECK(vtx_timeshift_replay(ts, UINT64_MAX, on_replay, NULL) == VTX_ERR_NOT_FOUND);
+
+    push(ts, pool, VTX_FRAME_P, 10, 0);      /* 关键帧之前的帧不回放 */
+    push(ts, pool, VTX_FRAME_SPS, 10, 10);
+    push(ts, pool, VTX_FRAME_PPS, 10, 10);
+    push(ts, pool, VTX_FRAME_I, 40, 10);
+    push(ts, pool, VTX_FRAME_P, 10, 20);
+    push(ts, pool, VTX_FRAME_SPS, 10, 100);
+    push(ts, pool, VTX_FRAME_PPS, 10, 100);
+    push(ts, pool, VTX_FRAME_I, 40, 100);
+    push(ts, pool, VTX_FRAME_P, 10, 110);
+
+    /* 最新的关键帧 */
+    g_count = 0;
+    CHECK(vtx_timeshift_replay(ts, UINT64_MAX, on_replay, NULL) == 4);
+    CHECK(g_count == 4);
+    CHECK(g_types[0] == VTX_FRAME_SPS && g_types[1] == VTX_FRAME_PPS &&
+          g_types[2] == VTX_FRAME_I && g_types[3] == VTX_FRAME_P);
+
+    /* 不晚于50ms的关键帧 */
+    g_count = 0;
+    CHECK(vtx_timeshift_replay(ts, 50, on_replay, NULL) == 8);
+    CHECK(g_types[0] == VTX_FRAME_SPS && g_types[2] == VTX_FRAME_I);
+
+    /* 早于所有关键帧：取最旧的关键帧 */
+    g_count = 0;
+    CHECK(vtx_timeshift_replay(ts, 0, on_replay, NULL) == 8);
+
+    vtx_timeshift_destroy(ts);
+    CHECK(pool_used(pool) == 0);
+    vtx_frame_pool_destroy(pool);
+}
+
+static void test_window(void) {
+    printf("Test 3: frames older than the time window are evicted\n");
+
+    vtx_frame_pool_t* pool = vtx_frame_pool_create(16, 64);
+    vtx_timeshift_t* ts = vtx_timeshift_create(100, 1024 * 1024);
+    CHECK(pool != NULL && ts != NULL);
+    if (!pool || !ts) {
+        return;
+    }
+
+    push(ts, pool, VTX_FRAME_I, 10, 0);
+    for (int i = 1; i <= 9; i++) {
+        push(ts, pool, VTX_FRAME_P, 10, (uint64_t)i * 10);
+    }
+    CHECK(pool_used(pool) == 10);
+
+    /* t=150：t<50的帧（包括唯一的关键帧）出环 */
+    push(ts, pool, VTX_FRAME_P, 10, 150);
+    CHECK(pool_used(pool) == 6);
+    g_count = 0;
+    CHECK(vtx_timeshift_replay(ts, UINT64_MAX, on_replay, NULL) == VTX_ERR_NOT_FOUND);
+
+    /* 槽位按需扩容 */
+    for (int i = 0; i < 1000; i++) {
+        push(ts, pool, i == 0 ? VTX_FRAME_I : VTX_FRAME_P, 10, 200);
+    }
+    g_count = 0;
+    CHECK(vtx_timeshift_replay(ts, UINT64_MAX, on_replay, NULL) == 1000);
+
+    vtx_timeshift_destroy(ts);
+    CHECK(pool_used(pool) == 0);
+    vtx_frame_pool_destroy(pool);
+}
+
+int main(void) {
+    printf("=== VTX Timeshift Test ===\n\n");
+
+    test_pool_bounded();
+    test_replay();
+    test_window();
+
+    VTX_TEST_RESULT();
+}
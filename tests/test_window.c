@@ -0,0 +1,205 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file test_window.c
+ * @brief Test the reliable DATA window and the media frame ID window
+ */
+
+#include "vtx_window.h"
+#include "vtx_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_resends = 0;
+static uint16_t g_last_resend_id = 0;
+
+static void on_resend(void* ctx, const vtx_data_slot_t* slot) {
+    (void)ctx;
+    g_resends++;
+    g_last_resend_id = slot->frame_id;
+}
+
+static vtx_data_window_t g_win;
+
+static void test_data_ack(void) {
+    printf("Test 1: DATA window reserve/commit/ack\n");
+
+    vtx_data_window_init(&g_win);
+    const uint8_t msg[] = "hello";
+    vtx_data_slot_t* slot = vtx_data_window_reserve(&g_win, 5, VTX_DATA_USER,
+                                                    msg, sizeof(msg));
+    CHECK(slot != NULL);
+    if (!slot) {
+        return;
+    }
+    CHECK(slot->size == sizeof(msg) && memcmp(slot->data, msg, sizeof(msg)) == 0);
+
+    /* 提交前ACK不可见 */
+    uint32_t rtt = 0;
+    CHECK(!vtx_data_window_ack(&g_win, 5, 100, &rtt));
+    vtx_data_window_commit(slot, 100);
+
+    /* 同一槽位（frame_id相差窗口大小）被占用：应返回NULL（调用者返回BUSY） */
+    CHECK(vtx_data_window_reserve(&g_win, 5 + VTX_DATA_WINDOW_SIZE,
+                                  VTX_DATA_USER, msg, 1) == NULL);
+    /* 其他槽位不受影响 */
+    vtx_data_slot_t* other = vtx_data_window_reserve(&g_win, 6, VTX_DATA_USER, NULL, 0);
+    CHECK(other != NULL);
+    if (other) {
+        vtx_data_window_commit(other, 100);
+        vtx_data_window_cancel(other);
+    }
+
+    /* 别名frame_id的ACK不能确认 */
+    CHECK(!vtx_data_window_ack(&g_win, 5 + VTX_DATA_WINDOW_SIZE, 120, &rtt));
+    CHECK(vtx_data_window_ack(&g_win, 5, 130, &rtt));
+    CHECK(rtt == 30);
+    /* 重复ACK */
+    CHECK(!vtx_data_window_ack(&g_win, 5, 131, &rtt));
+
+    /* 槽位已释放，可再次预留 */
+    slot = vtx_data_window_reserve(&g_win, 5 + VTX_DATA_WINDOW_SIZE,
+                                   VTX_DATA_LIMIT, msg, 1);
+    CHECK(slot != NULL);
+    if (slot) {
+        vtx_data_window_commit(slot, 200);
+        vtx_data_window_cancel(slot);
+    }
+
+    /* 超过VTX_CTRL_FRAME_DATA_SIZE */
+    static uint8_t big[VTX_CTRL_FRAME_DATA_SIZE + 1];
+    CHECK(vtx_data_window_reserve(&g_win, 7, VTX_DATA_USER, big, sizeof(big)) == NULL);
+}
+
+static void test_data_retrans(void) {
+    printf("Test 2: DATA window retransmission and Karn RTT\n");
+
+    vtx_data_window_init(&g_win);
+    vtx_data_slot_t* slot = vtx_data_window_reserve(&g_win, 9, VTX_DATA_USER,
+                                                    (const uint8_t*)"x", 1);
+    CHECK(slot != NULL);
+    if (!slot) {
+        return;
+    }
+    vtx_data_window_commit(slot, 1000);
+
+    g_resends = 0;
+    vtx_data_window_process(&g_win, 1049, 50, 2, on_resend, NULL);
+    CHECK(g_resends == 0);
+    vtx_data_window_process(&g_win, 1050, 50, 2, on_resend, NULL);
+    CHECK(g_resends == 1 && g_last_resend_id == 9);
+
+    /* 重传过的包不产生RTT样本 */
+    uint32_t rtt = 0;
+    CHECK(vtx_data_window_ack(&g_win, 9, 1060, &rtt));
+    CHECK(rtt == VTX_DATA_NO_RTT);
+
+    /* 达到最大重传次数后丢弃，槽位释放 */
+    slot = vtx_data_window_reserve(&g_win, 10, VTX_DATA_USER, NULL, 0);
+    CHECK(slot != NULL);
+    if (!slot) {
+        return;
+    }
+    vtx_data_window_commit(slot, 0);
+    g_resends = 0;
+    for (uint64_t t = 100; t <= 500; t += 100) {
+        vtx_data_window_process(&g_win, t, 50, 2, on_resend, NULL);
+    }
+    CHECK(g_resends == 2);
+    CHECK(!vtx_data_window_ack(&g_win, 10, 600, &rtt));
+    CHECK(vtx_data_window_reserve(&g_win, 10, VTX_DATA_USER, NULL, 0) != NULL);
+}
+
+static void test_fid_window(void) {
+    printf("Test 3: frame ID window new/done/stale\n");
+
+    vtx_fid_window_t win;
+    vtx_fid_window_reset(&win);
+
+    /* 首个分片定位窗口，标记后为迟到分片 */
+    CHECK(vtx_fid_window_check(&win, 100) == VTX_FID_NEW);
+    CHECK(vtx_fid_window_check(&win, 100) == VTX_FID_NEW);
+    vtx_fid_window_mark(&win, 100);
+    CHECK(vtx_fid_window_check(&win, 100) == VTX_FID_DONE);
+
+    /* 窗口内较旧但未完成的帧仍可重组 */
+    CHECK(vtx_fid_window_check(&win, 101) == VTX_FID_NEW);
+    CHECK(vtx_fid_window_check(&win, 99) == VTX_FID_NEW);
+    vtx_fid_window_mark(&win, 99);
+    CHECK(vtx_fid_window_check(&win, 99) == VTX_FID_DONE);
+
+    /* 窗口前进时清除新进入窗口的位 */
+    uint16_t ahead = (uint16_t)(100 + VTX_FID_WINDOW_SIZE);
+    CHECK(vtx_fid_window_check(&win, ahead) == VTX_FID_NEW);
+    CHECK(vtx_fid_window_check(&win, 100) == VTX_FID_STALE);
+
+    /* 窗口外的mark被忽略 */
+    vtx_fid_window_mark(&win, (uint16_t)(ahead + 1));
+    CHECK(vtx_fid_window_check(&win, (uint16_t)(ahead + 1)) == VTX_FID_NEW);
+
+    /* 复位后同一frame_id重新成为新帧（重新START后发送端重发I帧） */
+    vtx_fid_window_mark(&win, ahead);
+    CHECK(vtx_fid_window_check(&win, ahead) == VTX_FID_DONE);
+    vtx_fid_window_reset(&win);
+    CHECK(vtx_fid_window_check(&win, ahead) == VTX_FID_NEW);
+}
+
+static void test_fid_window_wrap(void) {
+    printf("Test 4: frame ID window wraparound and resync\n");
+
+    vtx_fid_window_t win;
+    vtx_fid_window_reset(&win);
+
+    /* frame_id回绕：65535之后的0是新帧，65535仍在窗口内 */
+    CHECK(vtx_fid_window_check(&win, 65535) == VTX_FID_NEW);
+    vtx_fid_window_mark(&win, 65535);
+    CHECK(vtx_fid_window_check(&win, 0) == VTX_FID_NEW);
+    CHECK(vtx_fid_window_check(&win, 65535) == VTX_FID_DONE);
+    vtx_fid_window_mark(&win, 0);
+    CHECK(vtx_fid_window_check(&win, 0) == VTX_FID_DONE);
+
+    /* 发送端frame_id重新开始：连续过旧分片达到阈值后重新定位 */
+    vtx_fid_window_reset(&win);
+    CHECK(vtx_fid_window_check(&win, 30000) == VTX_FID_NEW);
+    for (int i = 1; i < VTX_FID_STALE_RESYNC; i++) {
+        CHECK(vtx_fid_window_check(&win, 1) == VTX_FID_STALE);
+    }
+    CHECK(vtx_fid_window_check(&win, 1) == VTX_FID_NEW);
+    CHECK(vtx_fid_window_check(&win, 2) == VTX_FID_NEW);
+    vtx_fid_window_mark(&win, 1);
+    CHECK(vtx_fid_window_check(&win, 1) == VTX_FID_DONE);
+
+    /* 窗口内的分片打断过旧计数 */
+    vtx_fid_window_reset(&win);
+    CHECK(vtx_fid_window_check(&win, 30000) == VTX_FID_NEW);
+    for (int i = 1; i < VTX_FID_STALE_RESYNC; i++) {
+        CHECK(vtx_fid_window_check(&win, 1) == VTX_FID_STALE);
+    }
+    CHECK(vtx_fid_window_check(&win, 29999) == VTX_FID_NEW);
+    CHECK(vtx_fid_window_check(&win, 1) == VTX_FID_STALE);
+}
+
+int main(void) {
+    printf("=== VTX Window Test ===\n\n");
+
+    test_data_ack();
+    test_data_retrans();
+    test_fid_window();
+    test_fid_window_wrap();
+
+    VTX_TEST_RESULT();
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2025 ArdKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file vtx_test.h
+ * @brief Shared check helpers for unit tests
+ *
+ * 每个测试是一个独立的可执行文件：CHECK()失败时打印位置并计数，
+ * main()最后用VTX_TEST_RESULT()打印汇总并返回退出码
+ */
+
+#ifndef VTX_TEST_H
+#define VTX_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int g_failed = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failed++; \
+    } \
+} while (0)
+
+#define VTX_TEST_RESULT() do { \
+    printf("\n=== %s (%d failures) ===\n", g_failed ? "FAILED" : "All tests passed", g_failed); \
+    return g_failed ? EXIT_FAILURE : EXIT_SUCCESS; \
+} while (0)
+
+#endif /* VTX_TEST_H */